@@ -0,0 +1,1628 @@
+/***********************************************************************************************************************
+* able_Benchmarks.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Offline benchmarks of the control computations, run instead of the motions when ctrl_type is MODEL_BENCH. No
+* connection to the robot is opened : each benchmark draws random states, compares the implementation used in the
+* control loop with its reference and times both. Results are printed in the outputs file.
+***********************************************************************************************************************/
+
+#include "able_Benchmarks.h"
+
+// Sink of the timed computations, prevents the compiler from removing them
+static volatile float bench_Sink = 0.0f;
+
+// Cleared to stop the threads loading the cores during the placement benchmark
+static volatile int bench_LoadRunning = 0;
+
+// ------------------------------------------------------ MAIN ---------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_RunAll - Run all offline benchmarks
+|
+| Syntax --
+|	int bench_RunAll(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|	AbleControlStruct* ctrl_ABLE -> control struct, robot parameters and dynamics loaded
+|
+| Outputs --
+|	int -> 0 if every benchmark met its accuracy bound, -1 otherwise
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_RunAll(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE)
+{
+	// Initialise variables
+	ThreadInformations ableInfos = {};
+	int exit_flag = 0;
+
+	ableInfos.ctrl_ABLE = ctrl_ABLE;
+	ableInfos.err_file = err_file;
+	ableInfos.out_file = out_file;
+	srand(1);
+
+	fprintf(out_file, "\n------------------------------- OFFLINE BENCHMARKS -------------------------------\n");
+	if (bench_DynamicModel(err_file, out_file, &ableInfos) != 0)
+	{
+		exit_flag = -1;
+	}
+	if (bench_CompensationMap(err_file, out_file, &ableInfos) != 0)
+	{
+		exit_flag = -1;
+	}
+	if (bench_InverseDynamics(err_file, out_file, &ableInfos) != 0)
+	{
+		exit_flag = -1;
+	}
+	if (bench_CartesianControl(err_file, out_file, &ableInfos) != 0)
+	{
+		exit_flag = -1;
+	}
+	if (bench_HapticScene(err_file, out_file) != 0)
+	{
+		exit_flag = -1;
+	}
+	if (bench_ForceStage(err_file, out_file) != 0)
+	{
+		exit_flag = -1;
+	}
+	if (bench_ControlRate(err_file, out_file) != 0)
+	{
+		exit_flag = -1;
+	}
+	if (bench_ThreadPlacement(err_file, out_file) != 0)
+	{
+		exit_flag = -1;
+	}
+	if (bench_ZeroAllocation(err_file, out_file, &ableInfos) != 0)
+	{
+		exit_flag = -1;
+	}
+	if (bench_RobotState(err_file, out_file, &ableInfos) != 0)
+	{
+		exit_flag = -1;
+	}
+	fprintf(out_file, "Benchmarks %s\n", exit_flag == 0 ? "passed" : "FAILED");
+	fflush(out_file);
+	fflush(err_file);
+	return exit_flag;
+}
+
+// -------------------------------------------------- DYNAMIC MODEL ----------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_DynamicModel - Accuracy and timing of the per-iteration model evaluation against able_ComputeDynModelStat
+|
+| Syntax --
+|	int bench_DynamicModel(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|	ThreadInformations* ableInfos -> informations struct, only ctrl_ABLE is used
+|
+| Outputs --
+|	int -> 0 if the model error is below BENCH_MODEL_TOLERANCE, -1 otherwise
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_DynamicModel(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+
+	// Initialise variables
+	static bench_State states[BENCH_NB_STATES];
+	float fast_torques[NB_MOTORS];
+	float ref_torque, fast_s, fast_c, x, error, sum;
+	double max_sin_error = 0.0, max_cos_error = 0.0, max_torque = 0.0;
+	double max_error[NB_MOTORS] = {};
+	double ref_ns, fast_ns;
+	long long start_tick;
+	int exit_flag = 0;
+
+	// Accuracy of the fused sin/cos over the tolerated range
+	for (int k(0); k < BENCH_NB_SINCOS; k++)
+	{
+		x = -MODEL_SINCOS_RANGE + 2 * MODEL_SINCOS_RANGE * (float)k / (BENCH_NB_SINCOS - 1);
+		model_FastSinCos(x, &fast_s, &fast_c);
+		error = (float)fabs(fast_s - sin((double)x));
+		if (error > max_sin_error)
+		{
+			max_sin_error = error;
+		}
+		error = (float)fabs(fast_c - cos((double)x));
+		if (error > max_cos_error)
+		{
+			max_cos_error = error;
+		}
+	}
+	fprintf(out_file, "Fused sin/cos, |x| < %.0f rad : max error sin %.3e, cos %.3e (bound %.1e)\n",
+		    MODEL_SINCOS_RANGE, max_sin_error, max_cos_error, MODEL_SINCOS_MAX_ERROR);
+	if (max_sin_error > MODEL_SINCOS_MAX_ERROR || max_cos_error > MODEL_SINCOS_MAX_ERROR)
+	{
+		fprintf(err_file, "Fused sin/cos error above its bound\n");
+		exit_flag = -1;
+	}
+
+	// Accuracy of the compensation torques against the reference implementation
+	bench_DrawStates(ctrl_ABLE, states, BENCH_NB_STATES);
+	for (int k(0); k < BENCH_NB_STATES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k]);
+		model_ComputeCompensation(ctrl_ABLE, fast_torques);
+		for (int i(NB_MOTORS - 2); i < NB_MOTORS; i++)
+		{
+			ref_torque = able_ComputeDynModelStat(ableInfos, i);
+			if (fabs(ref_torque) > max_torque)
+			{
+				max_torque = fabs(ref_torque);
+			}
+			if (fabs(fast_torques[i] - ref_torque) > max_error[i])
+			{
+				max_error[i] = fabs(fast_torques[i] - ref_torque);
+			}
+		}
+	}
+	for (int i(NB_MOTORS - 2); i < NB_MOTORS; i++)
+	{
+		fprintf(out_file, "Model compensation axis %i : max error %.3e (max torque %.3e)\n", i + 1, max_error[i],
+			    max_torque);
+		if (max_error[i] > BENCH_MODEL_TOLERANCE * max_torque)
+		{
+			fprintf(err_file, "Model compensation of axis %i differs from the reference\n", i + 1);
+			exit_flag = -1;
+		}
+	}
+
+	// Timing of the reference path (one call per modelled axis, as done before)
+	sum = 0.0f;
+	start_tick = timebase_Now();
+	for (int k(0); k < BENCH_NB_CYCLES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k % BENCH_NB_STATES]);
+		for (int i(NB_MOTORS - 2); i < NB_MOTORS; i++)
+		{
+			sum += able_ComputeDynModelStat(ableInfos, i);
+		}
+	}
+	ref_ns = timebase_Seconds(timebase_Now() - start_tick) * 1e9 / BENCH_NB_CYCLES;
+	bench_Sink = sum;
+
+	// Timing of the per-iteration evaluation
+	sum = 0.0f;
+	start_tick = timebase_Now();
+	for (int k(0); k < BENCH_NB_CYCLES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k % BENCH_NB_STATES]);
+		model_ComputeCompensation(ctrl_ABLE, fast_torques);
+		sum += fast_torques[NB_MOTORS - 2] + fast_torques[NB_MOTORS - 1];
+	}
+	fast_ns = timebase_Seconds(timebase_Now() - start_tick) * 1e9 / BENCH_NB_CYCLES;
+	bench_Sink = sum;
+
+	fprintf(out_file, "Model compensation per iteration : reference %.1f ns, fused %.1f ns (x%.2f)\n", ref_ns, fast_ns,
+		    fast_ns > 0 ? ref_ns / fast_ns : 0.0);
+	fflush(out_file);
+	return exit_flag;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_CompensationMap - Error against able_ComputeDynModelStat and timing of the compensation map for several grid
+|						  resolutions
+|
+| Syntax --
+|	int bench_CompensationMap(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|	ThreadInformations* ableInfos -> informations struct, only ctrl_ABLE is used
+|
+| Outputs --
+|	int -> 0 if the error at the default resolution is below BENCH_MAP_TOLERANCE, -1 otherwise
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_CompensationMap(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+
+	// Initialise variables
+	static bench_State states[BENCH_NB_STATES];
+	static float ref_torques[BENCH_NB_STATES][NB_MOTORS];
+	const int resolutions[] = { 8, 16, 32, 64, 128 };
+	const int nb_resolutions = sizeof(resolutions) / sizeof(resolutions[0]);
+	map_compensation saved_map = ctrl_ABLE->compMap;
+	float map_torques[NB_MOTORS];
+	float sum;
+	double max_torque[NB_MOTORS] = {};
+	double max_error[NB_MOTORS], sq_error[NB_MOTORS], error, build_ms, map_ns, analytic_ns;
+	long long start_tick;
+	int exit_flag = 0;
+
+	// Reference torques on random states inside the motion ranges
+	bench_DrawStates(ctrl_ABLE, states, BENCH_NB_STATES);
+	for (int k(0); k < BENCH_NB_STATES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k]);
+		for (int i(NB_MOTORS - 2); i < NB_MOTORS; i++)
+		{
+			ref_torques[k][i] = able_ComputeDynModelStat(ableInfos, i);
+			if (fabs(ref_torques[k][i]) > max_torque[i])
+			{
+				max_torque[i] = fabs(ref_torques[k][i]);
+			}
+		}
+	}
+
+	// Timing of the analytic backend on the same states
+	sum = 0.0f;
+	start_tick = timebase_Now();
+	for (int k(0); k < BENCH_NB_CYCLES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k % BENCH_NB_STATES]);
+		model_ComputeCompensation(ctrl_ABLE, map_torques);
+		sum += map_torques[NB_MOTORS - 2] + map_torques[NB_MOTORS - 1];
+	}
+	analytic_ns = timebase_Seconds(timebase_Now() - start_tick) * 1e9 / BENCH_NB_CYCLES;
+	bench_Sink = sum;
+
+	fprintf(out_file, "Compensation map against able_ComputeDynModelStat (analytic backend : %.1f ns)\n", analytic_ns);
+	fprintf(out_file, "   nodes    size (kB)  build (ms)  eval (ns)  axis 3 max / rms      axis 4 max / rms\n");
+	for (int r(0); r < nb_resolutions; r++)
+	{
+		// Build the map at this resolution
+		start_tick = timebase_Now();
+		if (model_BuildMap(ctrl_ABLE, &ctrl_ABLE->compMap, resolutions[r], MAP_NB_SLIDER) != 0)
+		{
+			fprintf(err_file, "Compensation map of %i nodes could not be built\n", resolutions[r]);
+			exit_flag = -1;
+			continue;
+		}
+		build_ms = timebase_Seconds(timebase_Now() - start_tick) * 1e3;
+
+		// Error against the reference
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			max_error[i] = 0.0;
+			sq_error[i] = 0.0;
+		}
+		for (int k(0); k < BENCH_NB_STATES; k++)
+		{
+			bench_ApplyState(ctrl_ABLE, &states[k]);
+			model_ComputeCompensationMap(ctrl_ABLE, map_torques);
+			for (int i(NB_MOTORS - 2); i < NB_MOTORS; i++)
+			{
+				error = fabs(map_torques[i] - ref_torques[k][i]);
+				sq_error[i] += error * error;
+				if (error > max_error[i])
+				{
+					max_error[i] = error;
+				}
+			}
+		}
+
+		// Timing of the evaluation
+		sum = 0.0f;
+		start_tick = timebase_Now();
+		for (int k(0); k < BENCH_NB_CYCLES; k++)
+		{
+			bench_ApplyState(ctrl_ABLE, &states[k % BENCH_NB_STATES]);
+			model_ComputeCompensationMap(ctrl_ABLE, map_torques);
+			sum += map_torques[NB_MOTORS - 2] + map_torques[NB_MOTORS - 1];
+		}
+		map_ns = timebase_Seconds(timebase_Now() - start_tick) * 1e9 / BENCH_NB_CYCLES;
+		bench_Sink = sum;
+
+		fprintf(out_file, "%4i^2x%i %10zu %11.2f %10.1f  %.2e / %.2e  %.2e / %.2e\n", resolutions[r], MAP_NB_SLIDER,
+			    ctrl_ABLE->compMap.nodes.size() * sizeof(map_Node) / 1024, build_ms, map_ns,
+			    max_error[NB_MOTORS - 2], sqrt(sq_error[NB_MOTORS - 2] / BENCH_NB_STATES),
+			    max_error[NB_MOTORS - 1], sqrt(sq_error[NB_MOTORS - 1] / BENCH_NB_STATES));
+
+		// Check the default resolution
+		if (resolutions[r] == MAP_NB_THETA)
+		{
+			for (int i(NB_MOTORS - 2); i < NB_MOTORS; i++)
+			{
+				if (max_error[i] > BENCH_MAP_TOLERANCE * max_torque[i])
+				{
+					fprintf(err_file, "Compensation map error of axis %i above tolerance\n", i + 1);
+					exit_flag = -1;
+				}
+			}
+		}
+	}
+	fprintf(out_file, "Max reference torque : axis 3 %.3e, axis 4 %.3e\n", max_torque[NB_MOTORS - 2],
+		    max_torque[NB_MOTORS - 1]);
+
+	// Restore the map used by the control loop
+	ctrl_ABLE->compMap = saved_map;
+	fflush(out_file);
+	return exit_flag;
+}
+
+// ------------------------------------------------- INVERSE DYNAMICS --------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_InverseDynamics - Check the Newton-Euler inverse dynamics and time the RNEA backend
+|
+| Syntax --
+|	int bench_InverseDynamics(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|	ThreadInformations* ableInfos -> informations struct, only ctrl_ABLE is used
+|
+| Outputs --
+|	int -> 0 if both checks are below BENCH_RNEA_TOLERANCE, -1 otherwise
+|
+| Remarks --
+|	Static check : with the identified links, axes 1 and 2 at 0 and no motion, the torques must be the gravity terms
+|	of the analytic model (axis 3 including the centre of mass of axis 4). Dynamic check : on random chains, the
+|	torques must satisfy Lagrange equations, M(q) qdd + dM/dt qd - 1/2 d(qd^T M(q) qd)/dq, the mass matrix being
+|	obtained from the recursion itself and differentiated numerically.
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_InverseDynamics(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+
+	// Initialise variables
+	static bench_State states[BENCH_NB_STATES];
+	const float zeros[NB_MOTORS] = {};
+	const float base_acc[3] = { -G_VAL, 0.0f, 0.0f };
+	const float no_gravity[3] = {};
+	rnea_Link links[NB_MOTORS];
+	map_Node node;
+	float q[NB_MOTORS], qd[NB_MOTORS], qdd[NB_MOTORS], cos_q[NB_MOTORS], sin_q[NB_MOTORS];
+	float tau[NB_MOTORS], tau_static[NB_MOTORS], torques[NB_MOTORS];
+	float mass_matrix[NB_MOTORS][NB_MOTORS], mass_plus[NB_MOTORS][NB_MOTORS], mass_minus[NB_MOTORS][NB_MOTORS];
+	float dmass[NB_MOTORS][NB_MOTORS][NB_MOTORS];
+	double expected, error, scale, max_static = 0.0, max_gravity = 0.0, max_dynamic = 0.0, max_torque = 0.0;
+	double max_asym = 0.0, rnea_ns, analytic_ns;
+	float sum;
+	long long start_tick;
+	int exit_flag = 0;
+
+	// Static check against the gravity terms of the analytic model
+	bench_DrawStates(ctrl_ABLE, states, BENCH_NB_STATES);
+	for (int k(0); k < BENCH_NB_STATES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k]);
+		model_BuildLinks(&ctrl_ABLE->aDynamics, links);
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			q[i] = i < NB_MOTORS - 2 ? 0.0f : states[k].position[i];
+			cos_q[i] = cosf(q[i]);
+			sin_q[i] = sinf(q[i]);
+		}
+		rnea_InverseDynamics<NB_MOTORS>(links, cos_q, sin_q, zeros, zeros, base_acc, tau);
+		model_ComputeNode(&ctrl_ABLE->aDynamics, q[NB_MOTORS - 2], q[NB_MOTORS - 1],
+			              ctrl_ABLE->aDynamics.axis4_mod.x_slider, &node);
+		error = fabs(tau[NB_MOTORS - 2] - (node.gravity3 + node.gravity4));
+		if (fabs(tau[NB_MOTORS - 1] - node.gravity4) > error)
+		{
+			error = fabs(tau[NB_MOTORS - 1] - node.gravity4);
+		}
+		if (error > max_static)
+		{
+			max_static = error;
+		}
+		if (fabs(node.gravity3 + node.gravity4) > max_gravity)
+		{
+			max_gravity = fabs(node.gravity3 + node.gravity4);
+		}
+	}
+	fprintf(out_file, "Inverse dynamics, static check against the analytic gravity : max error %.3e (max torque %.3e)\n",
+		    max_static, max_gravity);
+	if (max_static > BENCH_RNEA_TOLERANCE * max_gravity)
+	{
+		fprintf(err_file, "Inverse dynamics differ from the analytic gravity model\n");
+		exit_flag = -1;
+	}
+
+	// Dynamic check on random chains
+	for (int k(0); k < BENCH_RNEA_CHECKS; k++)
+	{
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			rnea_SetGeometry(&links[i], bench_Uniform(-(float)M_PI, (float)M_PI), bench_Uniform(0.0f, 0.4f),
+				             bench_Uniform(-0.2f, 0.2f));
+			links[i].mass = bench_Uniform(0.5f, 3.0f);
+			for (int j(0); j < 3; j++)
+			{
+				links[i].first_moment[j] = links[i].mass * bench_Uniform(-0.2f, 0.2f);
+			}
+			links[i].inertia[0] = bench_Uniform(0.01f, 0.1f);
+			links[i].inertia[1] = bench_Uniform(0.01f, 0.1f);
+			links[i].inertia[2] = bench_Uniform(0.01f, 0.1f);
+			links[i].inertia[3] = bench_Uniform(-0.005f, 0.005f);
+			links[i].inertia[4] = bench_Uniform(-0.005f, 0.005f);
+			links[i].inertia[5] = bench_Uniform(-0.005f, 0.005f);
+			links[i].rotor_inertia = bench_Uniform(0.0f, 0.05f);
+			q[i] = bench_Uniform(-(float)M_PI, (float)M_PI);
+			qd[i] = bench_Uniform(-BENCH_MAX_ART_SPEED, BENCH_MAX_ART_SPEED);
+			qdd[i] = bench_Uniform(-10.0f, 10.0f);
+			cos_q[i] = cosf(q[i]);
+			sin_q[i] = sinf(q[i]);
+		}
+
+		// Torques without gravity, mass matrix and its derivatives
+		rnea_InverseDynamics<NB_MOTORS>(links, cos_q, sin_q, qd, qdd, no_gravity, tau);
+		bench_MassMatrix(links, q, mass_matrix);
+		for (int m(0); m < NB_MOTORS; m++)
+		{
+			q[m] += BENCH_RNEA_STEP;
+			bench_MassMatrix(links, q, mass_plus);
+			q[m] -= 2 * BENCH_RNEA_STEP;
+			bench_MassMatrix(links, q, mass_minus);
+			q[m] += BENCH_RNEA_STEP;
+			for (int i(0); i < NB_MOTORS; i++)
+			{
+				for (int j(0); j < NB_MOTORS; j++)
+				{
+					dmass[m][i][j] = (mass_plus[i][j] - mass_minus[i][j]) / (2 * BENCH_RNEA_STEP);
+				}
+			}
+		}
+
+		// Lagrange equations
+		scale = 0.0;
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			expected = 0.0;
+			for (int j(0); j < NB_MOTORS; j++)
+			{
+				expected += mass_matrix[i][j] * qdd[j];
+				for (int m(0); m < NB_MOTORS; m++)
+				{
+					expected += dmass[m][i][j] * qd[m] * qd[j] - 0.5 * dmass[i][m][j] * qd[m] * qd[j];
+				}
+				if (fabs(mass_matrix[i][j] - mass_matrix[j][i]) > max_asym)
+				{
+					max_asym = fabs(mass_matrix[i][j] - mass_matrix[j][i]);
+				}
+			}
+			if (fabs(tau[i] - expected) > max_dynamic)
+			{
+				max_dynamic = fabs(tau[i] - expected);
+			}
+			if (fabs(tau[i]) > max_torque)
+			{
+				max_torque = fabs(tau[i]);
+			}
+		}
+	}
+	fprintf(out_file, "Inverse dynamics, Lagrange equations on %i random chains : max error %.3e (max torque %.3e), "
+		    "mass matrix asymmetry %.3e\n", BENCH_RNEA_CHECKS, max_dynamic, max_torque, max_asym);
+	if (max_dynamic > BENCH_RNEA_TOLERANCE * max_torque)
+	{
+		fprintf(err_file, "Inverse dynamics do not satisfy Lagrange equations\n");
+		exit_flag = -1;
+	}
+
+	// Timing of the RNEA backend against the analytic backend
+	ctrl_ABLE->rtParams.cycle_dt = ctrl_ABLE->rtParams.sampling_frequency;
+	ctrl_ABLE->rtParams.acc_initialised = 0;
+	sum = 0.0f;
+	start_tick = timebase_Now();
+	for (int k(0); k < BENCH_NB_CYCLES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k % BENCH_NB_STATES]);
+		model_ComputeCompensationRnea(ctrl_ABLE, torques);
+		sum += torques[NB_MOTORS - 2] + torques[NB_MOTORS - 1];
+	}
+	rnea_ns = timebase_Seconds(timebase_Now() - start_tick) * 1e9 / BENCH_NB_CYCLES;
+	bench_Sink = sum;
+	sum = 0.0f;
+	start_tick = timebase_Now();
+	for (int k(0); k < BENCH_NB_CYCLES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k % BENCH_NB_STATES]);
+		model_ComputeCompensation(ctrl_ABLE, torques);
+		sum += torques[NB_MOTORS - 2] + torques[NB_MOTORS - 1];
+	}
+	analytic_ns = timebase_Seconds(timebase_Now() - start_tick) * 1e9 / BENCH_NB_CYCLES;
+	bench_Sink = sum;
+	fprintf(out_file, "Inverse dynamics of the %i axes : %.1f ns per iteration (analytic axes 3 and 4 : %.1f ns)\n",
+		    NB_MOTORS, rnea_ns, analytic_ns);
+	fflush(out_file);
+	return exit_flag;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_MassMatrix - Compute the mass matrix of a chain column by column with the inverse dynamics
+|
+| Syntax --
+|	void bench_MassMatrix(const rnea_Link* links, const float* q, float mass_matrix[NB_MOTORS][NB_MOTORS])
+|
+| Inputs --
+|	const rnea_Link* links -> NB_MOTORS links
+|	const float* q -> joint angles (rad)
+|	float mass_matrix[NB_MOTORS][NB_MOTORS] -> filled with the mass matrix
+----------------------------------------------------------------------------------------------------------------------*/
+void bench_MassMatrix(const rnea_Link* links, const float* q, float mass_matrix[NB_MOTORS][NB_MOTORS])
+{
+	// Initialise variables
+	const float zeros[NB_MOTORS] = {};
+	const float no_gravity[3] = {};
+	float cos_q[NB_MOTORS], sin_q[NB_MOTORS], unit[NB_MOTORS], column[NB_MOTORS];
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		cos_q[i] = cosf(q[i]);
+		sin_q[i] = sinf(q[i]);
+	}
+	for (int j(0); j < NB_MOTORS; j++)
+	{
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			unit[i] = i == j ? 1.0f : 0.0f;
+		}
+		rnea_InverseDynamics<NB_MOTORS>(links, cos_q, sin_q, zeros, unit, no_gravity, column);
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			mass_matrix[i][j] = column[i];
+		}
+	}
+}
+
+// ------------------------------------------------- CARTESIAN CONTROL -------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_CartesianControl - Check the Jacobian against the forward kinematics and time the Cartesian impedance
+|
+| Syntax --
+|	int bench_CartesianControl(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|	ThreadInformations* ableInfos -> informations struct, only ctrl_ABLE is used
+|
+| Outputs --
+|	int -> 0 if the Jacobian error is below BENCH_KIN_TOLERANCE, -1 otherwise
+|
+| Remarks --
+|	Each column of the Jacobian is compared with central differences of the wrist position and orientation (the
+|	angular column is the axial vector of (R(q + h) - R(q - h)) R(q)^T / 2h).
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_CartesianControl(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+
+	// Initialise variables
+	static bench_State states[BENCH_NB_STATES];
+	kin_State state, state_plus, state_minus;
+	float numeric[6], dr[9], torques[NB_MOTORS], ft_torques[NB_MOTORS];
+	double error, max_error = 0.0, cart_ns;
+	float sum, step;
+	long long start_tick;
+	BOOL use_FT = ctrl_ABLE->rtParams.use_FT;
+	int exit_flag = 0;
+
+	// Jacobian against central differences of the forward kinematics
+	bench_DrawStates(ctrl_ABLE, states, BENCH_NB_STATES);
+	for (int k(0); k < BENCH_NB_STATES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k]);
+		kin_ComputeState(ctrl_ABLE, &state);
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			step = BENCH_KIN_STEP;
+			ctrl_ABLE->state.position[i] = states[k].position[i] + step;
+			kin_ComputeState(ctrl_ABLE, &state_plus);
+			ctrl_ABLE->state.position[i] = states[k].position[i] - step;
+			kin_ComputeState(ctrl_ABLE, &state_minus);
+			ctrl_ABLE->state.position[i] = states[k].position[i];
+			for (int r(0); r < 3; r++)
+			{
+				numeric[r] = (state_plus.position[r] - state_minus.position[r]) / (2 * step);
+			}
+			// dR R^T, axial vector of the skew-symmetric part
+			for (int r(0); r < 3; r++)
+			{
+				for (int c(0); c < 3; c++)
+				{
+					dr[3 * r + c] = 0.0f;
+					for (int m(0); m < 3; m++)
+					{
+						dr[3 * r + c] += (state_plus.rotation[3 * r + m] - state_minus.rotation[3 * r + m])
+							           * state.rotation[3 * c + m] / (2 * step);
+					}
+				}
+			}
+			numeric[3] = 0.5f * (dr[7] - dr[5]);
+			numeric[4] = 0.5f * (dr[2] - dr[6]);
+			numeric[5] = 0.5f * (dr[3] - dr[1]);
+			for (int r(0); r < 6; r++)
+			{
+				error = fabs(numeric[r] - state.jacobian[r][i]);
+				if (error > max_error)
+				{
+					max_error = error;
+				}
+			}
+		}
+	}
+	fprintf(out_file, "Wrist Jacobian against finite differences : max error %.3e\n", max_error);
+	if (max_error > BENCH_KIN_TOLERANCE)
+	{
+		fprintf(err_file, "Wrist Jacobian differs from the forward kinematics\n");
+		exit_flag = -1;
+	}
+
+	// Timing of kinematics, impedance and wrist wrench mapping
+	bench_ApplyState(ctrl_ABLE, &states[0]);
+	kin_ComputeState(ctrl_ABLE, &state);
+	cart_InitImpedance(&ctrl_ABLE->aOrders.cartesian, &state);
+	ctrl_ABLE->rtParams.use_FT = TRUE;
+	sum = 0.0f;
+	start_tick = timebase_Now();
+	for (int k(0); k < BENCH_NB_CYCLES; k++)
+	{
+		bench_ApplyState(ctrl_ABLE, &states[k % BENCH_NB_STATES]);
+		kin_ComputeState(ctrl_ABLE, &state);
+		cart_WristTorques(ctrl_ABLE, &state, ft_torques);
+		cart_ComputeImpedance(ctrl_ABLE, &state, torques);
+		sum += torques[NB_MOTORS - 2] + torques[NB_MOTORS - 1] + ft_torques[NB_MOTORS - 1];
+	}
+	cart_ns = timebase_Seconds(timebase_Now() - start_tick) * 1e9 / BENCH_NB_CYCLES;
+	bench_Sink = sum;
+	ctrl_ABLE->aOrders.cartesian.target_set = 0;
+	ctrl_ABLE->rtParams.use_FT = use_FT;
+	fprintf(out_file, "Cartesian impedance (kinematics, Jacobian, wrist wrench, impedance) : %.1f ns per iteration\n",
+		    cart_ns);
+	fflush(out_file);
+	return exit_flag;
+}
+
+// --------------------------------------------------- HAPTIC SCENE ----------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_HapticScene - Compare the grid queries of random scenes with the exhaustive evaluation and time both
+|
+| Syntax --
+|	int bench_HapticScene(FILE* err_file, FILE* out_file)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|
+| Outputs --
+|	int -> 0 if every scene was built and its grid queries match the exhaustive ones, -1 otherwise
+|
+| Remarks --
+|	Queries stopped on their budget (SCENE_OVERRUN) return a previous force and are left out of the comparison.
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_HapticScene(FILE* err_file, FILE* out_file)
+{
+	// Initialise variables
+	static haptic_Scene scene;
+	static float positions[BENCH_NB_STATES][3], speeds[BENCH_NB_STATES][3];
+	const int nb_spheres[4] = { 16, 128, 512, 1000 };
+	float force[3], reference[3], sum;
+	double error, max_error, grid_ns, all_ns;
+	long long start_tick;
+	int nb_active, result, exit_flag = 0;
+
+	for (int k(0); k < BENCH_NB_STATES; k++)
+	{
+		for (int j(0); j < 3; j++)
+		{
+			positions[k][j] = bench_Uniform(-0.5f * BENCH_SCENE_SIZE, 0.5f * BENCH_SCENE_SIZE);
+			speeds[k][j] = bench_Uniform(-1.0f, 1.0f);
+		}
+	}
+	for (int s(0); s < 4; s++)
+	{
+		bench_MakeScene(&scene, nb_spheres[s], 8);
+		if (scene_Build(err_file, &scene, SCENE_CELL_SIZE) != 0)
+		{
+			fprintf(err_file, "Benchmark scene of %d primitives not built\n", scene.nb_primitives);
+			exit_flag = -1;
+			continue;
+		}
+
+		// Grid against exhaustive evaluation
+		max_error = 0.0;
+		nb_active = 0;
+		for (int k(0); k < BENCH_NB_STATES; k++)
+		{
+			result = scene_Query(&scene, positions[k], speeds[k], force);
+			if (result == SCENE_OVERRUN)
+			{
+				continue;
+			}
+			nb_active += result;
+			scene_QueryAll(&scene, positions[k], speeds[k], reference);
+			for (int j(0); j < 3; j++)
+			{
+				error = fabs(force[j] - reference[j]);
+				max_error = error > max_error ? error : max_error;
+			}
+		}
+		if (max_error > BENCH_SCENE_TOLERANCE)
+		{
+			fprintf(err_file, "Grid query of the haptic scene differs from the exhaustive evaluation\n");
+			exit_flag = -1;
+		}
+
+		// Timing
+		sum = 0.0f;
+		start_tick = timebase_Now();
+		for (int k(0); k < BENCH_NB_QUERIES; k++)
+		{
+			scene_Query(&scene, positions[k % BENCH_NB_STATES], speeds[k % BENCH_NB_STATES], force);
+			sum += force[0];
+		}
+		grid_ns = timebase_Seconds(timebase_Now() - start_tick) * 1e9 / BENCH_NB_QUERIES;
+		start_tick = timebase_Now();
+		for (int k(0); k < BENCH_NB_QUERIES; k++)
+		{
+			scene_QueryAll(&scene, positions[k % BENCH_NB_STATES], speeds[k % BENCH_NB_STATES], force);
+			sum += force[0];
+		}
+		all_ns = timebase_Seconds(timebase_Now() - start_tick) * 1e9 / BENCH_NB_QUERIES;
+		bench_Sink = sum;
+		fprintf(out_file, "Haptic scene of %d primitives : grid %dx%dx%d, %d per cell max, %.2f active per query, "
+			    "max error %.3e N\n", scene.nb_primitives, scene.dims[0], scene.dims[1], scene.dims[2],
+			    scene.max_per_cell, (double)nb_active / BENCH_NB_STATES, max_error);
+		fprintf(out_file, "    grid %.1f ns, exhaustive %.1f ns per query\n", grid_ns, all_ns);
+		scene_PrintStats(out_file, &scene);
+	}
+	fflush(out_file);
+	return exit_flag;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_MakeScene - Fill a scene with random primitives in a cube of side BENCH_SCENE_SIZE centered on the origin
+|
+| Syntax --
+|	void bench_MakeScene(haptic_Scene* scene, int nb_spheres, int nb_regions)
+|
+| Inputs --
+|	haptic_Scene* scene -> scene to fill (not built)
+|	int nb_spheres -> number of spheres (radius 5 to 25 mm)
+|	int nb_regions -> number of viscous regions and of force fields (side 5 to 20 cm)
+|
+| Remarks --
+|	The four side faces of the cube are walls, the fields are curl fields about the vertical axis.
+----------------------------------------------------------------------------------------------------------------------*/
+void bench_MakeScene(haptic_Scene* scene, int nb_spheres, int nb_regions)
+{
+	// Initialise variables
+	float half = 0.5f * BENCH_SCENE_SIZE, center[3], box_min[3], box_max[3], side, curl;
+	float field[9] = { 0.0f };
+
+	scene_Clear(scene);
+	for (int j(0); j < 2; j++)
+	{
+		for (int sign(-1); sign <= 1; sign += 2)
+		{
+			center[0] = center[1] = center[2] = 0.0f;
+			center[j] = -sign * half;
+			box_min[0] = box_min[1] = box_min[2] = 0.0f;
+			box_min[j] = (float)sign;
+			scene_AddPlane(scene, center, box_min, 1000.0f, 5.0f);
+		}
+	}
+	for (int p(0); p < nb_spheres; p++)
+	{
+		for (int j(0); j < 3; j++)
+		{
+			center[j] = bench_Uniform(-half, half);
+		}
+		scene_AddSphere(scene, center, bench_Uniform(0.005f, 0.025f), bench_Uniform(200.0f, 2000.0f), 2.0f);
+	}
+	for (int p(0); p < 2 * nb_regions; p++)
+	{
+		side = bench_Uniform(0.05f, 0.2f);
+		for (int j(0); j < 3; j++)
+		{
+			box_min[j] = bench_Uniform(-half, half - side);
+			box_max[j] = box_min[j] + side;
+		}
+		if (p < nb_regions)
+		{
+			scene_AddViscous(scene, box_min, box_max, bench_Uniform(5.0f, 30.0f));
+		}
+		else
+		{
+			curl = bench_Uniform(-15.0f, 15.0f);
+			field[1] = curl;
+			field[3] = -curl;
+			scene_AddField(scene, box_min, box_max, field);
+		}
+	}
+}
+
+// ---------------------------------------------------- FORCE STAGE ----------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_ForceStage - Compare the force read by the control loop with and without the force stage on a synthetic stream
+|
+| Syntax --
+|	int bench_ForceStage(FILE* err_file, FILE* out_file)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|
+| Outputs --
+|	int -> 0 if the force stage reduces both the force and the integral errors, -1 otherwise
+|
+| Remarks --
+|	The stream is a human force (bench_HumanForce) with white noise and a structural vibration, sampled every
+|	BENCH_FT_PERIOD. The control loop reads it every BENCH_FT_CTRL_PERIOD with an offset of a third of a sample.
+|	Previous scheme : last raw sample among one every five, integral of the force sampled by the control loop.
+|	Force stage : last publication extrapolated to the control tick, sum of the published impulses.
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_ForceStage(FILE* err_file, FILE* out_file)
+{
+	// Initialise variables
+	static ft_stage stage;
+	double frequency = (double)timebase_Frequency(), t, next_ctrl = BENCH_FT_CTRL_PERIOD + BENCH_FT_PERIOD / 3;
+	double error_raw = 0.0, error_filtered = 0.0, error_predicted = 0.0, truth, integral_truth = 0.0;
+	double integral_raw = 0.0, integral_stage = 0.0, drift_raw = 0.0, drift_stage = 0.0;
+	double published_integral = 0.0, last_integral = 0.0;
+	float raw[FTSTAGE_NB_CHANNELS] = { 0.0f }, published[2][FTSTAGE_NB_CHANNELS] = { { 0.0f } };
+	float predicted[FTSTAGE_NB_CHANNELS];
+	float raw_published = 0.0f, sum = 0.0f;
+	long long published_tick = 0, tick, start_tick;
+	int nb_samples = (int)(BENCH_FT_DURATION / BENCH_FT_PERIOD), nb_ctrl = 0, exit_flag = 0;
+
+	ftstage_InitForRate(&stage, (float)BENCH_FT_PERIOD, (float)(1.0 / BENCH_FT_CTRL_PERIOD));
+	for (int i(0); i < nb_samples; i++)
+	{
+		// Sample of the sensor, published by the previous scheme and by the stage
+		t = i * BENCH_FT_PERIOD;
+		tick = (long long)(t * frequency);
+		raw[2] = (float)bench_HumanForce(t) + bench_Uniform(-BENCH_FT_NOISE, BENCH_FT_NOISE)
+			   + BENCH_FT_VIBRATION * (float)sin(2 * M_PI * 1500.0 * t);
+		if (i % 5 == 0)
+		{
+			raw_published = raw[2];
+		}
+		if (ftstage_Push(&stage, raw, tick))
+		{
+			for (int c(0); c < FTSTAGE_NB_CHANNELS; c++)
+			{
+				published[0][c] = stage.filtered[c];
+				published[1][c] = stage.derivative[c];
+			}
+			published_integral = stage.integral[2];
+			published_tick = tick;
+		}
+
+		// Iterations of the control loop before the next sample
+		while (next_ctrl < t + BENCH_FT_PERIOD && next_ctrl < BENCH_FT_DURATION)
+		{
+			truth = bench_HumanForce(next_ctrl);
+			ftstage_Predict(published[0], published[1], stage.group_delay, published_tick,
+				            (long long)(next_ctrl * frequency), predicted);
+			error_raw += (raw_published - truth) * (raw_published - truth);
+			error_filtered += (published[0][2] - truth) * (published[0][2] - truth);
+			error_predicted += (predicted[2] - truth) * (predicted[2] - truth);
+			integral_truth += truth * BENCH_FT_CTRL_PERIOD;
+			integral_raw += raw_published * BENCH_FT_CTRL_PERIOD;
+			integral_stage += published_integral - last_integral;
+			last_integral = published_integral;
+			drift_raw = fabs(integral_raw - integral_truth) > drift_raw ? fabs(integral_raw - integral_truth) : drift_raw;
+			drift_stage = fabs(integral_stage - integral_truth) > drift_stage ? fabs(integral_stage - integral_truth) :
+				          drift_stage;
+			next_ctrl += BENCH_FT_CTRL_PERIOD;
+			nb_ctrl++;
+		}
+	}
+	fprintf(out_file, "Force read by the control loop (%d iterations), RMS error : raw one sample in five %.3f N, "
+		    "filtered %.3f N, filtered and extrapolated %.3f N\n", nb_ctrl, sqrt(error_raw / nb_ctrl),
+		    sqrt(error_filtered / nb_ctrl), sqrt(error_predicted / nb_ctrl));
+	fprintf(out_file, "Integral of the force, largest drift : sampled by the control loop %.4f N.s, impulses of the "
+		    "stage %.4f N.s\n", drift_raw, drift_stage);
+	if (error_predicted >= error_raw || drift_stage >= drift_raw)
+	{
+		fprintf(err_file, "Force stage does not improve the force read by the control loop\n");
+		exit_flag = -1;
+	}
+
+	// Timing of a run of the stage
+	start_tick = timebase_Now();
+	for (int i(0); i < BENCH_NB_CYCLES; i++)
+	{
+		raw[2] = (float)(i & 0xff);
+		ftstage_Push(&stage, raw, i);
+		sum += stage.filtered[2];
+	}
+	bench_Sink = sum;
+	fprintf(out_file, "Force stage : %.1f ns per sample\n", timebase_Seconds(timebase_Now() - start_tick) * 1e9 /
+		    BENCH_NB_CYCLES);
+	fflush(out_file);
+	return exit_flag;
+}
+
+// Synthetic force applied by a participant (N)
+double bench_HumanForce(double t)
+{
+	return 5.0 * sin(2 * M_PI * 1.3 * t) + 3.0 * sin(2 * M_PI * 4.1 * t + 0.5) + 1.5 * sin(2 * M_PI * 9.0 * t);
+}
+
+// --------------------------------------------------- CONTROL RATE ----------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_ControlRate - Track a minimum jerk move with a position loop simulated at each admissible control rate
+|
+| Syntax --
+|	int bench_ControlRate(FILE* err_file, FILE* out_file)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|
+| Outputs --
+|	int -> 0 if the move lasts its duration at every rate and the tracking does not degrade above 1 kHz, -1 otherwise
+|
+| Remarks --
+|	The axis integrates the speed order of the previous iteration over a period drawn with BENCH_RATE_JITTER around
+|	the nominal one. As in the control loop, the trajectory time and the integral term accumulate the measured period.
+|	The duration a sample-indexed trajectory (legacy 1 kHz tables) would have lasted is printed for comparison.
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_ControlRate(FILE* err_file, FILE* out_file)
+{
+	// Initialise variables
+	const float rates[4] = { CTRL_MIN_RATE, CTRL_DEFAULT_RATE, 2000.0f, CTRL_MAX_RATE };
+	minjerk_move move = { 0.0f, 1.0f, BENCH_RATE_MOVE, (int)(BENCH_RATE_MOVE / MINJERK_LEGACY_PERIOD) + 1 };
+	float period, dt, time, position, speed_order, integral_sum, error;
+	double error_sum, reference_rms = 0.0, rms;
+	int nb_iterations, exit_flag = 0;
+
+	for (int r(0); r < 4; r++)
+	{
+		period = 1.0f / rates[r];
+		time = 0.0f;
+		position = 0.0f;
+		speed_order = 0.0f;
+		integral_sum = 0.0f;
+		error_sum = 0.0;
+		nb_iterations = 0;
+		while (time < move.duration)
+		{
+			// Period of the iteration, the axis moves with the order of the previous iteration
+			dt = period * bench_Uniform(1.0f - BENCH_RATE_JITTER, 1.0f + BENCH_RATE_JITTER);
+			position += speed_order * dt;
+			time += dt;
+			// Position loop on the trajectory evaluated at the accumulated time
+			error = minjerk_Position(&move, time) - position;
+			integral_sum += error * dt;
+			speed_order = BENCH_RATE_KP * error + BENCH_RATE_KI * integral_sum;
+			error_sum += (double)error * error;
+			nb_iterations++;
+		}
+		rms = sqrt(error_sum / nb_iterations);
+		if (rates[r] == CTRL_DEFAULT_RATE)
+		{
+			reference_rms = rms;
+		}
+		fprintf(out_file, "Control rate %5.0f Hz : move of %.3f s lasted %.4f s (%d iterations), tracking RMS %.5f rad, "
+			    "sample-indexed move would last %.3f s\n", rates[r], move.duration, time, nb_iterations, rms,
+			    (move.nb_samples - 1) * period);
+		if (time - move.duration > (1.0f + BENCH_RATE_JITTER) * period ||
+			(reference_rms > 0.0 && rms > (1.0 + BENCH_RATE_TOLERANCE) * reference_rms))
+		{
+			fprintf(err_file, "Control rate %.0f Hz : move duration or tracking not rate independent\n", rates[r]);
+			exit_flag = -1;
+		}
+	}
+	fflush(out_file);
+	return exit_flag;
+}
+
+// ------------------------------------------------- THREAD PLACEMENT --------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_ThreadPlacement - Jitter of a periodic loop under load with each placement level
+|
+| Syntax --
+|	int bench_ThreadPlacement(FILE* err_file, FILE* out_file)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|
+| Outputs --
+|	int -> 0 if every configuration could be run, -1 otherwise
+|
+| Remarks --
+|	A thread with the control role waits BENCH_PLACEMENT_PERIODS deadlines while one thread per core spins at normal
+|	priority. The distribution of its periods is printed for PLACEMENT_NONE, PLACEMENT_PRIORITY and PLACEMENT_FULL,
+|	then the process is set back to the default scheduling, and the hard minimum of the working set set by
+|	PLACEMENT_FULL is released.
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_ThreadPlacement(FILE* err_file, FILE* out_file)
+{
+	// Initialise variables
+	static long long ticks[BENCH_PLACEMENT_PERIODS];
+	HANDLE load_threads[BENCH_MAX_LOAD_THREADS];
+	HANDLE loop_thread;
+	SYSTEM_INFO system_info;
+	bench_PeriodicLoop loop = { err_file, ticks, BENCH_PLACEMENT_PERIODS, BENCH_PLACEMENT_PERIOD };
+	SIZE_T working_min, working_max;
+	int nb_load, exit_flag = 0;
+
+	GetSystemInfo(&system_info);
+	nb_load = (int)system_info.dwNumberOfProcessors < BENCH_MAX_LOAD_THREADS ? (int)system_info.dwNumberOfProcessors :
+		      BENCH_MAX_LOAD_THREADS;
+	for (int level(PLACEMENT_NONE); level <= PLACEMENT_FULL && exit_flag == 0; level++)
+	{
+		placement_Init(level);
+		placement_SetupProcess(err_file, out_file, NULL, 0);
+
+		// Load every core, then run the loop with the control role
+		bench_LoadRunning = 1;
+		for (int i(0); i < nb_load; i++)
+		{
+			load_threads[i] = CreateThread(NULL, 0, &bench_LoadThread, NULL, 0, NULL);
+		}
+		loop_thread = CreateThread(NULL, 0, &bench_PeriodicThread, &loop, 0, NULL);
+		if (loop_thread == NULL)
+		{
+			fprintf(err_file, "Placement benchmark : loop thread not created (error %lu)\n", GetLastError());
+			exit_flag = -1;
+		}
+		else
+		{
+			WaitForSingleObject(loop_thread, INFINITE);
+			CloseHandle(loop_thread);
+		}
+		bench_LoadRunning = 0;
+		for (int i(0); i < nb_load; i++)
+		{
+			if (load_threads[i] != NULL)
+			{
+				WaitForSingleObject(load_threads[i], INFINITE);
+				CloseHandle(load_threads[i]);
+			}
+		}
+		if (exit_flag == 0)
+		{
+			placement_ReportJitter(out_file, "Periodic loop under load", ticks, BENCH_PLACEMENT_PERIODS,
+				                   BENCH_PLACEMENT_PERIOD);
+		}
+	}
+
+	// Back to the default scheduling for the following benchmarks, working set trimmed again by Windows
+	placement_Init(PLACEMENT_NONE);
+	placement_SetupProcess(err_file, out_file, NULL, 0);
+	if (!GetProcessWorkingSetSize(GetCurrentProcess(), &working_min, &working_max) ||
+		!SetProcessWorkingSetSizeEx(GetCurrentProcess(), working_min, working_max,
+			                        QUOTA_LIMITS_HARDWS_MIN_DISABLE | QUOTA_LIMITS_HARDWS_MAX_DISABLE))
+	{
+		fprintf(err_file, "Hard minimum of the working set not released (error %lu)\n", GetLastError());
+	}
+	fflush(out_file);
+	return exit_flag;
+}
+
+// ------------------------------------------------- ZERO ALLOCATION -------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_ZeroAllocation - Check that the control cycle does not allocate once in steady state
+|
+| Syntax --
+|	int bench_ZeroAllocation(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|	ThreadInformations* ableInfos -> informations struct, only ctrl_ABLE is used
+|
+| Outputs --
+|	int -> 0 if no allocation, free or realloc was made during the tracked cycles, -1 otherwise
+|
+| Remarks --
+|	Each cycle is the cycle of the control loop run by replay_Cycle (saturation, state frame, FT samples, orders of
+|	able_UpdateOrders and able_SelectAdaptedControl, storage and printing of the measures, check of the order), on
+|	drive frames written from random states (sim_WriteFrame) and on the wrist samples of the force stage, pushed at
+|	the rate of the sensor. The printed files are SIM_NULL_FILE and the measures are reserved as in
+|	preallocate_memory. For the torque and the Cartesian controls, BENCH_ALLOC_WARMUP cycles are run first, then
+|	BENCH_ALLOC_CYCLES cycles are tracked and the recorded operations are printed with their stack. The control struct
+|	is restored at the end.
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_ZeroAllocation(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+	ableMeasures* m = ctrl_ABLE->aMeasures;
+
+	// Initialise variables
+	static bench_State states[BENCH_NB_STATES];
+	static replay_Frame frames[BENCH_NB_STATES];
+	static ServoComEth eth_ABLE;
+	static ft_stage stage;
+	session_floats* channels[25] = { &m->able_currents_1, &m->able_currents_2, &m->able_currents_3, &m->able_currents_4,
+									 &m->able_artpos_1, &m->able_artpos_2, &m->able_artpos_3, &m->able_artpos_4,
+									 &m->able_speeds_1, &m->able_speeds_2, &m->able_speeds_3, &m->able_speeds_4,
+									 &m->able_xs_slider, &m->fx_FTA_sensor, &m->fy_FTA_sensor, &m->fz_FTA_sensor,
+									 &m->tx_FTA_sensor, &m->ty_FTA_sensor, &m->tz_FTA_sensor, &m->fx_FTW_sensor,
+									 &m->fy_FTW_sensor, &m->fz_FTW_sensor, &m->tx_FTW_sensor, &m->ty_FTW_sensor,
+									 &m->tz_FTW_sensor };
+	session_ticks* ticks[4] = { &m->able_ticks, &m->ftA_ticks, &m->ftW_ticks, &m->cycle_ticks };
+	const int ctrl_types[2] = { TORQUE_CTRL, CARTESIAN_CTRL };
+	AbleControlStruct* initial = new AbleControlStruct(*ctrl_ABLE);
+	ThreadInformations cycleInfos = *ableInfos;
+	FILE* null_file = NULL;
+	sim_Plant plant = {};
+	replay_Frame frame;
+	replay_Command command;
+	float raw[FTSTAGE_NB_CHANNELS] = { 0.0f };
+	int nb_samples = (int)(BENCH_FT_CTRL_PERIOD / BENCH_FT_PERIOD + 0.5);
+	int nb_cycles = BENCH_ALLOC_WARMUP + BENCH_ALLOC_CYCLES;
+	long long period_ticks = (long long)(rtValues->sampling_frequency * timebase_Frequency()), nb_operations = 0;
+	long long cycle_tick;
+	int exit_flag = 0;
+
+	// Files printed by the cycle
+	if (fopen_s(&null_file, SIM_NULL_FILE, "w") != 0 || null_file == NULL)
+	{
+		fprintf(err_file, "Zero allocation benchmark : %s not opened\n", SIM_NULL_FILE);
+		delete initial;
+		return -1;
+	}
+	cycleInfos.eth_ABLE = &eth_ABLE;
+	cycleInfos.currents_file = null_file;
+	cycleInfos.artpos_file = null_file;
+	cycleInfos.speeds_file = null_file;
+	cycleInfos.xs_slider_file = null_file;
+	cycleInfos.ft_Arm_sensor_file = null_file;
+	cycleInfos.ft_Wrist_sensor_file = null_file;
+	cycleInfos.times_file = null_file;
+
+	// Drive frames of random states of the elbow, as sent by the drive
+	bench_DrawStates(ctrl_ABLE, states, BENCH_NB_STATES);
+	for (int s(0); s < BENCH_NB_STATES; s++)
+	{
+		plant.position = states[s].position[NB_MOTORS - 1];
+		plant.speed = states[s].speed[NB_MOTORS - 1];
+		sim_WriteFrame(&plant, ctrl_ABLE, &eth_ABLE);
+		memset(&frames[s], 0, sizeof(replay_Frame));
+		frames[s].inputs = REPLAY_INPUT_FT;
+		frames[s].entree_tor = eth_ABLE.entree_tor;
+		frames[s].cycle_dt = rtValues->sampling_frequency;
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			frames[s].axes[i].coder = eth_ABLE.moteur[i].Position_Codeur;
+			frames[s].axes[i].speed = eth_ABLE.moteur[i].Vitesse_Filtree;
+			frames[s].axes[i].adc_current = eth_ABLE.moteur[i].ADC_Courant;
+			frames[s].axes[i].adc_voltage = eth_ABLE.moteur[i].ADC_Potentiometre;
+		}
+		frames[s].ft_Arm.streaming = TRUE;
+		frames[s].ft_Wrist.streaming = TRUE;
+	}
+
+	for (int p(0); p < 2; p++)
+	{
+		// Same state as the control loop before its first cycle (prepareMotions)
+		*ctrl_ABLE = *initial;
+		ctrl_ABLE->aOrders.ctrl_type = ctrl_types[p];
+		rtValues->use_FT = TRUE;
+		rtValues->able_RealTimeCommand = TRUE;
+		rtValues->order_counter = 0;
+		rtValues->iter_counter = 0;
+		rtValues->elapsed_time = 0.0;
+		rtValues->able_CheckTargetReachedNbIt = (int)(CHECK_TARGET_TIME * rtValues->ctrl_rate + 0.5f);
+		state_BuildConfig(ctrl_ABLE);
+		ctrlstate_Reset(&ctrl_ABLE->ctrlStates);
+		ftstage_InitForRate(&stage, (float)BENCH_FT_PERIOD, rtValues->ctrl_rate);
+		for (int i(0); i < 25; i++)
+		{
+			channels[i]->reserve(nb_cycles);
+		}
+		for (int i(0); i < 4; i++)
+		{
+			ticks[i]->reserve(nb_cycles);
+		}
+		m->execution_times.reserve(nb_cycles);
+
+		for (int k(0); k < nb_cycles && rtValues->able_RealTimeCommand; k++)
+		{
+			// Samples of the wrist sensor received during the period (FT thread)
+			for (int j(0); j < nb_samples; j++)
+			{
+				raw[2] = (float)bench_HumanForce((k * nb_samples + j) * BENCH_FT_PERIOD);
+				ftstage_Push(&stage, raw, k * period_ticks + j * period_ticks / nb_samples);
+			}
+			frame = frames[k % BENCH_NB_STATES];
+			frame.iter_counter = k;
+			frame.state_tick = k * period_ticks;
+			frame.ft_Wrist.fz = raw[2];
+			frame.ft_Wrist.tick = stage.tick;
+			frame.ft_Wrist.group_delay = stage.group_delay;
+			for (int c(0); c < FTSTAGE_NB_CHANNELS; c++)
+			{
+				frame.ft_Wrist.filtered[c] = stage.filtered[c];
+				frame.ft_Wrist.derivative[c] = stage.derivative[c];
+				frame.ft_Wrist.integral[c] = stage.integral[c];
+			}
+			frame.ft_Arm.tick = stage.tick;
+
+			// Control cycle
+			if (k == BENCH_ALLOC_WARMUP)
+			{
+				alloc_Enable(1);
+			}
+			alloc_BeginCycle(k);
+			cycle_tick = timebase_Now();
+			replay_Cycle(&cycleInfos, &frame, &command);
+			m->execution_times.push_back(timebase_Seconds(timebase_Now() - cycle_tick));
+			m->cycle_ticks.push_back(cycle_tick);
+			rtValues->iter_counter++;
+			alloc_EndCycle();
+			// Order received after the first cycle, as the control loop waiting for the first order
+			rtValues->order_counter = 1;
+		}
+		alloc_Enable(0);
+		if (!rtValues->able_RealTimeCommand)
+		{
+			fprintf(err_file, "Zero allocation benchmark : control %i stopped before the end of the cycles\n",
+				    ctrl_types[p]);
+			exit_flag = -1;
+		}
+
+		// Every operation of the steady state is a failure
+		fprintf(out_file, "Control type %i : ", ctrl_types[p]);
+		alloc_PrintReport(out_file);
+		nb_operations += alloc_NbOperations();
+		for (int i(0); i < 25; i++)
+		{
+			channels[i]->clear();
+		}
+		for (int i(0); i < 4; i++)
+		{
+			ticks[i]->clear();
+		}
+		m->execution_times.clear();
+	}
+	*ctrl_ABLE = *initial;
+	delete initial;
+	fclose(null_file);
+	if (nb_operations > 0)
+	{
+		fprintf(err_file, "Control cycle allocates in steady state (%lld operations)\n", nb_operations);
+		exit_flag = -1;
+	}
+	fflush(out_file);
+	return exit_flag;
+}
+
+// -------------------------------------------------- ROBOT STATE ------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_RobotState - Cache lines touched and cold-cache timing of the state extraction and of the reads of the torque
+|					 control, per-axis fields against the cycle snapshot
+|
+| Syntax --
+|	int bench_RobotState(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print results
+|	ThreadInformations* ableInfos -> informations struct, only ctrl_ABLE is used
+|
+| Outputs --
+|	int -> 0 if both paths give the same positions and speed orders, -1 otherwise
+|
+| Remarks --
+|	The cache miss counters of the processor are not readable from user mode : the lines touched are counted from
+|	the addresses of the fields, and each timed cycle starts after BENCH_EVICT_BYTES are walked to empty the caches.
+|	The size of the control struct and the time to copy it are printed as well.
+----------------------------------------------------------------------------------------------------------------------*/
+int bench_RobotState(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+	RobotState* state = &ctrl_ABLE->state;
+	RobotConfig* config = &ctrl_ABLE->config;
+
+	// Initialise variables
+	static ServoComEth eth;
+	static bench_LegacyState legacy;
+	static unsigned char evict[BENCH_EVICT_BYTES];
+	ServoComEth* eth_ABLE = ableInfos->eth_ABLE;
+	const void* legacy_fields[BENCH_MAX_FIELDS];
+	const void* snapshot_fields[BENCH_MAX_FIELDS];
+	float legacy_orders[NB_MOTORS], snapshot_orders[NB_MOTORS], legacy_position[NB_MOTORS];
+	float max_error = 0.0f, sum = 0.0f;
+	int nb_legacy = 0, nb_snapshot = 0, legacy_reads, snapshot_reads;
+	long long start_tick, legacy_ticks = 0, snapshot_ticks = 0, copy_ticks = 0;
+	AbleControlStruct* copy;
+	int exit_flag = 0;
+
+	ableInfos->eth_ABLE = &eth;
+	state_BuildConfig(ctrl_ABLE);
+
+	// Fields read by the torque control, then fields of the whole cycle (the drive frame is read by both paths, the
+	// recording and the telemetry read the snapshot)
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		legacy_fields[nb_legacy++] = &legacy.currentPosition[i];
+		legacy_fields[nb_legacy++] = &legacy.currentSpeed[i];
+		legacy_fields[nb_legacy++] = &legacy.currentADCcurrent[i];
+		legacy_fields[nb_legacy++] = &mValues->inhibition_State[i];
+		legacy_fields[nb_legacy++] = &mValues->Kp_V[i];
+		snapshot_fields[nb_snapshot++] = &state->position[i];
+		snapshot_fields[nb_snapshot++] = &state->speed[i];
+		snapshot_fields[nb_snapshot++] = &state->current[i];
+		snapshot_fields[nb_snapshot++] = &config->active[i];
+		snapshot_fields[nb_snapshot++] = &config->speed_gain[i];
+	}
+	legacy_fields[nb_legacy++] = &mValues->kt_gain;
+	snapshot_fields[nb_snapshot++] = &config->kt_gain;
+	legacy_reads = bench_CountLines(legacy_fields, nb_legacy);
+	snapshot_reads = bench_CountLines(snapshot_fields, nb_snapshot);
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		legacy_fields[nb_legacy++] = &eth.moteur[i];
+		legacy_fields[nb_legacy++] = &legacy.currentCoderPosition[i];
+		legacy_fields[nb_legacy++] = &legacy.currentVoltage[i];
+		legacy_fields[nb_legacy++] = &mValues->Kconv_I[i];
+		legacy_fields[nb_legacy++] = &mValues->offset_ADC[i];
+		legacy_fields[nb_legacy++] = &mValues->able_AxisReductions[i];
+		snapshot_fields[nb_snapshot++] = &eth.moteur[i];
+		snapshot_fields[nb_snapshot++] = &state->coder[i];
+		snapshot_fields[nb_snapshot++] = &state->voltage[i];
+		snapshot_fields[nb_snapshot++] = &config->current_gain[i];
+		snapshot_fields[nb_snapshot++] = &config->current_offset[i];
+		snapshot_fields[nb_snapshot++] = &config->reduction[i];
+	}
+	snapshot_fields[nb_snapshot++] = &state->inputs;
+	fprintf(out_file, "Robot state, lines read by the torque control : per-axis fields %i, snapshot %i\n",
+		    legacy_reads, snapshot_reads);
+	fprintf(out_file, "Robot state, lines touched per cycle : per-axis fields %i, snapshot %i\n",
+		    bench_CountLines(legacy_fields, nb_legacy), bench_CountLines(snapshot_fields, nb_snapshot));
+
+	for (int k(0); k < BENCH_STATE_CYCLES; k++)
+	{
+		// Random drive frame
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			eth.moteur[i].Position_Codeur = (int)bench_Uniform(-(float)NB_POINTS_CODERS, (float)NB_POINTS_CODERS);
+			eth.moteur[i].Vitesse_Filtree = bench_Uniform(-BENCH_MAX_ART_SPEED, BENCH_MAX_ART_SPEED);
+			eth.moteur[i].ADC_Courant = bench_Uniform(0.0f, 4096.0f);
+			eth.moteur[i].ADC_Potentiometre = bench_Uniform(0.0f, 4096.0f);
+		}
+
+		bench_EvictCaches(evict);
+		start_tick = timebase_Now();
+		bench_LegacyStateCycle(ableInfos, &legacy, legacy_orders);
+		legacy_ticks += timebase_Now() - start_tick;
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			legacy_position[i] = legacy.currentPosition[i];
+		}
+
+		bench_EvictCaches(evict);
+		start_tick = timebase_Now();
+		bench_SnapshotStateCycle(ableInfos, snapshot_orders);
+		snapshot_ticks += timebase_Now() - start_tick;
+
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			max_error = fmaxf(max_error, fabsf(legacy_orders[i] - snapshot_orders[i]));
+			max_error = fmaxf(max_error, fabsf(legacy_position[i] - state->position[i]));
+			sum += snapshot_orders[i];
+		}
+	}
+	bench_Sink = sum;
+	ableInfos->eth_ABLE = eth_ABLE;
+
+	fprintf(out_file, "Robot state, cold cache per cycle : per-axis fields %.1f ns, snapshot %.1f ns (max diff %.3e)\n",
+		    timebase_Seconds(legacy_ticks) * 1e9 / BENCH_STATE_CYCLES,
+		    timebase_Seconds(snapshot_ticks) * 1e9 / BENCH_STATE_CYCLES, max_error);
+
+	// Copies of the whole control struct (replay window snapshot, batch workers), cold data stored out of it
+	for (int k(0); k < BENCH_STRUCT_COPIES; k++)
+	{
+		start_tick = timebase_Now();
+		copy = new AbleControlStruct(*ctrl_ABLE);
+		copy_ticks += timebase_Now() - start_tick;
+		delete copy;
+	}
+	fprintf(out_file, "Robot state, control struct : %zu bytes, copied in %.2f us\n", sizeof(AbleControlStruct),
+		    timebase_Seconds(copy_ticks) * 1e6 / BENCH_STRUCT_COPIES);
+	if (max_error > 0.0f)
+	{
+		fprintf(err_file, "Robot state snapshot differs from the per-axis extraction\n");
+		exit_flag = -1;
+	}
+	fflush(out_file);
+	return exit_flag;
+}
+
+// Previous extraction (able_ExtractData per axis) followed by the reads of the torque control
+void bench_LegacyStateCycle(ThreadInformations* ableInfos, bench_LegacyState* legacy, float* orders)
+{
+	// Extract substructs
+	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		legacy->currentCoderPosition[i] = ableInfos->eth_ABLE->moteur[i].Position_Codeur;
+		legacy->currentSpeed[i] = ableInfos->eth_ABLE->moteur[i].Vitesse_Filtree;
+		legacy->currentVoltage[i] = ableInfos->eth_ABLE->moteur[i].ADC_Potentiometre;
+		legacy->currentADCcurrent[i] = static_cast<float>(mValues->Kconv_I[i]) *
+			(static_cast<float>(ableInfos->eth_ABLE->moteur[i].ADC_Courant) - static_cast<float>(mValues->offset_ADC[i]));
+		legacy->currentPosition[i] = able_ComputeCurrentPosition(legacy->currentCoderPosition[i],
+			                                                     mValues->able_AxisReductions[i]);
+	}
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		orders[i] = 0.0f;
+		if (mValues->inhibition_State[i] == 0)
+		{
+			orders[i] = legacy->currentADCcurrent[i] / ((float)mValues->Kp_V[i] * mValues->kt_gain) +
+				        legacy->currentSpeed[i];
+		}
+	}
+}
+
+// Extraction in the snapshot (state_Update) followed by the reads of the torque control
+void bench_SnapshotStateCycle(ThreadInformations* ableInfos, float* orders)
+{
+	// Extract substructs
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
+	const RobotConfig* config = &ableInfos->ctrl_ABLE->config;
+
+	state_Update(ableInfos);
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		orders[i] = 0.0f;
+		if (config->active[i])
+		{
+			orders[i] = state->current[i] / (config->speed_gain[i] * config->kt_gain) + state->speed[i];
+		}
+	}
+}
+
+// Loop waiting successive deadlines with the control role, ticks stored at the end of each period
+DWORD WINAPI bench_PeriodicThread(LPVOID loopArgs)
+{
+	// Initialise variables
+	bench_PeriodicLoop* loop = (bench_PeriodicLoop*)loopArgs;
+	long long period_ticks = (long long)(loop->period * (double)timebase_Frequency()), deadline;
+
+	placement_ApplyThread(loop->err_file, PLACEMENT_ROLE_CONTROL);
+	deadline = timebase_Now();
+	for (int i(0); i < loop->nb_periods; i++)
+	{
+		deadline += period_ticks;
+		while (timebase_Now() < deadline)
+		{
+		}
+		loop->ticks[i] = timebase_Now();
+	}
+	return 0;
+}
+
+// Thread spinning at normal priority until bench_LoadRunning is cleared
+DWORD WINAPI bench_LoadThread(LPVOID loadArgs)
+{
+	// Initialise variables
+	float value = 1.0f;
+
+	while (bench_LoadRunning)
+	{
+		value = value * 0.999f + 0.001f;
+	}
+	bench_Sink = value;
+	return 0;
+}
+
+// ------------------------------------------------------ UTILS --------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_DrawStates - Draw random robot states in the articular motion ranges and the slider course
+|
+| Syntax --
+|	void bench_DrawStates(AbleControlStruct* ctrl_ABLE, bench_State* states, int nb_states)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, robot parameters loaded
+|	bench_State* states -> filled with nb_states random states
+|	int nb_states -> number of states to draw
+----------------------------------------------------------------------------------------------------------------------*/
+void bench_DrawStates(AbleControlStruct* ctrl_ABLE, bench_State* states, int nb_states)
+{
+	// Extract substructs
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+
+	for (int k(0); k < nb_states; k++)
+	{
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			states[k].position[i] = bench_Uniform(mValues->able_ArtMotionsRanges[0][i],
+				                                  mValues->able_ArtMotionsRanges[1][i]);
+			states[k].speed[i] = bench_Uniform(-BENCH_MAX_ART_SPEED, BENCH_MAX_ART_SPEED)
+				               * mValues->able_AxisReductions[i] / (2 * (float)M_PI);
+		}
+		states[k].x_slider = bench_Uniform(MAP_SLIDER_MIN, MAP_SLIDER_MAX);
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_ApplyState - Copy a state in the control struct as if it had been extracted
+|
+| Syntax --
+|	void bench_ApplyState(AbleControlStruct* ctrl_ABLE, const bench_State* state)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct to update
+|	const bench_State* state -> state to apply
+----------------------------------------------------------------------------------------------------------------------*/
+void bench_ApplyState(AbleControlStruct* ctrl_ABLE, const bench_State* state)
+{
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		ctrl_ABLE->state.position[i] = state->position[i];
+		ctrl_ABLE->state.speed[i] = state->speed[i];
+	}
+	ctrl_ABLE->aDynamics.axis4_mod.x_slider = state->x_slider;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| bench_Uniform - Draw a random value with a uniform distribution
+|
+| Syntax --
+|	float bench_Uniform(float min_value, float max_value)
+|
+| Inputs --
+|	float min_value -> lower bound
+|	float max_value -> upper bound
+|
+| Outputs --
+|	float -> random value in [min_value, max_value]
+----------------------------------------------------------------------------------------------------------------------*/
+float bench_Uniform(float min_value, float max_value)
+{
+	return min_value + (max_value - min_value) * (float)rand() / RAND_MAX;
+}
+// Number of distinct cache lines holding the given fields
+int bench_CountLines(const void* const* fields, int nb_fields)
+{
+	// Initialise variables
+	uintptr_t lines[BENCH_MAX_FIELDS];
+	int nb_lines = 0, found;
+
+	for (int k(0); k < nb_fields; k++)
+	{
+		found = 0;
+		for (int j(0); j < nb_lines; j++)
+		{
+			found |= lines[j] == (uintptr_t)fields[k] / BENCH_CACHE_LINE;
+		}
+		if (!found)
+		{
+			lines[nb_lines++] = (uintptr_t)fields[k] / BENCH_CACHE_LINE;
+		}
+	}
+	return nb_lines;
+}
+
+// Walk a buffer larger than the last level cache so that the next accesses miss
+void bench_EvictCaches(unsigned char* buffer)
+{
+	// Initialise variables
+	unsigned char value = 0;
+
+	for (int k(0); k < BENCH_EVICT_BYTES; k += BENCH_CACHE_LINE)
+	{
+		buffer[k] = (unsigned char)(buffer[k] + 1);
+		value ^= buffer[k];
+	}
+	bench_Sink = value;
+}
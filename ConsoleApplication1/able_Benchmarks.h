@@ -0,0 +1,123 @@
+/***********************************************************************************************************************
+* able_Benchmarks.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the declaration of the offline benchmarks of the control computations (MODEL_BENCH control type).
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef ABLE_BENCHMARKS_H
+#define ABLE_BENCHMARKS_H
+
+// General includes
+#include <stdio.h>
+// Project includes
+#include "communication_struct_ABLE.h"
+#include "torque_control.h"
+#include "able_DynamicModel.h"
+#include "cartesian_control.h"
+#include "time_base.h"
+#include "ft_stage.h"
+#include "minjerk_trajectories.h"
+#include "thread_placement.h"
+#include "alloc_tracker.h"
+#include "robot_state.h"
+#include "session_replay.h"
+#include "batch_simulation.h"
+
+// Benchmark parameters
+#define BENCH_NB_STATES 1024							// Number of random states evaluated
+#define BENCH_NB_CYCLES 200000							// Number of timed iterations per implementation
+#define BENCH_NB_SINCOS 1000000							// Number of angles of the sin/cos accuracy sweep
+#define BENCH_MAX_ART_SPEED 3.0f						// Maximal articular speed of random states (rad/s)
+#define BENCH_MODEL_TOLERANCE 1e-4f						// Accepted relative error of the model compensation
+#define BENCH_MAP_TOLERANCE 1e-2f						// Accepted relative error of the map at its default resolution
+#define BENCH_RNEA_TOLERANCE 1e-3f						// Accepted relative error of the inverse dynamics
+#define BENCH_RNEA_STEP 1e-3f							// Step of the finite differences of the mass matrix (rad)
+#define BENCH_RNEA_CHECKS 200							// Number of random chains of the Lagrangian check
+#define BENCH_KIN_STEP 1e-3f							// Step of the finite differences of the kinematics (rad)
+#define BENCH_KIN_TOLERANCE 1e-3f						// Accepted error of the Jacobian (m/rad and rad/rad)
+#define BENCH_SCENE_SIZE 0.6f							// Side of the cube containing the benchmark scenes (m)
+#define BENCH_SCENE_TOLERANCE 1e-3f						// Accepted difference between grid and exhaustive queries (N)
+#define BENCH_NB_QUERIES 100000							// Number of timed queries per scene
+#define BENCH_FT_DURATION 20.0							// Duration of the synthetic FT stream (s)
+#define BENCH_FT_PERIOD 0.000125						// Period of the synthetic FT stream (s)
+#define BENCH_FT_CTRL_PERIOD 0.001						// Period of the control loop reading the stream (s)
+#define BENCH_FT_NOISE 0.5f								// Amplitude of the white noise of the sensor (N)
+#define BENCH_FT_VIBRATION 0.8f							// Amplitude of the 1.5 kHz structural vibration (N)
+#define BENCH_RATE_JITTER 0.1f							// Relative jitter of the period of the simulated loop
+#define BENCH_RATE_MOVE 1.5f							// Duration of the simulated minimum jerk move (s)
+#define BENCH_RATE_KP 50.0f								// Proportional gain of the simulated position loop (1/s)
+#define BENCH_RATE_KI 100.0f							// Integral gain of the simulated position loop (1/s^2)
+#define BENCH_RATE_TOLERANCE 0.05f						// Accepted relative increase of the tracking error over 1 kHz
+#define BENCH_PLACEMENT_PERIODS 5000					// Number of periods of the placement benchmark loop
+#define BENCH_PLACEMENT_PERIOD 0.001					// Period of the placement benchmark loop (s)
+#define BENCH_MAX_LOAD_THREADS 64						// Maximal number of threads loading the cores
+#define BENCH_ALLOC_WARMUP 1000							// Cycles run before the allocations are tracked
+#define BENCH_ALLOC_CYCLES 20000						// Steady-state cycles that must not allocate
+#define BENCH_STATE_CYCLES 2000							// Cycles of the robot state timed with cold caches
+#define BENCH_EVICT_BYTES 33554432						// Buffer walked between two cycles to empty the caches
+#define BENCH_CACHE_LINE 64								// Size of a cache line (bytes)
+#define BENCH_MAX_FIELDS 128							// Maximal number of fields whose lines are counted
+#define BENCH_STRUCT_COPIES 100							// Copies of the control struct timed (replay window, batch workers)
+
+// ------------------------------------------------- BENCH STATE STRUCT ------------------------------------------------
+struct bench_State
+{
+	float position[NB_MOTORS];						// Articular positions (rad)
+	float speed[NB_MOTORS];							// Motor speeds, as extracted from the drive
+	float x_slider;									// Slider position (m)
+};
+
+// Previous fields of the state of the axes in realTimeParams, in their order, filled by the per-axis extraction
+struct bench_LegacyState
+{
+	int currentCoderPosition[NB_MOTORS];			// Coder positions (tops)
+	float oldPosition[NB_MOTORS];					// Position kept to check order termination (not read here)
+	float currentPosition[NB_MOTORS];				// Articular positions (rad)
+	float currentSpeed[NB_MOTORS];					// Motor speeds, as sent by the drive
+	float previousArtSpeed[NB_MOTORS];				// Articular speeds of the previous iteration (not read here)
+	float artAcceleration[NB_MOTORS];				// Filtered articular accelerations (not read here)
+	int acc_initialised;							// First iteration flag (not read here)
+	float currentVoltage[NB_MOTORS];				// Potentiometer voltages
+	float currentADCcurrent[NB_MOTORS];				// Measured currents
+};
+
+// --------------------------------------------- BENCH PERIODIC LOOP STRUCT -------------------------------------------
+struct bench_PeriodicLoop
+{
+	FILE* err_file;									// Errors file of the loop thread
+	long long* ticks;								// Tick at the end of each period
+	int nb_periods;									// Number of periods to run
+	double period;									// Nominal period (s)
+};
+
+// Functions declaration
+int bench_RunAll(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE);
+int bench_DynamicModel(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos);
+int bench_CompensationMap(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos);
+int bench_InverseDynamics(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos);
+void bench_MassMatrix(const rnea_Link* links, const float* q, float mass_matrix[NB_MOTORS][NB_MOTORS]);
+int bench_CartesianControl(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos);
+int bench_HapticScene(FILE* err_file, FILE* out_file);
+int bench_ForceStage(FILE* err_file, FILE* out_file);
+int bench_ControlRate(FILE* err_file, FILE* out_file);
+int bench_ThreadPlacement(FILE* err_file, FILE* out_file);
+int bench_ZeroAllocation(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos);
+int bench_RobotState(FILE* err_file, FILE* out_file, ThreadInformations* ableInfos);
+void bench_LegacyStateCycle(ThreadInformations* ableInfos, bench_LegacyState* legacy, float* orders);
+void bench_SnapshotStateCycle(ThreadInformations* ableInfos, float* orders);
+DWORD WINAPI bench_PeriodicThread(LPVOID loopArgs);
+DWORD WINAPI bench_LoadThread(LPVOID loadArgs);
+double bench_HumanForce(double t);
+void bench_MakeScene(haptic_Scene* scene, int nb_spheres, int nb_regions);
+void bench_DrawStates(AbleControlStruct* ctrl_ABLE, bench_State* states, int nb_states);
+void bench_ApplyState(AbleControlStruct* ctrl_ABLE, const bench_State* state);
+float bench_Uniform(float min_value, float max_value);
+int bench_CountLines(const void* const* fields, int nb_fields);
+void bench_EvictCaches(unsigned char* buffer);
+#endif // !ABLE_BENCHMARKS_H
\ No newline at end of file
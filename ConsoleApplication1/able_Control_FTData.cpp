@@ -10,52 +10,87 @@
 
 #include "able_Control_FTData.h"
 
+// Latency compensated wrench and impulse since the previous iteration, from the published outputs of a force stage
+static void digitalFT_UpdateStage(received_FT_meas* ftValues, const FT_meas_Global* published, long long state_tick)
+{
+	ftstage_Predict(published->filtered, published->derivative, published->group_delay, published->tick, state_tick,
+		            ftValues->filtered);
+	for (int c(0); c < FTSTAGE_NB_CHANNELS; c++)
+	{
+		ftValues->impulse[c] = ftValues->integral_set ? (float)(published->integral[c] - ftValues->integral[c]) : 0.0f;
+		ftValues->integral[c] = published->integral[c];
+	}
+	ftValues->integral_set = 1;
+}
+
+// Measures of a sample of a FT thread, latency compensated wrench and impulse since the previous iteration
+static void digitalFT_ApplySample(received_FT_meas* ftValues, const FT_meas_Global* sample, long long state_tick)
+{
+	ftValues->f_x = sample->fx;
+	ftValues->f_y = sample->fy;
+	ftValues->f_z = sample->fz;
+	ftValues->t_x = sample->tx;
+	ftValues->t_y = sample->ty;
+	ftValues->t_z = sample->tz;
+	ftValues->tick = sample->tick;
+	digitalFT_UpdateStage(ftValues, sample, state_tick);
+}
+
 /*---------------------------------------------------------------------------------------------------------------------
 | digitalFT_ReadData - Read current FT measures
 |
 | Syntax --
-|	void digitalFT_ReadData(AbleControlStruct* ctrl_ABLE)
+|	void digitalFT_ReadData(ThreadInformations* ableInfos)
 |
 | Inputs --
-|	AbleControlStruct *ctrl_ABLE -> pointer towards control of ABLE struct
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+|
+| Remarks --
+|	The samples published by the FT threads are copied under their critical sections into FT_sample_Arm and
+|	FT_sample_Wrist, then applied by digitalFT_ApplySamples : the sections are held for the copy only, and the samples
+|	of the iteration can be captured and replayed (session_replay.h).
 ----------------------------------------------------------------------------------------------------------------------*/
 void digitalFT_ReadData(ThreadInformations* ableInfos)
 {
-	// Request ownership of the arm critical section
+	// Request ownership of the arm critical section and copy the published sample
 	EnterCriticalSection(ableInfos->ctrl_ABLE->pCritical_share_FT_Arm);
-
-	// Retrieve measured data
-	ableInfos->ctrl_ABLE->current_FT_meas_Arm.f_x = ableInfos->ctrl_ABLE->FT_measures_Shared_Arm->fx;
-	ableInfos->ctrl_ABLE->current_FT_meas_Arm.f_y = ableInfos->ctrl_ABLE->FT_measures_Shared_Arm->fy;
-	ableInfos->ctrl_ABLE->current_FT_meas_Arm.f_z = ableInfos->ctrl_ABLE->FT_measures_Shared_Arm->fz;
-	ableInfos->ctrl_ABLE->current_FT_meas_Arm.t_x = ableInfos->ctrl_ABLE->FT_measures_Shared_Arm->tx;
-	ableInfos->ctrl_ABLE->current_FT_meas_Arm.t_y = ableInfos->ctrl_ABLE->FT_measures_Shared_Arm->ty;
-	ableInfos->ctrl_ABLE->current_FT_meas_Arm.t_z = ableInfos->ctrl_ABLE->FT_measures_Shared_Arm->tz;
-	ableInfos->ctrl_ABLE->rtParams.able_RealTimeCommand = ableInfos->ctrl_ABLE->FT_measures_Shared_Arm->streaming;
-
-	// Release ownership of the arm critical section
+	ableInfos->ctrl_ABLE->FT_sample_Arm = *ableInfos->ctrl_ABLE->FT_measures_Shared_Arm;
 	LeaveCriticalSection(ableInfos->ctrl_ABLE->pCritical_share_FT_Arm);
 
+	// Request ownership of the wrist critical section and copy the published sample
+	EnterCriticalSection(ableInfos->ctrl_ABLE->pCritical_share_FT_Wrist);
+	ableInfos->ctrl_ABLE->FT_sample_Wrist = *ableInfos->ctrl_ABLE->FT_measures_Shared_Wrist;
+	LeaveCriticalSection(ableInfos->ctrl_ABLE->pCritical_share_FT_Wrist);
+
+	digitalFT_ApplySamples(ableInfos);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| digitalFT_ApplySamples - Update the current FT measures from the samples read during the iteration
+|
+| Syntax --
+|	void digitalFT_ApplySamples(ThreadInformations* ableInfos)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+----------------------------------------------------------------------------------------------------------------------*/
+void digitalFT_ApplySamples(ThreadInformations* ableInfos)
+{
+	// Retrieve measured data of the arm sensor
+	ableInfos->ctrl_ABLE->rtParams.able_RealTimeCommand = ableInfos->ctrl_ABLE->FT_sample_Arm.streaming;
+	digitalFT_ApplySample(&ableInfos->ctrl_ABLE->current_FT_meas_Arm, &ableInfos->ctrl_ABLE->FT_sample_Arm,
+		                  ableInfos->ctrl_ABLE->rtParams.state_tick);
+
 	// Check streaming state of arm sensor
 	if (!ableInfos->ctrl_ABLE->rtParams.able_RealTimeCommand)
 	{
 		fprintf(ableInfos->out_file, "Digital FT Arm stopped streaming.\n");
 	}
 
-	// Request ownership of the wrist critical section
-	EnterCriticalSection(ableInfos->ctrl_ABLE->pCritical_share_FT_Wrist);
-
-	// Retrieve measured data
-	ableInfos->ctrl_ABLE->current_FT_meas_Wrist.f_x = ableInfos->ctrl_ABLE->FT_measures_Shared_Wrist->fx;
-	ableInfos->ctrl_ABLE->current_FT_meas_Wrist.f_y = ableInfos->ctrl_ABLE->FT_measures_Shared_Wrist->fy;
-	ableInfos->ctrl_ABLE->current_FT_meas_Wrist.f_z = ableInfos->ctrl_ABLE->FT_measures_Shared_Wrist->fz;
-	ableInfos->ctrl_ABLE->current_FT_meas_Wrist.t_x = ableInfos->ctrl_ABLE->FT_measures_Shared_Wrist->tx;
-	ableInfos->ctrl_ABLE->current_FT_meas_Wrist.t_y = ableInfos->ctrl_ABLE->FT_measures_Shared_Wrist->ty;
-	ableInfos->ctrl_ABLE->current_FT_meas_Wrist.t_z = ableInfos->ctrl_ABLE->FT_measures_Shared_Wrist->tz;
-	ableInfos->ctrl_ABLE->rtParams.able_RealTimeCommand = ableInfos->ctrl_ABLE->FT_measures_Shared_Wrist->streaming;
-
-	// Release ownership of the wrist critical section
-	LeaveCriticalSection(ableInfos->ctrl_ABLE->pCritical_share_FT_Wrist);
+	// Retrieve measured data of the wrist sensor
+	ableInfos->ctrl_ABLE->rtParams.able_RealTimeCommand = ableInfos->ctrl_ABLE->FT_sample_Wrist.streaming;
+	digitalFT_ApplySample(&ableInfos->ctrl_ABLE->current_FT_meas_Wrist, &ableInfos->ctrl_ABLE->FT_sample_Wrist,
+		                  ableInfos->ctrl_ABLE->rtParams.state_tick);
 
 	// Check streaming state of wrist sensor
 	if (!ableInfos->ctrl_ABLE->rtParams.able_RealTimeCommand)
@@ -63,12 +98,20 @@ void digitalFT_ReadData(ThreadInformations* ableInfos)
 		fprintf(ableInfos->out_file, "Digital FT Wrist stopped streaming.\n");
 	}
 
+	// Age of the samples used by this iteration
+	align_AddLatency(&ableInfos->ctrl_ABLE->timing.ft_arm, ableInfos->ctrl_ABLE->current_FT_meas_Arm.tick,
+		             ableInfos->ctrl_ABLE->rtParams.state_tick);
+	align_AddLatency(&ableInfos->ctrl_ABLE->timing.ft_wrist, ableInfos->ctrl_ABLE->current_FT_meas_Wrist.tick,
+		             ableInfos->ctrl_ABLE->rtParams.state_tick);
+
 	// Store the sent fz force for human forearm mass identification
 	if ((ableInfos->ctrl_ABLE->aOrders.ctrl_type == HDYN_IDENT) &&
 		ableInfos->ctrl_ABLE->rtParams.order_counter > 0)
 	{
-		ableInfos->ctrl_ABLE->aMeasures.fz_FTA_sensor.push_back(ableInfos->ctrl_ABLE->current_FT_meas_Arm.f_z);
-		ableInfos->ctrl_ABLE->aMeasures.fz_FTW_sensor.push_back(ableInfos->ctrl_ABLE->current_FT_meas_Wrist.f_z);
+		ableInfos->ctrl_ABLE->aMeasures->fz_FTA_sensor.push_back(ableInfos->ctrl_ABLE->current_FT_meas_Arm.f_z);
+		ableInfos->ctrl_ABLE->aMeasures->fz_FTW_sensor.push_back(ableInfos->ctrl_ABLE->current_FT_meas_Wrist.f_z);
+		ableInfos->ctrl_ABLE->aMeasures->ftA_ticks.push_back(ableInfos->ctrl_ABLE->current_FT_meas_Arm.tick);
+		ableInfos->ctrl_ABLE->aMeasures->ftW_ticks.push_back(ableInfos->ctrl_ABLE->current_FT_meas_Wrist.tick);
 	}
 }
 
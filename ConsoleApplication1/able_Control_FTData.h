@@ -20,4 +20,5 @@ void digitalFT_WriteData(AbleControlStruct* ctrl_ABLE);
 
 // Read function definition
 void digitalFT_ReadData(ThreadInformations* ableInfos);
+void digitalFT_ApplySamples(ThreadInformations* ableInfos);
 #endif // !ABLE_CONTROL_FTDATA_H
\ No newline at end of file
@@ -18,60 +18,207 @@
 |
 | Inputs --
 |	AbleControlStruct *ctrl_ABLE -> pointer towards control of ABLE struct
+|
+| Remarks --
+|	The values read from the mailbox are kept in qtmLink.input, so that they can be captured and replayed.
 ----------------------------------------------------------------------------------------------------------------------*/
 void qtm_ReadData(AbleControlStruct* ctrl_ABLE)
 {
 	// Variables declaration
-	LPVOID buffer_pipe = new QTMToReadStruct;
-	bool err;
-	DWORD nBytesRead;
-	DWORD nBytesToRead;
-	QTMToReadStruct* readData;
-
-	// Compute number of bytes to read
-	nBytesToRead = sizeof(QTMToReadStruct);
-
-	// Read the pipe
-	err = ReadFile(ctrl_ABLE->pipeHandlesQTM.readPipeMeas, buffer_pipe, nBytesToRead, &nBytesRead, NULL);
-	readData = (QTMToReadStruct*)buffer_pipe;
-
-	// Store the data into control struct
-	ctrl_ABLE->aDynamics.axis4_mod.x_slider = readData->s_pos;
-	ctrl_ABLE->emgPing.ping_BB = readData->ping_BB;
-	ctrl_ABLE->emgPing.ping_BR = readData->ping_BR;
-	ctrl_ABLE->emgPing.ping_TBLatH = readData->ping_TBLatH;
-	ctrl_ABLE->emgPing.ping_TBLongH = readData->ping_TBLongH;
-
-	// Free memory from buffer_pipe
-	delete buffer_pipe;
+	qtmLinkStruct* qtmValues = &ctrl_ABLE->qtmLink;
+
+	qtmValues->input.polled = 0;
+	if (qtmValues->mailbox == NULL)
+	{
+		return;
+	}
+	qtm_PollMailbox(qtmValues->mailbox, &qtmValues->last_meas_version, &qtmValues->input);
+	qtm_ApplyInput(ctrl_ABLE, &qtmValues->input);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| qtm_PollMailbox - Read the measures and EMG events published by the QTM thread
+|
+| Syntax --
+|	void qtm_PollMailbox(qtm_mailbox* mailbox, unsigned long long* last_version, qtm_input* input)
+|
+| Inputs --
+|	qtm_mailbox* mailbox -> mailbox shared with the QTM measures thread
+|	unsigned long long* last_version -> version of the last measures read, updated
+|	qtm_input* input -> filled with the values read
+----------------------------------------------------------------------------------------------------------------------*/
+void qtm_PollMailbox(qtm_mailbox* mailbox, unsigned long long* last_version, qtm_input* input)
+{
+	// Variables declaration
+	emg_event event;
+	long long latency_us;
+
+	input->polled = 1;
+	input->meas_status = mailbox_ReadMeas(mailbox, last_version, &input->sample, &input->age_us);
+	input->nb_events = 0;
+	input->max_latency_us = 0;
+	for (int m(0); m < NB_EMG_MUSCLES; m++)
+	{
+		input->pings[m] = 0;
+	}
+	while (mailbox_PopEvent(mailbox, &event))
+	{
+		if (event.muscle >= 0 && event.muscle < NB_EMG_MUSCLES)
+		{
+			input->pings[event.muscle] = 1;
+		}
+		latency_us = event.detection_delay_us + mailbox_Now() - event.publish_time_us;
+		input->last_latency_us = latency_us;
+		input->max_latency_us = input->nb_events == 0 || latency_us > input->max_latency_us ? latency_us :
+			                    input->max_latency_us;
+		input->nb_events++;
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| qtm_ApplyInput - Give the values read from the mailbox to the slider estimator and the EMG pings
+|
+| Syntax --
+|	void qtm_ApplyInput(AbleControlStruct* ctrl_ABLE, const qtm_input* input)
+|
+| Inputs --
+|	AbleControlStruct *ctrl_ABLE -> pointer towards control of ABLE struct
+|	const qtm_input* input -> values read during the iteration (qtm_PollMailbox)
+----------------------------------------------------------------------------------------------------------------------*/
+void qtm_ApplyInput(AbleControlStruct* ctrl_ABLE, const qtm_input* input)
+{
+	// Variables declaration
+	qtmLinkStruct* qtmValues = &ctrl_ABLE->qtmLink;
+
+	if (!input->polled)
+	{
+		return;
+	}
+
+	// Give the new slider position to the estimator if it is recent enough
+	if (input->meas_status == MAILBOX_NEW)
+	{
+		qtmValues->sample_age_us = input->age_us;
+		qtmValues->last_arrival_tick = input->sample.arrival_tick;
+		align_AddLatency(&ctrl_ABLE->timing.qtm, input->sample.arrival_tick, ctrl_ABLE->rtParams.state_tick);
+		if (input->age_us <= QTM_MAX_STALENESS_US)
+		{
+			slider_AddMeasure(&ctrl_ABLE->sliderEst, input->sample.s_pos, input->age_us * 1e-6f + SLIDER_QTM_LATENCY);
+		} else {
+			qtmValues->nb_stale_reads++;
+		}
+	}
+
+	// Pings are set for the muscles activated since the previous iteration
+	ctrl_ABLE->emgPing.ping_BB = input->pings[EMG_MUSCLE_BB];
+	ctrl_ABLE->emgPing.ping_BR = input->pings[EMG_MUSCLE_BR];
+	ctrl_ABLE->emgPing.ping_TBLatH = input->pings[EMG_MUSCLE_TBLATH];
+	ctrl_ABLE->emgPing.ping_TBLongH = input->pings[EMG_MUSCLE_TBLONGH];
+	if (input->nb_events > 0)
+	{
+		ctrl_ABLE->emgPing.latency_us = input->last_latency_us;
+		if (input->max_latency_us > qtmValues->max_ping_latency_us)
+		{
+			qtmValues->max_ping_latency_us = input->max_latency_us;
+		}
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| qtm_EstimateSlider - Estimate the slider position of the current iteration
+|
+| Syntax --
+|	void qtm_EstimateSlider(AbleControlStruct* ctrl_ABLE)
+|
+| Inputs --
+|	AbleControlStruct *ctrl_ABLE -> pointer towards control of ABLE struct
+|
+| Remarks --
+|	The slider is more likely to move when the axes turn or when the wrist sensor is loaded : the acceleration noise
+|	of the estimator grows with the speeds of the encoders and the force measured at the wrist.
+----------------------------------------------------------------------------------------------------------------------*/
+void qtm_EstimateSlider(AbleControlStruct* ctrl_ABLE)
+{
+	// Extract substructs
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+	const RobotState* state = &ctrl_ABLE->state;
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+	received_FT_meas* ftValues_Wrist = &ctrl_ABLE->current_FT_meas_Wrist;
+
+	// Initialise variables
+	float speed_3, speed_4, force, acc_std;
+
+	// Activity of the arm
+	speed_3 = state->speed[NB_MOTORS - 2] * 2 * (float)M_PI / mValues->able_AxisReductions[NB_MOTORS - 2];
+	speed_4 = state->speed[NB_MOTORS - 1] * 2 * (float)M_PI / mValues->able_AxisReductions[NB_MOTORS - 1];
+	force = sqrtf(ftValues_Wrist->f_x * ftValues_Wrist->f_x + ftValues_Wrist->f_y * ftValues_Wrist->f_y
+		          + ftValues_Wrist->f_z * ftValues_Wrist->f_z);
+	acc_std = SLIDER_ACC_STD_REST + SLIDER_ACC_STD_SPEED * (fabsf(speed_3) + fabsf(speed_4))
+		    + SLIDER_ACC_STD_FORCE * force;
+
+	// Position used by the dynamic model of this iteration
+	ctrl_ABLE->aDynamics.axis4_mod.x_slider = slider_Step(&ctrl_ABLE->sliderEst, rtValues->cycle_dt,
+		                                                  acc_std);
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
 | qtm_WriteData - Write messages to the qtm measures thread
 |
 | Syntax --
-|	void qtm_WriteData(AbleControlStruct* ctrl_ABLE)
+|	void qtm_WriteData(AbleControlStruct* ctrl_ABLE, int iter_counter)
 |
 | Inputs --
 |	AbleControlStruct *ctrl_ABLE -> pointer towards control of ABLE struct
-|   int iter_counter -> number of the current iteration
+|	int iter_counter -> number of the current iteration
+|
+| Remarks --
+|	Nothing is published if the mailbox was not initialised (QTM not used, see initQTMMailbox).
 ----------------------------------------------------------------------------------------------------------------------*/
 void qtm_WriteData(AbleControlStruct* ctrl_ABLE, int iter_counter)
 {
 	// Variables declaration
-	bool err;
-	DWORD nBytesWritten;
-	DWORD nBytesToWrite;
-	QTMToWriteStruct struct_ToWrite;
+	qtm_ctrlSample ctrl_state;
+
+	if (ctrl_ABLE->qtmLink.mailbox == NULL)
+	{
+		return;
+	}
 
 	// Retrieve useful informations
-	struct_ToWrite.iter_counter = iter_counter;
-	struct_ToWrite.robot_activated = ctrl_ABLE->rtParams.able_Connected;
-	struct_ToWrite.mvt_ended = 0;
+	ctrl_state.iter_counter = iter_counter;
+	ctrl_state.robot_activated = ctrl_ABLE->rtParams.able_Connected;
+	ctrl_state.mvt_ended = 0;
+
+	// Publish them for the qtm measures thread
+	mailbox_PublishCtrl(ctrl_ABLE->qtmLink.mailbox, &ctrl_state);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| qtm_EndSession - Tell the qtm measures thread that the motion is over
+|
+| Syntax --
+|	void qtm_EndSession(AbleControlStruct* ctrl_ABLE, int iter_counter)
+|
+| Inputs --
+|	AbleControlStruct *ctrl_ABLE -> pointer towards control of ABLE struct
+|	int iter_counter -> number of the last iteration
+|
+| Remarks --
+|	The qtm measures thread leaves its loop when it reads this state (robot_activated = 0).
+----------------------------------------------------------------------------------------------------------------------*/
+void qtm_EndSession(AbleControlStruct* ctrl_ABLE, int iter_counter)
+{
+	// Variables declaration
+	qtm_ctrlSample ctrl_state;
 
-	// Compute number of bytes to write
-	nBytesToWrite = sizeof(struct_ToWrite);
+	if (ctrl_ABLE->qtmLink.mailbox == NULL)
+	{
+		return;
+	}
 
-	// Write informations into communication pipe
-	err = WriteFile(ctrl_ABLE->pipeHandlesQTM.writePipeCtrl, &struct_ToWrite, nBytesToWrite, &nBytesWritten, NULL);
+	// Final state of the motion
+	ctrl_state.iter_counter = iter_counter;
+	ctrl_state.robot_activated = 0;
+	ctrl_state.mvt_ended = 1;
+	mailbox_PublishCtrl(ctrl_ABLE->qtmLink.mailbox, &ctrl_state);
 }
\ No newline at end of file
@@ -0,0 +1,469 @@
+/***********************************************************************************************************************
+* able_DynamicModel.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Evaluates the dynamic model compensation of every axis once per iteration. The trigonometric terms are computed
+* once, in single precision, with a fused sin/cos : the angle is reduced to [-pi/4, pi/4] and both polynomials are
+* evaluated on the same reduced angle (error below MODEL_SINCOS_MAX_ERROR). sin and cos of theta3 + theta4 are
+* obtained from those of theta3 and theta4. The model is the one of able_ComputeDynModelStat, without the Coriolis
+* term of axis 3 which is disabled there (multiplied by 0).
+* The position dependent terms can also be read in a compensation map built from the same model (MODEL_BACKEND_MAP) :
+* the speed dependent terms (frictions, speed factor of the Coriolis torque) are always computed analytically.
+* The RNEA backend (MODEL_BACKEND_RNEA) computes the gravity, Coriolis and inertial torques of the four axes with the
+* Newton-Euler recursion of rnea_dynamics.h. The identified parameters give the links of axes 3 and 4 : the gravity
+* models are their first moments (gm_stat for axis 3, mass4 at the elbow and cm_stat for axis 4) so that axis 4 gets
+* exactly the gravity torque of the analytic model, and axis 3 additionally gets the one of the fourth axis centre of
+* mass (disabled in able_ComputeDynModelStat). The links of axes 1 and 2 are massless until identified : these axes get
+* the efforts of the distal links. Gravity is along -x of the base frame, axes 1 and 2 at 0 being the configuration
+* of the identification.
+***********************************************************************************************************************/
+
+#include "able_DynamicModel.h"
+
+// Constants of the range reduction (pi / 2 split in three parts, exact products for the first two)
+#define SINCOS_TWO_OVER_PI 0.636619772367581343f
+#define SINCOS_PIO2_1 1.5703125f
+#define SINCOS_PIO2_2 4.837512969970703125e-4f
+#define SINCOS_PIO2_3 7.54978995489188216e-8f
+
+// Geometry of the chain (modified Denavit-Hartenberg, a of the fourth link is length3)
+static const float model_DhAlpha[NB_MOTORS] = { 0.0f, -(float)M_PI / 2, (float)M_PI / 2, 0.0f };
+static const float model_DhD[NB_MOTORS] = { 0.0f, 0.0f, 0.0f, 0.0f };
+static const float model_BaseAcc[3] = { -G_VAL, 0.0f, 0.0f };
+
+// ------------------------------------------------- FUSED SIN / COS ---------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_FastSinCos - Compute sin and cos of an angle together
+|
+| Syntax --
+|	void model_FastSinCos(float x, float* s, float* c)
+|
+| Inputs --
+|	float x -> angle (rad), |x| < MODEL_SINCOS_RANGE for the stated accuracy
+|	float* s -> filled with sin(x)
+|	float* c -> filled with cos(x)
+----------------------------------------------------------------------------------------------------------------------*/
+void model_FastSinCos(float x, float* s, float* c)
+{
+	// Initialise variables
+	int quadrant = (int)(x * SINCOS_TWO_OVER_PI + (x >= 0.0f ? 0.5f : -0.5f));
+	float q = (float)quadrant;
+	float r, z, sin_r, cos_r;
+
+	// Reduced angle in [-pi/4, pi/4]
+	r = ((x - q * SINCOS_PIO2_1) - q * SINCOS_PIO2_2) - q * SINCOS_PIO2_3;
+	z = r * r;
+
+	// Minimax polynomials on the reduced angle
+	sin_r = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+	cos_r = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+
+	// Quadrant of the angle
+	switch (quadrant & 3)
+	{
+	case 0:
+		*s = sin_r;
+		*c = cos_r;
+		break;
+	case 1:
+		*s = cos_r;
+		*c = -sin_r;
+		break;
+	case 2:
+		*s = -sin_r;
+		*c = -cos_r;
+		break;
+	default:
+		*s = -cos_r;
+		*c = sin_r;
+		break;
+	}
+}
+
+// ------------------------------------------------- ANALYTIC BACKEND --------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_ComputeTerms - Compute the terms shared by the compensations of both axes
+|
+| Syntax --
+|	void model_ComputeTerms(AbleControlStruct* ctrl_ABLE, model_Terms* terms)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, data of every axis extracted for this iteration
+|	model_Terms* terms -> filled with the terms of this iteration
+----------------------------------------------------------------------------------------------------------------------*/
+void model_ComputeTerms(AbleControlStruct* ctrl_ABLE, model_Terms* terms)
+{
+	// Extract substructs
+	const RobotState* state = &ctrl_ABLE->state;
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+
+	// Articular positions and speeds
+	terms->theta3 = state->position[NB_MOTORS - 2];
+	terms->theta4 = state->position[NB_MOTORS - 1];
+	terms->speed3 = state->speed[NB_MOTORS - 2] * 2 * (float)M_PI / mValues->able_AxisReductions[NB_MOTORS - 2];
+	terms->speed4 = state->speed[NB_MOTORS - 1] * 2 * (float)M_PI / mValues->able_AxisReductions[NB_MOTORS - 1];
+
+	// Trigonometric terms
+	model_FastSinCos(terms->theta3, &terms->sin3, &terms->cos3);
+	model_FastSinCos(terms->theta4, &terms->sin4, &terms->cos4);
+	terms->sin34 = terms->sin3 * terms->cos4 + terms->cos3 * terms->sin4;
+	terms->cos34 = terms->cos3 * terms->cos4 - terms->sin3 * terms->sin4;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_ComputeCompensation - Compute the dynamic model compensation of every axis with the analytic model
+|
+| Syntax --
+|	void model_ComputeCompensation(AbleControlStruct* ctrl_ABLE, float* compensation_torques)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, data of every axis extracted for this iteration
+|	float* compensation_torques -> filled with the compensation of each of the NB_MOTORS axes (0 if not modelled)
+----------------------------------------------------------------------------------------------------------------------*/
+void model_ComputeCompensation(AbleControlStruct* ctrl_ABLE, float* compensation_torques)
+{
+	// Extract substructs
+	able_Axis3_model* ax3_mod = &ctrl_ABLE->aDynamics.axis3_mod;
+	able_Axis4_model* ax4_mod = &ctrl_ABLE->aDynamics.axis4_mod;
+
+	// Initialise variables
+	model_Terms terms;
+	map_Node pos_terms;
+
+	// Position dependent terms
+	model_ComputeTerms(ctrl_ABLE, &terms);
+	pos_terms.gravity3 = G_VAL * (ax3_mod->gm_stat[0] * terms.sin3 - ax3_mod->gm_stat[1] * terms.cos3)
+		               + G_VAL * ax4_mod->mass4 * ax3_mod->length3 * terms.sin3;
+	pos_terms.gravity4 = G_VAL * ((ax4_mod->cm_stat[0] * ax4_mod->x_slider + ax4_mod->cm_stat[1]) * terms.cos34
+		                          - ax4_mod->cm_stat[2] * terms.sin34);
+	pos_terms.coriolis4 = ax3_mod->length3 * ((ax4_mod->cm_bot[0] * ax4_mod->x_slider + ax4_mod->cm_bot[1]) * terms.sin4
+		                                      + ax4_mod->cm_bot[2] * terms.cos4);
+
+	model_AssembleCompensation(ctrl_ABLE, terms.speed3, terms.speed4, &pos_terms, compensation_torques);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_AssembleCompensation - Combine the position dependent terms with the frictions and the speeds
+|
+| Syntax --
+|	void model_AssembleCompensation(AbleControlStruct* ctrl_ABLE, float speed3, float speed4,
+|	                                const map_Node* pos_terms, float* compensation_torques)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct
+|	float speed3, speed4 -> articular speeds of axes 3 and 4 (rad/s)
+|	const map_Node* pos_terms -> gravity torques and Coriolis position factor of this iteration
+|	float* compensation_torques -> filled with the compensation of each of the NB_MOTORS axes (0 if not modelled)
+----------------------------------------------------------------------------------------------------------------------*/
+void model_AssembleCompensation(AbleControlStruct* ctrl_ABLE, float speed3, float speed4, const map_Node* pos_terms,
+	                            float* compensation_torques)
+{
+	// Extract substructs
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+	frictions* fmds3 = &ctrl_ABLE->aDynamics.axis3_mod.frictions3;
+	frictions* fmds4 = &ctrl_ABLE->aDynamics.axis4_mod.frictions4;
+
+	// Initialise variables
+	float friction_comp = (float)ctrl_ABLE->rtParams.friction_comp;
+	float friction_torque, coriolis_torque;
+
+	for (int i(0); i < NB_MOTORS - 2; i++)
+	{
+		compensation_torques[i] = 0.0f;
+	}
+
+	// Third axis
+	friction_torque = (fmds4->adhfric + fmds3->visc_frics[0] * speed3) * friction_comp;
+	compensation_torques[NB_MOTORS - 2] = friction_torque
+		                                + pos_terms->gravity3 / mValues->able_AxisReductions[NB_MOTORS - 2];
+
+	// Fourth axis
+	friction_torque = (fmds4->adhfric + fmds4->visc_frics[0] * speed4) * friction_comp;
+	coriolis_torque = speed3 * (2 * speed3 + speed4) * pos_terms->coriolis4;
+	compensation_torques[NB_MOTORS - 1] = friction_torque + (pos_terms->gravity4 + coriolis_torque)
+		                                / mValues->able_AxisReductions[NB_MOTORS - 1];
+}
+
+// ---------------------------------------------------- RNEA BACKEND ---------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_BuildLinks - Build the links of the inverse dynamics from the identified dynamics
+|
+| Syntax --
+|	void model_BuildLinks(const ableDynamics* aDyns, rnea_Link* links)
+|
+| Inputs --
+|	const ableDynamics* aDyns -> identified dynamics, x_slider of this iteration
+|	rnea_Link* links -> filled with the NB_MOTORS links
+----------------------------------------------------------------------------------------------------------------------*/
+void model_BuildLinks(const ableDynamics* aDyns, rnea_Link* links)
+{
+	// Extract substructs
+	const able_Axis3_model* ax3_mod = &aDyns->axis3_mod;
+	const able_Axis4_model* ax4_mod = &aDyns->axis4_mod;
+
+	// Initialise variables
+	float xs = ax4_mod->x_slider;
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		rnea_SetGeometry(&links[i], model_DhAlpha[i], 0.0f, model_DhD[i]);
+		rnea_ClearInertia(&links[i]);
+		links[i].rotor_inertia = aDyns->rotor_inertias[i];
+	}
+	links[NB_MOTORS - 1].p[0] = ax3_mod->length3;
+
+	// Third axis
+	links[NB_MOTORS - 2].first_moment[0] = ax3_mod->gm_stat[0];
+	links[NB_MOTORS - 2].first_moment[1] = -ax3_mod->gm_stat[1];
+	links[NB_MOTORS - 2].inertia[2] = ax3_mod->inertias3.inertia_model[0] + ax3_mod->inertias3.inertia_model[1] * xs
+		                            + ax3_mod->inertias3.inertia_model[2] * xs * xs;
+
+	// Fourth axis
+	links[NB_MOTORS - 1].mass = ax4_mod->mass4;
+	links[NB_MOTORS - 1].first_moment[0] = -ax4_mod->cm_stat[2];
+	links[NB_MOTORS - 1].first_moment[1] = ax4_mod->cm_stat[0] * xs + ax4_mod->cm_stat[1];
+	links[NB_MOTORS - 1].inertia[2] = ax4_mod->inertias4.inertia_model[0] + ax4_mod->inertias4.inertia_model[1] * xs
+		                            + ax4_mod->inertias4.inertia_model[2] * xs * xs;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_EstimateAccelerations - Estimate the articular accelerations by filtered differentiation of the speeds
+|
+| Syntax --
+|	void model_EstimateAccelerations(AbleControlStruct* ctrl_ABLE, const float* speeds, float* accelerations)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct (cycle_dt, previous speeds and accelerations)
+|	const float* speeds -> articular speeds of this iteration (rad/s)
+|	float* accelerations -> filled with the filtered accelerations (rad/s^2)
+----------------------------------------------------------------------------------------------------------------------*/
+void model_EstimateAccelerations(AbleControlStruct* ctrl_ABLE, const float* speeds, float* accelerations)
+{
+	// Extract substructs
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+
+	// Initialise variables
+	float dt = rtValues->cycle_dt;
+	float gain = dt / (dt + 1.0f / (2 * (float)M_PI * MODEL_ACC_CUTOFF));
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		if (rtValues->acc_initialised && dt > 0.0f)
+		{
+			rtValues->artAcceleration[i] += gain * ((speeds[i] - rtValues->previousArtSpeed[i]) / dt
+				                                    - rtValues->artAcceleration[i]);
+		}
+		else {
+			rtValues->artAcceleration[i] = 0.0f;
+		}
+		rtValues->previousArtSpeed[i] = speeds[i];
+		accelerations[i] = rtValues->artAcceleration[i];
+	}
+	rtValues->acc_initialised = 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_ComputeCompensationRnea - Compute the dynamic model compensation of every axis with the inverse dynamics
+|
+| Syntax --
+|	void model_ComputeCompensationRnea(AbleControlStruct* ctrl_ABLE, float* compensation_torques)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, data of every axis extracted for this iteration
+|	float* compensation_torques -> filled with the compensation of each of the NB_MOTORS axes
+----------------------------------------------------------------------------------------------------------------------*/
+void model_ComputeCompensationRnea(AbleControlStruct* ctrl_ABLE, float* compensation_torques)
+{
+	// Extract substructs
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+	const RobotState* state = &ctrl_ABLE->state;
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+	frictions* fmds3 = &ctrl_ABLE->aDynamics.axis3_mod.frictions3;
+	frictions* fmds4 = &ctrl_ABLE->aDynamics.axis4_mod.frictions4;
+
+	// Initialise variables
+	rnea_Link links[NB_MOTORS];
+	float cos_q[NB_MOTORS], sin_q[NB_MOTORS], speeds[NB_MOTORS], accelerations[NB_MOTORS], torques[NB_MOTORS];
+	float friction_comp = (float)rtValues->friction_comp;
+
+	// State of the chain
+	model_BuildLinks(&ctrl_ABLE->aDynamics, links);
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		model_FastSinCos(state->position[i], &sin_q[i], &cos_q[i]);
+		speeds[i] = state->speed[i] * 2 * (float)M_PI / mValues->able_AxisReductions[i];
+	}
+	model_EstimateAccelerations(ctrl_ABLE, speeds, accelerations);
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		accelerations[i] *= MODEL_INERTIA_RATIO;
+	}
+
+	// Articular torques, motor side with the frictions of axes 3 and 4
+	rnea_InverseDynamics<NB_MOTORS>(links, cos_q, sin_q, speeds, accelerations, model_BaseAcc, torques);
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		compensation_torques[i] = torques[i] / mValues->able_AxisReductions[i];
+	}
+	compensation_torques[NB_MOTORS - 2] += (fmds4->adhfric + fmds3->visc_frics[0] * speeds[NB_MOTORS - 2]) * friction_comp;
+	compensation_torques[NB_MOTORS - 1] += (fmds4->adhfric + fmds4->visc_frics[0] * speeds[NB_MOTORS - 1]) * friction_comp;
+}
+
+// ---------------------------------------------------- MAP BACKEND ----------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_ComputeCompensationMap - Compute the dynamic model compensation of every axis with the compensation map
+|
+| Syntax --
+|	void model_ComputeCompensationMap(AbleControlStruct* ctrl_ABLE, float* compensation_torques)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, data of every axis extracted and compensation map built
+|	float* compensation_torques -> filled with the compensation of each of the NB_MOTORS axes (0 if not modelled)
+----------------------------------------------------------------------------------------------------------------------*/
+void model_ComputeCompensationMap(AbleControlStruct* ctrl_ABLE, float* compensation_torques)
+{
+	// Extract substructs
+	const RobotState* state = &ctrl_ABLE->state;
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+
+	// Initialise variables
+	map_Node pos_terms;
+	float speed3, speed4;
+
+	speed3 = state->speed[NB_MOTORS - 2] * 2 * (float)M_PI / mValues->able_AxisReductions[NB_MOTORS - 2];
+	speed4 = state->speed[NB_MOTORS - 1] * 2 * (float)M_PI / mValues->able_AxisReductions[NB_MOTORS - 1];
+	map_Lookup(&ctrl_ABLE->compMap, state->position[NB_MOTORS - 2], state->position[NB_MOTORS - 1],
+		       ctrl_ABLE->aDynamics.axis4_mod.x_slider, &pos_terms);
+
+	model_AssembleCompensation(ctrl_ABLE, speed3, speed4, &pos_terms, compensation_torques);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_ComputeNode - Compute the position dependent terms of the model at a point, in double precision
+|
+| Syntax --
+|	void model_ComputeNode(const ableDynamics* aDyns, double theta3, double theta4, double x_slider, map_Node* node)
+|
+| Inputs --
+|	const ableDynamics* aDyns -> identified dynamics
+|	double theta3, theta4 -> articular positions of axes 3 and 4 (rad)
+|	double x_slider -> position of the slider (m)
+|	map_Node* node -> filled with the terms
+----------------------------------------------------------------------------------------------------------------------*/
+void model_ComputeNode(const ableDynamics* aDyns, double theta3, double theta4, double x_slider, map_Node* node)
+{
+	// Extract substructs
+	const able_Axis3_model* ax3_mod = &aDyns->axis3_mod;
+	const able_Axis4_model* ax4_mod = &aDyns->axis4_mod;
+
+	node->gravity3 = (float)(G_VAL * (ax3_mod->gm_stat[0] * sin(theta3) - ax3_mod->gm_stat[1] * cos(theta3))
+		                     + G_VAL * ax4_mod->mass4 * ax3_mod->length3 * sin(theta3));
+	node->gravity4 = (float)(G_VAL * ((ax4_mod->cm_stat[0] * x_slider + ax4_mod->cm_stat[1]) * cos(theta3 + theta4)
+		                              - ax4_mod->cm_stat[2] * sin(theta3 + theta4)));
+	node->coriolis4 = (float)(ax3_mod->length3 * ((ax4_mod->cm_bot[0] * x_slider + ax4_mod->cm_bot[1]) * sin(theta4)
+		                                          + ax4_mod->cm_bot[2] * cos(theta4)));
+	node->unused = 0.0f;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_BuildMap - Build the compensation map over the motion ranges of axes 3 and 4 and the course of the slider
+|
+| Syntax --
+|	int model_BuildMap(AbleControlStruct* ctrl_ABLE, map_compensation* map, int nb_theta, int nb_slider)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, motion ranges and dynamics loaded
+|	map_compensation* map -> map to build
+|	int nb_theta -> number of nodes along theta3 and theta4
+|	int nb_slider -> number of nodes along x_slider
+|
+| Outputs --
+|	int -> 0 : Success ; -1 : invalid grid
+----------------------------------------------------------------------------------------------------------------------*/
+int model_BuildMap(AbleControlStruct* ctrl_ABLE, map_compensation* map, int nb_theta, int nb_slider)
+{
+	// Extract substructs
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+
+	// Initialise variables
+	int nb_nodes[MAP_NB_DIMS] = { nb_theta, nb_theta, nb_slider };
+	float min_value[MAP_NB_DIMS] = { mValues->able_ArtMotionsRanges[0][NB_MOTORS - 2] - MAP_THETA_MARGIN,
+		                             mValues->able_ArtMotionsRanges[0][NB_MOTORS - 1] - MAP_THETA_MARGIN, MAP_SLIDER_MIN };
+	float max_value[MAP_NB_DIMS] = { mValues->able_ArtMotionsRanges[1][NB_MOTORS - 2] + MAP_THETA_MARGIN,
+		                             mValues->able_ArtMotionsRanges[1][NB_MOTORS - 1] + MAP_THETA_MARGIN, MAP_SLIDER_MAX };
+
+	if (map_Allocate(map, nb_nodes, min_value, max_value) != 0)
+	{
+		return -1;
+	}
+	for (int i_s(0); i_s < nb_slider; i_s++)
+	{
+		for (int i_4(0); i_4 < nb_theta; i_4++)
+		{
+			for (int i_3(0); i_3 < nb_theta; i_3++)
+			{
+				model_ComputeNode(&ctrl_ABLE->aDynamics, map_Coordinate(map, MAP_DIM_THETA3, i_3),
+					              map_Coordinate(map, MAP_DIM_THETA4, i_4), map_Coordinate(map, MAP_DIM_SLIDER, i_s),
+					              map_NodeAt(map, i_3, i_4, i_s));
+			}
+		}
+	}
+	map->ready = 1;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| model_InitBackend - Select the backend of the model evaluation and build the compensation map if needed
+|
+| Syntax --
+|	int model_InitBackend(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, int backend)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	AbleControlStruct* ctrl_ABLE -> control struct, motion ranges and dynamics loaded
+|	int backend -> MODEL_BACKEND_ANALYTIC, MODEL_BACKEND_MAP or MODEL_BACKEND_RNEA
+|
+| Outputs --
+|	int -> 0 : requested backend selected ; -1 : map not built, analytic backend selected
+----------------------------------------------------------------------------------------------------------------------*/
+int model_InitBackend(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, int backend)
+{
+	// Initialise variables
+	long long start_tick;
+
+	ctrl_ABLE->rtParams.model_backend = MODEL_BACKEND_ANALYTIC;
+	ctrl_ABLE->rtParams.acc_initialised = 0;
+	if (backend == MODEL_BACKEND_RNEA)
+	{
+		ctrl_ABLE->rtParams.model_backend = MODEL_BACKEND_RNEA;
+		fprintf(out_file, "Dynamic model evaluated by Newton-Euler inverse dynamics (inertia ratio %.2f)\n",
+			    MODEL_INERTIA_RATIO);
+		return 0;
+	}
+	if (backend != MODEL_BACKEND_MAP)
+	{
+		fprintf(out_file, "Dynamic model evaluated analytically\n");
+		return 0;
+	}
+
+	// Build the map from the loaded dynamics
+	start_tick = timebase_Now();
+	if (model_BuildMap(ctrl_ABLE, &ctrl_ABLE->compMap, MAP_NB_THETA, MAP_NB_SLIDER) != 0)
+	{
+		fprintf(err_file, "Compensation map could not be built, analytic model used\n");
+		return -1;
+	}
+	ctrl_ABLE->rtParams.model_backend = MODEL_BACKEND_MAP;
+	fprintf(out_file, "Dynamic model read in a %i x %i x %i compensation map (%zu kB) built in %.1f ms\n",
+		    MAP_NB_THETA, MAP_NB_THETA, MAP_NB_SLIDER, ctrl_ABLE->compMap.nodes.size() * sizeof(map_Node) / 1024,
+		    timebase_Seconds(timebase_Now() - start_tick) * 1e3);
+	return 0;
+}
@@ -0,0 +1,73 @@
+/***********************************************************************************************************************
+* able_DynamicModel.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the declaration of the evaluation of the dynamic model of ABLE once per iteration, for every axis.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef ABLE_DYNAMICMODEL_H
+#define ABLE_DYNAMICMODEL_H
+
+// General includes
+#include <stdio.h>
+// Project includes
+#include "control_struct.h"
+#include "compensation_map.h"
+#include "rnea_dynamics.h"
+#include "time_base.h"
+
+// Accuracy of model_FastSinCos : absolute error on sin and cos for |x| < MODEL_SINCOS_RANGE
+#define MODEL_SINCOS_MAX_ERROR 2e-7f
+#define MODEL_SINCOS_RANGE 100.0f
+
+// Backends of the model evaluation
+#define MODEL_BACKEND_ANALYTIC 0						// Analytic model, fused sin/cos
+#define MODEL_BACKEND_MAP 1								// Tabulated compensation map
+#define MODEL_BACKEND_RNEA 2							// Newton-Euler inverse dynamics of the four axes, with inertia
+#define DEFAULT_MODEL_BACKEND MODEL_BACKEND_ANALYTIC	// Backend used when the session does not set it (argv[28])
+
+// Grid of the compensation map
+#define MAP_NB_THETA 64									// Number of nodes along theta3 and theta4
+#define MAP_NB_SLIDER 4									// Number of nodes along x_slider
+#define MAP_THETA_MARGIN 0.1f							// Margin around the articular motion ranges (rad)
+#define MAP_SLIDER_MIN -0.40f							// Lowest slider position covered (m)
+#define MAP_SLIDER_MAX 0.05f							// Highest slider position covered (m)
+
+// Inverse dynamics (MODEL_BACKEND_RNEA)
+#define MODEL_ACC_CUTOFF 15.0f							// Cutoff frequency of the acceleration estimation (Hz)
+#define MODEL_INERTIA_RATIO 1.0f						// Part of the inertial torques compensated
+
+// ------------------------------------------------- MODEL TERMS STRUCT ------------------------------------------------
+// Trigonometric and kinematic terms shared by the compensations of both axes
+struct model_Terms
+{
+	float theta3, theta4;					// Articular positions of axes 3 and 4 (rad)
+	float speed3, speed4;					// Articular speeds of axes 3 and 4 (rad/s)
+	float sin3, cos3;						// sin and cos of theta3
+	float sin4, cos4;						// sin and cos of theta4
+	float sin34, cos34;						// sin and cos of theta3 + theta4
+};
+
+// Functions declaration
+void model_FastSinCos(float x, float* s, float* c);
+void model_ComputeTerms(AbleControlStruct* ctrl_ABLE, model_Terms* terms);
+void model_ComputeCompensation(AbleControlStruct* ctrl_ABLE, float* compensation_torques);
+void model_ComputeCompensationMap(AbleControlStruct* ctrl_ABLE, float* compensation_torques);
+void model_AssembleCompensation(AbleControlStruct* ctrl_ABLE, float speed3, float speed4, const map_Node* pos_terms,
+	                            float* compensation_torques);
+
+// Inverse dynamics
+void model_BuildLinks(const ableDynamics* aDyns, rnea_Link* links);
+void model_EstimateAccelerations(AbleControlStruct* ctrl_ABLE, const float* speeds, float* accelerations);
+void model_ComputeCompensationRnea(AbleControlStruct* ctrl_ABLE, float* compensation_torques);
+
+// Compensation map
+void model_ComputeNode(const ableDynamics* aDyns, double theta3, double theta4, double x_slider, map_Node* node);
+int model_BuildMap(AbleControlStruct* ctrl_ABLE, map_compensation* map, int nb_theta, int nb_slider);
+int model_InitBackend(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, int backend);
+#endif // !ABLE_DYNAMICMODEL_H
\ No newline at end of file
@@ -0,0 +1,190 @@
+/***********************************************************************************************************************
+* able_Kinematics.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Forward kinematics and geometric Jacobian of ABLE at the wrist. The chain is the one of the inverse dynamics
+* (model_BuildLinks, modified Denavit-Hartenberg) and the wrist is on the x axis of the fourth frame, at the slider
+* position. All matrices have a fixed size : an evaluation uses the stack only.
+***********************************************************************************************************************/
+
+#include "able_Kinematics.h"
+
+/*---------------------------------------------------------------------------------------------------------------------
+| kin_ForwardKinematics - Compute the frames of a chain, the tool pose and the geometric Jacobian at the tool
+|
+| Syntax --
+|	void kin_ForwardKinematics(const rnea_Link* links, const float* cos_q, const float* sin_q, const float* tool,
+|	                           kin_State* state)
+|
+| Inputs --
+|	const rnea_Link* links -> NB_MOTORS links (only the geometry is used)
+|	const float* cos_q, sin_q -> cos and sin of the joint angles
+|	const float* tool -> position of the tool in the last frame (m)
+|	kin_State* state -> filled with the tool pose, the joint frames and the Jacobian
+----------------------------------------------------------------------------------------------------------------------*/
+void kin_ForwardKinematics(const rnea_Link* links, const float* cos_q, const float* sin_q, const float* tool,
+	                       kin_State* state)
+{
+	// Initialise variables
+	float rotation[9] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+	float origin[3] = { 0.0f, 0.0f, 0.0f };
+	float next[9], local[9], lever[3];
+	float ca, sa, c, s;
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		// Origin of the frame : o + R p
+		for (int r(0); r < 3; r++)
+		{
+			origin[r] += rotation[3 * r] * links[i].p[0] + rotation[3 * r + 1] * links[i].p[1]
+				       + rotation[3 * r + 2] * links[i].p[2];
+		}
+
+		// Orientation of the frame : R Rx(alpha) Rz(q)
+		ca = links[i].cos_alpha;
+		sa = links[i].sin_alpha;
+		c = cos_q[i];
+		s = sin_q[i];
+		local[0] = c;		local[1] = -s;		local[2] = 0.0f;
+		local[3] = ca * s;	local[4] = ca * c;	local[5] = -sa;
+		local[6] = sa * s;	local[7] = sa * c;	local[8] = ca;
+		for (int r(0); r < 3; r++)
+		{
+			for (int k(0); k < 3; k++)
+			{
+				next[3 * r + k] = rotation[3 * r] * local[k] + rotation[3 * r + 1] * local[3 + k]
+					            + rotation[3 * r + 2] * local[6 + k];
+			}
+		}
+		for (int k(0); k < 9; k++)
+		{
+			rotation[k] = next[k];
+		}
+
+		// Joint axis = z axis of the frame
+		for (int r(0); r < 3; r++)
+		{
+			state->axis_origin[i][r] = origin[r];
+			state->axis_direction[i][r] = rotation[3 * r + 2];
+		}
+	}
+
+	// Tool pose
+	for (int r(0); r < 3; r++)
+	{
+		state->position[r] = origin[r] + rotation[3 * r] * tool[0] + rotation[3 * r + 1] * tool[1]
+			               + rotation[3 * r + 2] * tool[2];
+	}
+	for (int k(0); k < 9; k++)
+	{
+		state->rotation[k] = rotation[k];
+	}
+
+	// Jacobian columns : z x (p - o) and z
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		for (int r(0); r < 3; r++)
+		{
+			lever[r] = state->position[r] - state->axis_origin[i][r];
+		}
+		rnea_Cross(state->axis_direction[i], lever, next);
+		for (int r(0); r < 3; r++)
+		{
+			state->jacobian[r][i] = next[r];
+			state->jacobian[3 + r][i] = state->axis_direction[i][r];
+		}
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| kin_ComputeState - Compute the wrist pose and Jacobian of ABLE for the current iteration
+|
+| Syntax --
+|	void kin_ComputeState(AbleControlStruct* ctrl_ABLE, kin_State* state)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, data of every axis extracted for this iteration
+|	kin_State* state -> filled with the wrist pose and the Jacobian
+----------------------------------------------------------------------------------------------------------------------*/
+void kin_ComputeState(AbleControlStruct* ctrl_ABLE, kin_State* state)
+{
+	// Initialise variables
+	rnea_Link links[NB_MOTORS];
+	float cos_q[NB_MOTORS], sin_q[NB_MOTORS];
+	float tool[3] = { KIN_WRIST_OFFSET - ctrl_ABLE->aDynamics.axis4_mod.x_slider, 0.0f, 0.0f };
+
+	model_BuildLinks(&ctrl_ABLE->aDynamics, links);
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		model_FastSinCos(ctrl_ABLE->state.position[i], &sin_q[i], &cos_q[i]);
+	}
+	kin_ForwardKinematics(links, cos_q, sin_q, tool, state);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| kin_JacobianTranspose - Map a wrench applied at the wrist into joint torques
+|
+| Syntax --
+|	void kin_JacobianTranspose(const kin_State* state, const float* wrench, float* torques)
+|
+| Inputs --
+|	const kin_State* state -> wrist Jacobian
+|	const float* wrench -> force (0-2) and moment (3-5) in the base frame
+|	float* torques -> filled with the NB_MOTORS joint torques
+----------------------------------------------------------------------------------------------------------------------*/
+void kin_JacobianTranspose(const kin_State* state, const float* wrench, float* torques)
+{
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		torques[i] = 0.0f;
+		for (int r(0); r < 6; r++)
+		{
+			torques[i] += state->jacobian[r][i] * wrench[r];
+		}
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| kin_JacobianProduct - Compute the wrist twist from the joint speeds
+|
+| Syntax --
+|	void kin_JacobianProduct(const kin_State* state, const float* speeds, float* twist)
+|
+| Inputs --
+|	const kin_State* state -> wrist Jacobian
+|	const float* speeds -> NB_MOTORS joint speeds (rad/s)
+|	float* twist -> filled with the linear (0-2) and angular (3-5) speeds in the base frame
+----------------------------------------------------------------------------------------------------------------------*/
+void kin_JacobianProduct(const kin_State* state, const float* speeds, float* twist)
+{
+	for (int r(0); r < 6; r++)
+	{
+		twist[r] = 0.0f;
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			twist[r] += state->jacobian[r][i] * speeds[i];
+		}
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| kin_RotateToBase - Express a vector of the wrist frame in the base frame
+|
+| Syntax --
+|	void kin_RotateToBase(const kin_State* state, const float* v, float* r)
+|
+| Inputs --
+|	const kin_State* state -> wrist orientation
+|	const float* v -> vector in the wrist frame
+|	float* r -> filled with the vector in the base frame
+----------------------------------------------------------------------------------------------------------------------*/
+void kin_RotateToBase(const kin_State* state, const float* v, float* r)
+{
+	for (int k(0); k < 3; k++)
+	{
+		r[k] = state->rotation[3 * k] * v[0] + state->rotation[3 * k + 1] * v[1] + state->rotation[3 * k + 2] * v[2];
+	}
+}
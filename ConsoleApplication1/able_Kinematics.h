@@ -0,0 +1,42 @@
+/***********************************************************************************************************************
+* able_Kinematics.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the declaration of the forward kinematics and geometric Jacobian of ABLE at the wrist.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef ABLE_KINEMATICS_H
+#define ABLE_KINEMATICS_H
+
+// Project includes
+#include "control_struct.h"
+#include "able_DynamicModel.h"
+#include "rnea_dynamics.h"
+
+// Position of the wrist (FT sensor origin) along the forearm, in addition to the slider position (m)
+#define KIN_WRIST_OFFSET 0.0f
+
+// ------------------------------------------------- KINEMATICS STRUCT -------------------------------------------------
+// Wrist pose and Jacobian, in the base frame (fixed-size, filled every iteration)
+struct kin_State
+{
+	float position[3];						// Position of the wrist (m)
+	float rotation[9];						// Orientation of the wrist frame (row-major, columns = wrist axes)
+	float axis_origin[NB_MOTORS][3];		// Origin of each joint frame (m)
+	float axis_direction[NB_MOTORS][3];		// Direction of each joint axis
+	float jacobian[6][NB_MOTORS];			// Geometric Jacobian : linear speed (rows 0-2), angular speed (rows 3-5)
+};
+
+// Functions declaration
+void kin_ForwardKinematics(const rnea_Link* links, const float* cos_q, const float* sin_q, const float* tool,
+	                       kin_State* state);
+void kin_ComputeState(AbleControlStruct* ctrl_ABLE, kin_State* state);
+void kin_JacobianTranspose(const kin_State* state, const float* wrench, float* torques);
+void kin_JacobianProduct(const kin_State* state, const float* speeds, float* twist);
+void kin_RotateToBase(const kin_State* state, const float* v, float* r);
+#endif // !ABLE_KINEMATICS_H
\ No newline at end of file
@@ -55,12 +55,10 @@ void able_UpdateOrderIdent(ThreadInformations* ableInfos)
 	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
-
-	// Initialise variables
-	static bool first_call = TRUE;
+	orders_ctrlState* ctrlState = &ableInfos->ctrl_ABLE->ctrlStates.orders;
 
 	for (int i(0); i < NB_MOTORS; i++) {
-		if (rtValues->order_counter == 1 && first_call == TRUE)
+		if (rtValues->order_counter == 1 && !ctrlState->ident_started)
 		{
 			fprintf(ableInfos->out_file, "Home position reached ! Starting identification... \n");
 
@@ -71,11 +69,11 @@ void able_UpdateOrderIdent(ThreadInformations* ableInfos)
 				// Set proportionnal gain of speed control loop if dynamica identification
 				if (oValues->ctrl_type == DYN_IDENT)
 				{
-					rtValues->iter_id_start = rtValues->iter_counter;
+					rtValues->time_id_start = rtValues->elapsed_time;
 					mValues->Kp_V_r[i] = 1 / mValues->Kp_V[i];
 				}
 			}
-			first_call = FALSE;
+			ctrlState->ident_started = 1;
 		}
 		if (mValues->inhibition_State[i] == 0)
 		{
@@ -101,18 +99,13 @@ void able_UpdateOrderMinJerk(ThreadInformations* ableInfos)
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
 	minjerk_trajs* minJerk = &ableInfos->ctrl_ABLE->minJerk;
 
+	// Initialise variables
+	const minjerk_move* move = minjerk_BlockMove(minJerk, rtValues->current_minJerkMove);
+
 	// Compute current startpoint and endpoint of the minimum jerk trajectory
-	if (!rtValues->jerkFamiliarisation && !rtValues->jerkTrajs_AllEnded) {
-		// Normal block
-		rtValues->current_startMinJerk = minJerk->all_Jmoves[rtValues->current_minJerkMove].at(0);
-		rtValues->current_endMinJerk = minJerk->all_Jmoves[rtValues->current_minJerkMove]
-			.at(minJerk->all_Jmoves[rtValues->current_minJerkMove].size() - 1);
-	}
-	else if (rtValues->jerkFamiliarisation && !rtValues->jerkTrajs_AllEnded) {
-		// Familiarisation block
-		rtValues->current_startMinJerk = minJerk->all_JmovesFam[rtValues->current_minJerkMove].at(0);
-		rtValues->current_endMinJerk = minJerk->all_JmovesFam[rtValues->current_minJerkMove]
-			.at(minJerk->all_JmovesFam[rtValues->current_minJerkMove].size() - 1);
+	if (!rtValues->jerkTrajs_AllEnded) {
+		rtValues->current_startMinJerk = move->start;
+		rtValues->current_endMinJerk = move->end;
 	}
 
 	// If goStart phase, go to current_startMinJerk, else, if min jerk move started, follow trajectory
@@ -120,13 +113,9 @@ void able_UpdateOrderMinJerk(ThreadInformations* ableInfos)
 	{
 		oValues->positionOrder[3] = rtValues->current_startMinJerk;
 	}
-	else if (rtValues->jerkMove_started && !rtValues->jerkFamiliarisation && !rtValues->jerkTrajs_AllEnded)
-	{
-		oValues->positionOrder[3] = minJerk->all_Jmoves[rtValues->current_minJerkMove].at(rtValues->current_posMinJerk);
-	}
-	else if (rtValues->jerkMove_started && rtValues->jerkFamiliarisation && !rtValues->jerkTrajs_AllEnded)
+	else if (rtValues->jerkMove_started && !rtValues->jerkTrajs_AllEnded)
 	{
-		oValues->positionOrder[3] = minJerk->all_JmovesFam[rtValues->current_minJerkMove].at(rtValues->current_posMinJerk);
+		oValues->positionOrder[3] = minjerk_Position(move, rtValues->current_timeMinJerk);
 	}
 	else if (rtValues->jerkTrajs_AllEnded && rtValues->jerkBlockWithFatigueTest)
 	{
@@ -159,7 +148,7 @@ void able_SelectAdaptedControl(ThreadInformations* ableInfos)
 	minjerk_trajs* minJerk = &ableInfos->ctrl_ABLE->minJerk;
 
 	// Initialise variables
-	int iter_order;
+	float time_order;
 
 	// Initialisation and static identifications
 	if (oValues->ctrl_type == STATIC_IDENT || oValues->ctrl_type == HDYN_IDENT ||
@@ -171,8 +160,8 @@ void able_SelectAdaptedControl(ThreadInformations* ableInfos)
 	else if (oValues->ctrl_type == DYN_IDENT)
 	{
 		// Speed control identifications
-		iter_order = rtValues->iter_counter - rtValues->iter_id_start;
-		able_DynIdentAsserv(ableInfos, iter_order);
+		time_order = (float)(rtValues->elapsed_time - rtValues->time_id_start);
+		able_DynIdentAsserv(ableInfos, time_order);
 	}
 	else if (oValues->ctrl_type == TORQUE_CTRL || oValues->ctrl_type == MINJERK_TRAJS &&
 		rtValues->jerkTrajs_AllEnded && rtValues->jerkHomePosAfterTrajs && rtValues->jerkBlockWithFatigueTest)
@@ -185,6 +174,16 @@ void able_SelectAdaptedControl(ThreadInformations* ableInfos)
 		// Adaptative oscillators control (Hopf, ...)
 		able_Hopf_PositionAsserv(ableInfos);
 	}
+	else if (oValues->ctrl_type == CARTESIAN_CTRL)
+	{
+		// Cartesian impedance control around the wrist pose
+		able_CartesianAsserv(ableInfos);
+	}
+	else if (oValues->ctrl_type == HAPTIC_CTRL)
+	{
+		// Transparent control rendering the haptic virtual scene at the wrist
+		able_HapticAsserv(ableInfos);
+	}
 }
 
 // ------------------------------------------------- CHECK ORDERS FUNCTIONS --------------------------------------------
@@ -206,13 +205,14 @@ bool able_CheckOrderState(ThreadInformations* ableInfos)
 	bool order_end = true;
 	
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
 
 	if (ableInfos->ctrl_ABLE->aOrders.ctrl_type != MINJERK_TRAJS)
 	{
 		// Check displacements of each axis
 		for (int i(0); i < NB_MOTORS; i++)
 		{
-			pos_evolution = abs(rtValues->currentPosition[i] - rtValues->oldPosition[i]);
+			pos_evolution = abs(state->position[i] - rtValues->oldPosition[i]);
 			// End of order limit definition
 			if (pos_evolution > 0.005)
 			{
@@ -243,15 +243,16 @@ void able_CheckOrderMinJerk(ThreadInformations* ableInfos)
 {
 	// Extract substructs
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
 	minjerk_trajs* minJerk = &ableInfos->ctrl_ABLE->minJerk;
+	orders_ctrlState* ctrlState = &ableInfos->ctrl_ABLE->ctrlStates.orders;
 
 	// Initialise variables
 	float dist_to_start, dist_to_end;
-	static int counter_delayForce = 0;
 
 	// Compute distance to move start and move end
-	dist_to_start = abs(rtValues->currentPosition[NB_MOTORS - 1] - rtValues->current_startMinJerk);
-	dist_to_end = abs(rtValues->currentPosition[NB_MOTORS - 1] - rtValues->current_endMinJerk);
+	dist_to_start = abs(state->position[NB_MOTORS - 1] - rtValues->current_startMinJerk);
+	dist_to_end = abs(state->position[NB_MOTORS - 1] - rtValues->current_endMinJerk);
 
 	// Check state of movement
 	if (!rtValues->jerkMove_started && dist_to_start < 0.01)
@@ -264,37 +265,30 @@ void able_CheckOrderMinJerk(ThreadInformations* ableInfos)
 		// Movement is near the end, re-initialise all parameters
 		rtValues->jerkMove_started = FALSE;
 		rtValues->jerkMove_startReached = FALSE;
-		rtValues->timer_jerk_end_move = 0;
-		rtValues->current_posMinJerk = 0;
+		rtValues->timer_jerk_end_move = 0.0f;
+		rtValues->current_timeMinJerk = 0.0f;
 		rtValues->current_minJerkMove++;
 	}
-	else if (rtValues->jerkMove_started && !rtValues->jerkFamiliarisation &&
-		rtValues->current_posMinJerk < (int)(minJerk->all_Jmoves[rtValues->current_minJerkMove].size()) - 1)
-	{
-		// Update order during movement
-		rtValues->current_posMinJerk++;
-	}
-	else if (rtValues->jerkMove_started && rtValues->jerkFamiliarisation &&
-		rtValues->current_posMinJerk < (int)(minJerk->all_JmovesFam[rtValues->current_minJerkMove].size()) - 1)
+	else if (rtValues->jerkMove_started &&
+		rtValues->current_timeMinJerk < minjerk_BlockMove(minJerk, rtValues->current_minJerkMove)->duration)
 	{
-		// Update order during familiarisation block movement
-		rtValues->current_posMinJerk++;
+		// Update order during movement, time measured from the actual period
+		rtValues->current_timeMinJerk += rtValues->cycle_dt;
 	}
-	else if (!rtValues->jerkBlockWithFatigueTest && (rtValues->current_minJerkMove >= NB_REP * NB_JERK_TRAJS ||
-			 rtValues->current_minJerkMove >= NB_REP_FAM * NB_JERK_TRAJS && rtValues->jerkFamiliarisation))
+	else if (!rtValues->jerkBlockWithFatigueTest && minjerk_BlockEnded(minJerk, rtValues->current_minJerkMove))
 	{
 		// Delay robot stop
-		counter_delayForce++;
-		if (counter_delayForce >= DELAYROBSTOP)
+		ctrlState->counter_delayForce += rtValues->cycle_dt;
+		if (ctrlState->counter_delayForce >= DELAYROBSTOP)
 		{
 			rtValues->robot_stopAfterTrajs = TRUE;
 		}
 	}
-	else if (rtValues->jerkBlockWithFatigueTest && rtValues->jerkTrajs_AllEnded && abs(rtValues->currentPosition[3]) < 0.05)
+	else if (rtValues->jerkBlockWithFatigueTest && rtValues->jerkTrajs_AllEnded && abs(state->position[3]) < 0.05)
 	{
 		// If fatigue block wanted, delay its beginning by 2 seconds once home position is reached
-		counter_delayForce++;
-		if (counter_delayForce >= DELAYFORCEFATIGUE)
+		ctrlState->counter_delayForce += rtValues->cycle_dt;
+		if (ctrlState->counter_delayForce >= DELAYFORCEFATIGUE)
 		{
 			rtValues->jerkHomePosAfterTrajs = TRUE;
 		}
@@ -318,13 +312,16 @@ int switch_OrderReached(ThreadInformations* ableInfos)
 	bool order_done;
 	// Extract substructs
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
 	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 
 	//fprintf(ableInfos->out_file, "SWITCH OR\n");
 
 	if (rtValues->iter_counter % rtValues->able_CheckTargetReachedNbIt == 0 &&
-		(oValues->ctrl_type != TORQUE_CTRL || rtValues->order_counter == 0) || oValues->ctrl_type == MINJERK_TRAJS)
+		(oValues->ctrl_type != TORQUE_CTRL && oValues->ctrl_type != CARTESIAN_CTRL && oValues->ctrl_type != HAPTIC_CTRL ||
+		rtValues->order_counter == 0) ||
+		oValues->ctrl_type == MINJERK_TRAJS)
 	{
 		// Check if target position has been reached
 		order_done = able_CheckOrderState(ableInfos);
@@ -354,14 +351,13 @@ int switch_OrderReached(ThreadInformations* ableInfos)
 		}
 		else if (oValues->ctrl_type == MINJERK_TRAJS)
 		{
-			if (rtValues->robot_stopAfterTrajs && (rtValues->current_minJerkMove >= NB_REP * NB_JERK_TRAJS && !rtValues->jerkBlockWithFatigueTest ||
-				rtValues->current_minJerkMove >= NB_REP_FAM * NB_JERK_TRAJS && rtValues->jerkFamiliarisation && !rtValues->jerkBlockWithFatigueTest))
+			if (rtValues->robot_stopAfterTrajs && !rtValues->jerkBlockWithFatigueTest &&
+				minjerk_BlockEnded(&ableInfos->ctrl_ABLE->minJerk, rtValues->current_minJerkMove))
 			{
 				rtValues->order_counter = 255;
 				return 0;
 			}
-			else if ((rtValues->current_minJerkMove >= NB_REP * NB_JERK_TRAJS ||
-				      rtValues->current_minJerkMove >= NB_REP_FAM * NB_JERK_TRAJS && rtValues->jerkFamiliarisation) &&
+			else if (minjerk_BlockEnded(&ableInfos->ctrl_ABLE->minJerk, rtValues->current_minJerkMove) &&
 				      rtValues->jerkBlockWithFatigueTest)
 			{
 				rtValues->jerkTrajs_AllEnded = TRUE;
@@ -370,7 +366,7 @@ int switch_OrderReached(ThreadInformations* ableInfos)
 		// Store current position for further comparison
 		for (int i(0); i < NB_MOTORS; i++)
 		{
-			rtValues->oldPosition[i] = rtValues->currentPosition[i];
+			rtValues->oldPosition[i] = state->position[i];
 		}
 	}
 	return 1;
@@ -18,6 +18,9 @@
 #include "position_control.h"
 #include "torque_control.h"
 #include "adaptative_oscillators_control.h"
+#include "minjerk_trajectories.h"
+#include "cartesian_control.h"
+#include "controller_state.h"
 
 // Orders update functions
 void able_UpdateOrders(ThreadInformations* ableInfos);
@@ -28,20 +28,17 @@ void able_Hopf_PositionAsserv(ThreadInformations* ableInfos)
     ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
     motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
     hopf_oscillator* hValues = &ableInfos->ctrl_ABLE->hopfParams;
+    const RobotState* state = &ableInfos->ctrl_ABLE->state;
+    hopf_ctrlState* ctrlState = &ableInfos->ctrl_ABLE->ctrlStates.hopf;
 
     // Variables declaration
     float pos_dif;
-    //static float omega_d, phi_d, alpha_d;
-    static float omega = 0.0f;
-    static float phi = 0.0f;
-    static float alpha = 0.0f;
-    static int old_counter;
     
     // Check if order has changed since previous iteration
-    if (old_counter != rtValues->order_counter && oValues->ctrl_type != MINJERK_TRAJS)
+    if (ctrlState->old_counter != rtValues->order_counter && oValues->ctrl_type != MINJERK_TRAJS)
     {
         // Update old counter to the current order
-        old_counter = rtValues->order_counter;
+        ctrlState->old_counter = rtValues->order_counter;
         fprintf(ableInfos->out_file, "Order counter : %d ; Position order : %f\n", rtValues->order_counter,
                 ableInfos->ctrl_ABLE->aOrders.positionOrder[3]);
     }
@@ -50,26 +47,24 @@ void able_Hopf_PositionAsserv(ThreadInformations* ableInfos)
     {
         if (i == NB_MOTORS - 1)
         {
-            // Extract current data
-            able_ExtractData(ableInfos, i);
             // Compute diference in coder position
-            pos_dif = rtValues->currentPosition[i] - oValues->positionOrder[i];
+            pos_dif = state->position[i] - oValues->positionOrder[i];
             // Compute Hopf pulsation
-            hValues->omega_dot = pos_dif * cos(phi) * HOPF_V;
+            hValues->omega_dot = pos_dif * cos(ctrlState->phi) * HOPF_V;
             // integration
-            omega += hValues->omega_dot * rtValues->sampling_frequency;
+            ctrlState->omega += hValues->omega_dot * rtValues->cycle_dt;
             // Compute arg
-            hValues->phi_dot = omega - pos_dif * cos(phi) * HOPF_V;
+            hValues->phi_dot = ctrlState->omega - pos_dif * cos(ctrlState->phi) * HOPF_V;
             // integration
-            phi += hValues->phi_dot * rtValues->sampling_frequency;
+            ctrlState->phi += hValues->phi_dot * rtValues->cycle_dt;
             // Compute module
-            hValues->alpha_dot = pos_dif * sin(phi) * ETA;
+            hValues->alpha_dot = pos_dif * sin(ctrlState->phi) * ETA;
             // integration
-            alpha += hValues->alpha_dot * rtValues->sampling_frequency;
+            ctrlState->alpha += hValues->alpha_dot * rtValues->cycle_dt;
             // Target
-            oValues->speedOrder[i] = (alpha * sin(phi) - oValues->positionOrder[i])
+            oValues->speedOrder[i] = (ctrlState->alpha * sin(ctrlState->phi) - oValues->positionOrder[i])
                                    / rtValues->sampling_frequency;
-            oValues->positionOrder[i] = alpha * sin(phi);
+            oValues->positionOrder[i] = ctrlState->alpha * sin(ctrlState->phi);
         }
         // Regulate interaction force for CoT experimentation
     }
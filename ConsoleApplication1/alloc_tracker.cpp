@@ -0,0 +1,362 @@
+/***********************************************************************************************************************
+* alloc_tracker.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Records the allocations made during the cycles of the control loop : replaced global operators, hook of the debug
+* C runtime heap and regions of the session storage.
+***********************************************************************************************************************/
+
+#include "alloc_tracker.h"
+#include <new>
+#include <stdlib.h>
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+// Tracker of the process, a single thread marks its cycles at a time
+static alloc_Tracker tracker = {};
+
+// Names of the recorded operations
+static const char* alloc_EventNames[ALLOC_NB_EVENT_TYPES] = { "new", "delete", "malloc", "realloc", "free",
+															  "storage region", "storage release" };
+
+// Internal functions
+static BOOL alloc_Tracked();
+static void* alloc_Malloc(int type, size_t size);
+static void alloc_Release(int type, void* block);
+#ifdef _DEBUG
+static int alloc_CrtHook(int alloc_type, void* user_data, size_t size, int block_type, long request,
+						 const unsigned char* file_name, int line);
+#endif
+
+// ---------------------------------------------------- TRACKING FUNCTIONS ---------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| alloc_Enable - Start or stop the recording of the operations made during the marked cycles
+|
+| Syntax --
+|	void alloc_Enable(int enabled)
+|
+| Inputs --
+|	int enabled -> 1 : reset the statistics and record ; 0 : stop recording (statistics kept for the report)
+|
+| Remarks --
+|	The C runtime heap can only be hooked by the debug runtime (_DEBUG) : in release builds, malloc, realloc and free
+|	called directly are not seen, while operator new, the STL containers and the session storage are.
+----------------------------------------------------------------------------------------------------------------------*/
+void alloc_Enable(int enabled)
+{
+	if (enabled)
+	{
+		memset(&tracker, 0, sizeof(alloc_Tracker));
+		tracker.last_faulty_cycle = -1;
+#ifdef _DEBUG
+		_CrtSetAllocHook(alloc_CrtHook);
+#endif
+		tracker.enabled = 1;
+	}else
+	{
+		tracker.enabled = 0;
+		tracker.in_cycle = 0;
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| alloc_BeginCycle - Mark the start of a cycle on the calling thread
+|
+| Syntax --
+|	void alloc_BeginCycle(long long cycle)
+|
+| Inputs --
+|	long long cycle -> index of the cycle, printed with the recorded operations
+----------------------------------------------------------------------------------------------------------------------*/
+void alloc_BeginCycle(long long cycle)
+{
+	if (!tracker.enabled)
+	{
+		return;
+	}
+	tracker.thread_id = GetCurrentThreadId();
+	tracker.cycle = cycle;
+	tracker.in_cycle = 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| alloc_EndCycle - Mark the end of the current cycle
+|
+| Syntax --
+|	void alloc_EndCycle()
+----------------------------------------------------------------------------------------------------------------------*/
+void alloc_EndCycle()
+{
+	if (!tracker.in_cycle)
+	{
+		return;
+	}
+	tracker.in_cycle = 0;
+	tracker.nb_cycles++;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| alloc_Record - Record an operation if the calling thread is inside a marked cycle
+|
+| Syntax --
+|	void alloc_Record(int type, size_t size)
+|
+| Inputs --
+|	int type -> ALLOC_EVENT_*
+|	size_t size -> requested size (bytes), 0 for frees
+|
+| Remarks --
+|	Called from the allocation paths themselves : nothing is allocated here, the stack is captured in place.
+----------------------------------------------------------------------------------------------------------------------*/
+void alloc_Record(int type, size_t size)
+{
+	// Initialise variables
+	alloc_Event* event;
+
+	if (!alloc_Tracked())
+	{
+		return;
+	}
+	tracker.counts[type]++;
+	tracker.bytes += size;
+	if (tracker.cycle != tracker.last_faulty_cycle)
+	{
+		tracker.faulty_cycles++;
+		tracker.last_faulty_cycle = tracker.cycle;
+	}
+	if (tracker.nb_events < ALLOC_MAX_EVENTS)
+	{
+		event = &tracker.events[tracker.nb_events];
+		event->type = type;
+		event->size = size;
+		event->cycle = tracker.cycle;
+		event->nb_frames = CaptureStackBackTrace(1, ALLOC_STACK_DEPTH, event->frames, NULL);
+		tracker.nb_events++;
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| alloc_NbOperations - Number of operations recorded since alloc_Enable
+|
+| Syntax --
+|	long long alloc_NbOperations()
+|
+| Outputs --
+|	long long -> allocations, frees and reallocs made during the marked cycles
+----------------------------------------------------------------------------------------------------------------------*/
+long long alloc_NbOperations()
+{
+	// Initialise variables
+	long long nb_operations = 0;
+
+	for (int i(0); i < ALLOC_NB_EVENT_TYPES; i++)
+	{
+		nb_operations += tracker.counts[i];
+	}
+	return nb_operations;
+}
+
+// ----------------------------------------------------- REPORT FUNCTIONS ----------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| alloc_PrintReport - Print the operations made during the marked cycles, with the symbols of their stack
+|
+| Syntax --
+|	void alloc_PrintReport(FILE* out_file)
+|
+| Inputs --
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|
+| Remarks --
+|	To be called once the tracking is stopped : loading the symbols allocates.
+----------------------------------------------------------------------------------------------------------------------*/
+void alloc_PrintReport(FILE* out_file)
+{
+	// Initialise variables
+	char buffer[sizeof(SYMBOL_INFO) + ALLOC_SYMBOL_LENGTH];
+	SYMBOL_INFO* symbol = (SYMBOL_INFO*)buffer;
+	IMAGEHLP_LINE64 line;
+	HANDLE process = GetCurrentProcess();
+	DWORD64 offset;
+	DWORD displacement;
+	BOOL symbols;
+	const alloc_Event* event;
+
+	fprintf(out_file, "Allocations in the control loop : %lld operations in %lld of %lld cycles (%lld bytes)\n",
+		    alloc_NbOperations(), tracker.faulty_cycles, tracker.nb_cycles, tracker.bytes);
+	if (tracker.nb_events == 0)
+	{
+		return;
+	}
+	for (int i(0); i < ALLOC_NB_EVENT_TYPES; i++)
+	{
+		if (tracker.counts[i] > 0)
+		{
+			fprintf(out_file, "   %s : %lld\n", alloc_EventNames[i], tracker.counts[i]);
+		}
+	}
+
+	// Print the kept operations with their stack
+	SymSetOptions(SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES | SYMOPT_UNDNAME);
+	symbols = SymInitialize(process, NULL, TRUE);
+	for (int i(0); i < tracker.nb_events; i++)
+	{
+		event = &tracker.events[i];
+		fprintf(out_file, "Cycle %lld : %s of %zu bytes\n", event->cycle, alloc_EventNames[event->type], event->size);
+		for (int j(0); j < event->nb_frames; j++)
+		{
+			symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+			symbol->MaxNameLen = ALLOC_SYMBOL_LENGTH;
+			line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
+			if (!symbols || !SymFromAddr(process, (DWORD64)event->frames[j], &offset, symbol))
+			{
+				fprintf(out_file, "      %p\n", event->frames[j]);
+			}else if (SymGetLineFromAddr64(process, (DWORD64)event->frames[j], &displacement, &line))
+			{
+				fprintf(out_file, "      %s (%s:%lu)\n", symbol->Name, line.FileName, line.LineNumber);
+			}else
+			{
+				fprintf(out_file, "      %s + 0x%llx\n", symbol->Name, offset);
+			}
+		}
+	}
+	if (symbols)
+	{
+		SymCleanup(process);
+	}
+	fflush(out_file);
+}
+
+// --------------------------------------------------- INTERNAL FUNCTIONS ----------------------------------------------
+
+// True if the calling thread is inside a marked cycle
+static BOOL alloc_Tracked()
+{
+	return tracker.enabled && tracker.in_cycle && GetCurrentThreadId() == tracker.thread_id;
+}
+
+// Allocation of the replaced operators, the runtime allocation below is not recorded a second time by the hook
+static void* alloc_Malloc(int type, size_t size)
+{
+	// Initialise variables
+	void* block;
+
+	if (size == 0)
+	{
+		size = 1;
+	}
+	if (!alloc_Tracked())
+	{
+		return malloc(size);
+	}
+	alloc_Record(type, size);
+	tracker.nested++;
+	block = malloc(size);
+	tracker.nested--;
+	return block;
+}
+
+// Release of the replaced operators
+static void alloc_Release(int type, void* block)
+{
+	if (block == NULL || !alloc_Tracked())
+	{
+		free(block);
+		return;
+	}
+	alloc_Record(type, 0);
+	tracker.nested++;
+	free(block);
+	tracker.nested--;
+}
+
+#ifdef _DEBUG
+// Hook of the debug runtime heap, CRT blocks included (stdio buffers)
+static int alloc_CrtHook(int alloc_type, void* user_data, size_t size, int block_type, long request,
+						 const unsigned char* file_name, int line)
+{
+	if (tracker.nested == 0 && alloc_Tracked())
+	{
+		switch (alloc_type)
+		{
+		case _HOOK_ALLOC:
+			alloc_Record(ALLOC_EVENT_MALLOC, size);
+			break;
+		case _HOOK_REALLOC:
+			alloc_Record(ALLOC_EVENT_REALLOC, size);
+			break;
+		case _HOOK_FREE:
+			alloc_Record(ALLOC_EVENT_FREE, 0);
+			break;
+		}
+	}
+	return TRUE;
+}
+#endif
+
+// ------------------------------------------------ REPLACED GLOBAL OPERATORS ------------------------------------------
+
+void* operator new(size_t size)
+{
+	void* block = alloc_Malloc(ALLOC_EVENT_NEW, size);
+	if (block == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return block;
+}
+
+void* operator new[](size_t size)
+{
+	void* block = alloc_Malloc(ALLOC_EVENT_NEW, size);
+	if (block == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return block;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return alloc_Malloc(ALLOC_EVENT_NEW, size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return alloc_Malloc(ALLOC_EVENT_NEW, size);
+}
+
+void operator delete(void* block) noexcept
+{
+	alloc_Release(ALLOC_EVENT_DELETE, block);
+}
+
+void operator delete[](void* block) noexcept
+{
+	alloc_Release(ALLOC_EVENT_DELETE, block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+	alloc_Release(ALLOC_EVENT_DELETE, block);
+}
+
+void operator delete[](void* block, size_t) noexcept
+{
+	alloc_Release(ALLOC_EVENT_DELETE, block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept
+{
+	alloc_Release(ALLOC_EVENT_DELETE, block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept
+{
+	alloc_Release(ALLOC_EVENT_DELETE, block);
+}
@@ -0,0 +1,76 @@
+/***********************************************************************************************************************
+* alloc_tracker.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the tracker of the allocations made by the control loop. The global operator new/delete
+* are replaced, the heap of the debug C runtime is hooked and the session storage reports its regions : every
+* allocation, free or realloc made by the thread that marked a cycle is recorded with its stack, then printed with
+* the symbols of the frames. Used by the control loop when requested (argv[24]) and by the zero allocation benchmark.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+// General includes
+#include <stdio.h>
+#include <Windows.h>
+#include <DbgHelp.h>
+#pragma comment(lib, "Dbghelp.lib")	// Symbols of the recorded stacks
+
+// Recorded operations
+#define ALLOC_EVENT_NEW 0								// operator new / new[]
+#define ALLOC_EVENT_DELETE 1							// operator delete / delete[]
+#define ALLOC_EVENT_MALLOC 2							// malloc of the C runtime (debug runtime only)
+#define ALLOC_EVENT_REALLOC 3							// realloc of the C runtime (debug runtime only)
+#define ALLOC_EVENT_FREE 4								// free of the C runtime (debug runtime only)
+#define ALLOC_EVENT_STORAGE 5							// Region of the session storage (vector growth)
+#define ALLOC_EVENT_STORAGE_FREE 6						// Release of a region of the session storage
+#define ALLOC_NB_EVENT_TYPES 7
+
+// Tracker constants
+#define ALLOC_MAX_EVENTS 64								// Operations kept with their stack
+#define ALLOC_STACK_DEPTH 16							// Frames kept for each operation
+#define ALLOC_SYMBOL_LENGTH 256							// Length of the symbol names printed in the report
+
+// ------------------------------------------------- ALLOCATION EVENT STRUCT -------------------------------------------
+struct alloc_Event
+{
+	int type;											// ALLOC_EVENT_*
+	size_t size;										// Requested size (bytes), 0 for frees
+	long long cycle;									// Cycle during which the operation was made
+	int nb_frames;										// Frames captured
+	void* frames[ALLOC_STACK_DEPTH];					// Return addresses, innermost first
+};
+
+// ------------------------------------------------ ALLOCATION TRACKER STRUCT ------------------------------------------
+struct alloc_Tracker
+{
+	volatile int enabled;								// 1 : operations of the marked cycles are recorded
+	volatile int in_cycle;								// 1 : between alloc_BeginCycle and alloc_EndCycle
+	volatile DWORD thread_id;							// Thread that marked the current cycle
+	int nested;											// Depth of the runtime calls made by the replaced operators
+	long long cycle;									// Current cycle
+	long long nb_cycles;								// Cycles marked since alloc_Enable
+	long long faulty_cycles;							// Cycles during which at least one operation was made
+	long long last_faulty_cycle;						// Last cycle counted in faulty_cycles
+	long long counts[ALLOC_NB_EVENT_TYPES];				// Operations of each type
+	long long bytes;									// Bytes requested by the allocations
+	int nb_events;										// Operations kept (at most ALLOC_MAX_EVENTS)
+	alloc_Event events[ALLOC_MAX_EVENTS];				// First operations, with their stack
+};
+
+// Tracking functions
+void alloc_Enable(int enabled);
+void alloc_BeginCycle(long long cycle);
+void alloc_EndCycle();
+void alloc_Record(int type, size_t size);
+long long alloc_NbOperations();
+
+// Report functions
+void alloc_PrintReport(FILE* out_file);
+#endif // !ALLOC_TRACKER_H
\ No newline at end of file
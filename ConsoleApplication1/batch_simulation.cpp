@@ -0,0 +1,796 @@
+/***********************************************************************************************************************
+* batch_simulation.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Runs batches of simulated sessions with the controllers of the robot, in parallel and with a virtual clock. The
+* simulated plant is the elbow axis : proportional speed loop of the drive with its current limit, gravity and friction
+* of the identified model, and a human forearm attached at the wrist sensor. The state frame and the wrist sample go
+* through the fault injector before the control loop, untouched unless a fault profile is run.
+***********************************************************************************************************************/
+
+#include "batch_simulation.h"
+
+// Names of the parameters in the sweep file and in the results table
+static const char* sim_ParamNames[SIM_NB_PARAMS] = { "mass", "antiG", "k_fp", "k_fi", "Kp_P", "Ki_P", "start", "end",
+													 "move_duration", "duration", "model_error" };
+static const char* sim_ModeNames[SIM_NB_MODES] = { "torque", "position", "oscillator" };
+
+// Values of the parameters absent from the sweep file (mass, Kp_P and Ki_P are taken from the control struct if set)
+static const float sim_Defaults[SIM_NB_PARAMS] = { 1.5f, 0.0f, 0.1f, 0.001f, 125.0f, 1.5f, -0.5f, 0.5f, 1.5f, 10.0f,
+												   0.0f };
+
+// ------------------------------------------------------ BATCH --------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sim_RunBatch - Run every session of the sweep file on all cores and write the table of their metrics
+|
+| Syntax --
+|	int sim_RunBatch(FILE* err_file, FILE* out_file, const AbleControlStruct* ctrl_ABLE, const char* sweep_name,
+|					 const char* profiles_name, const char* results_name)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	FILE* out_file -> file to print the summary of the batch
+|	const AbleControlStruct* ctrl_ABLE -> control struct, robot parameters, dynamics and model backend loaded
+|	const char* sweep_name -> name of the sweep file
+|	const char* profiles_name -> name of the fault profiles file, NULL : fault-free sessions only
+|	const char* results_name -> name of the results table
+|
+| Outputs --
+|	int -> 0 if every session was run and the table written, -1 otherwise
+|
+| Remarks --
+|	Each worker copies the control struct once and runs sessions until the batch is exhausted. The sessions do not
+|	share any state : the table does not depend on the number of workers nor on the order in which they run. With
+|	fault profiles, the worker runs each session fault-free first, then once per profile with the same random
+|	faults for every session, and the table compares each profile with the fault-free session.
+----------------------------------------------------------------------------------------------------------------------*/
+int sim_RunBatch(FILE* err_file, FILE* out_file, const AbleControlStruct* ctrl_ABLE, const char* sweep_name,
+	             const char* profiles_name, const char* results_name)
+{
+	// Initialise variables
+	std::vector<sim_Session> sessions;
+	std::vector<fault_Profile> profiles;
+	std::vector<sim_Result> results;
+	sim_Batch batch = {};
+	sim_Worker workers[SIM_MAX_WORKERS] = {};
+	HANDLE threads[SIM_MAX_WORKERS];
+	SYSTEM_INFO system_info;
+	FILE* results_file = NULL;
+	long long start_tick;
+	double wall_time, simulated_time = 0.0;
+	int nb_workers, nb_started = 0, nb_diverged = 0, nb_runs;
+
+	if (sim_ReadSweep(err_file, sweep_name, ctrl_ABLE, &sessions) != 0 ||
+		(profiles_name != NULL && fault_ReadProfiles(err_file, profiles_name, &profiles) != 0))
+	{
+		return -1;
+	}
+	nb_runs = (int)profiles.size() + 1;
+	results.resize(sessions.size() * nb_runs);
+	batch.model = ctrl_ABLE;
+	batch.sessions = sessions.data();
+	batch.profiles = profiles.data();
+	batch.nb_profiles = (int)profiles.size();
+	batch.results = results.data();
+	batch.nb_sessions = (int)sessions.size();
+	batch.next_session = 0;
+
+	// One worker per core, not more than sessions
+	GetSystemInfo(&system_info);
+	nb_workers = (int)system_info.dwNumberOfProcessors;
+	nb_workers = nb_workers < 1 ? 1 : (nb_workers > SIM_MAX_WORKERS ? SIM_MAX_WORKERS : nb_workers);
+	nb_workers = nb_workers > batch.nb_sessions ? batch.nb_sessions : nb_workers;
+	fprintf(out_file, "Batch simulation : %i sessions, %i fault profiles, on %i workers\n", batch.nb_sessions,
+		    batch.nb_profiles, nb_workers);
+	fflush(out_file);
+
+	start_tick = timebase_Now();
+	for (int i(0); i < nb_workers; i++)
+	{
+		workers[i].batch = &batch;
+		if (fopen_s(&workers[i].null_file, SIM_NULL_FILE, "w") != 0 || workers[i].null_file == NULL)
+		{
+			fprintf(err_file, "Prints of simulation worker %i not redirected to %s\n", i, SIM_NULL_FILE);
+			break;
+		}
+		threads[i] = CreateThread(NULL, 0, &sim_WorkerThread, &workers[i], 0, NULL);
+		if (threads[i] == NULL)
+		{
+			fprintf(err_file, "Simulation worker %i not created (%lu)\n", i, GetLastError());
+			fclose(workers[i].null_file);
+			break;
+		}
+		nb_started++;
+	}
+	for (int i(0); i < nb_started; i++)
+	{
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+		fclose(workers[i].null_file);
+	}
+	wall_time = timebase_Seconds(timebase_Now() - start_tick);
+	if (nb_started == 0)
+	{
+		fprintf(err_file, "No simulation worker started, batch cancelled\n");
+		return -1;
+	}
+
+	// Table of the metrics, in the order of the sweep
+	fopen_s(&results_file, results_name, "w");
+	if (results_file == NULL)
+	{
+		fprintf(err_file, "Simulation results file %s not opened !\n", results_name);
+		return -1;
+	}
+	if (batch.nb_profiles > 0)
+	{
+		sim_WriteFaultResults(results_file, batch.sessions, batch.profiles, batch.nb_profiles, batch.results,
+			                  batch.nb_sessions);
+	} else
+	{
+		sim_WriteResults(results_file, batch.sessions, batch.results, batch.nb_sessions);
+	}
+	fclose(results_file);
+
+	for (size_t k(0); k < results.size(); k++)
+	{
+		simulated_time += results[k].nb_cycles * (double)ctrl_ABLE->rtParams.sampling_frequency;
+		nb_diverged += results[k].diverged;
+	}
+	fprintf(out_file, "Batch simulation : %.1f s simulated in %.1f s (x%.0f real time), %i sessions diverged\n",
+		    simulated_time, wall_time, wall_time > 0.0 ? simulated_time / wall_time : 0.0, nb_diverged);
+	for (int p(0); p < batch.nb_profiles; p++)
+	{
+		sim_PrintProfile(out_file, &batch.profiles[p], batch.results, p + 1, nb_runs, batch.nb_sessions);
+	}
+	for (int i(0); i < nb_started; i++)
+	{
+		fprintf(out_file, "Simulation worker %i : %i sessions\n", i, workers[i].nb_sessions);
+	}
+	fprintf(out_file, "Simulation results written in %s\n", results_name);
+	fflush(out_file);
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sim_ReadSweep - Read the values of the parameters and build the sessions of every combination
+|
+| Syntax --
+|	int sim_ReadSweep(FILE* err_file, const char* sweep_name, const AbleControlStruct* ctrl_ABLE,
+|					  std::vector<sim_Session>* sessions)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	const char* sweep_name -> name of the sweep file
+|	const AbleControlStruct* ctrl_ABLE -> control struct, default mass and position gains
+|	std::vector<sim_Session>* sessions -> filled with the sessions of the batch
+|
+| Outputs --
+|	int -> 0 : Success ; -1 : file not opened, invalid or too many sessions
+|
+| Remarks --
+|	One parameter per line, followed by its values or by min:max:nb for nb values evenly spaced, '#' starts a
+|	comment. The modes are given by name :
+|		mode torque oscillator
+|		mass 1.0 1.5 2.0
+|		k_fp 0.05:0.5:10
+|	Every combination of the values is a session, the parameters absent from the file keep a single default value.
+----------------------------------------------------------------------------------------------------------------------*/
+int sim_ReadSweep(FILE* err_file, const char* sweep_name, const AbleControlStruct* ctrl_ABLE,
+	              std::vector<sim_Session>* sessions)
+{
+	// Initialise variables
+	FILE* sweep_file = NULL;
+	char line[SIM_LINE_LENGTH], *token, *end;
+	float values[SIM_NB_PARAMS][SIM_MAX_VALUES];
+	int nb_values[SIM_NB_PARAMS], modes[SIM_NB_MODES], counters[SIM_NB_PARAMS + 1] = { 0 };
+	int nb_modes = 0, param, nb_lines = 0, status = 0, nb_range;
+	float min_value, max_value;
+	long long nb_sessions;
+	sim_Session session;
+
+	for (int p(0); p < SIM_NB_PARAMS; p++)
+	{
+		values[p][0] = sim_Defaults[p];
+		nb_values[p] = 0;
+	}
+	if (ctrl_ABLE->hDynId.mass > 0.0f)
+	{
+		values[SIM_PARAM_MASS][0] = ctrl_ABLE->hDynId.mass;
+	}
+	values[SIM_PARAM_KPP][0] = (float)ctrl_ABLE->mParams.Kp_P[NB_MOTORS - 1];
+	values[SIM_PARAM_KIP][0] = (float)ctrl_ABLE->mParams.Ki_P[NB_MOTORS - 1];
+
+	fopen_s(&sweep_file, sweep_name, "rt");
+	if (sweep_file == NULL)
+	{
+		fprintf(err_file, "Simulation sweep file %s not opened !\n", sweep_name);
+		return -1;
+	}
+	while (status == 0 && fgets(line, SIM_LINE_LENGTH, sweep_file) != NULL)
+	{
+		nb_lines++;
+		if ((end = strchr(line, '#')) != NULL)
+		{
+			*end = '\0';
+		}
+		token = strtok(line, " \t\r\n");
+		if (token == NULL)
+		{
+			continue;
+		}
+
+		// Modes given by name
+		if (strcmp(token, "mode") == 0)
+		{
+			while (status == 0 && (token = strtok(NULL, " \t\r\n")) != NULL)
+			{
+				param = -1;
+				for (int m(0); m < SIM_NB_MODES; m++)
+				{
+					param = strcmp(token, sim_ModeNames[m]) == 0 ? m : param;
+				}
+				if (param < 0 || nb_modes == SIM_NB_MODES)
+				{
+					fprintf(err_file, "Invalid simulated mode %s, line %i of %s\n", token, nb_lines, sweep_name);
+					status = -1;
+					break;
+				}
+				modes[nb_modes++] = param;
+			}
+			continue;
+		}
+
+		// Values of a parameter
+		param = -1;
+		for (int p(0); p < SIM_NB_PARAMS; p++)
+		{
+			param = strcmp(token, sim_ParamNames[p]) == 0 ? p : param;
+		}
+		if (param < 0 || nb_values[param] != 0)
+		{
+			fprintf(err_file, "Unknown or repeated parameter %s, line %i of %s\n", token, nb_lines, sweep_name);
+			status = -1;
+			break;
+		}
+		while ((token = strtok(NULL, " \t\r\n")) != NULL)
+		{
+			if (sscanf(token, "%f:%f:%i", &min_value, &max_value, &nb_range) == 3 && nb_range > 0 &&
+				nb_values[param] + nb_range <= SIM_MAX_VALUES)
+			{
+				for (int j(0); j < nb_range; j++)
+				{
+					values[param][nb_values[param]++] = nb_range == 1 ? min_value :
+						min_value + (max_value - min_value) * j / (nb_range - 1);
+				}
+			}
+			else if (strchr(token, ':') == NULL && nb_values[param] < SIM_MAX_VALUES)
+			{
+				values[param][nb_values[param]] = strtof(token, &end);
+				if (*end != '\0' || !isfinite(values[param][nb_values[param]]))
+				{
+					status = -1;
+					break;
+				}
+				nb_values[param]++;
+			}
+			else
+			{
+				status = -1;
+				break;
+			}
+		}
+		if (status != 0 || nb_values[param] == 0)
+		{
+			fprintf(err_file, "Invalid values of %s, line %i of %s\n", sim_ParamNames[param], nb_lines, sweep_name);
+			status = -1;
+		}
+	}
+	fclose(sweep_file);
+	if (status != 0)
+	{
+		return -1;
+	}
+
+	// Defaults : torque control, one value per parameter
+	if (nb_modes == 0)
+	{
+		modes[nb_modes++] = SIM_MODE_TORQUE;
+	}
+	nb_sessions = nb_modes;
+	for (int p(0); p < SIM_NB_PARAMS; p++)
+	{
+		nb_values[p] = nb_values[p] == 0 ? 1 : nb_values[p];
+		nb_sessions *= nb_values[p];
+	}
+	for (int j(0); j < nb_values[SIM_PARAM_MOVE]; j++)
+	{
+		status = values[SIM_PARAM_MOVE][j] > 0.0f ? status : -1;
+	}
+	for (int j(0); j < nb_values[SIM_PARAM_DURATION]; j++)
+	{
+		status = values[SIM_PARAM_DURATION][j] > 0.0f ? status : -1;
+	}
+	if (status != 0 || nb_sessions > SIM_MAX_SESSIONS)
+	{
+		fprintf(err_file, "Simulation sweep %s rejected : %lld sessions (max %i), durations must be positive\n",
+			    sweep_name, nb_sessions, SIM_MAX_SESSIONS);
+		return -1;
+	}
+
+	// Every combination, the last parameter varying fastest
+	sessions->clear();
+	sessions->reserve((size_t)nb_sessions);
+	for (long long k(0); k < nb_sessions; k++)
+	{
+		session.mode = modes[counters[0]];
+		for (int p(0); p < SIM_NB_PARAMS; p++)
+		{
+			session.params[p] = values[p][counters[p + 1]];
+		}
+		sessions->push_back(session);
+		for (int p(SIM_NB_PARAMS); p >= 0; p--)
+		{
+			if (++counters[p] < (p == 0 ? nb_modes : nb_values[p - 1]))
+			{
+				break;
+			}
+			counters[p] = 0;
+		}
+	}
+	return 0;
+}
+
+// Worker thread : copy of the control struct with its own measures storage, then sessions of the batch until it is exhausted, each one fault-free
+// first (reference of the tracking error) then with every fault profile
+DWORD WINAPI sim_WorkerThread(LPVOID workerArgs)
+{
+	// Initialise variables
+	sim_Worker* worker = (sim_Worker*)workerArgs;
+	sim_Batch* batch = worker->batch;
+	ThreadInformations ableInfos = {};
+	fault_Injector* injector = new fault_Injector();
+	std::vector<float> reference;
+	const sim_Session* session;
+	sim_Result* results;
+	float period = batch->model->rtParams.sampling_frequency;
+	LONG index;
+
+	ableInfos.ctrl_ABLE = new AbleControlStruct(*batch->model);
+	ableInfos.ctrl_ABLE->aMeasures = new ableMeasures();
+	ableInfos.eth_ABLE = new ServoComEth();
+	ableInfos.err_file = worker->null_file;
+	ableInfos.out_file = worker->null_file;
+	while ((index = InterlockedIncrement(&batch->next_session) - 1) < batch->nb_sessions)
+	{
+		session = &batch->sessions[index];
+		results = &batch->results[index * (batch->nb_profiles + 1)];
+		if (batch->nb_profiles > 0)
+		{
+			reference.assign((size_t)(session->params[SIM_PARAM_DURATION] / period + 0.5f), NAN);
+		}
+		fault_Reset(injector, NULL, 1, period, NULL, batch->nb_profiles > 0 ? &reference : NULL);
+		sim_RunSession(&ableInfos, session, injector, &results[0]);
+		for (int p(0); p < batch->nb_profiles; p++)
+		{
+			fault_Reset(injector, &batch->profiles[p], batch->profiles[p].seed, period, &reference, NULL);
+			sim_RunSession(&ableInfos, session, injector, &results[p + 1]);
+		}
+		worker->nb_sessions++;
+	}
+	delete ableInfos.eth_ABLE;
+	delete ableInfos.ctrl_ABLE->aMeasures;
+	delete ableInfos.ctrl_ABLE;
+	delete injector;
+	return 0;
+}
+
+// ----------------------------------------------------- SESSION -------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sim_RunSession - Run one simulated session with the controllers of the robot
+|
+| Syntax --
+|	void sim_RunSession(ThreadInformations* ableInfos, const sim_Session* session, fault_Injector* injector,
+|						sim_Result* result)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> informations struct of the worker (control struct, drive frame, null files)
+|	const sim_Session* session -> parameters of the session
+|	fault_Injector* injector -> faults injected in the transports, reset for the session (fault_Reset)
+|	sim_Result* result -> filled with the metrics of the session
+|
+| Remarks --
+|	Each cycle follows the control loop : state frame (fault_DriveFrame, state_Update) and wrist sample
+|	(fault_FTSample, digitalFT_ApplySamples), orders of able_SelectAdaptedControl, saturation (sature_SpeedOrders),
+|	then the plant is integrated over one period. The virtual clock advances by the nominal period, plus the delays
+|	of the drive frames during which the plant runs with the previous orders ; the ticks are timebase ticks of the
+|	virtual clock. The session stops as the control loop when the wrist sensor stops streaming. The tracking error is
+|	taken against the trajectory : intended angle of the human in torque and oscillator modes, order of the position
+|	control.
+----------------------------------------------------------------------------------------------------------------------*/
+void sim_RunSession(ThreadInformations* ableInfos, const sim_Session* session, fault_Injector* injector,
+	                sim_Result* result)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+	ableOrders* oValues = &ctrl_ABLE->aOrders;
+
+	// Initialise variables
+	sim_Plant plant = {};
+	FT_meas_Global published = {};
+	float period = rtValues->sampling_frequency;
+	float compensation[NB_MOTORS], load = 0.0f;
+	float time, delay, shift = 0.0f, target, error, order;
+	double sum_error = 0.0, sum_force = 0.0, frequency = (double)timebase_Frequency();
+	int nb_cycles = (int)(session->params[SIM_PARAM_DURATION] / period + 0.5f);
+
+	sim_SetupSession(ctrl_ABLE, session);
+	*result = {};
+	plant.position = session->params[SIM_PARAM_START];
+	published.streaming = TRUE;
+	ctrl_ABLE->FT_sample_Arm = published;
+	ctrl_ABLE->FT_sample_Wrist = published;
+	for (int k(0); k < nb_cycles; k++)
+	{
+		// Virtual clock, the state frame is received after the delay of the transport
+		delay = fault_BeginCycle(injector, k);
+		rtValues->iter_counter = k;
+		sim_WriteFrame(&plant, ctrl_ABLE, ableInfos->eth_ABLE);
+		if (delay > 0.0f)
+		{
+			sim_StepPlant(&plant, ctrl_ABLE, session, load, k * period + shift, delay);
+			published.integral[2] += plant.impulse;
+			shift += delay;
+		}
+		time = k * period + shift;
+		rtValues->elapsed_time = time;
+		rtValues->state_tick = (long long)(time * frequency);
+		rtValues->cycle_dt = fminf(period + delay, TIMEBASE_DT_MAX_RATIO * period);
+
+		// State frame and wrist sample, through the transports
+		fault_DriveFrame(injector, ableInfos->eth_ABLE, rtValues);
+		state_Update(ableInfos);
+		published.derivative[2] = k == 0 ? 0.0f : (plant.force - published.fz) / rtValues->cycle_dt;
+		published.fz = plant.force;
+		published.filtered[2] = plant.force;
+		published.tick = rtValues->state_tick;
+		ctrl_ABLE->FT_sample_Arm.tick = rtValues->state_tick;
+		fault_FTSample(injector, &published, &ctrl_ABLE->FT_sample_Wrist);
+		digitalFT_ApplySamples(ableInfos);
+		if (!rtValues->able_RealTimeCommand)
+		{
+			fault_Stop(injector, time);
+			break;
+		}
+
+		// Orders of the controllers, saturated as in the control loop
+		target = sim_Target(session, time);
+		oValues->positionOrder[NB_MOTORS - 1] = target;
+		able_SelectAdaptedControl(ableInfos);
+		order = oValues->speedOrder[NB_MOTORS - 1];
+		sature_SpeedOrders(ableInfos);
+		result->nb_order_sat += oValues->speedOrder[NB_MOTORS - 1] != order;
+
+		// Plant over one period, gravity and friction of the model with the error of the session
+		model_ComputeCompensation(ctrl_ABLE, compensation);
+		load = compensation[NB_MOTORS - 1] * (1.0f + session->params[SIM_PARAM_MODEL_ERROR]);
+		sim_StepPlant(&plant, ctrl_ABLE, session, load, time, period);
+		published.integral[2] += plant.impulse;
+		result->nb_current_sat += plant.current_sat;
+		result->nb_cycles++;
+
+		// Metrics
+		error = target - (float)plant.position;
+		fault_EndCycle(injector, time, error);
+		error = fabsf(error);
+		sum_error += error * error;
+		sum_force += plant.force * plant.force;
+		result->max_error = fmaxf(result->max_error, error);
+		result->peak_force = fmaxf(result->peak_force, fabsf(plant.force));
+		if (!(fabs(plant.position) < SIM_DIVERGENCE_ANGLE))
+		{
+			result->diverged = 1;
+			break;
+		}
+	}
+	if (result->nb_cycles > 0)
+	{
+		result->rms_error = (float)sqrt(sum_error / result->nb_cycles);
+		result->rms_force = (float)sqrt(sum_force / result->nb_cycles);
+	}
+	fault_Finish(injector, &result->faults);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sim_SetupSession - Set the control struct of a worker for a new session
+|
+| Syntax --
+|	void sim_SetupSession(AbleControlStruct* ctrl_ABLE, const sim_Session* session)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct of the worker
+|	const sim_Session* session -> parameters of the session
+|
+| Remarks --
+|	Only the elbow is controlled. The measures of the previous session are cleared but their memory is kept, the
+|	controllers start from their initial state.
+----------------------------------------------------------------------------------------------------------------------*/
+void sim_SetupSession(AbleControlStruct* ctrl_ABLE, const sim_Session* session)
+{
+	// Extract substructs
+	ableOrders* oValues = &ctrl_ABLE->aOrders;
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+	ableMeasures* m = ctrl_ABLE->aMeasures;
+
+	// Initialise variables
+	session_floats* channels[] = { &m->able_xs_slider, &m->able_currents_1, &m->able_currents_2, &m->able_currents_3,
+								   &m->able_currents_4, &m->able_artpos_1, &m->able_artpos_2, &m->able_artpos_3,
+								   &m->able_artpos_4, &m->able_speeds_1, &m->able_speeds_2, &m->able_speeds_3,
+								   &m->able_speeds_4, &m->fx_FTA_sensor, &m->fy_FTA_sensor, &m->fz_FTA_sensor,
+								   &m->tx_FTA_sensor, &m->ty_FTA_sensor, &m->tz_FTA_sensor, &m->fx_FTW_sensor,
+								   &m->fy_FTW_sensor, &m->fz_FTW_sensor, &m->tx_FTW_sensor, &m->ty_FTW_sensor,
+								   &m->tz_FTW_sensor };
+	const int ctrl_types[SIM_NB_MODES] = { TORQUE_CTRL, STATIC_IDENT, OSCILLATOR_CTRL };
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		mValues->inhibition_State[i] = i != NB_MOTORS - 1;
+		mValues->Kp_P[i] = session->params[SIM_PARAM_KPP];
+		mValues->Ki_P[i] = session->params[SIM_PARAM_KIP];
+		oValues->positionOrder[i] = 0.0f;
+		oValues->speedOrder[i] = 0.0f;
+	}
+	state_BuildConfig(ctrl_ABLE);
+	oValues->ctrl_type = ctrl_types[session->mode];
+	oValues->antiG_value = session->params[SIM_PARAM_ANTIG];
+	ctrlstate_Reset(&ctrl_ABLE->ctrlStates);
+	ctrl_ABLE->hopfParams = {};
+	ctrl_ABLE->hDynId.mass = session->params[SIM_PARAM_MASS];
+
+	// Wrist and arm sensors, gains of the session
+	ctrl_ABLE->current_FT_meas_Arm = {};
+	ctrl_ABLE->current_FT_meas_Wrist = {};
+	ctrl_ABLE->current_FT_meas_Arm.k_fp = session->params[SIM_PARAM_KFP];
+	ctrl_ABLE->current_FT_meas_Arm.k_fi = session->params[SIM_PARAM_KFI];
+	ctrl_ABLE->current_FT_meas_Wrist.k_fp = session->params[SIM_PARAM_KFP];
+	ctrl_ABLE->current_FT_meas_Wrist.k_fi = session->params[SIM_PARAM_KFI];
+
+	// Orders in progress from the first cycle
+	rtValues->use_FT = session->mode != SIM_MODE_POSITION;
+	rtValues->order_counter = 1;
+	rtValues->iter_counter = 0;
+	rtValues->elapsed_time = 0.0;
+	for (size_t c(0); c < sizeof(channels) / sizeof(channels[0]); c++)
+	{
+		channels[c]->clear();
+	}
+	m->able_ticks.clear();
+	m->ftA_ticks.clear();
+	m->ftW_ticks.clear();
+}
+
+// ------------------------------------------------------ PLANT --------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sim_WriteFrame - Write the state of the plant in the drive frame, as translated by ETH_carte_variateur_V3_Datas
+|
+| Syntax --
+|	void sim_WriteFrame(const sim_Plant* plant, const AbleControlStruct* ctrl_ABLE, ServoComEth* eth_ABLE)
+|
+| Inputs --
+|	const sim_Plant* plant -> state of the simulated elbow
+|	const AbleControlStruct* ctrl_ABLE -> control struct, reductions and ADC conversion
+|	ServoComEth* eth_ABLE -> drive frame to fill, the other axes are at rest at 0 rad
+|
+| Remarks --
+|	The coder counts from 0 : negative angles are read after a full turn of the axis (able_ComputeCurrentPosition).
+----------------------------------------------------------------------------------------------------------------------*/
+void sim_WriteFrame(const sim_Plant* plant, const AbleControlStruct* ctrl_ABLE, ServoComEth* eth_ABLE)
+{
+	// Extract substructs
+	const motorsParams* mValues = &ctrl_ABLE->mParams;
+
+	// Initialise variables
+	int axis = NB_MOTORS - 1;
+	double position = plant->position < 0.0 ? plant->position + 2 * M_PI : plant->position;
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		eth_ABLE->moteur[i].Position_Codeur = 0;
+		eth_ABLE->moteur[i].Vitesse_Filtree = 0.0f;
+		eth_ABLE->moteur[i].ADC_Courant = (float)mValues->offset_ADC[i];
+		eth_ABLE->moteur[i].ADC_Potentiometre = 0.0f;
+	}
+	eth_ABLE->moteur[axis].Position_Codeur =
+		(int)floor(position * mValues->able_AxisReductions[axis] * 4 * NB_POINTS_CODERS / (2 * M_PI) + 0.5);
+	eth_ABLE->moteur[axis].Vitesse_Filtree = (float)plant->speed;
+	eth_ABLE->moteur[axis].ADC_Courant = (float)(plant->current / mValues->Kconv_I[axis] + mValues->offset_ADC[axis]);
+	eth_ABLE->entree_tor = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sim_StepPlant - Integrate the simulated elbow over one control period, or the delay of a drive frame
+|
+| Syntax --
+|	void sim_StepPlant(sim_Plant* plant, const AbleControlStruct* ctrl_ABLE, const sim_Session* session, float load,
+|					   float time, float duration)
+|
+| Inputs --
+|	sim_Plant* plant -> state of the simulated elbow, advanced by duration
+|	const AbleControlStruct* ctrl_ABLE -> control struct, saturated speed order and motor parameters
+|	const sim_Session* session -> parameters of the session (mode, trajectory)
+|	float load -> torque of gravity and friction on the motor, held over the period
+|	float time -> time of the start of the period (s)
+|	float duration -> integrated duration (s), the control period or the delay of the drive frame
+|
+| Remarks --
+|	The drive closes a proportional speed loop (current = Kp_V * speed error, as assumed by the torque control),
+|	integrated implicitly in SIM_SUBSTEPS steps and limited to SIM_MAX_CURRENT. The forearm weighs on the wrist sensor
+|	as expected by the antigravity control, and when the human leads it is pulled towards the trajectory by a spring
+|	and a damper. The sensor reads the opposite of the force applied in the direction of the axis.
+----------------------------------------------------------------------------------------------------------------------*/
+void sim_StepPlant(sim_Plant* plant, const AbleControlStruct* ctrl_ABLE, const sim_Session* session, float load,
+	               float time, float duration)
+{
+	// Extract substructs
+	const motorsParams* mValues = &ctrl_ABLE->mParams;
+	const humanDyn* hmds = &ctrl_ABLE->hDynId;
+
+	// Initialise variables
+	int axis = NB_MOTORS - 1;
+	double reduction = mValues->able_AxisReductions[axis];
+	double gain = mValues->kt_gain * mValues->Kp_V[axis];
+	double inertia = 2 * M_PI * (SIM_MOTOR_INERTIA + hmds->farm_FE_inertia / (reduction * reduction));
+	double step = (double)duration / SIM_SUBSTEPS;
+	double order = ctrl_ABLE->aOrders.speedOrder[axis];
+	double target, target_speed, art_speed, force, torque, speed;
+
+	plant->impulse = 0.0;
+	plant->current_sat = 0;
+	for (int s(0); s < SIM_SUBSTEPS; s++)
+	{
+		// Human : weight of the forearm, and spring and damper towards the trajectory when leading
+		art_speed = plant->speed * 2 * M_PI / reduction;
+		force = -hmds->mass * G_VAL * cos(plant->position + hmds->delta_theta);
+		if (session->mode != SIM_MODE_POSITION)
+		{
+			target = sim_Target(session, (float)(time + s * step));
+			target_speed = (sim_Target(session, (float)(time + (s + 1) * step)) - target) / step;
+			force -= SIM_HUMAN_STIFFNESS * (target - plant->position) + SIM_HUMAN_DAMPING * (target_speed - art_speed);
+		}
+		torque = -force * SIM_WRIST_LEVER / reduction - load;
+
+		// Speed loop of the drive, current limited
+		speed = (inertia * plant->speed + step * (gain * order + torque)) / (inertia + step * gain);
+		plant->current = mValues->Kp_V[axis] * (order - speed);
+		if (fabs(plant->current) > SIM_MAX_CURRENT)
+		{
+			plant->current = plant->current > 0.0 ? SIM_MAX_CURRENT : -SIM_MAX_CURRENT;
+			speed = plant->speed + step * (mValues->kt_gain * plant->current + torque) / inertia;
+			plant->current_sat = 1;
+		}
+		plant->speed = speed;
+		plant->position += step * speed * 2 * M_PI / reduction;
+		plant->impulse += force * step;
+		plant->force = (float)force;
+	}
+}
+
+// Trajectory of the session : back and forth minimum jerk moves between start and end
+float sim_Target(const sim_Session* session, float time)
+{
+	// Initialise variables
+	minjerk_move move = { session->params[SIM_PARAM_START], session->params[SIM_PARAM_END],
+						  session->params[SIM_PARAM_MOVE], 0 };
+	int index = (int)(time / move.duration);
+
+	if (index % 2 == 1)
+	{
+		move.start = session->params[SIM_PARAM_END];
+		move.end = session->params[SIM_PARAM_START];
+	}
+	return minjerk_Position(&move, time - index * move.duration);
+}
+
+// ------------------------------------------------------ RESULTS ------------------------------------------------------
+
+// One line per session : parameters then metrics
+void sim_WriteResults(FILE* results_file, const sim_Session* sessions, const sim_Result* results, int nb_sessions)
+{
+	fprintf(results_file, "session;mode");
+	for (int p(0); p < SIM_NB_PARAMS; p++)
+	{
+		fprintf(results_file, ";%s", sim_ParamNames[p]);
+	}
+	fprintf(results_file, ";rms_error;max_error;peak_force;rms_force;order_sat;current_sat;cycles;diverged\n");
+	for (int k(0); k < nb_sessions; k++)
+	{
+		fprintf(results_file, "%i;%s", k, sim_ModeNames[sessions[k].mode]);
+		for (int p(0); p < SIM_NB_PARAMS; p++)
+		{
+			fprintf(results_file, ";%g", sessions[k].params[p]);
+		}
+		fprintf(results_file, ";%f;%f;%f;%f;%i;%i;%i;%i\n", results[k].rms_error, results[k].max_error,
+			    results[k].peak_force, results[k].rms_force, results[k].nb_order_sat, results[k].nb_current_sat,
+			    results[k].nb_cycles, results[k].diverged);
+	}
+}
+
+// One line per session and profile, the fault-free session first : parameters, metrics, then faults and increase of
+// the metrics over the fault-free session
+void sim_WriteFaultResults(FILE* results_file, const sim_Session* sessions, const fault_Profile* profiles,
+	                       int nb_profiles, const sim_Result* results, int nb_sessions)
+{
+	// Initialise variables
+	const sim_Result* reference;
+	const sim_Result* result;
+	const fault_Report* faults;
+
+	fprintf(results_file, "session;mode");
+	for (int p(0); p < SIM_NB_PARAMS; p++)
+	{
+		fprintf(results_file, ";%s", sim_ParamNames[p]);
+	}
+	fprintf(results_file, ";profile;rms_error;max_error;peak_force;rms_force;order_sat;current_sat;cycles;diverged"
+		    ";drive_faulty;ft_faulty;episodes;overruns;max_cycle_ms;stopped_ms;max_deviation;max_recovery_ms"
+		    ";mean_recovery_ms;unrecovered;rms_error_increase;peak_force_increase\n");
+	for (int k(0); k < nb_sessions; k++)
+	{
+		reference = &results[k * (nb_profiles + 1)];
+		for (int j(0); j <= nb_profiles; j++)
+		{
+			result = &reference[j];
+			faults = &result->faults;
+			fprintf(results_file, "%i;%s", k, sim_ModeNames[sessions[k].mode]);
+			for (int p(0); p < SIM_NB_PARAMS; p++)
+			{
+				fprintf(results_file, ";%g", sessions[k].params[p]);
+			}
+			fprintf(results_file, ";%s;%f;%f;%f;%f;%i;%i;%i;%i", j == 0 ? "none" : profiles[j - 1].name,
+				    result->rms_error, result->max_error, result->peak_force, result->rms_force, result->nb_order_sat,
+				    result->nb_current_sat, result->nb_cycles, result->diverged);
+			fprintf(results_file, ";%i;%i;%i;%i;%.3f;%.1f;%f;%.3f;%.3f;%i;%f;%f\n", faults->nb_faulty[FAULT_DRIVE],
+				    faults->nb_faulty[FAULT_FT], faults->nb_episodes, faults->nb_overruns, faults->max_cycle * 1000.0f,
+				    faults->stopped_time < 0.0f ? -1.0f : faults->stopped_time * 1000.0f, faults->max_deviation,
+				    faults->max_recovery * 1000.0f, faults->mean_recovery * 1000.0f, faults->nb_unrecovered,
+				    result->rms_error - reference->rms_error, result->peak_force - reference->peak_force);
+		}
+	}
+}
+
+// Summary of one fault profile over the sessions of the batch : run of the profile among the nb_runs of each session,
+// the fault-free run first
+void sim_PrintProfile(FILE* out_file, const fault_Profile* profile, const sim_Result* results, int run, int nb_runs,
+	                  int nb_sessions)
+{
+	// Initialise variables
+	const sim_Result* reference;
+	const sim_Result* result;
+	float max_cycle = 0.0f, max_recovery = 0.0f;
+	double rms_increase = 0.0;
+	int nb_stopped = 0, nb_overruns = 0, nb_unrecovered = 0, nb_diverged = 0;
+
+	for (int k(0); k < nb_sessions; k++)
+	{
+		reference = &results[k * nb_runs];
+		result = &reference[run];
+		nb_stopped += result->faults.stopped_time >= 0.0f;
+		nb_diverged += result->diverged;
+		nb_overruns += result->faults.nb_overruns;
+		nb_unrecovered += result->faults.nb_unrecovered;
+		max_cycle = fmaxf(max_cycle, result->faults.max_cycle);
+		max_recovery = fmaxf(max_recovery, result->faults.max_recovery);
+		rms_increase += result->rms_error - reference->rms_error;
+	}
+	fprintf(out_file, "Fault profile %s : %i sessions stopped, %i diverged, %i overruns (max cycle %.2f ms), recovery "
+		    "max %.1f ms, %i episodes unrecovered, rms error %+.4f rad\n", profile->name, nb_stopped, nb_diverged,
+		    nb_overruns, max_cycle * 1000.0f, max_recovery * 1000.0f, nb_unrecovered,
+		    nb_sessions > 0 ? rms_increase / nb_sessions : 0.0);
+}
@@ -0,0 +1,142 @@
+/***********************************************************************************************************************
+* batch_simulation.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the batch of simulated sessions (BATCH_SIM control type). Each session runs the controllers
+* of the robot (position, torque, oscillator) on a simulated elbow axis driven by a simulated human, with a virtual
+* clock : the sessions run as fast as the processor allows, one per worker thread, and their metrics are written in a
+* single table. In a fault campaign (FAULT_SIM control type), each session is run again with every fault profile
+* injected in its transports (fault_injection.h).
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef BATCH_SIMULATION_H
+#define BATCH_SIMULATION_H
+
+// General includes
+#include <stdio.h>
+#include <vector>
+#include <Windows.h>
+// Project includes
+#include "able_OrdersManagement.h"
+#include "robot_state.h"
+#include "controller_state.h"
+#include "able_DynamicModel.h"
+#include "minjerk_trajectories.h"
+#include "able_Control_FTData.h"
+#include "fault_injection.h"
+#include "time_base.h"
+
+// Batch files
+#define SIM_SWEEP_FILE "sim_sweep.txt"					// Values of the parameters of the sessions
+#define SIM_RESULTS_FILE "sim_results.txt"				// Table of the metrics of the sessions
+#define SIM_NULL_FILE "NUL"								// Device receiving the prints of the controllers
+// Batch limits
+#define SIM_MAX_WORKERS 64								// Maximal number of worker threads
+#define SIM_MAX_SESSIONS 100000							// Maximal number of sessions of a batch
+#define SIM_MAX_VALUES 64								// Maximal number of values of a parameter
+#define SIM_LINE_LENGTH 512								// Maximal length of a line of the sweep file
+// Simulated plant and human
+#define SIM_SUBSTEPS 10									// Integration steps of the plant per control period
+#define SIM_MOTOR_INERTIA 3e-5f							// Inertia of the motor and robot forearm on the motor (kg.m^2)
+#define SIM_MAX_CURRENT 5.0f							// Current limit of the drive (A)
+#define SIM_WRIST_LEVER 0.25f							// Distance between the elbow axis and the wrist sensor (m)
+#define SIM_HUMAN_STIFFNESS 60.0f						// Stiffness between intended and actual forearm angles (N/rad)
+#define SIM_HUMAN_DAMPING 5.0f							// Damping between intended and actual forearm speeds (N.s/rad)
+#define SIM_DIVERGENCE_ANGLE 1.5f						// Articular angle stopping a session, coder read up to pi/2 (rad)
+
+// Simulated controls
+#define SIM_MODE_TORQUE 0								// Torque control (transparent or antigravity), human leads
+#define SIM_MODE_POSITION 1								// Position control on the trajectory, human passive
+#define SIM_MODE_OSCILLATOR 2							// Hopf oscillator on the trajectory, human leads
+#define SIM_NB_MODES 3
+
+// Parameters of a session, one line of the sweep file each
+#define SIM_PARAM_MASS 0								// Mass of the human forearm (kg)
+#define SIM_PARAM_ANTIG 1								// antiG_value of the torque control
+#define SIM_PARAM_KFP 2									// Proportional gain of the force correction
+#define SIM_PARAM_KFI 3									// Integral gain of the force correction
+#define SIM_PARAM_KPP 4									// Proportional gain of the position loop
+#define SIM_PARAM_KIP 5									// Integral gain of the position loop
+#define SIM_PARAM_START 6								// First bound of the back and forth moves (rad)
+#define SIM_PARAM_END 7									// Second bound of the back and forth moves (rad)
+#define SIM_PARAM_MOVE 8								// Duration of one minimum jerk move (s)
+#define SIM_PARAM_DURATION 9							// Simulated duration of the session (s)
+#define SIM_PARAM_MODEL_ERROR 10						// Relative error of the plant gravity and friction on the model
+#define SIM_NB_PARAMS 11
+
+// ---------------------------------------------------- SESSION STRUCT -------------------------------------------------
+struct sim_Session
+{
+	int mode;										// SIM_MODE_TORQUE, SIM_MODE_POSITION or SIM_MODE_OSCILLATOR
+	float params[SIM_NB_PARAMS];					// Value of each SIM_PARAM_ parameter
+};
+
+// ---------------------------------------------------- RESULT STRUCT --------------------------------------------------
+struct sim_Result
+{
+	float rms_error;								// RMS tracking error (rad)
+	float max_error;								// Maximal tracking error (rad)
+	float peak_force;								// Peak interaction force at the wrist (N)
+	float rms_force;								// RMS interaction force at the wrist (N)
+	int nb_order_sat;								// Cycles with a speed order saturated (sature_SpeedOrders)
+	int nb_current_sat;								// Cycles with the current of the drive at its limit
+	int nb_cycles;									// Simulated cycles
+	int diverged;									// 1 : the axis left the motion range, session stopped
+	fault_Report faults;							// Faults injected in the transports and their effects
+};
+
+// ---------------------------------------------------- PLANT STRUCT ---------------------------------------------------
+struct sim_Plant
+{
+	double position;								// Articular position of the elbow (rad)
+	double speed;									// Motor speed (rev/s, as sent by the drive)
+	double current;									// Current of the drive (A)
+	double impulse;									// Integral of the wrist force since the previous frame (N.s)
+	float force;									// Wrist force at the frame (N)
+	int current_sat;								// 1 : current limited during the last period
+};
+
+// ----------------------------------------------------- BATCH STRUCT --------------------------------------------------
+struct sim_Batch
+{
+	const AbleControlStruct* model;					// Control struct copied by each worker (parameters, dynamics)
+	const sim_Session* sessions;					// Sessions of the batch
+	const fault_Profile* profiles;					// Fault profiles run after each fault-free session
+	int nb_profiles;								// Number of fault profiles, 0 : fault-free sessions only
+	sim_Result* results;							// Result of each session, then of each of its fault profiles
+	int nb_sessions;								// Number of sessions
+	volatile LONG next_session;						// Next session to run, shared by the workers
+};
+
+// ---------------------------------------------------- WORKER STRUCT --------------------------------------------------
+struct sim_Worker
+{
+	sim_Batch* batch;								// Batch shared by the workers
+	FILE* null_file;								// Prints of the controllers
+	int nb_sessions;								// Number of sessions run by the worker
+};
+
+// Functions declaration
+int sim_RunBatch(FILE* err_file, FILE* out_file, const AbleControlStruct* ctrl_ABLE, const char* sweep_name,
+	             const char* profiles_name, const char* results_name);
+int sim_ReadSweep(FILE* err_file, const char* sweep_name, const AbleControlStruct* ctrl_ABLE,
+	              std::vector<sim_Session>* sessions);
+DWORD WINAPI sim_WorkerThread(LPVOID workerArgs);
+void sim_RunSession(ThreadInformations* ableInfos, const sim_Session* session, fault_Injector* injector,
+	                sim_Result* result);
+void sim_SetupSession(AbleControlStruct* ctrl_ABLE, const sim_Session* session);
+void sim_WriteFrame(const sim_Plant* plant, const AbleControlStruct* ctrl_ABLE, ServoComEth* eth_ABLE);
+void sim_StepPlant(sim_Plant* plant, const AbleControlStruct* ctrl_ABLE, const sim_Session* session, float load,
+	               float time, float duration);
+float sim_Target(const sim_Session* session, float time);
+void sim_WriteResults(FILE* results_file, const sim_Session* sessions, const sim_Result* results, int nb_sessions);
+void sim_WriteFaultResults(FILE* results_file, const sim_Session* sessions, const fault_Profile* profiles,
+	                       int nb_profiles, const sim_Result* results, int nb_sessions);
+void sim_PrintProfile(FILE* out_file, const fault_Profile* profile, const sim_Result* results, int run, int nb_runs,
+	                  int nb_sessions);
+#endif // !BATCH_SIMULATION_H
\ No newline at end of file
@@ -0,0 +1,356 @@
+/***********************************************************************************************************************
+* cartesian_control.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Achieves Cartesian impedance control of ABLE. At each iteration the wrist pose and Jacobian are computed, a
+* spring-damper between the wrist and the target pose gives a wrench that is mapped into joint torques with the
+* transposed Jacobian, and added to the dynamic model compensation. The wrench measured by the wrist FT sensor is
+* mapped the same way (cOrders->ft_torques) and is fed back with the session FT gain. The impedance, its saturations
+* and the FT gain are session inputs (cart_SetSessionImpedance). The target is the wrist pose when the control starts. Torques are applied through the speed loop of the drives as in able_TorqueAsserv.
+* The haptic control (HAPTIC_CTRL) keeps the transparent compensation and renders the forces of the virtual scene at
+* the wrist through the same path, the scene origin being the wrist position when the control starts.
+***********************************************************************************************************************/
+
+#include "cartesian_control.h"
+
+// ------------------------------------------------ MAIN CARTESIAN CONTROL ---------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| able_CartesianAsserv - Compute the impedance torques and the orders that will be sent during next iteration
+|
+| Syntax --
+|	void able_CartesianAsserv(ThreadInformations* ableInfos)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+----------------------------------------------------------------------------------------------------------------------*/
+void able_CartesianAsserv(ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	cartesianOrders* cOrders = &ableInfos->ctrl_ABLE->aOrders.cartesian;
+
+	// Initialise variables
+	kin_State state;
+	float compensation_torques[NB_MOTORS], impedance_torques[NB_MOTORS];
+
+	// Kinematics and dynamic model once for all axes, on the state of the cycle (state_Update)
+	kin_ComputeState(ableInfos->ctrl_ABLE, &state);
+	if (!cOrders->target_set)
+	{
+		cart_InitImpedance(cOrders, &state);
+		fprintf(ableInfos->out_file, "Cartesian impedance target : %f %f %f\n", cOrders->target_position[0],
+			    cOrders->target_position[1], cOrders->target_position[2]);
+	}
+	able_ComputeDynModelCompensation(ableInfos, compensation_torques);
+	cart_WristTorques(ableInfos->ctrl_ABLE, &state, cOrders->ft_torques);
+	cart_ComputeImpedance(ableInfos->ctrl_ABLE, &state, impedance_torques);
+	if (cOrders->ft_gain != 0.0f)
+	{
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			impedance_torques[i] += cOrders->ft_gain * cOrders->ft_torques[i];
+		}
+	}
+	cart_ApplyTorques(ableInfos, compensation_torques, impedance_torques);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| able_HapticAsserv - Compute the forces of the virtual scene at the wrist and the orders of next iteration
+|
+| Syntax --
+|	void able_HapticAsserv(ThreadInformations* ableInfos)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+|
+| Remarks --
+|	The rendered force is stored in cOrders->wrench (no moment). The scene has to be built before the motions.
+----------------------------------------------------------------------------------------------------------------------*/
+void able_HapticAsserv(ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	cartesianOrders* cOrders = &ableInfos->ctrl_ABLE->aOrders.cartesian;
+	haptic_Scene* scene = ableInfos->ctrl_ABLE->scene;
+
+	// Initialise variables
+	kin_State state;
+	float compensation_torques[NB_MOTORS], haptic_torques[NB_MOTORS], twist[6];
+
+	// Kinematics and dynamic model once for all axes, on the state of the cycle (state_Update)
+	kin_ComputeState(ableInfos->ctrl_ABLE, &state);
+	if (!cOrders->target_set)
+	{
+		cart_InitImpedance(cOrders, &state);
+		for (int k(0); k < 3; k++)
+		{
+			scene->offset[k] = state.position[k];
+		}
+		fprintf(ableInfos->out_file, "Haptic scene origin : %f %f %f\n", scene->offset[0], scene->offset[1],
+			    scene->offset[2]);
+	}
+	able_ComputeDynModelCompensation(ableInfos, compensation_torques);
+	cart_WristTwist(ableInfos->ctrl_ABLE, &state, twist);
+
+	// Force of the scene at the wrist
+	scene_Query(scene, state.position, twist, cOrders->wrench);
+	cOrders->wrench[3] = cOrders->wrench[4] = cOrders->wrench[5] = 0.0f;
+	kin_JacobianTranspose(&state, cOrders->wrench, haptic_torques);
+	cart_ApplyTorques(ableInfos, compensation_torques, haptic_torques);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| cart_ApplyTorques - Set the speed orders applying the compensation and additional articular torques
+|
+| Syntax --
+|	void cart_ApplyTorques(ThreadInformations* ableInfos, const float* compensation_torques, const float* torques)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+|	const float* compensation_torques -> motor side compensation torques of the NB_MOTORS axes
+|	const float* torques -> articular torques of the NB_MOTORS axes (N.m)
+----------------------------------------------------------------------------------------------------------------------*/
+void cart_ApplyTorques(ThreadInformations* ableInfos, const float* compensation_torques, const float* torques)
+{
+	// Extract substructs
+	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
+	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
+
+	// Initialise variables
+	float gain_Kp_V, gain_Kt;
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		if (mValues->inhibition_State[i] == 0)
+		{
+			// Motor side torque of the axis
+			oValues->able_DynModTorque = compensation_torques[i] + torques[i] / mValues->able_AxisReductions[i];
+
+			// Set corresponding speed order to ignore the controller speed loop and build a torque control
+			gain_Kp_V = (float)mValues->Kp_V[i];
+			gain_Kt = mValues->kt_gain;
+			oValues->speedOrder[i] = oValues->able_DynModTorque / (gain_Kp_V * gain_Kt) + state->speed[i];
+		}
+	}
+	// Store current values
+	storeValuesInVectors(ableInfos);
+}
+
+// ------------------------------------------------ IMPEDANCE COMPUTATION ----------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| cart_SetSessionImpedance - Set the impedance, its saturations and the FT gain of the session
+|
+| Syntax --
+|	int cart_SetSessionImpedance(cartesianOrders* cOrders, const char* values)
+|
+| Inputs --
+|	cartesianOrders* cOrders -> Cartesian orders to set
+|	const char* values -> "stiffness pos;damping pos;stiffness rot;damping rot;max force;max moment;FT gain",
+|	                      NULL for the default impedance
+|
+| Outputs --
+|	int -> 0 : Success ; -1 : values invalid, default impedance set
+|
+| Remarks --
+|	Every value but the FT gain has to be positive (zero stiffness or damping allowed). The impedance is applied by
+|	cart_InitImpedance, when the target is set.
+----------------------------------------------------------------------------------------------------------------------*/
+int cart_SetSessionImpedance(cartesianOrders* cOrders, const char* values)
+{
+	// Initialise variables
+	const float defaults[CART_NB_SESSION_PARAMS] = { CART_STIFFNESS_POS, CART_DAMPING_POS, CART_STIFFNESS_ROT,
+		                                             CART_DAMPING_ROT, CART_MAX_FORCE, CART_MAX_MOMENT, CART_FT_GAIN };
+	float params[CART_NB_SESSION_PARAMS];
+	int err = 0;
+
+	memcpy(params, defaults, sizeof(params));
+
+	if (values != NULL)
+	{
+		if (sscanf(values, "%f;%f;%f;%f;%f;%f;%f", &params[0], &params[1], &params[2], &params[3], &params[4],
+			       &params[5], &params[6]) != CART_NB_SESSION_PARAMS)
+		{
+			err = -1;
+		}
+		for (int k(0); k < CART_NB_SESSION_PARAMS - 1; k++)
+		{
+			if (params[k] < 0.0f || (k >= 4 && params[k] == 0.0f))
+			{
+				err = -1;
+			}
+		}
+	}
+	if (err != 0)
+	{
+		memcpy(params, defaults, sizeof(params));
+	}
+	cOrders->session_stiffness[0] = params[0];
+	cOrders->session_damping[0] = params[1];
+	cOrders->session_stiffness[1] = params[2];
+	cOrders->session_damping[1] = params[3];
+	cOrders->max_wrench[0] = params[4];
+	cOrders->max_wrench[1] = params[5];
+	cOrders->ft_gain = params[6];
+	return err;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| cart_InitImpedance - Set the target at the current wrist pose and the impedance of the session
+|
+| Syntax --
+|	void cart_InitImpedance(cartesianOrders* cOrders, const kin_State* state)
+|
+| Inputs --
+|	cartesianOrders* cOrders -> Cartesian orders to initialise
+|	const kin_State* state -> current wrist pose
+----------------------------------------------------------------------------------------------------------------------*/
+void cart_InitImpedance(cartesianOrders* cOrders, const kin_State* state)
+{
+	for (int k(0); k < 3; k++)
+	{
+		cOrders->target_position[k] = state->position[k];
+		cOrders->stiffness[k] = cOrders->session_stiffness[0];
+		cOrders->damping[k] = cOrders->session_damping[0];
+		cOrders->stiffness[3 + k] = cOrders->session_stiffness[1];
+		cOrders->damping[3 + k] = cOrders->session_damping[1];
+	}
+	for (int k(0); k < 9; k++)
+	{
+		cOrders->target_rotation[k] = state->rotation[k];
+	}
+	cOrders->target_set = 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| cart_ComputeImpedance - Compute the joint torques of the spring-damper between the wrist and the target pose
+|
+| Syntax --
+|	void cart_ComputeImpedance(AbleControlStruct* ctrl_ABLE, const kin_State* state, float* torques)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, Cartesian orders set
+|	const kin_State* state -> current wrist pose and Jacobian
+|	float* torques -> filled with the NB_MOTORS articular torques (N.m)
+|
+| Remarks --
+|	The orientation error is 1/2 sum(r_k x rd_k) over the axes of both frames (small angle approximation of the
+|	rotation vector, exact direction). The force and the moment are saturated in norm (cOrders->max_wrench).
+----------------------------------------------------------------------------------------------------------------------*/
+void cart_ComputeImpedance(AbleControlStruct* ctrl_ABLE, const kin_State* state, float* torques)
+{
+	// Extract substructs
+	cartesianOrders* cOrders = &ctrl_ABLE->aOrders.cartesian;
+
+	// Initialise variables
+	float twist[6], error[6], axis[3], target_axis[3], cross[3];
+	float norm, ratio;
+
+	cart_WristTwist(ctrl_ABLE, state, twist);
+
+	// Position and orientation errors
+	for (int k(0); k < 3; k++)
+	{
+		error[k] = cOrders->target_position[k] - state->position[k];
+		error[3 + k] = 0.0f;
+	}
+	for (int c(0); c < 3; c++)
+	{
+		for (int k(0); k < 3; k++)
+		{
+			axis[k] = state->rotation[3 * k + c];
+			target_axis[k] = cOrders->target_rotation[3 * k + c];
+		}
+		rnea_Cross(axis, target_axis, cross);
+		for (int k(0); k < 3; k++)
+		{
+			error[3 + k] += 0.5f * cross[k];
+		}
+	}
+
+	// Impedance wrench, saturated
+	for (int k(0); k < 6; k++)
+	{
+		cOrders->wrench[k] = cOrders->stiffness[k] * error[k] - cOrders->damping[k] * twist[k];
+	}
+	for (int part(0); part < 2; part++)
+	{
+		norm = sqrtf(cOrders->wrench[3 * part] * cOrders->wrench[3 * part] + cOrders->wrench[3 * part + 1]
+			         * cOrders->wrench[3 * part + 1] + cOrders->wrench[3 * part + 2] * cOrders->wrench[3 * part + 2]);
+		ratio = cOrders->max_wrench[part] / norm;
+		if (ratio < 1.0f)
+		{
+			for (int k(0); k < 3; k++)
+			{
+				cOrders->wrench[3 * part + k] *= ratio;
+			}
+		}
+	}
+	kin_JacobianTranspose(state, cOrders->wrench, torques);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| cart_WristTwist - Compute the linear and angular speeds of the wrist from the articular speeds
+|
+| Syntax --
+|	void cart_WristTwist(AbleControlStruct* ctrl_ABLE, const kin_State* state, float* twist)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, current motor speeds
+|	const kin_State* state -> current wrist pose and Jacobian
+|	float* twist -> filled with the linear (m/s) and angular (rad/s) speeds in the base frame
+----------------------------------------------------------------------------------------------------------------------*/
+void cart_WristTwist(AbleControlStruct* ctrl_ABLE, const kin_State* state, float* twist)
+{
+	// Extract substructs
+	const RobotState* axes = &ctrl_ABLE->state;
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+
+	// Initialise variables
+	float speeds[NB_MOTORS];
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		speeds[i] = axes->speed[i] * 2 * (float)M_PI / mValues->able_AxisReductions[i];
+	}
+	kin_JacobianProduct(state, speeds, twist);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| cart_WristTorques - Map the wrench measured by the wrist FT sensor into joint torques
+|
+| Syntax --
+|	void cart_WristTorques(AbleControlStruct* ctrl_ABLE, const kin_State* state, float* torques)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, last wrist FT measure
+|	const kin_State* state -> current wrist pose and Jacobian
+|	float* torques -> filled with the NB_MOTORS articular torques (N.m), 0 if the FT sensors are not used
+|
+| Remarks --
+|	The sensor frame is assumed aligned with the wrist frame and its origin at the wrist. The filtered wrench of the
+|	force stage is used, extrapolated to the state tick.
+----------------------------------------------------------------------------------------------------------------------*/
+void cart_WristTorques(AbleControlStruct* ctrl_ABLE, const kin_State* state, float* torques)
+{
+	// Extract substructs
+	received_FT_meas* ftValues_Wrist = &ctrl_ABLE->current_FT_meas_Wrist;
+
+	// Initialise variables
+	float wrench[6];
+
+	if (!ctrl_ABLE->rtParams.use_FT)
+	{
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			torques[i] = 0.0f;
+		}
+		return;
+	}
+	kin_RotateToBase(state, ftValues_Wrist->filtered, wrench);
+	kin_RotateToBase(state, ftValues_Wrist->filtered + 3, wrench + 3);
+	kin_JacobianTranspose(state, wrench, torques);
+}
@@ -0,0 +1,45 @@
+/***********************************************************************************************************************
+* cartesian_control.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the declaration of functions to achieve Cartesian impedance control of ABLE (CARTESIAN_CTRL) and to render
+* the haptic virtual scene at the wrist (HAPTIC_CTRL)
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef CARTESIAN_CONTROL_H
+#define CARTESIAN_CONTROL_H
+
+#include "communication_struct_ABLE.h"
+#include "utils_for_ABLE_Com.h"
+#include "data_recording_functions.h"
+#include "torque_control.h"
+#include "able_Kinematics.h"
+#include "haptic_scene.h"
+
+// Default impedance around the target pose, used when the session does not set it (argv[27])
+#define CART_STIFFNESS_POS 150.0f					// Translational stiffness (N/m)
+#define CART_DAMPING_POS 8.0f						// Translational damping (N.s/m)
+#define CART_STIFFNESS_ROT 2.0f						// Rotational stiffness (N.m/rad)
+#define CART_DAMPING_ROT 0.05f						// Rotational damping (N.m.s/rad)
+#define CART_MAX_FORCE 30.0f						// Saturation of the impedance force (N)
+#define CART_MAX_MOMENT 3.0f						// Saturation of the impedance moment (N.m)
+#define CART_FT_GAIN 0.0f							// Part of the wrist wrench added to the command (0 : no feedback)
+#define CART_NB_SESSION_PARAMS 7					// Stiffness and damping (pos, rot), saturations, FT gain
+
+// Cartesian control main functions
+void able_CartesianAsserv(ThreadInformations* ableInfos);
+void able_HapticAsserv(ThreadInformations* ableInfos);
+void cart_ApplyTorques(ThreadInformations* ableInfos, const float* compensation_torques, const float* torques);
+
+// Impedance computation
+int cart_SetSessionImpedance(cartesianOrders* cOrders, const char* values);
+void cart_InitImpedance(cartesianOrders* cOrders, const kin_State* state);
+void cart_ComputeImpedance(AbleControlStruct* ctrl_ABLE, const kin_State* state, float* torques);
+void cart_WristTwist(AbleControlStruct* ctrl_ABLE, const kin_State* state, float* twist);
+void cart_WristTorques(AbleControlStruct* ctrl_ABLE, const kin_State* state, float* torques);
+#endif // !CARTESIAN_CONTROL_H
\ No newline at end of file
@@ -15,8 +15,11 @@
 
 #include <vector>
 #include "low_level_command_1DoF_main.h"
+#include "emg_onset.h"
 
-#define PIPE_BUFFER_LENGTH 512		// Define length of the buffer for pipe communications
+#define NB_EMG_CHANNELS 4			// Number of EMG channels streamed (BB, BR, TBLoH, TBLaH)
+#define EMG_HISTORY 4096			// Number of EMG samples kept per channel (power of 2)
+#define QTM_RECV_FRAMES 64			// Number of frames the receive buffer can hold
 
 // -------------------------------------------------- SOCKET SUBSTRUCT -------------------------------------------------
 struct socketStruct
@@ -26,13 +29,42 @@ struct socketStruct
 	sockaddr_in recvAddr;         // Structure for connection
 };
 
-// --------------------------------------------------- PIPE SUBSTRUCT --------------------------------------------------
-struct pipeStruct
+// ------------------------------------------------- QTM/EMG FRAME STRUCT ----------------------------------------------
+// Binary frame sent by the Python script on the socket, little-endian : struct.pack("<HBBIQf4fI", ...)
+struct qtm_frame
 {
-	HANDLE readPipeCtrl;	// Handle of the read extremity of the pipe mastered by the control thread
-	HANDLE writePipeMeas;	// Handle of the write extremity of the pipe mastered by the qtm measures thread
-	int robot_activated;	// Int determining if the robot is still controlled by the control code 1 : YES; 0 : NO
-	int iter_counter;		// Number of iterations of the control thread
+	unsigned short magic;				// QTM_FRAME_MAGIC
+	unsigned char version;				// QTM_FRAME_VERSION
+	unsigned char flags;				// QTM_FRAME_SLIDER | QTM_FRAME_EMG
+	unsigned int sequence;				// Incremented by the sender at each frame
+	unsigned long long timestamp_us;	// Acquisition time given by the sender (us)
+	float slider_pos;					// Position of the slider (valid if QTM_FRAME_SLIDER)
+	float emg[NB_EMG_CHANNELS];			// BB, BR, TBLoH and TBLaH samples (valid if QTM_FRAME_EMG)
+	unsigned int reserved;				// Kept to 0
+};
+
+// ------------------------------------------------- STREAM STATE SUBSTRUCT --------------------------------------------
+struct streamStruct
+{
+	char buffer[QTM_RECV_FRAMES * sizeof(qtm_frame)];	// Bytes received and not decoded yet
+	int nb_buffered;									// Number of bytes in the buffer
+	unsigned int last_sequence;							// Sequence number of the last decoded frame
+	unsigned long long last_timestamp_us;				// Source timestamp of the last decoded frame
+	long long nb_frames;								// Number of decoded frames
+	long long nb_lost;									// Number of frames missing in the sequence
+	long long nb_late;									// Number of frames received out of order (dropped)
+	long long nb_skipped_bytes;							// Number of bytes skipped to find the start of a frame
+	long long last_arrival_tick;						// Reception tick of the last decoded frame (timebase_Now)
+	align_link clock;									// Drift of the sender clock against the common time base
+};
+
+// ------------------------------------------------- MAILBOX SUBSTRUCT -------------------------------------------------
+struct mailboxStruct
+{
+	qtm_mailbox* mailbox;					// Mailbox shared with the control thread
+	unsigned long long last_ctrl_version;	// Version of the last control state read
+	int robot_activated;					// Int determining if the robot is still controlled 1 : YES; 0 : NO
+	int iter_counter;						// Number of iterations of the control thread
 };
 
 // -------------------------------------------- QUALISYS MEASURES SUBSTRUCT --------------------------------------------
@@ -52,11 +84,14 @@ struct emgMeasures
 	int ping_TricepsBrachialLongH;
 	// Variable to send for TricepsBrachialLatH activation (0 : no activation detected, 1 : activation detected)
 	int ping_TricepsBrachialLatH;
-	// Store all passed values of EMG
-	std::vector<float> emg_BB;		// Vector stroring the EMG values of the Biceps Brachii
-	std::vector<float> emg_BR;		// Vector stroring the EMG values of the Brachio Radialis
-	std::vector<float> emg_TBLoH;	// Vector stroring the EMG values of the Triceps Brachial Long Head
-	std::vector<float> emg_TBLaH;	// Vector stroring the EMG values of the Triceps Brachial Lateral Head
+	// Ring of the last EMG samples (sample i is stored at index i % EMG_HISTORY)
+	float emg_values[NB_EMG_CHANNELS][EMG_HISTORY];		// Samples of BB, BR, TBLoH and TBLaH
+	unsigned long long emg_timestamps[EMG_HISTORY];		// Source timestamps of the samples (us)
+	long long emg_ticks[EMG_HISTORY];					// Reception ticks of the samples (timebase_Now)
+	long long nb_emg_samples;							// Number of samples received since the start
+	// Onset detection
+	emg_detector detector;								// Streaming onset detector of the four channels
+	int pending_onsets;									// Onsets detected since the last publication (bit i : channel i)
 };
 
 // --------------------------------------------- GLOBAL COMMUNICATION STRUCT -------------------------------------------
@@ -64,36 +99,13 @@ struct ComStruct
 {
 	// Definition of substruct containing the socket parameters to communicate with Python
 	socketStruct sockStruct;
-	// Communication pipes handles
-	pipeStruct pipeHandles;
-	// Definition of substruct containing the pipe parameters to communicate between threads (control/communication)
-	pipeStruct comPipeStruct;
+	// Decoding state of the binary stream received on the socket
+	streamStruct streamState;
+	// Definition of substruct containing the mailbox to communicate between threads (control/communication)
+	mailboxStruct comMailbox;
 	// Definition of substruct containing the qualisys measures to send to the control thread of ABLE
 	qualisysMeasures qualMeas;
 	// Definition of substruct containing the EMG measures to send to the control thread of ABLE
 	emgMeasures emgMeas;
 };
-
-// -------------------------------------------- RECEIVED COMMUNICATION STRUCT ------------------------------------------
-struct ReadStruct
-{
-	int iter_counter;
-	int robot_activated;
-	int mvt_ended;
-};
-
-// ------------------------------------------- TRANSMITTED COMMUNICATION STRUCT ----------------------------------------
-struct TransStruct
-{
-	// Current position of the slider to transmit
-	float s_pos;
-	// Variable to send for BicepsBrachial activation (0 : no activation detected, 1 : activation detected)
-	int ping_BB;
-	// Variable to send for BrachioRadialis activation (0 : no activation detected, 1 : activation detected)
-	int ping_BR;
-	// Variable to send for TricepsBrachialLongH activation (0 : no activation detected, 1 : activation detected)
-	int ping_TBLongH;
-	// Variable to send for TricepsBrachialLatH activation (0 : no activation detected, 1 : activation detected)
-	int ping_TBLatH;
-};
 #endif // !COMMUNICATION_STRUCT_H
\ No newline at end of file
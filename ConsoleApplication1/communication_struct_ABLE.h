@@ -38,6 +38,7 @@ struct ThreadInformations
 	FILE* ft_Wrist_sensor_file;
 	FILE* times_file;
 	FILE* times;
+	bool export_measures;	// True : whole session reached by recordValuesInFile, written by export_StartSession
 };
 
 #endif // !COMMUNICATION_STRUCT_ABLE_H
\ No newline at end of file
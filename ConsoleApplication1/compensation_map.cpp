@@ -0,0 +1,168 @@
+/***********************************************************************************************************************
+* compensation_map.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Tabulated compensation map. The grid is regular so that the cell of a point is found with one multiplication per
+* dimension, and the nodes are stored in a single contiguous array with theta3 varying fastest : the two nodes of a
+* cell along theta3 are adjacent and an evaluation reads four pairs of nodes. Points out of the grid are clamped to
+* its border and counted. The content of the nodes is filled by the model (see model_BuildMap).
+***********************************************************************************************************************/
+
+#include "compensation_map.h"
+
+/*---------------------------------------------------------------------------------------------------------------------
+| map_Allocate - Allocate the nodes of a map and set its grid
+|
+| Syntax --
+|	int map_Allocate(map_compensation* map, const int* nb_nodes, const float* min_value, const float* max_value)
+|
+| Inputs --
+|	map_compensation* map -> map to allocate
+|	const int* nb_nodes -> number of nodes along each dimension (at least 2)
+|	const float* min_value -> first node along each dimension
+|	const float* max_value -> last node along each dimension
+|
+| Outputs --
+|	int -> 0 : Success ; -1 : invalid grid
+----------------------------------------------------------------------------------------------------------------------*/
+int map_Allocate(map_compensation* map, const int* nb_nodes, const float* min_value, const float* max_value)
+{
+	// Initialise variables
+	size_t total_nodes = 1;
+
+	map->ready = 0;
+	for (int d(0); d < MAP_NB_DIMS; d++)
+	{
+		if (nb_nodes[d] < 2 || max_value[d] <= min_value[d])
+		{
+			return -1;
+		}
+		map->nb_nodes[d] = nb_nodes[d];
+		map->min_value[d] = min_value[d];
+		map->step[d] = (max_value[d] - min_value[d]) / (nb_nodes[d] - 1);
+		map->inv_step[d] = 1.0f / map->step[d];
+		total_nodes *= nb_nodes[d];
+	}
+	map->nodes.assign(total_nodes, map_Node());
+	map->nb_lookups = 0;
+	map->nb_clamped = 0;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| map_NodeAt - Access a node of the map
+|
+| Syntax --
+|	map_Node* map_NodeAt(map_compensation* map, int i_theta3, int i_theta4, int i_slider)
+|
+| Inputs --
+|	map_compensation* map -> allocated map
+|	int i_theta3, i_theta4, i_slider -> indexes of the node along each dimension
+|
+| Outputs --
+|	map_Node* -> node
+----------------------------------------------------------------------------------------------------------------------*/
+map_Node* map_NodeAt(map_compensation* map, int i_theta3, int i_theta4, int i_slider)
+{
+	return &map->nodes[((size_t)i_slider * map->nb_nodes[MAP_DIM_THETA4] + i_theta4) * map->nb_nodes[MAP_DIM_THETA3]
+		               + i_theta3];
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| map_Coordinate - Coordinate of a node along a dimension
+|
+| Syntax --
+|	float map_Coordinate(const map_compensation* map, int dim, int index)
+|
+| Inputs --
+|	const map_compensation* map -> allocated map
+|	int dim -> dimension (MAP_DIM_THETA3, MAP_DIM_THETA4 or MAP_DIM_SLIDER)
+|	int index -> index of the node along this dimension
+|
+| Outputs --
+|	float -> coordinate of the node
+----------------------------------------------------------------------------------------------------------------------*/
+float map_Coordinate(const map_compensation* map, int dim, int index)
+{
+	return map->min_value[dim] + index * map->step[dim];
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| map_Lookup - Evaluate the terms of the map at a point by trilinear interpolation
+|
+| Syntax --
+|	void map_Lookup(map_compensation* map, float theta3, float theta4, float x_slider, map_Node* terms)
+|
+| Inputs --
+|	map_compensation* map -> built map
+|	float theta3, theta4 -> articular positions of axes 3 and 4 (rad)
+|	float x_slider -> position of the slider (m)
+|	map_Node* terms -> filled with the interpolated terms
+----------------------------------------------------------------------------------------------------------------------*/
+void map_Lookup(map_compensation* map, float theta3, float theta4, float x_slider, map_Node* terms)
+{
+	// Initialise variables
+	float point[MAP_NB_DIMS] = { theta3, theta4, x_slider };
+	float weight[MAP_NB_DIMS], position, w0, w1;
+	int cell[MAP_NB_DIMS];
+	int clamped = 0;
+	size_t stride_4 = map->nb_nodes[MAP_DIM_THETA3];
+	size_t stride_s = stride_4 * map->nb_nodes[MAP_DIM_THETA4];
+	const map_Node* base;
+	const map_Node* n00;
+	const map_Node* n10;
+	const map_Node* n01;
+	const map_Node* n11;
+	float g3[2], g4[2], c4[2];
+
+	// Cell and position in the cell along each dimension
+	for (int d(0); d < MAP_NB_DIMS; d++)
+	{
+		position = (point[d] - map->min_value[d]) * map->inv_step[d];
+		// A NaN position fails every comparison : it is clamped to the first node, never converted to a cell
+		if (!(position >= 0.0f))
+		{
+			position = 0.0f;
+			clamped = 1;
+		}
+		else if (position > (float)(map->nb_nodes[d] - 1)) {
+			position = (float)(map->nb_nodes[d] - 1);
+			clamped = 1;
+		}
+		cell[d] = (int)position;
+		if (cell[d] > map->nb_nodes[d] - 2)
+		{
+			cell[d] = map->nb_nodes[d] - 2;
+		}
+		weight[d] = position - cell[d];
+	}
+	map->nb_lookups++;
+	map->nb_clamped += clamped;
+
+	// Interpolate along theta3 then theta4 for both slider planes
+	base = &map->nodes[cell[MAP_DIM_SLIDER] * stride_s + cell[MAP_DIM_THETA4] * stride_4 + cell[MAP_DIM_THETA3]];
+	w1 = weight[MAP_DIM_THETA3];
+	w0 = 1.0f - w1;
+	for (int k(0); k < 2; k++)
+	{
+		n00 = base + k * stride_s;
+		n10 = n00 + 1;
+		n01 = n00 + stride_4;
+		n11 = n01 + 1;
+		g3[k] = (w0 * n00->gravity3 + w1 * n10->gravity3) * (1.0f - weight[MAP_DIM_THETA4])
+			  + (w0 * n01->gravity3 + w1 * n11->gravity3) * weight[MAP_DIM_THETA4];
+		g4[k] = (w0 * n00->gravity4 + w1 * n10->gravity4) * (1.0f - weight[MAP_DIM_THETA4])
+			  + (w0 * n01->gravity4 + w1 * n11->gravity4) * weight[MAP_DIM_THETA4];
+		c4[k] = (w0 * n00->coriolis4 + w1 * n10->coriolis4) * (1.0f - weight[MAP_DIM_THETA4])
+			  + (w0 * n01->coriolis4 + w1 * n11->coriolis4) * weight[MAP_DIM_THETA4];
+	}
+
+	// Interpolate along x_slider
+	terms->gravity3 = g3[0] + (g3[1] - g3[0]) * weight[MAP_DIM_SLIDER];
+	terms->gravity4 = g4[0] + (g4[1] - g4[0]) * weight[MAP_DIM_SLIDER];
+	terms->coriolis4 = c4[0] + (c4[1] - c4[0]) * weight[MAP_DIM_SLIDER];
+	terms->unused = 0.0f;
+}
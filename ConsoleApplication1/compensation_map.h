@@ -0,0 +1,55 @@
+/***********************************************************************************************************************
+* compensation_map.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the declaration of the tabulated compensation map : terms of the dynamic model precomputed over a regular
+* (theta3, theta4, x_slider) grid and evaluated by trilinear interpolation.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef COMPENSATION_MAP_H
+#define COMPENSATION_MAP_H
+
+// General includes
+#include <stddef.h>
+#include <vector>
+
+// Map constants
+#define MAP_NB_DIMS 3									// theta3, theta4, x_slider
+#define MAP_DIM_THETA3 0
+#define MAP_DIM_THETA4 1
+#define MAP_DIM_SLIDER 2
+
+// ---------------------------------------------------- NODE STRUCT ----------------------------------------------------
+// Position dependent terms at a node of the grid (16 bytes, four nodes per cache line)
+struct map_Node
+{
+	float gravity3;							// Gravity torque of axis 3, articular side (N.m)
+	float gravity4;							// Gravity torque of axis 4, articular side (N.m)
+	float coriolis4;						// Position factor of the Coriolis torque of axis 4 (kg.m)
+	float unused;							// Padding
+};
+
+// ----------------------------------------------------- MAP STRUCT ----------------------------------------------------
+struct map_compensation
+{
+	int ready;								// 1 : map built and usable, 0 : not built
+	int nb_nodes[MAP_NB_DIMS];				// Number of nodes along each dimension
+	float min_value[MAP_NB_DIMS];			// First node along each dimension
+	float step[MAP_NB_DIMS];				// Distance between two nodes along each dimension
+	float inv_step[MAP_NB_DIMS];			// Inverse of the step
+	std::vector<map_Node> nodes;			// Nodes, theta3 varying fastest then theta4 then x_slider
+	long long nb_lookups;					// Number of evaluations
+	long long nb_clamped;					// Number of evaluations out of the grid or NaN (clamped to its border)
+};
+
+// Functions declaration
+int map_Allocate(map_compensation* map, const int* nb_nodes, const float* min_value, const float* max_value);
+map_Node* map_NodeAt(map_compensation* map, int i_theta3, int i_theta4, int i_slider);
+float map_Coordinate(const map_compensation* map, int dim, int index);
+void map_Lookup(map_compensation* map, float theta3, float theta4, float x_slider, map_Node* terms);
+#endif // !COMPENSATION_MAP_H
\ No newline at end of file
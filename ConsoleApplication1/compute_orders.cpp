@@ -9,10 +9,13 @@
 ***********************************************************************************************************************/
 
 #include "compute_orders.h"
-#include <string>
 
 using namespace std;
 
+// Successive axial positions for dynamic identification (640 kB), only used to build dynamicOrdersIdAll before the
+// motions : kept out of the control struct
+static float dynamicOrdersId[NB_MOTORS][NB_MEASURES_DYNAMIC_ID];
+
 /*---------------------------------------------------------------------------------------------------------------------
 | initializationOrdersComputation - Initialize orders according to command mode
 |
@@ -74,7 +77,7 @@ void setIdentificationOrders(FILE* err_file, FILE* out_file, AbleControlStruct*
 	{
 		// Initialize minimum jerk counters
 		rtValues->current_minJerkMove = 0;
-		rtValues->current_posMinJerk = 0;
+		rtValues->current_timeMinJerk = 0.0f;
 		rtValues->jerkMove_startReached = FALSE;
 		rtValues->jerkMove_goStart = FALSE;
 		rtValues->jerkMove_started = FALSE;
@@ -99,7 +102,7 @@ void setGoHomeOrders(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABL
 	// Variables declaration
 	float art_theta_i, pos_dif;
 	// Extract substructs
-	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+	RobotState* state = &ctrl_ABLE->state;
 	motorsParams* mValues = &ctrl_ABLE->mParams;
 	ableOrders* oValues = &ctrl_ABLE->aOrders;
 
@@ -109,17 +112,17 @@ void setGoHomeOrders(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABL
 		// Set articular position order (home)
 		oValues->positionOrder[i] = 0.0f;
 		// Compute current position and motion sign
-		art_theta_i = able_ComputeCurrentPosition(rtValues->currentCoderPosition[i], mValues->able_AxisReductions[i]);
+		art_theta_i = able_ComputeCurrentPosition(state->coder[i], mValues->able_AxisReductions[i]);
 
 		oValues->positionCoderOrder[i] = oValues->positionOrder[i] * mValues->able_AxisReductions[i];
 		// Update position and speed order
-		rtValues->currentPosition[i] = art_theta_i;
+		state->position[i] = art_theta_i;
 		// Compute diference in articular position
 		pos_dif = oValues->positionOrder[i] - art_theta_i;
 		// Compute speed order based on position diference
 		oValues->speedOrder[i] = (float)(mValues->Kp_P[i] * pos_dif);
 		// Print current position in out file
-		fprintf(out_file, "Theta %i : %f\n", i + 1, rtValues->currentPosition[i]);
+		fprintf(out_file, "Theta %i : %f\n", i + 1, state->position[i]);
 	}
 }
 
@@ -224,17 +227,21 @@ void computeDynIdentOrders(FILE* err_file, FILE* out_file, AbleControlStruct* ct
 	ableOrders* oValues = &ctrl_ABLE->aOrders;
 	realTimeParams* rtParams = &ctrl_ABLE->rtParams;
 
-	// Define number of iterations
+	// Define number of orders of the table (sampled at DYN_IDENT_PERIOD)
+	int nb_orders = 0;
 	if (mValues->nb_activated_motors == 1) {
-		rtParams->nb_iterations_dyn_ident = NB_MEASURES_DYNAMIC_ID + 10000;
+		nb_orders = NB_MEASURES_DYNAMIC_ID;
 	} else if (mValues->nb_activated_motors == 2) {
-		rtParams->nb_iterations_dyn_ident = NB_MEASURES_DYNAMIC_ID * COMBINATIONS_2MOTORS + 10000;
+		nb_orders = NB_MEASURES_DYNAMIC_ID * COMBINATIONS_2MOTORS;
 	} else if(mValues->nb_activated_motors == 3) {
-		rtParams->nb_iterations_dyn_ident = NB_MEASURES_DYNAMIC_ID * COMBINATIONS_3MOTORS + 10000;
+		nb_orders = NB_MEASURES_DYNAMIC_ID * COMBINATIONS_3MOTORS;
 	} else if(mValues->nb_activated_motors == 4) {
-		rtParams->nb_iterations_dyn_ident = NB_MEASURES_DYNAMIC_ID * COMBINATIONS_4MOTORS + 10000;
+		nb_orders = NB_MEASURES_DYNAMIC_ID * COMBINATIONS_4MOTORS;
 	}
-	
+	// Convert the duration of the identification into iterations of the control loop
+	rtParams->nb_iterations_dyn_ident = (int)(((float)nb_orders * DYN_IDENT_PERIOD + DYN_IDENT_END_TIME)
+		                                      / rtParams->sampling_frequency + 0.5f);
+
 
 	// Compute successive positions according to the identification phase for each activated axis
 	for (int i(0); i < NB_MOTORS; i++)
@@ -247,10 +254,10 @@ void computeDynIdentOrders(FILE* err_file, FILE* out_file, AbleControlStruct* ct
 
 			for (int j(0); j < NB_MEASURES_DYNAMIC_ID; j++)
 			{
-				oValues->dynamicOrdersId[i][j] = mid_position
-					                           + oValues->amplitude / 3
-											   * sinf(oValues->omega.at(j) * 0.001f * ((float)j + (float)i * (float)j / NB_MEASURES_DYNAMIC_ID));
-				//fprintf(out_file, "Axis %i order %f\n", i, oValues->dynamicOrdersId[i][j]);
+				dynamicOrdersId[i][j] = mid_position
+					                  + oValues->amplitude / 3
+					                  * sinf(oValues->omega.at(j) * DYN_IDENT_PERIOD * ((float)j + (float)i * (float)j / NB_MEASURES_DYNAMIC_ID));
+				//fprintf(out_file, "Axis %i order %f\n", i, dynamicOrdersId[i][j]);
 			}
 			mValues->activated_motors.push_back(i);
 		}
@@ -380,7 +387,7 @@ void fillDynamicOrdersTable(FILE* out_file, AbleControlStruct* ctrl_ABLE)
 		// Fill orders
 		for (int i(0); i < NB_MEASURES_DYNAMIC_ID; i++)
 		{
-			oValues->dynamicOrdersIdAll[activated_motor].push_back(oValues->dynamicOrdersId[activated_motor][i]);
+			oValues->dynamicOrdersIdAll[activated_motor].push_back(dynamicOrdersId[activated_motor][i]);
 		}
 	}
 	else if (mValues->nb_activated_motors == 2) {
@@ -400,7 +407,7 @@ void fillDynamicOrdersTable(FILE* out_file, AbleControlStruct* ctrl_ABLE)
 						motor_found = 1;
 						for (int l(0); l < NB_MEASURES_DYNAMIC_ID; l++)
 						{
-							oValues->dynamicOrdersIdAll[current_motor].push_back(oValues->dynamicOrdersId[current_motor][l]);
+							oValues->dynamicOrdersIdAll[current_motor].push_back(dynamicOrdersId[current_motor][l]);
 							
 						}
 					}
@@ -434,7 +441,7 @@ void fillDynamicOrdersTable(FILE* out_file, AbleControlStruct* ctrl_ABLE)
 						motor_found = 1;
 						for (int l(0); l < NB_MEASURES_DYNAMIC_ID; l++)
 						{
-							oValues->dynamicOrdersIdAll[current_motor].push_back(oValues->dynamicOrdersId[current_motor][l]);
+							oValues->dynamicOrdersIdAll[current_motor].push_back(dynamicOrdersId[current_motor][l]);
 						}
 					}
 				}
@@ -466,7 +473,7 @@ void fillDynamicOrdersTable(FILE* out_file, AbleControlStruct* ctrl_ABLE)
 						motor_found = 1;
 						for (int l(0); l < NB_MEASURES_DYNAMIC_ID; l++)
 						{
-							oValues->dynamicOrdersIdAll[current_motor].push_back(oValues->dynamicOrdersId[current_motor][l]);
+							oValues->dynamicOrdersIdAll[current_motor].push_back(dynamicOrdersId[current_motor][l]);
 						}
 					}
 				}
@@ -488,97 +495,30 @@ void fillDynamicOrdersTable(FILE* out_file, AbleControlStruct* ctrl_ABLE)
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
-| extractJerkPositions - Extract all pre-computed minimum jerk trajectories
+| extractJerkPositions - Load the minimum jerk block (moves, order and repetitions) from a descriptor or a legacy file
 |
 | Syntax --
-|	void extractJerkPositions(FILE* err_file, AbleControlStruct* ctrl_ABLE)
+|	int extractJerkPositions(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, const char* file_name)
 |
 | Inputs --
 |	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
 |	AbleControlStruct* ctrl_ABLE -> Struct containing all ABLE's informations
-----------------------------------------------------------------------------------------------------------------------*/
-void extractJerkPositions(FILE* err_file, AbleControlStruct* ctrl_ABLE)
-{
-	// Initialize parsing variables
-	string line;
-	string delimiter = ";";
-	size_t position = 0, size;
-	string token;
-	float pos_i;
-	int i = 0;
-	// Extract data
-	if (ctrl_ABLE->minJerk.minjerk_file.is_open())
-	{
-		while (getline(ctrl_ABLE->minJerk.minjerk_file, line))
-		{
-			while ((position = line.find(delimiter)) != string::npos)
-			{
-				token = line.substr(0, position);
-				pos_i = stof(token, &size);
-				line.erase(0, position + delimiter.length());
-				ctrl_ABLE->minJerk.parsed_movements[i].push_back(pos_i);
-			}
-			i++;
-		}
-		duplicateJerkPositions(ctrl_ABLE);
-		ctrl_ABLE->minJerk.minjerk_file.close();
-		ctrl_ABLE->rtParams.robot_stopAfterTrajs = FALSE;
-	}
-	else
-	{
-		fprintf(err_file, "File containing minimum jerk trajectories not opened !\n");
-	}
-}
-
-/*---------------------------------------------------------------------------------------------------------------------
-| duplicateJerkPositions - Duplicate all pre-computed minimum jerk trajectories for control
+|	const char* file_name -> name of the block descriptor or of the legacy trajectories file
 |
-| Syntax --
-|	void duplicateJerkPositions(AbleControlStruct* ctrl_ABLE)
-|
-| Inputs --
-|	AbleControlStruct* ctrl_ABLE -> Struct containing all ABLE's informations
+| Outputs --
+|	int -> 0 : Success ; 1 : Block not loaded (no move to execute, the session must not start)
 ----------------------------------------------------------------------------------------------------------------------*/
-void duplicateJerkPositions(AbleControlStruct* ctrl_ABLE)
+int extractJerkPositions(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, const char* file_name)
 {
-	// Extract substruct
-	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
-	// Duplicate data
-	for (int i(0); i < NB_JERK_TRAJS / 2; i++)
+	// Extract data
+	if (minjerk_LoadBlock(err_file, out_file, &ctrl_ABLE->minJerk, file_name, ctrl_ABLE->rtParams.jerkFamiliarisation) != 0
+		|| ctrl_ABLE->minJerk.nb_blockMoves <= 0)
 	{
-		if (!rtValues->jerkFamiliarisation)
-		{
-			for (int j(2 * NB_REP * i); j < 2 * NB_REP * (i + 1); j++)
-			{
-				ctrl_ABLE->minJerk.all_Jmoves[j].resize(ctrl_ABLE->minJerk.parsed_movements[2 * i].size());
-				if (j % 2 == 0)
-				{
-					copy(ctrl_ABLE->minJerk.parsed_movements[2 * i].begin(),
-						ctrl_ABLE->minJerk.parsed_movements[2 * i].end(),
-						ctrl_ABLE->minJerk.all_Jmoves[j].begin());
-				}
-				else {
-					copy(ctrl_ABLE->minJerk.parsed_movements[2 * i + 1].begin(),
-						ctrl_ABLE->minJerk.parsed_movements[2 * i + 1].end(),
-						ctrl_ABLE->minJerk.all_Jmoves[j].begin());
-				}
-			}
-		} else if (rtValues->jerkFamiliarisation) {
-			for (int j(2 * NB_REP_FAM * i); j < 2 * NB_REP_FAM * (i + 1); j++)
-			{
-				ctrl_ABLE->minJerk.all_JmovesFam[j].resize(ctrl_ABLE->minJerk.parsed_movements[2 * i].size());
-				if (j % 2 == 0)
-				{
-					copy(ctrl_ABLE->minJerk.parsed_movements[2 * i].begin(),
-						ctrl_ABLE->minJerk.parsed_movements[2 * i].end(),
-						ctrl_ABLE->minJerk.all_JmovesFam[j].begin());
-				}
-				else {
-					copy(ctrl_ABLE->minJerk.parsed_movements[2 * i + 1].begin(),
-						ctrl_ABLE->minJerk.parsed_movements[2 * i + 1].end(),
-						ctrl_ABLE->minJerk.all_JmovesFam[j].begin());
-				}
-			}
-		}
+		fprintf(err_file, "Minimum jerk trajectories not extracted !\n");
+		return 1;
 	}
+	fprintf(out_file, "Minimum jerk block : %i moves to execute\n", ctrl_ABLE->minJerk.nb_blockMoves);
+	ctrl_ABLE->rtParams.robot_stopAfterTrajs = FALSE;
+	return 0;
 }
\ No newline at end of file
@@ -21,6 +21,7 @@
 
 #include "control_struct.h"			// Header containing the full declaration of the control struct
 #include "handle_communication.h"	// Header of the code containing the functions to communicate with ABLE
+#include "minjerk_trajectories.h"	// Header of the minimum jerk trajectories evaluation
 
 // Initialisation of orders function
 void initializationOrdersComputation(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE);
@@ -36,8 +37,6 @@ void targetsComputationGeomID_1DoF(AbleControlStruct* ctrl_ABLE);
 void computeDynIdentOrders(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE);
 void generateMotorCombinations(FILE* out_file, AbleControlStruct* ctrl_ABLE);
 void fillDynamicOrdersTable(FILE* out_file, AbleControlStruct* ctrl_ABLE);
-// Extract pre-computed minimum jerk trajectories
-void extractJerkPositions(FILE* err_file, AbleControlStruct* ctrl_ABLE);
-// Duplicate all pre-computed minimum jerk trajectories for control
-void duplicateJerkPositions(AbleControlStruct* ctrl_ABLE);
+// Load minimum jerk block
+int extractJerkPositions(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, const char* file_name);
 #endif // !LOW_LEVEL_COMMAND_1DOF_MAIN_H
\ No newline at end of file
@@ -21,6 +21,12 @@
 #include <Windows.h>
 
 #include "shared_FT_struct.h"		// Header containing the shared FT measures struct definition
+#include "qtm_mailbox.h"			// Header containing the mailbox shared with the QTM measures thread
+#include "slider_estimator.h"		// Header containing the estimator of the slider position
+#include "stream_alignment.h"		// Header containing the common time base and the streams statistics
+#include "compensation_map.h"		// Header containing the tabulated compensation map
+#include "haptic_scene.h"			// Header containing the haptic virtual scene
+#include "session_storage.h"			// Header containing the allocator of the session buffers
 
 using namespace std;
 
@@ -35,16 +41,28 @@ using namespace std;
 #define NB_MEASURES_GEOM_ID 20							// Number of target for static identification
 #define NB_MEASURES_SPEED_ID 5							// Number of speeds for constant speed identification
 #define NB_MEASURES_DYNAMIC_ID 40000					// Number of successive measures for dynamic identification
+#define DYN_IDENT_PERIOD 0.001f							// Period of the dynamic identification orders table (s)
+#define DYN_IDENT_END_TIME 10.0f						// Time added after the dynamic identification orders (s)
 #define IDENT_NOT_SPLITED_DATA 0                        // Not-splited data identification method
 #define IDENT_SPLITED_DATA 1                            // Splited data identification method
 #define END_WAIT 5										// Waiting time at the end of movement (s)
 #define NB_JERK_TRAJS 4									// Number of jerk trajectories to extract
 #define NB_REP_FAM 2									// Number of repetions of each jerk traj for familiarisation
 #define NB_REP 15										// Number of repetions of each jerk traj
-#define NB_MEASURES_FATIGUE_TEST 10000					// Number of measures for fatigue tests at the end of jerk trajectories
+#define MAX_JERK_MOVES 16								// Maximum number of distinct jerk moves in a block descriptor
+#define MAX_JERK_SEGMENTS 16							// Maximum number of segments in a block descriptor
+#define MAX_JERK_SEQUENCE 255							// Maximum number of jerk moves executed during a block
+#define FATIGUE_TEST_DURATION 10.0f						// Duration of each force of the fatigue tests at the end of jerk trajectories (s)
 #define FORCE_FATIGUE_TEST 15.0f						// Constant force to apply during fatigue tests
-#define DELAYFORCEFATIGUE 2000							// Number of iterations at home position before launching the test
-#define DELAYROBSTOP 2000
+#define DELAYFORCEFATIGUE 2.0f							// Time at home position before launching the test (s)
+#define DELAYROBSTOP 2.0f								// Time before stopping the robot at the end of the block (s)
+#define SPEED_LIMIT_TIME 6.0f							// Time during which the speed of torque control is limited (s)
+#define CHECK_TARGET_TIME_STATIC 2.5f					// Time between order state checks, static identification (s)
+#define CHECK_TARGET_TIME_HDYN 5.0f						// Time between order state checks, human identification (s)
+#define CHECK_TARGET_TIME 0.5f							// Time between order state checks, other controls (s)
+#define CTRL_DEFAULT_RATE 1000.0f						// Default rate of the control loop (Hz)
+#define CTRL_MIN_RATE 500.0f							// Lowest rate of the control loop (Hz)
+#define CTRL_MAX_RATE 4000.0f							// Highest rate of the control loop (Hz)
 #define SIZE_VECS 3000000
 #define NB_ANG_LEVELS 29
 // Define all different control possibilities
@@ -56,16 +74,51 @@ using namespace std;
 #define HDYN_IDENT 5
 #define MINJERK_TRAJS 6
 #define OSCILLATOR_CTRL 7
+#define MODEL_BENCH 8
+#define CARTESIAN_CTRL 9
+#define HAPTIC_CTRL 10
+#define BATCH_SIM 11
+#define FAULT_SIM 12
 // Define combination numbers
 #define COMBINATIONS_2MOTORS 3
 #define COMBINATIONS_3MOTORS 7
 #define COMBINATIONS_4MOTORS 15
 
-// ------------------------------------------------- QTM PIPE SUBSTRUCT ------------------------------------------------
-struct pipeStructQTMRead
+// ------------------------------------------------- QTM INPUT SUBSTRUCT -----------------------------------------------
+// Values read from the mailbox during one iteration (qtm_PollMailbox), applied by qtm_ApplyInput
+struct qtm_input
 {
-	HANDLE writePipeCtrl;	// Handle of the write extremity of the pipe mastered by the control thread
-	HANDLE readPipeMeas;	// Handle of the read extremity of the pipe mastered by the qtm measures thread
+	int polled;								// 1 : mailbox read during the iteration
+	int meas_status;						// MAILBOX_NEW, MAILBOX_SAME, MAILBOX_EMPTY or MAILBOX_BUSY
+	qtm_measSample sample;					// Measures read (MAILBOX_NEW)
+	long long age_us;						// Age of the measures read (us)
+	int pings[NB_EMG_MUSCLES];				// 1 : muscle activated since the previous iteration
+	int nb_events;							// Number of EMG events popped
+	long long last_latency_us;				// Latency of the last event popped (us)
+	long long max_latency_us;				// Largest latency of the events popped (us)
+};
+
+// ------------------------------------------------- QTM LINK SUBSTRUCT ------------------------------------------------
+struct qtmLinkStruct
+{
+	qtm_input input;						// Values read from the mailbox during the current iteration
+	qtm_mailbox* mailbox;					// Mailbox shared with the qtm measures thread
+	unsigned long long last_meas_version;	// Version of the last measures read
+	long long sample_age_us;				// Age of the last measures read (us)
+	long long nb_stale_reads;				// Number of reads older than QTM_MAX_STALENESS_US (not applied)
+	long long max_ping_latency_us;			// Largest latency of an EMG ping (us)
+	long long last_arrival_tick;			// Reception tick of the last measures read (timebase_Now)
+};
+
+// ------------------------------------------------- TIMING SUBSTRUCT --------------------------------------------------
+// Live latency and drift of the streams against the common time base
+struct timingStruct
+{
+	align_link drive;						// Drive state frames : clock against the nominal period
+	align_link ft_arm;						// Arm FT samples : latency between acquisition and use
+	align_link ft_wrist;					// Wrist FT samples : latency between acquisition and use
+	align_link qtm;							// QTM measures : latency between reception and use
+	storage_Faults faults;					// Page faults taken during each iteration of the control loop
 };
 
 // -------------------------------------------- MOTORS' PARAMETERS SUBSTRUCT -------------------------------------------
@@ -95,6 +148,24 @@ struct motorsParams
 	std::vector<int> motors_combinations4[15];
 };
 
+// ------------------------------------------------ CARTESIAN ORDERS ---------------------------------------------------
+// Impedance around a target wrist pose (CARTESIAN_CTRL), in the base frame. HAPTIC_CTRL stores the rendered force.
+struct cartesianOrders
+{
+	int target_set;												// 1 : target and impedance set, 0 : set at next iteration
+	float target_position[3];									// Target position of the wrist (m)
+	float target_rotation[9];									// Target orientation of the wrist (row-major)
+	float stiffness[6];											// Stiffness along x, y, z (N/m) and about x, y, z (N.m/rad)
+	float damping[6];											// Damping along x, y, z (N.s/m) and about x, y, z (N.m.s/rad)
+	float wrench[6];											// Last impedance force (N) and moment (N.m)
+	float ft_torques[NB_MOTORS];								// Last wrist FT wrench mapped into joint torques (N.m)
+	// Impedance set by the session (cart_SetSessionImpedance), applied when the target is set
+	float session_stiffness[2];									// Translational (N/m) and rotational (N.m/rad) stiffness
+	float session_damping[2];									// Translational (N.s/m) and rotational (N.m.s/rad) damping
+	float max_wrench[2];										// Saturation of the impedance force (N) and moment (N.m)
+	float ft_gain;												// Part of the wrist wrench added to the command
+};
+
 // ------------------------------------------------- ORDERS PARAMETERS -------------------------------------------------
 struct ableOrders
 {
@@ -111,12 +182,12 @@ struct ableOrders
 	float speedOrder[NB_VALUES_TO_SEND];						// Table containing speed order to send to ABLE
 	float currentOrder[NB_VALUES_TO_SEND];						// Table containing current order to send to ABLE (not enabled)
 	float positionOrdersDoF[NB_MOTORS][NB_MEASURES_GEOM_ID];	// Table of successive positions for geometrical identification
-	float dynamicOrdersId[NB_MOTORS][NB_MEASURES_DYNAMIC_ID];	// Table of successive axial positions for dynamic identification
 	std::vector<float> dynamicOrdersIdAll[NB_MOTORS];			// Table of successive positions arranged for dynamic identification
 	// Dynamic identification properties (dtheta(t)/dt = amplitude*omega*sin(omega*t))
 	std::vector<float> omega;									// Pulsation of the speed command law
 	float amplitude;											// Amplitude of the speed command law
 	float angular_levels[NB_ANG_LEVELS];
+	cartesianOrders cartesian;									// Cartesian impedance orders
 };
 
 // ------------------------------------------- IDENTIFIED DYNAMICS SUBSTRUCTS ------------------------------------------
@@ -128,29 +199,31 @@ struct frictions
 	float visc_frics[2];			// Viscous friction coefficients for both movements directions
 };
 
-// Substruct containing identified inertias (-> inertia not compensated by model while no intention detection)
+// Substruct containing identified inertias (compensated by the RNEA backend only, MODEL_BACKEND_RNEA)
 struct inertias
 {
-	float inertia_model[3];			// Inertia model (dependant of x_slider)
+	float inertia_model[3];			// Inertia about the joint axis : [0] + [1] x_slider + [2] x_slider^2 (kg.m^2)
 };
 
 // ---------------------------------------- IDENTIFIED AXIS DYNAMICS SUBSTRUCTS ----------------------------------------
-// Dynamic parameters of ABLE third axis (inertia identified but not compensated)
+// Dynamic parameters of ABLE third axis
 struct able_Axis3_model
 {
 	float length3;							// Identified  length of ABlE third axis
 	frictions frictions3;					// Identified frictions parameters for ABLE third axis
+	inertias inertias3;						// Identified inertia of ABLE third axis (without the fourth axis)
 	float gm_stat[2];						// Identified gravity model of axis 3 if speed = 0 (independant of x_slider)
 	float gm_top[2];						// Identified gravity model of axis 3 if speed < 0 (independant of x_slider)
 	float gm_bot[2];						// Identified gravity model of axis 3 if speed > 0 (independant of x_slider)
 };
 
-// Dynamic parameters of ABLE fourth axis (inertia identified but not compensated)
+// Dynamic parameters of ABLE fourth axis
 struct able_Axis4_model
 {
 	float mass4;							// Identified mass of ABLE fourth axis
-	float x_slider;							// Position of the slider (TODO : add extern measures for real-time estimation)
+	float x_slider;							// Position of the slider (estimated at each iteration by sliderEst)
 	frictions frictions4;					// Identified frictions parameters for ABLE fourth axis
+	inertias inertias4;						// Identified inertia of ABLE fourth axis
 	float cm_stat[3];						// Identified CM position of axis 4 if speed = 0 (dependant of x_slider)
 	float cm_top[3];						// Identified CM position of axis 4 if speed < 0 (dependant of x_slider)
 	float cm_bot[3];						// Identified CM position of axis 4 if speed > 0 (dependant of x_slider)
@@ -161,6 +234,7 @@ struct ableDynamics
 {
 	able_Axis3_model axis3_mod;				// Identified model of ABLE third axis
 	able_Axis4_model axis4_mod;				// Identified model of ABLE fourth axis
+	float rotor_inertias[NB_MOTORS];		// Inertias of the motors and gearboxes, articular side (kg.m^2)
 };
 
 // ------------------------------------------- REAL TIME PARAMETERS SUBSTRUCTS -----------------------------------------
@@ -168,26 +242,33 @@ struct realTimeParams
 {
 	bool able_Connected;	                    // false : disconnected, true : connected
 	int friction_comp;                          // 1 : friction compensated, 0 : friction not compensated
-	float sampling_frequency;					// Frequency at which orders are sent to ABLE
+	float sampling_frequency;					// Nominal period at which orders are sent to ABLE (s)
+	float ctrl_rate;							// Rate of the control loop (Hz), 1 / sampling_frequency
+	int placement_level;						// Placement of the real time threads (PLACEMENT_NONE to PLACEMENT_FULL)
+	int track_allocs;							// 1 : allocations made during the control cycles are recorded
+	int replay_mode;							// REPLAY_OFF, REPLAY_CAPTURE or REPLAY_PLAY (session_replay.h)
+	double elapsed_time;						// Time since the start of the control loop (s), sum of cycle_dt
+	long long state_tick;						// Tick of the last drive state frame (timebase_Now)
+	float cycle_dt;								// Measured time between the two last state frames (s)
+	int model_backend;							// Evaluation of the dynamic model (MODEL_BACKEND_ANALYTIC, _MAP or _RNEA)
 	bool able_RealTimeCommand;					// true : Real time command allowed; false : not allowed
 	bool able_OrderNotTransmitted;				// true : Error in order transmission; false : transmission OK
-	int currentCoderPosition[NB_MOTORS];		// Table containing real time measured positions of coders
 	float oldPosition[NB_MOTORS];				// Table containing an old position to check order termination
-	float currentPosition[NB_MOTORS];			// Table containing real time computed positions
-	float currentSpeed[NB_MOTORS];				// Table containing real time measured speed
-	float currentVoltage[NB_MOTORS];			// Table containing real time measured voltage
-	float currentADCcurrent[NB_MOTORS];			// Table containing real time measured ADC current
+	float previousArtSpeed[NB_MOTORS];			// Articular speeds of the previous iteration (rad/s)
+	float artAcceleration[NB_MOTORS];			// Filtered articular accelerations (rad/s^2)
+	int acc_initialised;						// 1 : previousArtSpeed valid, 0 : first iteration
 	int able_CheckTargetReachedNbIt;			// Number of iterations between each order state check
+	float duration_Com;							// Duration of the command in case of transparent command (s)
 	int limit_iterCom;				            // Limit number of iterations in case of transparent command
 	int nb_iterations_dyn_ident;				// Number of iterations in case of dynamic identification
 	int able_Calibrated;						// 0 : not calibrated, 1 : calibrated
 	int order_counter;                          // Order counter to change orders
 	int iter_counter;							// Couter of main loop iterations
-	int iter_id_start;							// Start iteration of dynamic identification
+	double time_id_start;						// Start time of dynamic identification (s, elapsed_time)
 	int i2t;									// int monitoring motors overload
 	float current_startMinJerk;					// Startpoint of the current minimum jerk trajectory
 	float current_endMinJerk;					// Endpoint of the current minimum jerk trajectory
-	int current_posMinJerk;					    // Current target position index during jerk trajectory execution
+	float current_timeMinJerk;					// Time since the start of the current jerk trajectory (s)
 	int current_minJerkMove;					// Counter of the minimum jerk trajectories
 	BOOL use_QTM;								// True : Use Qualisys measures ; False : Do not use Qualisys measures
 	BOOL use_FT;								// True : Use FT measures ; False : Do not use FT measures
@@ -199,7 +280,7 @@ struct realTimeParams
 	BOOL robot_stopAfterTrajs;
 	int jerkBlockWithFatigueTest;				// True : Add a test of fatigue at the end of the block ; False : don't
 	int jerkFamiliarisation;					// True : Use familiarisation parameters
-	int timer_jerk_end_move;					// Timer allowing progressive strengthenning of the position control
+	float timer_jerk_end_move;					// Time since the start of the move, progressive strengthenning (s)
 	int correct_fz_antigrav;					// 1 : Correction on Fz activated ; 0 : Not activated
 	int correct_q_antigrav;						// 1 : Correction on q activated ; 0 : Not activated
 	int correct_q_antigrav_2;					// 1 : Correction 2 on q activated ; 0 : Not activated
@@ -209,32 +290,36 @@ struct realTimeParams
 // ----------------------------------------- MEASURED VALUES STORAGE SUBSTRUCTS ----------------------------------------
 struct ableMeasures
 {
-	std::vector<float> able_xs_slider;			// Vector containing measured values of x_slider
-	std::vector<float> able_currents_1;			// Vector containing values of the current for identification (axis 1)
-	std::vector<float> able_currents_2;			// Vector containing values of the current for identification (axis 2)
-	std::vector<float> able_currents_3;			// Vector containing values of the current for identification (axis 3)
-	std::vector<float> able_currents_4;			// Vector containing values of the current for identification (axis 4)
-	std::vector<float> able_artpos_1;			// Vector containing values of the position for identification (axis 1)
-	std::vector<float> able_artpos_2;			// Vector containing values of the position for identification (axis 2)
-	std::vector<float> able_artpos_3;			// Vector containing values of the position for identification (axis 3)
-	std::vector<float> able_artpos_4;			// Vector containing values of the position for identification (axis 4)
-	std::vector<float> able_speeds_1;			// Vector containing values of the speed for identification (axis 1)
-	std::vector<float> able_speeds_2;			// Vector containing values of the speed for identification (axis 2)
-	std::vector<float> able_speeds_3;			// Vector containing values of the speed for identification (axis 3)
-	std::vector<float> able_speeds_4;			// Vector containing values of the speed for identification (axis 4)
-	std::vector<double> execution_times;		// Vector containing execution time of each motion thread loop (s)
-	std::vector<float> fx_FTA_sensor;			// All Fx forces sent by digital FT arm sensor for human identification
-	std::vector<float> fy_FTA_sensor;			// All Fy forces sent by digital FT arm sensor for human identification
-	std::vector<float> fz_FTA_sensor;			// All Fz forces sent by digital FT arm sensor for human identification
-	std::vector<float> tx_FTA_sensor;			// All Tx torques sent by digital FT arm sensor for human identification
-	std::vector<float> ty_FTA_sensor;			// All Ty torques sent by digital FT arm sensor for human identification
-	std::vector<float> tz_FTA_sensor;			// All Tz torques sent by digital FT arm sensor for human identification
-	std::vector<float> fx_FTW_sensor;			// All Fx forces sent by digital FT wrist sensor for human identification
-	std::vector<float> fy_FTW_sensor;			// All Fy forces sent by digital FT wrist sensor for human identification
-	std::vector<float> fz_FTW_sensor;			// All Fz forces sent by digital FT wrist sensor for human identification
-	std::vector<float> tx_FTW_sensor;			// All Tx torques sent by digital FT wrist sensor for human identification
-	std::vector<float> ty_FTW_sensor;			// All Ty torques sent by digital FT wrist sensor for human identification
-	std::vector<float> tz_FTW_sensor;			// All Tz torques sent by digital FT wrist sensor for human identification
+	session_floats able_xs_slider;			// Vector containing measured values of x_slider
+	session_floats able_currents_1;			// Vector containing values of the current for identification (axis 1)
+	session_floats able_currents_2;			// Vector containing values of the current for identification (axis 2)
+	session_floats able_currents_3;			// Vector containing values of the current for identification (axis 3)
+	session_floats able_currents_4;			// Vector containing values of the current for identification (axis 4)
+	session_floats able_artpos_1;			// Vector containing values of the position for identification (axis 1)
+	session_floats able_artpos_2;			// Vector containing values of the position for identification (axis 2)
+	session_floats able_artpos_3;			// Vector containing values of the position for identification (axis 3)
+	session_floats able_artpos_4;			// Vector containing values of the position for identification (axis 4)
+	session_floats able_speeds_1;			// Vector containing values of the speed for identification (axis 1)
+	session_floats able_speeds_2;			// Vector containing values of the speed for identification (axis 2)
+	session_floats able_speeds_3;			// Vector containing values of the speed for identification (axis 3)
+	session_floats able_speeds_4;			// Vector containing values of the speed for identification (axis 4)
+	session_doubles execution_times;		// Vector containing execution time of each motion thread loop (s)
+	session_ticks cycle_ticks;			// Start tick of each motion thread loop (timebase_Now)
+	session_ticks able_ticks;			// Tick of the state frame of each stored sample (timebase_Now)
+	session_ticks ftA_ticks;			// Acquisition tick of the stored arm FT samples (timebase_Now)
+	session_ticks ftW_ticks;			// Acquisition tick of the stored wrist FT samples (timebase_Now)
+	session_floats fx_FTA_sensor;			// All Fx forces sent by digital FT arm sensor for human identification
+	session_floats fy_FTA_sensor;			// All Fy forces sent by digital FT arm sensor for human identification
+	session_floats fz_FTA_sensor;			// All Fz forces sent by digital FT arm sensor for human identification
+	session_floats tx_FTA_sensor;			// All Tx torques sent by digital FT arm sensor for human identification
+	session_floats ty_FTA_sensor;			// All Ty torques sent by digital FT arm sensor for human identification
+	session_floats tz_FTA_sensor;			// All Tz torques sent by digital FT arm sensor for human identification
+	session_floats fx_FTW_sensor;			// All Fx forces sent by digital FT wrist sensor for human identification
+	session_floats fy_FTW_sensor;			// All Fy forces sent by digital FT wrist sensor for human identification
+	session_floats fz_FTW_sensor;			// All Fz forces sent by digital FT wrist sensor for human identification
+	session_floats tx_FTW_sensor;			// All Tx torques sent by digital FT wrist sensor for human identification
+	session_floats ty_FTW_sensor;			// All Ty torques sent by digital FT wrist sensor for human identification
+	session_floats tz_FTW_sensor;			// All Tz torques sent by digital FT wrist sensor for human identification
 };
 
 // ----------------------------------------- IDENTIFIED HUMAN DYNAMICS SUBSTRUCT ---------------------------------------
@@ -258,6 +343,8 @@ struct emg_pings
 	int ping_TBLongH;
 	// TricepsBrachialLatH activation (0 : no activation detected, 1 : activation detected)
 	int ping_TBLatH;
+	// Latency of the last ping : detection delay of the EMG pipeline and time spent in the mailbox (us)
+	long long latency_us;
 };
 
 // --------------------------------------------- CURRENT FT MEASURES STRUCT --------------------------------------------
@@ -269,6 +356,11 @@ struct received_FT_meas
 	float t_x;											// Computed torque along x axis
 	float t_y;											// Computed torque along y axis
 	float t_z;											// Computed torque along z axis
+	long long tick;										// Acquisition tick of the sample (timebase_Now)
+	float filtered[FTSTAGE_NB_CHANNELS];				// Filtered wrench extrapolated to the state tick
+	float impulse[FTSTAGE_NB_CHANNELS];					// Integral of the wrench since the previous iteration
+	double integral[FTSTAGE_NB_CHANNELS];				// Integral of the wrench at the last publication
+	int integral_set;									// 1 : integral read at least once, 0 : first iteration
 	float k_fp;											// Proportionnal gain of force correction
 	float k_fi;											// Integral gain of force correction
 	float k_fd;                                         // Derivative gain of force correction
@@ -281,13 +373,106 @@ struct deadman_buttons
 	BOOL rightb_pushed;						// True : Right button pushed ; False : Right button not pushed
 };
 
-// ----------------------------------------- PRE-COMPUTED MINIMUM JERKS STRUCT -----------------------------------------
+// ---------------------------------------------- MINIMUM JERK MOVE SUBSTRUCT -----------------------------------------
+struct minjerk_move
+{
+	float start;							// Startpoint of the move (rad)
+	float end;								// Endpoint of the move (rad)
+	float duration;							// Duration of the move (s)
+	int nb_samples;							// Number of orders of the move at the descriptor sampling period
+};
+
+// -------------------------------------------- MINIMUM JERK SEGMENT SUBSTRUCT -----------------------------------------
+struct minjerk_segment
+{
+	unsigned char first_move;				// Index of the first move of the segment
+	unsigned char nb_moves;					// Number of successive moves of the segment
+	unsigned short repetitions;				// Number of repetitions of the segment
+};
+
+// ---------------------------------------------- MINIMUM JERK BLOCK STRUCT --------------------------------------------
 struct minjerk_trajs
 {
-	ifstream minjerk_file;											// File containing pre-computed minimum jerk trajectories
-	std::vector<float> parsed_movements[NB_JERK_TRAJS];				// Table containing all minimum jerk movements data
-	std::vector<float> all_JmovesFam[NB_JERK_TRAJS * NB_REP_FAM];	// Table containing duplicated jerk movements data for familiarisation
-	std::vector<float> all_Jmoves[NB_JERK_TRAJS*NB_REP];			// Table containing duplicated jerk movements data
+	minjerk_move moves[MAX_JERK_MOVES];				// Distinct moves of the block, evaluated analytically
+	int nb_moves;									// Number of distinct moves
+	minjerk_segment segments[MAX_JERK_SEGMENTS];	// Order and repetitions of the moves
+	int nb_segments;								// Number of segments
+	unsigned char sequence[MAX_JERK_SEQUENCE];		// Index of the move executed at each position of the block
+	int nb_blockMoves;								// Number of moves executed during the block
+	float sampling_period;							// Sampling period the durations were expressed for (s)
+};
+
+// ------------------------------------------------ ROBOT STATE SUBSTRUCTS ---------------------------------------------
+// State of the axes extracted once per cycle from the drive frame (state_Update), one array per quantity. Only copy of
+// the measured state : the controllers, the model, the recording and the telemetry read it
+struct alignas(64) RobotState
+{
+	float position[NB_MOTORS];					// Articular positions (rad)
+	float speed[NB_MOTORS];						// Filtered motor speeds, as sent by the drive
+	float current[NB_MOTORS];					// Measured currents
+	float voltage[NB_MOTORS];					// Potentiometer voltages
+	int coder[NB_MOTORS];						// Coder positions (tops)
+	int inputs;									// Digital inputs of the drive (entree_tor, deadman buttons)
+};
+
+// Configuration of the axes read by the controllers, built before the motions and constant during them
+struct alignas(64) RobotConfig
+{
+	float reduction[NB_MOTORS];					// Reductions of the axes
+	float current_gain[NB_MOTORS];				// Conversion of the ADC current (Kconv_I)
+	float current_offset[NB_MOTORS];			// Offset of the ADC current
+	float speed_gain[NB_MOTORS];				// Proportional gain of the speed loop of the drive (Kp_V)
+	float kt_gain;								// Force constant of the motors
+	int active[NB_MOTORS];						// 1 : axis controlled (inhibition_State == 0)
+};
+
+// ---------------------------------------------- CONTROLLERS STATE SUBSTRUCTS ---------------------------------------
+// Integrators and counters kept by the controllers between two cycles. Plain data : all zeros is the initial state, the
+// block is copied with the control struct (snapshot of the replayed window)
+struct position_ctrlState
+{
+	float integral_sum[NB_MOTORS];				// Integral of the position errors (rad.s)
+	int old_counter;							// Order counter of the previous cycle
+	float if_integral_sum;						// Integral of the interaction force error (able_RegulateIFPos)
+	float if_speed_sign;						// Sign of the speed of the previous cycle (able_RegulateIFPos)
+};
+
+struct dynIdent_ctrlState
+{
+	float integral_sum[NB_MOTORS];				// Integral of the position errors (rad.s)
+	float integral_sum_speed;					// Integral of the speed errors
+	int old_counter;							// Order counter of the previous cycle
+};
+
+struct hopf_ctrlState
+{
+	float omega;								// Pulsation of the oscillator (rad/s)
+	float phi;									// Phase of the oscillator (rad)
+	float alpha;								// Amplitude of the oscillator (rad)
+	int old_counter;							// Order counter of the previous cycle
+};
+
+struct torque_ctrlState
+{
+	float transparent_sum[NB_MOTORS];			// Integral of the force errors of the transparent control
+	float antigrav_sum[NB_MOTORS];				// Integral of the force errors of the antigravity control
+	float fatigue_sum[NB_MOTORS];				// Integral of the force errors of the fatigue test
+	float time_FatigueTest;						// Time since the start of the fatigue test (s)
+};
+
+struct orders_ctrlState
+{
+	int ident_started;							// 1 : gains of the identification set (able_UpdateOrderIdent)
+	float counter_delayForce;					// Time waited after the end of the minimum jerk block (s)
+};
+
+struct controllers_State
+{
+	position_ctrlState position;				// able_PositionAsserv, able_RegulateIFPos
+	dynIdent_ctrlState dynIdent;				// able_DynIdentAsserv
+	hopf_ctrlState hopf;						// able_Hopf_PositionAsserv
+	torque_ctrlState torque;					// able_TorqueAsserv and FT controls
+	orders_ctrlState orders;					// Orders management
 };
 
 //------------------------------------------------- HOPF OSCILLATOR STRUCT----------------------------------------------
@@ -301,18 +486,32 @@ struct hopf_oscillator
 // ------------------------------------------------ GLOBAL CONTROL STRUCT ----------------------------------------------
 struct AbleControlStruct
 {
-	// Communication with QTM pipe handles
-	pipeStructQTMRead pipeHandlesQTM;
+	// State of the axes for the current cycle (control thread)
+	RobotState state;
+	// Configuration of the axes, constant during the motions
+	RobotConfig config;
+	// Integrators and counters of the controllers
+	controllers_State ctrlStates;
+	// Communication with QTM measures thread
+	qtmLinkStruct qtmLink;
+	// Estimation of the slider position from the QTM measures
+	slider_estimator sliderEst;
+	// Latency and drift of the measured streams
+	timingStruct timing;
 	// Motors state variables and parameters
 	motorsParams mParams;
 	// Orders variables
 	ableOrders aOrders;
 	// Identified dynamic model for torque command on splited data
 	ableDynamics aDynamics;
+	// Tabulated compensation map (MODEL_BACKEND_MAP)
+	map_compensation compMap;
+	// Haptic virtual scene (HAPTIC_CTRL), stored out of the struct (read only during the motions)
+	haptic_Scene* scene;
 	// Real time parameters
 	realTimeParams rtParams;
-	// Measures storage
-	ableMeasures aMeasures;
+	// Measures storage, stored out of the struct (only appended to during the motions)
+	ableMeasures* aMeasures;
 	// Human identified dynamics
 	humanDyn hDynId;
 	// EMG detection of movement
@@ -332,6 +531,9 @@ struct AbleControlStruct
 	CRITICAL_SECTION* pCritical_share_FT_Wrist;
 	// Shared measures struct for wrist measures
 	FT_meas_Global* FT_measures_Shared_Wrist;
+	// Samples of the FT threads read during the current iteration
+	FT_meas_Global FT_sample_Arm;
+	FT_meas_Global FT_sample_Wrist;
 	// Hopf oscillator parameters struct
 	hopf_oscillator hopfParams;
 };
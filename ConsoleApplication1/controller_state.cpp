@@ -0,0 +1,25 @@
+/***********************************************************************************************************************
+* controller_state.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Reset of the state of the controllers.
+***********************************************************************************************************************/
+
+#include "controller_state.h"
+
+/*---------------------------------------------------------------------------------------------------------------------
+| ctrlstate_Reset - Set the states of all controllers to their initial value
+|
+| Syntax --
+|	void ctrlstate_Reset(controllers_State* states)
+|
+| Inputs --
+|	controllers_State* states -> states to reset
+----------------------------------------------------------------------------------------------------------------------*/
+void ctrlstate_Reset(controllers_State* states)
+{
+	*states = {};
+}
@@ -0,0 +1,23 @@
+/***********************************************************************************************************************
+* controller_state.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the functions handling the state of the controllers (controllers_State). The integrators
+* and counters are kept in the control struct instead of static variables of the controllers : each control struct
+* runs its own controllers, the states are reset before the motions of a session.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef CONTROLLER_STATE_H
+#define CONTROLLER_STATE_H
+
+// Project includes
+#include "control_struct.h"
+
+// Controllers state functions
+void ctrlstate_Reset(controllers_State* states);
+#endif // !CONTROLLER_STATE_H
\ No newline at end of file
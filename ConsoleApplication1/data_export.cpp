@@ -0,0 +1,371 @@
+/***********************************************************************************************************************
+* data_export.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Exports all the measures of a session once the control thread has ended. Every text file of ThreadInformations is
+* written by its own thread, in the format of the sequential export, values being formatted with std::to_chars in large
+* buffers. The measures are read in place : they are not modified until the export is joined, before the files are
+* closed. The session archive is written by executeMotions.
+***********************************************************************************************************************/
+
+#include "data_export.h"
+#include "data_recording_functions.h"
+#include <charconv>
+#include <string.h>
+
+using namespace std;
+using namespace std::chrono;
+
+// Export in progress (one per process)
+static export_session session;
+
+/*---------------------------------------------------------------------------------------------------------------------
+| export_WriteColumnsThread - Write the channels of a job row by row ("%f" format followed by the separator)
+|
+| Syntax --
+|	DWORD WINAPI export_WriteColumnsThread(LPVOID jobArgs)
+|
+| Inputs --
+|	LPVOID jobArgs -> pointer towards the export_job to execute
+|
+| Outputs --
+|	DWORD -> 0 : Success ; 1 : Write error
+|
+| Remarks --
+|	The file is only written by this job until export_WaitSession, it is flushed but left open.
+----------------------------------------------------------------------------------------------------------------------*/
+DWORD WINAPI export_WriteColumnsThread(LPVOID jobArgs)
+{
+	// Initialise variables
+	export_job* job = (export_job*)jobArgs;
+	auto timestamp_0 = high_resolution_clock::now();
+	FILE* file = job->file;
+	vector<char> buffer(EXPORT_BUFFER_SIZE);
+	char* cursor = buffer.data();
+	char* buffer_end = buffer.data() + buffer.size();
+	size_t separator_length = strlen(job->separator);
+	size_t nb_rows = job->columns[0]->size();
+	DWORD err = 0;
+
+	// Rows are limited by the shortest channel
+	for (int j(1); j < job->nb_columns; j++)
+	{
+		if (job->columns[j]->size() < nb_rows)
+		{
+			nb_rows = job->columns[j]->size();
+		}
+	}
+
+	job->nb_bytes = 0;
+	for (size_t i(0); i < nb_rows && err == 0; i++)
+	{
+		for (int j(0); j < job->nb_columns; j++)
+		{
+			// Write the buffer once nearly full
+			if (buffer_end - cursor < EXPORT_MAX_VALUE_CHARS)
+			{
+				if (fwrite(buffer.data(), 1, cursor - buffer.data(), file) != (size_t)(cursor - buffer.data()))
+				{
+					err = 1;
+				}
+				job->nb_bytes += cursor - buffer.data();
+				cursor = buffer.data();
+			}
+			cursor = to_chars(cursor, buffer_end, (*job->columns[j])[i], chars_format::fixed, 6).ptr;
+			memcpy(cursor, job->separator, separator_length);
+			cursor += separator_length;
+		}
+	}
+	if (fwrite(buffer.data(), 1, cursor - buffer.data(), file) != (size_t)(cursor - buffer.data()))
+	{
+		err = 1;
+	}
+	job->nb_bytes += cursor - buffer.data();
+	if (fflush(file) != 0)
+	{
+		err = 1;
+	}
+
+	duration<double> elapsed = high_resolution_clock::now() - timestamp_0;
+	job->elapsed = elapsed.count();
+	job->err = err;
+	return err;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| export_AddJob - Add a text file job to the session
+|
+| Syntax --
+|	static void export_AddJob(const char* name, FILE* file, const char* separator, int nb_columns,
+|							  const session_floats* const* columns)
+|
+| Inputs --
+|	const char* name -> name printed in the report
+|	FILE* file -> destination file, opened by initFiles (nothing added if NULL : simulated sessions)
+|	const char* separator -> separator written after each value
+|	int nb_columns -> number of channels
+|	const session_floats* const* columns -> channels, in the order of the row
+----------------------------------------------------------------------------------------------------------------------*/
+static void export_AddJob(const char* name, FILE* file, const char* separator, int nb_columns,
+						  const session_floats* const* columns)
+{
+	export_job* job = &session.jobs[session.nb_jobs];
+
+	if (file == NULL)
+	{
+		return;
+	}
+	job->name = name;
+	job->file = file;
+	job->separator = separator;
+	job->nb_columns = nb_columns;
+	for (int j(0); j < nb_columns; j++)
+	{
+		job->columns[j] = columns[j];
+	}
+	job->nb_bytes = 0;
+	job->elapsed = 0.0;
+	job->err = 0;
+	session.nb_jobs++;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| export_StartSession - Launch one writing thread per file on the stored measures of the session, the files and their
+|                       format being the ones of the sequential export (recordValuesInFile)
+|
+| Syntax --
+|	void export_StartSession(ThreadInformations* ableInfos)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+|
+| Remarks --
+|	Called once the control thread has ended : the measures are read in place, without copy, and must not be modified
+|	before export_WaitSession. Their readers in the meantime (archive, human identification) only read them. A job
+|	whose thread can not be created is run in place.
+----------------------------------------------------------------------------------------------------------------------*/
+void export_StartSession(ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
+	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+	const ableMeasures* m = ableInfos->ctrl_ABLE->aMeasures;
+
+	if (session.running)
+	{
+		fprintf(ableInfos->err_file, "Export already running, measures not exported !\n");
+		return;
+	}
+	session.measures = m;
+	session.err_file = ableInfos->err_file;
+	session.out_file = ableInfos->out_file;
+	session.nb_jobs = 0;
+	session.nb_threads = 0;
+
+	// Same cases as the sequential export (whole session reached by recordValuesInFile)
+	if (!ableInfos->export_measures)
+	{
+		return;
+	}
+
+	// Build jobs, same files and formats as the sequential export
+	const session_floats* currents[4] = { &m->able_currents_1, &m->able_currents_2, &m->able_currents_3, &m->able_currents_4 };
+	const session_floats* artpos[4] = { &m->able_artpos_1, &m->able_artpos_2, &m->able_artpos_3, &m->able_artpos_4 };
+	const session_floats* speeds[4] = { &m->able_speeds_1, &m->able_speeds_2, &m->able_speeds_3, &m->able_speeds_4 };
+	const session_floats* xs_slider[1] = { &m->able_xs_slider };
+	export_AddJob("currents", ableInfos->currents_file, " ; ", 4, currents);
+	export_AddJob("positions", ableInfos->artpos_file, " ; ", 4, artpos);
+	export_AddJob("speeds", ableInfos->speeds_file, " ; ", 4, speeds);
+	export_AddJob("x_slider", ableInfos->xs_slider_file, " ; ", 1, xs_slider);
+	if (oValues->ctrl_type == HDYN_IDENT)
+	{
+		const session_floats* fz_Arm[1] = { &m->fz_FTA_sensor };
+		const session_floats* fz_Wrist[1] = { &m->fz_FTW_sensor };
+		export_AddJob("fz arm", ableInfos->fz_Arm_file, " ; ", 1, fz_Arm);
+		export_AddJob("fz wrist", ableInfos->fz_Wrist_file, " ; ", 1, fz_Wrist);
+	}
+	if (rtValues->use_FT && oValues->ctrl_type == TORQUE_CTRL)
+	{
+		const session_floats* ft_Arm[6] = { &m->fx_FTA_sensor, &m->fy_FTA_sensor, &m->fz_FTA_sensor,
+												&m->tx_FTA_sensor, &m->ty_FTA_sensor, &m->tz_FTA_sensor };
+		const session_floats* ft_Wrist[6] = { &m->fx_FTW_sensor, &m->fy_FTW_sensor, &m->fz_FTW_sensor,
+												  &m->tx_FTW_sensor, &m->ty_FTW_sensor, &m->tz_FTW_sensor };
+		export_AddJob("FT arm", ableInfos->ft_Arm_sensor_file, ";", 6, ft_Arm);
+		export_AddJob("FT wrist", ableInfos->ft_Wrist_sensor_file, ";", 6, ft_Wrist);
+	}
+
+	// Launch threads
+	session.start = high_resolution_clock::now();
+	for (int i(0); i < session.nb_jobs; i++)
+	{
+		HANDLE thread = CreateThread(NULL, 0, export_WriteColumnsThread, &session.jobs[i], 0, NULL);
+		if (thread == NULL)
+		{
+			fprintf(ableInfos->err_file, "Export thread of %s not created (error %lu), written in place\n",
+				session.jobs[i].name, GetLastError());
+			export_WriteColumnsThread(&session.jobs[i]);
+		}
+		else
+		{
+			session.threads[session.nb_threads] = thread;
+			session.nb_threads++;
+		}
+	}
+	session.running = true;
+	fprintf(ableInfos->out_file, "Export of the session launched (%i threads for %i files)\n", session.nb_threads,
+		session.nb_jobs);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| export_ReportFTAlignment - Print the latency of a stored FT stream and the error of holding its samples
+|
+| Syntax --
+|	void export_ReportFTAlignment(FILE* out_file, const char* name, const session_ticks* control_ticks,
+|	                              const session_ticks* ft_ticks, const session_floats* ft_values)
+|
+| Inputs --
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	const char* name -> name of the stream
+|	const session_ticks* control_ticks -> ticks of the state frames of the stored samples
+|	const session_ticks* ft_ticks -> acquisition ticks of the FT samples used at these iterations
+|	const session_floats* ft_values -> FT values used at these iterations
+----------------------------------------------------------------------------------------------------------------------*/
+void export_ReportFTAlignment(FILE* out_file, const char* name, const session_ticks* control_ticks,
+	                          const session_ticks* ft_ticks, const session_floats* ft_values)
+{
+	// Initialise variables
+	align_link link;
+	std::vector<long long> sample_ticks;
+	std::vector<float> sample_values, aligned;
+	double sum_sq = 0.0;
+	int nb_aligned = 0;
+
+	if (ft_ticks->size() != control_ticks->size() || ft_values->size() != control_ticks->size())
+	{
+		return;
+	}
+
+	// Latency of the sample used at each iteration, and the distinct samples received
+	align_InitLink(&link);
+	for (size_t j(0); j < control_ticks->size(); j++)
+	{
+		align_AddLatency(&link, (*ft_ticks)[j], (*control_ticks)[j]);
+		if ((*ft_ticks)[j] != 0 && (sample_ticks.empty() || (*ft_ticks)[j] > sample_ticks.back()))
+		{
+			sample_ticks.push_back((*ft_ticks)[j]);
+			sample_values.push_back((*ft_values)[j]);
+		}
+	}
+	align_PrintLink(out_file, name, &link);
+
+	// Difference between the held values and the samples interpolated at the control ticks
+	aligned.resize(control_ticks->size());
+	align_Resample(sample_ticks.data(), sample_values.data(), (int)sample_ticks.size(), control_ticks->data(),
+		           aligned.data(), (int)aligned.size(), ALIGN_LINEAR);
+	for (size_t j(0); j < aligned.size(); j++)
+	{
+		if (!isnan(aligned[j]))
+		{
+			sum_sq += (aligned[j] - (*ft_values)[j]) * (aligned[j] - (*ft_values)[j]);
+			nb_aligned++;
+		}
+	}
+	if (nb_aligned > 0)
+	{
+		fprintf(out_file, "%s : %zu distinct samples, rms difference hold / linear on the control timeline %f\n",
+			    name, sample_ticks.size(), sqrt(sum_sq / nb_aligned));
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| export_ReportTiming - Print the timing of the exported measures (offline latency and drift)
+|
+| Syntax --
+|	void export_ReportTiming(FILE* out_file, const ableMeasures* m, float sampling_period)
+|
+| Inputs --
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	const ableMeasures* m -> exported measures
+|	float sampling_period -> nominal period of the control loop (s)
+|
+| Remarks --
+|	Called at the end of executeMotions, while the export threads read the same measures.
+----------------------------------------------------------------------------------------------------------------------*/
+void export_ReportTiming(FILE* out_file, const ableMeasures* m, float sampling_period)
+{
+	// Initialise variables
+	align_link loop;
+
+	// Loop clock against the nominal period
+	align_InitLink(&loop);
+	for (size_t j(0); j < m->cycle_ticks.size(); j++)
+	{
+		align_AddClock(&loop, j * (double)sampling_period, m->cycle_ticks[j]);
+	}
+	align_PrintLink(out_file, "Control loop", &loop);
+
+	// Jitter of the loop, labelled with the thread placement it ran with
+	placement_ReportJitter(out_file, "Control loop", m->cycle_ticks.data(), m->cycle_ticks.size(), sampling_period);
+
+	// FT streams on the control timeline
+	export_ReportFTAlignment(out_file, "Stored FT arm (fz)", &m->able_ticks, &m->ftA_ticks, &m->fz_FTA_sensor);
+	export_ReportFTAlignment(out_file, "Stored FT wrist (fz)", &m->able_ticks, &m->ftW_ticks, &m->fz_FTW_sensor);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| export_WaitSession - Wait for the end of the export and print its throughput
+|
+| Syntax --
+|	void export_WaitSession(ThreadInformations* ableInfos)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+----------------------------------------------------------------------------------------------------------------------*/
+void export_WaitSession(ThreadInformations* ableInfos)
+{
+	// Initialise variables
+	size_t total_bytes = 0;
+
+	if (!session.running)
+	{
+		return;
+	}
+
+	// Wait for all jobs
+	auto timestamp_0 = high_resolution_clock::now();
+	if (session.nb_threads > 0)
+	{
+		WaitForMultipleObjects(session.nb_threads, session.threads, TRUE, INFINITE);
+	}
+	auto timestamp_1 = high_resolution_clock::now();
+	duration<double> waited = timestamp_1 - timestamp_0;
+	duration<double> elapsed = timestamp_1 - session.start;
+
+	// Report
+	for (int i(0); i < session.nb_threads; i++)
+	{
+		CloseHandle(session.threads[i]);
+	}
+	for (int i(0); i < session.nb_jobs; i++)
+	{
+		if (session.jobs[i].err != 0)
+		{
+			fprintf(ableInfos->err_file, "Export of %s failed !\n", session.jobs[i].name);
+		}
+		fprintf(ableInfos->out_file, "Export %s : %.2f MB in %.3f s (%.1f MB/s)\n", session.jobs[i].name,
+			session.jobs[i].nb_bytes / 1e6, session.jobs[i].elapsed,
+			(session.jobs[i].elapsed > 0.0) ? session.jobs[i].nb_bytes / 1e6 / session.jobs[i].elapsed : 0.0);
+		total_bytes += session.jobs[i].nb_bytes;
+	}
+	fprintf(ableInfos->out_file, "Export done : %.2f MB in %.3f s (%.1f MB/s), %.3f s spent waiting at exit\n",
+		total_bytes / 1e6, elapsed.count(), (elapsed.count() > 0.0) ? total_bytes / 1e6 / elapsed.count() : 0.0,
+		waited.count());
+	fflush(ableInfos->out_file);
+
+	// The measures can be modified again
+	session.measures = NULL;
+	session.running = false;
+}
@@ -0,0 +1,57 @@
+/***********************************************************************************************************************
+* data_export.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the end of session export functions.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef DATA_EXPORT_H
+#define DATA_EXPORT_H
+
+// Project includes
+#include "communication_struct_ABLE.h"
+#include "thread_placement.h"
+
+// Export constants
+#define EXPORT_MAX_JOBS 8								// One job per exported file
+#define EXPORT_MAX_COLUMNS 6							// Maximum number of channels written in one file
+#define EXPORT_BUFFER_SIZE (4 * 1024 * 1024)			// Size of the formatting buffer of each job (bytes)
+#define EXPORT_MAX_VALUE_CHARS 64						// Room kept in the buffer for one formatted value
+
+// --------------------------------------------------- EXPORT JOB STRUCT -----------------------------------------------
+struct export_job
+{
+	const char* name;									// Name printed in the export report
+	FILE* file;											// Destination file of ThreadInformations, closed by clean_Files
+	const session_floats* columns[EXPORT_MAX_COLUMNS];	// Channels written on each row
+	int nb_columns;										// Number of channels
+	const char* separator;								// Separator written after each value
+	size_t nb_bytes;									// Number of bytes written
+	double elapsed;										// Duration of the job (s)
+	DWORD err;											// 0 : Success ; 1 : Write error
+};
+
+// ------------------------------------------------- EXPORT SESSION STRUCT ---------------------------------------------
+struct export_session
+{
+	const ableMeasures* measures;						// Measures of the session, read in place until joined
+	export_job jobs[EXPORT_MAX_JOBS];					// Jobs of the export
+	HANDLE threads[EXPORT_MAX_JOBS];					// Threads launched (jobs not launched are run in place)
+	int nb_jobs;										// Number of jobs
+	int nb_threads;										// Number of threads launched
+	FILE* err_file;										// pointer towards "errors.txt" (stderr)
+	FILE* out_file;										// pointer towards "outputs.txt" (stdout)
+	std::chrono::high_resolution_clock::time_point start;	// Launch time of the export
+	bool running;										// True : Export launched and not joined
+};
+
+// Export function definition
+void export_StartSession(ThreadInformations* ableInfos);
+void export_WaitSession(ThreadInformations* ableInfos);
+void export_ReportTiming(FILE* out_file, const ableMeasures* m, float sampling_period);
+#endif // !DATA_EXPORT_H
@@ -22,26 +22,29 @@
 void storeValuesInVectors(ThreadInformations* ableInfos)
 {
 	// Get pointers towards structs
-	ableMeasures* cMeasures = &ableInfos->ctrl_ABLE->aMeasures;
+	ableMeasures* cMeasures = ableInfos->ctrl_ABLE->aMeasures;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
 	ableDynamics* cDyn = &ableInfos->ctrl_ABLE->aDynamics;
 	received_FT_meas* rtFTmeas_Arm = &ableInfos->ctrl_ABLE->current_FT_meas_Arm;
 	received_FT_meas* rtFTmeas_Wrist = &ableInfos->ctrl_ABLE->current_FT_meas_Wrist;
 	// Store current values during motion
-	cMeasures->able_currents_1.push_back(rtValues->currentADCcurrent[0]);
-	cMeasures->able_currents_2.push_back(rtValues->currentADCcurrent[1]);
-	cMeasures->able_currents_3.push_back(rtValues->currentADCcurrent[2]);
-	cMeasures->able_currents_4.push_back(rtValues->currentADCcurrent[3]);
+	cMeasures->able_currents_1.push_back(state->current[0]);
+	cMeasures->able_currents_2.push_back(state->current[1]);
+	cMeasures->able_currents_3.push_back(state->current[2]);
+	cMeasures->able_currents_4.push_back(state->current[3]);
 	// Store articular positions values during motion
-	cMeasures->able_artpos_1.push_back(rtValues->currentPosition[0]);
-	cMeasures->able_artpos_2.push_back(rtValues->currentPosition[1]);
-	cMeasures->able_artpos_3.push_back(rtValues->currentPosition[2]);
-	cMeasures->able_artpos_4.push_back(rtValues->currentPosition[3]);
+	cMeasures->able_artpos_1.push_back(state->position[0]);
+	cMeasures->able_artpos_2.push_back(state->position[1]);
+	cMeasures->able_artpos_3.push_back(state->position[2]);
+	cMeasures->able_artpos_4.push_back(state->position[3]);
 	// Store speed values during motion
-	cMeasures->able_speeds_1.push_back(rtValues->currentSpeed[0]);
-	cMeasures->able_speeds_2.push_back(rtValues->currentSpeed[1]);
-	cMeasures->able_speeds_3.push_back(rtValues->currentSpeed[2]);
-	cMeasures->able_speeds_4.push_back(rtValues->currentSpeed[3]);
+	cMeasures->able_speeds_1.push_back(state->speed[0]);
+	cMeasures->able_speeds_2.push_back(state->speed[1]);
+	cMeasures->able_speeds_3.push_back(state->speed[2]);
+	cMeasures->able_speeds_4.push_back(state->speed[3]);
+	// Store the tick of the state frame of these values
+	cMeasures->able_ticks.push_back(rtValues->state_tick);
 	// Store x_slider values measured by Qualisys
 	cMeasures->able_xs_slider.push_back(cDyn->axis4_mod.x_slider);
 	// Store FT measures
@@ -55,6 +58,7 @@ void storeValuesInVectors(ThreadInformations* ableInfos)
 		cMeasures->tx_FTA_sensor.push_back(rtFTmeas_Arm->t_x);
 		cMeasures->ty_FTA_sensor.push_back(rtFTmeas_Arm->t_y);
 		cMeasures->tz_FTA_sensor.push_back(rtFTmeas_Arm->t_z);
+		cMeasures->ftA_ticks.push_back(rtFTmeas_Arm->tick);
 		// Record wrist sensor measures
 		cMeasures->fx_FTW_sensor.push_back(rtFTmeas_Wrist->f_x);
 		cMeasures->fy_FTW_sensor.push_back(rtFTmeas_Wrist->f_y);
@@ -62,6 +66,7 @@ void storeValuesInVectors(ThreadInformations* ableInfos)
 		cMeasures->tx_FTW_sensor.push_back(rtFTmeas_Wrist->t_x);
 		cMeasures->ty_FTW_sensor.push_back(rtFTmeas_Wrist->t_y);
 		cMeasures->tz_FTW_sensor.push_back(rtFTmeas_Wrist->t_z);
+		cMeasures->ftW_ticks.push_back(rtFTmeas_Wrist->tick);
 	}
 }
 
@@ -79,7 +84,12 @@ void recordCurrentValues(ThreadInformations* ableInfos)
 	// Extract substructs
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
-	ableMeasures* measValues = &ableInfos->ctrl_ABLE->aMeasures;
+	ableMeasures* measValues = ableInfos->ctrl_ABLE->aMeasures;
+	// No currents file for the simulated sessions
+	if (ableInfos->currents_file == NULL)
+	{
+		return;
+	}
 	if (rtValues->order_counter > 0 || oValues->ctrl_type == MINJERK_TRAJS)
 	{
 		// Record currents values
@@ -150,7 +160,8 @@ void recordValuesInFile(ThreadInformations* ableInfos)
 	// Extract substructs
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
-	ableMeasures* measValues = &ableInfos->ctrl_ABLE->aMeasures;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
+	ableMeasures* measValues = ableInfos->ctrl_ABLE->aMeasures;
 
 	if (oValues->ctrl_type != STATIC_IDENT)
 	{
@@ -167,13 +178,14 @@ void recordValuesInFile(ThreadInformations* ableInfos)
 	// Write robot positions
 	for (int i(0); i < NB_MOTORS; i++)
 	{
-		fprintf(ableInfos->identification_file, "Axis %i : %f\n", i, rtValues->currentPosition[i]);
+		fprintf(ableInfos->identification_file, "Axis %i : %f\n", i, state->position[i]);
 	}
 	// Write robot currents
 	if (oValues->ctrl_type == STATIC_IDENT)
 	{
-		// If static identification : get 1000 last current values (1 second)
-		for (int i(measValues->able_currents_1.size() - 2000); i < (int)(measValues->able_currents_1.size() - 1000); i++)
+		// If static identification : get the current values of the last second but one, whatever the control rate
+		int nb_second = (int)(rtValues->ctrl_rate + 0.5f);
+		for (int i(measValues->able_currents_1.size() - 2 * nb_second); i < (int)(measValues->able_currents_1.size() - nb_second); i++)
 		{
 			fprintf(ableInfos->currents_file, "%f ; ", measValues->able_currents_1.at(i));
 			fprintf(ableInfos->currents_file, "%f ; ", measValues->able_currents_2.at(i));
@@ -183,53 +195,10 @@ void recordValuesInFile(ThreadInformations* ableInfos)
 	}
 	else if (rtValues->order_counter == 255)
 	{
-		// If any other control : get all currents and speeds
-		for (int i(0); i < (int)(measValues->able_currents_1.size()); i++)
-		{
-			// Record currents values
-			fprintf(ableInfos->currents_file, "%f ; ", measValues->able_currents_1.at(i));
-			fprintf(ableInfos->currents_file, "%f ; ", measValues->able_currents_2.at(i));
-			fprintf(ableInfos->currents_file, "%f ; ", measValues->able_currents_3.at(i));
-			fprintf(ableInfos->currents_file, "%f ; ", measValues->able_currents_4.at(i));
-			// Record articular positions values
-			fprintf(ableInfos->artpos_file, "%f ; ", measValues->able_artpos_1.at(i));
-			fprintf(ableInfos->artpos_file, "%f ; ", measValues->able_artpos_2.at(i));
-			fprintf(ableInfos->artpos_file, "%f ; ", measValues->able_artpos_3.at(i));
-			fprintf(ableInfos->artpos_file, "%f ; ", measValues->able_artpos_4.at(i));
-			// Record speeds values
-			fprintf(ableInfos->speeds_file, "%f ; ", measValues->able_speeds_1.at(i));
-			fprintf(ableInfos->speeds_file, "%f ; ", measValues->able_speeds_2.at(i));
-			fprintf(ableInfos->speeds_file, "%f ; ", measValues->able_speeds_3.at(i));
-			fprintf(ableInfos->speeds_file, "%f ; ", measValues->able_speeds_4.at(i));
-			// Record x_slider values
-			fprintf(ableInfos->xs_slider_file, "%f ; ", measValues->able_xs_slider.at(i));
-			// recprd Fz values for human limb identification
-			if (oValues->ctrl_type == HDYN_IDENT)
-			{
-				fprintf(ableInfos->fz_Arm_file, "%f ; ", measValues->fz_FTA_sensor.at(i));
-				fprintf(ableInfos->fz_Wrist_file, "%f ; ", measValues->fz_FTW_sensor.at(i));
-			}
-		}
-		if (rtValues->use_FT && ableInfos->ctrl_ABLE->aOrders.ctrl_type == TORQUE_CTRL)
-		{
-			for (int i(0); i < (int)(measValues->fx_FTA_sensor.size()); i++)
-			{
-				// Record arm sensor measures
-				fprintf(ableInfos->ft_Arm_sensor_file, "%f;", measValues->fx_FTA_sensor.at(i));
-				fprintf(ableInfos->ft_Arm_sensor_file, "%f;", measValues->fy_FTA_sensor.at(i));
-				fprintf(ableInfos->ft_Arm_sensor_file, "%f;", measValues->fz_FTA_sensor.at(i));
-				fprintf(ableInfos->ft_Arm_sensor_file, "%f;", measValues->tx_FTA_sensor.at(i));
-				fprintf(ableInfos->ft_Arm_sensor_file, "%f;", measValues->ty_FTA_sensor.at(i));
-				fprintf(ableInfos->ft_Arm_sensor_file, "%f;", measValues->tz_FTA_sensor.at(i));
-				// Record wrist sensor measures
-				fprintf(ableInfos->ft_Wrist_sensor_file, "%f;", measValues->fx_FTW_sensor.at(i));
-				fprintf(ableInfos->ft_Wrist_sensor_file, "%f;", measValues->fy_FTW_sensor.at(i));
-				fprintf(ableInfos->ft_Wrist_sensor_file, "%f;", measValues->fz_FTW_sensor.at(i));
-				fprintf(ableInfos->ft_Wrist_sensor_file, "%f;", measValues->tx_FTW_sensor.at(i));
-				fprintf(ableInfos->ft_Wrist_sensor_file, "%f;", measValues->ty_FTW_sensor.at(i));
-				fprintf(ableInfos->ft_Wrist_sensor_file, "%f;", measValues->tz_FTW_sensor.at(i));
-			}
-		}
+		// If any other control : the measures of the session are kept and written in the files above, in parallel, at
+		// the end of executeMotions once the control thread has ended
+		ableInfos->export_measures = true;
+		return;
 	}
 	// Clear currents vectors
 	measValues->able_currents_1.clear();
@@ -267,4 +236,76 @@ void recordValuesInFile(ThreadInformations* ableInfos)
 		measValues->ty_FTW_sensor.clear();
 		measValues->tz_FTW_sensor.clear();
 	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| recordMeasuresInArchive - Write all the stored measures of the session in a single archive (see session_archive.h),
+|                           samples missing in a channel are written as NaN
+|
+| Syntax --
+|	size_t recordMeasuresInArchive(FILE* err_file, FILE* out_file, ableMeasures* measValues, float sampling_period)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	ableMeasures* measValues -> measures to write
+|	float sampling_period -> time between two samples (s)
+|
+| Outputs --
+|	size_t -> size of the archive (bytes) ; 0 : Archive not written
+----------------------------------------------------------------------------------------------------------------------*/
+size_t recordMeasuresInArchive(FILE* err_file, FILE* out_file, ableMeasures* measValues, float sampling_period)
+{
+	// Initialise variables
+	static const archive_channelDesc channels[SESSION_ARCHIVE_CHANNELS] = {
+		{ "current_1", "ADC" }, { "current_2", "ADC" }, { "current_3", "ADC" }, { "current_4", "ADC" },
+		{ "artpos_1", "rad" }, { "artpos_2", "rad" }, { "artpos_3", "rad" }, { "artpos_4", "rad" },
+		{ "speed_1", "rad/s" }, { "speed_2", "rad/s" }, { "speed_3", "rad/s" }, { "speed_4", "rad/s" },
+		{ "xs_slider", "m" },
+		{ "fx_FTA", "N" }, { "fy_FTA", "N" }, { "fz_FTA", "N" }, { "tx_FTA", "Nm" }, { "ty_FTA", "Nm" }, { "tz_FTA", "Nm" },
+		{ "fx_FTW", "N" }, { "fy_FTW", "N" }, { "fz_FTW", "N" }, { "tx_FTW", "Nm" }, { "ty_FTW", "Nm" }, { "tz_FTW", "Nm" },
+		{ "exec_time", "s" } };
+	const session_floats* float_columns[SESSION_ARCHIVE_CHANNELS - 1] = {
+		&measValues->able_currents_1, &measValues->able_currents_2, &measValues->able_currents_3, &measValues->able_currents_4,
+		&measValues->able_artpos_1, &measValues->able_artpos_2, &measValues->able_artpos_3, &measValues->able_artpos_4,
+		&measValues->able_speeds_1, &measValues->able_speeds_2, &measValues->able_speeds_3, &measValues->able_speeds_4,
+		&measValues->able_xs_slider,
+		&measValues->fx_FTA_sensor, &measValues->fy_FTA_sensor, &measValues->fz_FTA_sensor,
+		&measValues->tx_FTA_sensor, &measValues->ty_FTA_sensor, &measValues->tz_FTA_sensor,
+		&measValues->fx_FTW_sensor, &measValues->fy_FTW_sensor, &measValues->fz_FTW_sensor,
+		&measValues->tx_FTW_sensor, &measValues->ty_FTW_sensor, &measValues->tz_FTW_sensor };
+	float sample[SESSION_ARCHIVE_CHANNELS];
+	archive_writer writer;
+	size_t nb_samples = measValues->execution_times.size();
+	int err = 0;
+
+	// The longest channel gives the number of samples
+	for (int i(0); i < SESSION_ARCHIVE_CHANNELS - 1; i++)
+	{
+		if (float_columns[i]->size() > nb_samples)
+		{
+			nb_samples = float_columns[i]->size();
+		}
+	}
+	if (archive_OpenWriter(err_file, &writer, SESSION_ARCHIVE_FILE, channels, SESSION_ARCHIVE_CHANNELS, sampling_period) != 0)
+	{
+		return 0;
+	}
+
+	// Write samples row by row, the writer stores them by columns
+	for (size_t j(0); j < nb_samples && err == 0; j++)
+	{
+		for (int i(0); i < SESSION_ARCHIVE_CHANNELS - 1; i++)
+		{
+			sample[i] = (j < float_columns[i]->size()) ? (*float_columns[i])[j] : NAN;
+		}
+		sample[SESSION_ARCHIVE_CHANNELS - 1] = (j < measValues->execution_times.size()) ? (float)measValues->execution_times[j] : NAN;
+		err = archive_AppendSample(&writer, sample);
+	}
+	if (archive_CloseWriter(err_file, &writer) != 0 || err != 0)
+	{
+		return 0;
+	}
+	fprintf(out_file, "Session archive written : %zu samples of %i channels\n", nb_samples, SESSION_ARCHIVE_CHANNELS);
+	return (size_t)(writer.header.data_offset + writer.header.nb_chunks * writer.header.chunk_size);
 }
\ No newline at end of file
@@ -15,6 +15,11 @@
 
 #include "communication_struct_ABLE.h"
 #include "utils_for_ABLE_Com.h"
+#include "session_archive.h"
+
+// Session archive
+#define SESSION_ARCHIVE_FILE "session_archive.absa"	// Archive written at the end of the session
+#define SESSION_ARCHIVE_CHANNELS 26					// Number of channels recorded in the session archive
 
 // Temporary recording functions
 void storeValuesInVectors(ThreadInformations* ableInfos);
@@ -22,5 +27,6 @@ void storeValuesInVectors(ThreadInformations* ableInfos);
 // File recording functions
 void recordCurrentValues(ThreadInformations* ableInfos);
 void recordValuesInFile(ThreadInformations* ableInfos);
+size_t recordMeasuresInArchive(FILE* err_file, FILE* out_file, ableMeasures* measValues, float sampling_period);
 
 #endif // !DATA_RECORDING_FUNCTIONS_H
\ No newline at end of file
@@ -0,0 +1,169 @@
+/***********************************************************************************************************************
+* emg_onset.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Detects the onsets of muscle activations in the EMG stream : band-pass (20-450 Hz) and mains notch biquads, Teager-
+* Kaiser energy operator, rectification, envelope and adaptive threshold on the statistics of the envelope at rest.
+***********************************************************************************************************************/
+
+#include "emg_onset.h"
+#include <cmath>
+#include <string.h>
+
+#define EMG_PI 3.14159265358979323846
+
+// Kinds of second order sections
+#define BIQUAD_HIGHPASS 0
+#define BIQUAD_LOWPASS 1
+#define BIQUAD_NOTCH 2
+
+// Compute the coefficients of a second order section (audio EQ cookbook) and reset its states
+static void emg_DesignBiquad(emg_biquad4* filter, int kind, double frequency, double q, double sample_rate)
+{
+	double w0 = 2.0 * EMG_PI * frequency / sample_rate;
+	double alpha = sin(w0) / (2.0 * q), cos_w0 = cos(w0);
+	double a0 = 1.0 + alpha, b0, b1, b2;
+
+	if (kind == BIQUAD_HIGHPASS)
+	{
+		b0 = (1.0 + cos_w0) / 2.0;
+		b1 = -(1.0 + cos_w0);
+		b2 = b0;
+	} else if (kind == BIQUAD_LOWPASS)
+	{
+		b0 = (1.0 - cos_w0) / 2.0;
+		b1 = 1.0 - cos_w0;
+		b2 = b0;
+	} else {
+		b0 = 1.0;
+		b1 = -2.0 * cos_w0;
+		b2 = 1.0;
+	}
+	filter->b0 = _mm_set1_ps((float)(b0 / a0));
+	filter->b1 = _mm_set1_ps((float)(b1 / a0));
+	filter->b2 = _mm_set1_ps((float)(b2 / a0));
+	filter->a1 = _mm_set1_ps((float)(-2.0 * cos_w0 / a0));
+	filter->a2 = _mm_set1_ps((float)((1.0 - alpha) / a0));
+	filter->z1 = _mm_setzero_ps();
+	filter->z2 = _mm_setzero_ps();
+}
+
+// Filter one sample of each channel
+static inline __m128 emg_StepBiquad(emg_biquad4* filter, __m128 x)
+{
+	__m128 y = _mm_add_ps(_mm_mul_ps(filter->b0, x), filter->z1);
+	filter->z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(filter->b1, x), _mm_mul_ps(filter->a1, y)), filter->z2);
+	filter->z2 = _mm_sub_ps(_mm_mul_ps(filter->b2, x), _mm_mul_ps(filter->a2, y));
+	return y;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| emg_InitDetector - Design the filters and reset the detector
+|
+| Syntax --
+|	void emg_InitDetector(emg_detector* detector, float sample_rate)
+|
+| Inputs --
+|	emg_detector* detector -> detector to initialise
+|	float sample_rate -> sample rate of the EMG stream (Hz)
+----------------------------------------------------------------------------------------------------------------------*/
+void emg_InitDetector(emg_detector* detector, float sample_rate)
+{
+	memset(detector, 0, sizeof(emg_detector));
+	emg_DesignBiquad(&detector->highpass, BIQUAD_HIGHPASS, EMG_HIGHPASS_HZ, 0.70710678, sample_rate);
+	emg_DesignBiquad(&detector->lowpass, BIQUAD_LOWPASS, EMG_LOWPASS_HZ, 0.70710678, sample_rate);
+	emg_DesignBiquad(&detector->notch, BIQUAD_NOTCH, EMG_NOTCH_HZ, EMG_NOTCH_Q, sample_rate);
+	detector->envelope_coef = _mm_set1_ps((float)(1.0 - exp(-2.0 * EMG_PI * EMG_ENVELOPE_HZ / sample_rate)));
+	detector->base_coef = _mm_set1_ps((float)(1.0 - exp(-1.0 / (EMG_BASELINE_S * sample_rate))));
+	detector->onset_samples = (int)(EMG_ONSET_S * sample_rate + 0.5f);
+	detector->calibration_samples = (int)(EMG_CALIBRATION_S * sample_rate + 0.5f);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| emg_ProcessSample - Process one sample of the four channels
+|
+| Syntax --
+|	int emg_ProcessSample(emg_detector* detector, const float* samples, unsigned long long timestamp_us)
+|
+| Inputs --
+|	emg_detector* detector -> initialised detector
+|	const float* samples -> one raw sample per channel (BB, BR, TBLongH, TBLatH)
+|	unsigned long long timestamp_us -> source timestamp of the samples (us)
+|
+| Outputs --
+|	int -> bit i set if an onset was detected on channel i with this sample
+----------------------------------------------------------------------------------------------------------------------*/
+int emg_ProcessSample(emg_detector* detector, const float* samples, unsigned long long timestamp_us)
+{
+	// Initialise variables
+	__m128 x, energy, deviation, std_dev, rest_mask;
+	int above_onset, above_offset, onsets = 0;
+
+	// Band-pass and notch filtering
+	x = _mm_loadu_ps(samples);
+	x = emg_StepBiquad(&detector->highpass, x);
+	x = emg_StepBiquad(&detector->lowpass, x);
+	x = emg_StepBiquad(&detector->notch, x);
+
+	// Rectified Teager-Kaiser energy : |x[n-1]^2 - x[n] x[n-2]|
+	energy = _mm_sub_ps(_mm_mul_ps(detector->x1, detector->x1), _mm_mul_ps(x, detector->x2));
+	energy = _mm_andnot_ps(_mm_set1_ps(-0.0f), energy);
+	detector->x2 = detector->x1;
+	detector->x1 = x;
+
+	// Envelope
+	detector->envelope = _mm_add_ps(detector->envelope,
+		                            _mm_mul_ps(detector->envelope_coef, _mm_sub_ps(energy, detector->envelope)));
+
+	// Thresholds from the statistics of the envelope at rest
+	deviation = _mm_sub_ps(detector->envelope, detector->base_mean);
+	std_dev = _mm_sqrt_ps(detector->base_var);
+	above_onset = _mm_movemask_ps(_mm_cmpgt_ps(deviation, _mm_mul_ps(_mm_set1_ps(EMG_ONSET_K), std_dev)));
+	above_offset = _mm_movemask_ps(_mm_cmpgt_ps(deviation, _mm_mul_ps(_mm_set1_ps(EMG_OFFSET_K), std_dev)));
+
+	// The baseline only follows the channels at rest
+	rest_mask = _mm_castsi128_ps(_mm_set_epi32(detector->active[3] ? 0 : -1, detector->active[2] ? 0 : -1,
+		                                       detector->active[1] ? 0 : -1, detector->active[0] ? 0 : -1));
+	detector->base_mean = _mm_add_ps(detector->base_mean,
+		                             _mm_and_ps(rest_mask, _mm_mul_ps(detector->base_coef, deviation)));
+	detector->base_var = _mm_add_ps(detector->base_var, _mm_and_ps(rest_mask,
+		                            _mm_mul_ps(detector->base_coef,
+		                                       _mm_sub_ps(_mm_mul_ps(deviation, deviation), detector->base_var))));
+	detector->nb_samples++;
+	if (detector->nb_samples <= detector->calibration_samples)
+	{
+		return 0;
+	}
+
+	// Onset after onset_samples consecutive samples above the onset threshold, offset below the offset threshold
+	for (int i(0); i < EMG_DETECTOR_CHANNELS; i++)
+	{
+		if (!detector->active[i])
+		{
+			if (above_onset & (1 << i))
+			{
+				if (detector->above[i]++ == 0)
+				{
+					detector->first_above_us[i] = timestamp_us;
+				}
+				if (detector->above[i] >= detector->onset_samples)
+				{
+					detector->active[i] = 1;
+					detector->delay_us[i] = (long long)(timestamp_us - detector->first_above_us[i]);
+					detector->nb_onsets[i]++;
+					onsets |= 1 << i;
+				}
+			} else {
+				detector->above[i] = 0;
+			}
+		} else if (!(above_offset & (1 << i)))
+		{
+			detector->active[i] = 0;
+			detector->above[i] = 0;
+		}
+	}
+	return onsets;
+}
@@ -0,0 +1,69 @@
+/***********************************************************************************************************************
+* emg_onset.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the streaming EMG onset detector. The four channels (BB, BR, TBLongH, TBLatH) are
+* processed together in SSE registers, one sample at a time and with a fixed cost per sample.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef EMG_ONSET_H
+#define EMG_ONSET_H
+
+// General includes
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+// Detector constants
+#define EMG_DETECTOR_CHANNELS 4					// Number of channels processed together (one SSE register)
+#define EMG_SAMPLE_RATE 2000.0f					// Sample rate of the EMG stream (Hz)
+#define EMG_HIGHPASS_HZ 20.0f					// Cut-off of the high-pass filter (movement artefacts)
+#define EMG_LOWPASS_HZ 450.0f					// Cut-off of the low-pass filter
+#define EMG_NOTCH_HZ 50.0f						// Frequency of the mains notch
+#define EMG_NOTCH_Q 30.0f						// Quality factor of the mains notch
+#define EMG_ENVELOPE_HZ 10.0f					// Cut-off of the envelope smoothing
+#define EMG_BASELINE_S 2.0f						// Time constant of the rest baseline (s)
+#define EMG_CALIBRATION_S 1.0f					// Rest duration before detections are allowed (s)
+#define EMG_ONSET_K 5.0f						// Onset threshold : baseline mean + EMG_ONSET_K standard deviations
+#define EMG_OFFSET_K 2.0f						// Offset threshold : baseline mean + EMG_OFFSET_K standard deviations
+#define EMG_ONSET_S 0.010f						// Time above the onset threshold required for a detection (s)
+
+// ------------------------------------------------- BIQUAD SUBSTRUCT --------------------------------------------------
+// Same second order section applied to the four channels (transposed direct form II)
+struct emg_biquad4
+{
+	__m128 b0, b1, b2;						// Numerator coefficients
+	__m128 a1, a2;							// Denominator coefficients (a0 = 1)
+	__m128 z1, z2;							// States of each channel
+};
+
+// ------------------------------------------------- DETECTOR STRUCT ---------------------------------------------------
+struct emg_detector
+{
+	emg_biquad4 highpass;					// Band-pass filter, high-pass section
+	emg_biquad4 lowpass;					// Band-pass filter, low-pass section
+	emg_biquad4 notch;						// Mains notch
+	__m128 x1, x2;							// Last two filtered samples (TKEO)
+	__m128 envelope;						// Smoothed rectified TKEO of each channel
+	__m128 envelope_coef;					// Envelope smoothing coefficient
+	__m128 base_mean;						// Mean of the envelope at rest
+	__m128 base_var;						// Variance of the envelope at rest
+	__m128 base_coef;						// Baseline smoothing coefficient
+	int onset_samples;						// Samples above the onset threshold required for a detection
+	int calibration_samples;				// Samples at rest before detections are allowed
+	long long nb_samples;					// Samples processed
+	int above[EMG_DETECTOR_CHANNELS];		// Consecutive samples above the onset threshold
+	int active[EMG_DETECTOR_CHANNELS];		// 1 : muscle active ; 0 : muscle at rest
+	unsigned long long first_above_us[EMG_DETECTOR_CHANNELS];	// Source time of the first sample above threshold
+	long long delay_us[EMG_DETECTOR_CHANNELS];					// Delay of the last detection (us)
+	long long nb_onsets[EMG_DETECTOR_CHANNELS];					// Number of detections
+};
+
+// Functions declaration
+void emg_InitDetector(emg_detector* detector, float sample_rate);
+int emg_ProcessSample(emg_detector* detector, const float* samples, unsigned long long timestamp_us);
+#endif // !EMG_ONSET_H
\ No newline at end of file
@@ -0,0 +1,472 @@
+/***********************************************************************************************************************
+* fault_injection.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Injects the faults of a profile in the state frames of the drive and in the samples of the wrist FT thread, between
+* the transports and the control loop, and measures their effect on the iterations and on the tracking of the
+* controllers. The injector only touches the frames once received : the same calls sit before state_Update and
+* digitalFT_ApplySamples in the simulated sessions (batch_simulation.h).
+***********************************************************************************************************************/
+
+#include "fault_injection.h"
+
+// Names of the transports and faults in the profiles file and in the results table
+static const char* fault_TransportNames[FAULT_NB_TRANSPORTS] = { "drive", "ft" };
+static const char* fault_KindNames[FAULT_NB_KINDS] = { "delay", "drop", "duplicate", "corrupt" };
+
+// Random generator of the injector (xorshift), the same seed gives the same faults
+static unsigned int fault_Random(fault_Injector* injector)
+{
+	injector->random ^= injector->random << 13;
+	injector->random ^= injector->random >> 17;
+	injector->random ^= injector->random << 5;
+	return injector->random;
+}
+
+// Uniform draw in [0, 1[
+static float fault_Uniform(fault_Injector* injector)
+{
+	return (fault_Random(injector) >> 8) * (1.0f / 16777216.0f);
+}
+
+// ----------------------------------------------------- PROFILES ------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| fault_ReadProfiles - Read the fault profiles of a campaign
+|
+| Syntax --
+|	int fault_ReadProfiles(FILE* err_file, const char* profiles_name, std::vector<fault_Profile>* profiles)
+|
+| Inputs --
+|	FILE* err_file -> file to print errors
+|	const char* profiles_name -> name of the profiles file
+|	std::vector<fault_Profile>* profiles -> filled with the profiles of the file
+|
+| Outputs --
+|	int -> 0 : Success ; -1 : file not opened, invalid or without profile
+|
+| Remarks --
+|	"profile name" starts a profile and "seed n" sets the seed of its random faults, '#' starts a comment. Every
+|	other line is a rule : transport (drive, ft), fault (delay, drop, duplicate, corrupt), then at=iteration for a
+|	scripted fault or rate=probability for a fault starting at random iterations, length=iterations (1 by default)
+|	and delay=ms for the delays :
+|		profile stall
+|		drive drop at=3000 length=50
+|		ft delay rate=0.01 length=20 delay=4
+----------------------------------------------------------------------------------------------------------------------*/
+int fault_ReadProfiles(FILE* err_file, const char* profiles_name, std::vector<fault_Profile>* profiles)
+{
+	// Initialise variables
+	FILE* profiles_file = NULL;
+	char line[FAULT_LINE_LENGTH], *token, *end;
+	fault_Profile* profile = NULL;
+	fault_Rule rule;
+	int nb_lines = 0, status = 0;
+	float value;
+
+	profiles->clear();
+	profiles->reserve(FAULT_MAX_PROFILES);
+	fopen_s(&profiles_file, profiles_name, "rt");
+	if (profiles_file == NULL)
+	{
+		fprintf(err_file, "Fault profiles file %s not opened !\n", profiles_name);
+		return -1;
+	}
+	while (status == 0 && fgets(line, FAULT_LINE_LENGTH, profiles_file) != NULL)
+	{
+		nb_lines++;
+		if ((end = strchr(line, '#')) != NULL)
+		{
+			*end = '\0';
+		}
+		token = strtok(line, " \t\r\n");
+		if (token == NULL)
+		{
+			continue;
+		}
+
+		// New profile and its seed
+		if (strcmp(token, "profile") == 0)
+		{
+			token = strtok(NULL, " \t\r\n");
+			if (token == NULL || strlen(token) >= FAULT_NAME_LENGTH || profiles->size() == FAULT_MAX_PROFILES)
+			{
+				fprintf(err_file, "Invalid fault profile name or too many profiles (max %i), line %i of %s\n",
+					    FAULT_MAX_PROFILES, nb_lines, profiles_name);
+				status = -1;
+				break;
+			}
+			profiles->push_back(fault_Profile());
+			profile = &profiles->back();
+			strcpy(profile->name, token);
+			profile->seed = (unsigned int)profiles->size();
+			profile->nb_rules = 0;
+			continue;
+		}
+		if (strcmp(token, "seed") == 0)
+		{
+			token = strtok(NULL, " \t\r\n");
+			if (profile == NULL || token == NULL || sscanf(token, "%u", &profile->seed) != 1 || profile->seed == 0)
+			{
+				fprintf(err_file, "Invalid seed, line %i of %s\n", nb_lines, profiles_name);
+				status = -1;
+			}
+			continue;
+		}
+
+		// Rule of the current profile : transport and fault
+		rule.transport = -1;
+		rule.kind = -1;
+		for (int t(0); t < FAULT_NB_TRANSPORTS; t++)
+		{
+			rule.transport = strcmp(token, fault_TransportNames[t]) == 0 ? t : rule.transport;
+		}
+		token = strtok(NULL, " \t\r\n");
+		for (int k(0); token != NULL && k < FAULT_NB_KINDS; k++)
+		{
+			rule.kind = strcmp(token, fault_KindNames[k]) == 0 ? k : rule.kind;
+		}
+		if (profile == NULL || rule.transport < 0 || rule.kind < 0 || profile->nb_rules == FAULT_MAX_RULES)
+		{
+			fprintf(err_file, "Invalid fault rule, missing profile or too many rules (max %i), line %i of %s\n",
+				    FAULT_MAX_RULES, nb_lines, profiles_name);
+			status = -1;
+			break;
+		}
+
+		// Trigger, length and delay
+		rule.start = -1;
+		rule.rate = -1.0f;
+		rule.length = 1;
+		rule.delay = 0.0f;
+		while ((token = strtok(NULL, " \t\r\n")) != NULL)
+		{
+			if ((end = strchr(token, '=')) == NULL)
+			{
+				status = -1;
+				break;
+			}
+			*end = '\0';
+			value = strtof(end + 1, &end);
+			if (*end != '\0' || !isfinite(value))
+			{
+				status = -1;
+				break;
+			}
+			if (strcmp(token, "at") == 0 && value >= 0.0f)
+			{
+				rule.start = (int)value;
+			} else if (strcmp(token, "rate") == 0 && value >= 0.0f && value <= 1.0f)
+			{
+				rule.rate = value;
+			} else if (strcmp(token, "length") == 0 && value >= 1.0f)
+			{
+				rule.length = (int)value;
+			} else if (strcmp(token, "delay") == 0 && value > 0.0f)
+			{
+				rule.delay = value * 1e-3f;
+			} else
+			{
+				status = -1;
+				break;
+			}
+		}
+		if (status != 0 || (rule.start < 0) == (rule.rate < 0.0f) || (rule.kind == FAULT_DELAY) != (rule.delay > 0.0f))
+		{
+			fprintf(err_file, "Invalid fault rule, at= or rate= expected, delay= for the delays only, line %i of %s\n",
+				    nb_lines, profiles_name);
+			status = -1;
+			break;
+		}
+		profile->rules[profile->nb_rules++] = rule;
+	}
+	fclose(profiles_file);
+	if (status == 0 && profiles->empty())
+	{
+		fprintf(err_file, "No fault profile in %s\n", profiles_name);
+		status = -1;
+	}
+	return status;
+}
+
+// ----------------------------------------------------- INJECTOR ------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| fault_Reset - Prepare the injector for a session
+|
+| Syntax --
+|	void fault_Reset(fault_Injector* injector, const fault_Profile* profile, unsigned int seed, float period,
+|					 const std::vector<float>* reference, std::vector<float>* trace)
+|
+| Inputs --
+|	fault_Injector* injector -> injector of the session
+|	const fault_Profile* profile -> faults to inject, NULL : frames delivered untouched
+|	unsigned int seed -> seed of the random faults (not 0)
+|	float period -> nominal period of the control loop (s)
+|	const std::vector<float>* reference -> tracking error of the fault-free session, NULL : no recovery measured
+|	std::vector<float>* trace -> filled with the tracking error of the session (sized by the caller), or NULL
+----------------------------------------------------------------------------------------------------------------------*/
+void fault_Reset(fault_Injector* injector, const fault_Profile* profile, unsigned int seed, float period,
+	             const std::vector<float>* reference, std::vector<float>* trace)
+{
+	*injector = fault_Injector();
+	injector->profile = profile;
+	injector->random = seed != 0 ? seed : 1;
+	injector->period = period;
+	injector->episode_end = -1.0f;
+	injector->reference = reference;
+	injector->trace = trace;
+	injector->report.stopped_time = -1.0f;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| fault_BeginCycle - Draw the faults of an iteration
+|
+| Syntax --
+|	float fault_BeginCycle(fault_Injector* injector, int iteration)
+|
+| Inputs --
+|	fault_Injector* injector -> injector of the session
+|	int iteration -> counter of the iteration
+|
+| Outputs --
+|	float -> delay of the state frame of the drive (s) : the iteration lasts the period plus this delay
+|
+| Remarks --
+|	Every random rule draws at every iteration, faulty or not : the faults of a rule do not depend on the others. A
+|	rule does not restart before the end of its previous fault.
+----------------------------------------------------------------------------------------------------------------------*/
+float fault_BeginCycle(fault_Injector* injector, int iteration)
+{
+	// Initialise variables
+	const fault_Rule* rule;
+	int draw, age, faulty;
+
+	memset(injector->active, 0, sizeof(injector->active));
+	injector->drive_delay = 0.0f;
+	injector->ft_delay = 0;
+	injector->faulty = 0;
+	if (injector->profile == NULL)
+	{
+		return 0.0f;
+	}
+	for (int r(0); r < injector->profile->nb_rules; r++)
+	{
+		rule = &injector->profile->rules[r];
+		draw = rule->start < 0 && fault_Uniform(injector) < rule->rate;
+		if (injector->remaining[r] == 0 && (rule->start == iteration || draw))
+		{
+			injector->remaining[r] = rule->length;
+		}
+		if (injector->remaining[r] == 0)
+		{
+			continue;
+		}
+		injector->remaining[r]--;
+		injector->active[rule->transport][rule->kind] = 1;
+		if (rule->kind == FAULT_DELAY && rule->transport == FAULT_DRIVE)
+		{
+			injector->drive_delay = rule->delay > injector->drive_delay ? rule->delay : injector->drive_delay;
+		} else if (rule->kind == FAULT_DELAY)
+		{
+			age = (int)(rule->delay / injector->period + 0.5f);
+			injector->ft_delay = age > injector->ft_delay ? age : injector->ft_delay;
+		}
+	}
+
+	// Faulty iterations of each transport and episodes
+	for (int t(0); t < FAULT_NB_TRANSPORTS; t++)
+	{
+		faulty = 0;
+		for (int k(0); k < FAULT_NB_KINDS; k++)
+		{
+			faulty |= injector->active[t][k];
+		}
+		injector->report.nb_faulty[t] += faulty;
+		injector->faulty |= faulty;
+	}
+	if (injector->faulty && !injector->in_episode)
+	{
+		injector->report.nb_episodes++;
+		if (injector->episode_end >= 0.0f)
+		{
+			injector->report.nb_unrecovered++;
+			injector->episode_end = -1.0f;
+		}
+	}
+	return injector->drive_delay;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| fault_DriveFrame - Pass the state frame received from the drive through the faults of the iteration
+|
+| Syntax --
+|	void fault_DriveFrame(fault_Injector* injector, ServoComEth* eth_ABLE, realTimeParams* rtValues)
+|
+| Inputs --
+|	fault_Injector* injector -> injector of the session
+|	ServoComEth* eth_ABLE -> translated state frame (ETH_carte_variateur_V3_Datas), modified by the faults
+|	realTimeParams* rtValues -> able_OrderNotTransmitted set as by check_OrderTransmission
+|
+| Remarks --
+|	A dropped frame is seen as a receive error and leaves the previous frame in the buffers, a duplicated frame
+|	repeats the previous one without error. A corrupted frame has the same random bit of every coder position flipped
+|	and is not detected.
+----------------------------------------------------------------------------------------------------------------------*/
+void fault_DriveFrame(fault_Injector* injector, ServoComEth* eth_ABLE, realTimeParams* rtValues)
+{
+	// Initialise variables
+	int* active = injector->active[FAULT_DRIVE];
+	int bit;
+
+	rtValues->able_OrderNotTransmitted = active[FAULT_DROP] != 0;
+	if ((active[FAULT_DROP] || active[FAULT_DUPLICATE]) && injector->frame_received)
+	{
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			eth_ABLE->moteur[i] = injector->moteur[i];
+		}
+		eth_ABLE->entree_tor = injector->entree_tor;
+		return;
+	}
+	if (active[FAULT_CORRUPT])
+	{
+		bit = (int)(fault_Random(injector) % FAULT_CORRUPT_BITS);
+		for (int i(0); i < NB_MOTORS; i++)
+		{
+			eth_ABLE->moteur[i].Position_Codeur ^= 1 << bit;
+		}
+	}
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		injector->moteur[i] = eth_ABLE->moteur[i];
+	}
+	injector->entree_tor = eth_ABLE->entree_tor;
+	injector->frame_received = 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| fault_FTSample - Pass the sample published by the FT thread through the faults of the iteration
+|
+| Syntax --
+|	void fault_FTSample(fault_Injector* injector, const FT_meas_Global* published, FT_meas_Global* read)
+|
+| Inputs --
+|	fault_Injector* injector -> injector of the session
+|	const FT_meas_Global* published -> last sample published by the FT thread
+|	FT_meas_Global* read -> sample read by the control loop (FT_sample_Wrist), holds the previous one
+|
+| Remarks --
+|	Dropped and duplicated samples leave the previous sample in the shared struct. A delayed sample is the one
+|	published the delay earlier, with its tick : its age is compensated by ftstage_Predict as in the control loop. A
+|	checksum failure ends the streaming loop of the FT thread, the streaming flag drops.
+----------------------------------------------------------------------------------------------------------------------*/
+void fault_FTSample(fault_Injector* injector, const FT_meas_Global* published, FT_meas_Global* read)
+{
+	// Initialise variables
+	int* active = injector->active[FAULT_FT];
+	int age = injector->ft_delay;
+
+	injector->history[injector->nb_published % FAULT_HISTORY] = *published;
+	injector->nb_published++;
+	if ((active[FAULT_DROP] || active[FAULT_DUPLICATE]) && injector->nb_published > 1)
+	{
+		return;
+	}
+	age = age > FAULT_HISTORY - 1 ? FAULT_HISTORY - 1 : age;
+	age = age > injector->nb_published - 1 ? injector->nb_published - 1 : age;
+	*read = injector->history[(injector->nb_published - 1 - age) % FAULT_HISTORY];
+	if (active[FAULT_CORRUPT])
+	{
+		read->streaming = FALSE;
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| fault_EndCycle - Measure the effect of the faults at the end of an iteration
+|
+| Syntax --
+|	void fault_EndCycle(fault_Injector* injector, float time, float error)
+|
+| Inputs --
+|	fault_Injector* injector -> injector of the session
+|	float time -> time at which the state frame of the iteration was received (s)
+|	float error -> tracking error at the end of the iteration (rad)
+|
+| Remarks --
+|	The tracking error is compared with the one of the fault-free session at the same time, when the fault-free
+|	session reached it (NAN otherwise). An episode is recovered at the first fault-free iteration where the deviation
+|	is within FAULT_RECOVERY_TOLERANCE, the iterations without fault-free error to compare with do not recover.
+----------------------------------------------------------------------------------------------------------------------*/
+void fault_EndCycle(fault_Injector* injector, float time, float error)
+{
+	// Extract substructs
+	fault_Report* report = &injector->report;
+
+	// Initialise variables
+	int index = (int)(time / injector->period + 0.5f);
+	float cycle = injector->period + injector->drive_delay, deviation = -1.0f, recovery;
+
+	if (injector->trace != NULL && index < (int)injector->trace->size())
+	{
+		(*injector->trace)[index] = error;
+	}
+	if (injector->reference != NULL && index < (int)injector->reference->size() &&
+		!isnan((*injector->reference)[index]))
+	{
+		deviation = fabsf(error - (*injector->reference)[index]);
+	}
+
+	// Iterations longer than the period
+	report->nb_overruns += injector->drive_delay > 0.0f;
+	report->max_cycle = cycle > report->max_cycle ? cycle : report->max_cycle;
+	report->max_deviation = deviation > report->max_deviation ? deviation : report->max_deviation;
+
+	// Recovery after the end of the episode
+	if (injector->faulty)
+	{
+		injector->in_episode = 1;
+		return;
+	}
+	if (injector->in_episode)
+	{
+		injector->in_episode = 0;
+		injector->episode_end = time;
+	}
+	if (injector->episode_end >= 0.0f && deviation >= 0.0f && deviation <= FAULT_RECOVERY_TOLERANCE)
+	{
+		recovery = time - injector->episode_end;
+		report->max_recovery = recovery > report->max_recovery ? recovery : report->max_recovery;
+		injector->sum_recovery += recovery;
+		injector->nb_recovered++;
+		injector->episode_end = -1.0f;
+	}
+}
+
+// Control loop stopped : the episode in progress is not recovered
+void fault_Stop(fault_Injector* injector, float time)
+{
+	injector->report.stopped_time = time;
+	if (injector->in_episode || injector->episode_end >= 0.0f)
+	{
+		injector->report.nb_unrecovered++;
+	}
+	injector->in_episode = 0;
+	injector->episode_end = -1.0f;
+}
+
+// Metrics of the session, the episode in progress at the end is not recovered
+void fault_Finish(fault_Injector* injector, fault_Report* report)
+{
+	if (injector->in_episode || injector->episode_end >= 0.0f)
+	{
+		injector->report.nb_unrecovered++;
+		injector->in_episode = 0;
+		injector->episode_end = -1.0f;
+	}
+	injector->report.mean_recovery = injector->nb_recovered > 0 ? injector->sum_recovery / injector->nb_recovered : 0.0f;
+	*report = injector->report;
+}
@@ -0,0 +1,118 @@
+/***********************************************************************************************************************
+* fault_injection.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the fault injection between the transports and the control loop. The state frame of the
+* drive and the sample of the wrist FT thread go through an injector before being used : each fault profile delays,
+* drops, duplicates or corrupts them, on a script or at random, and the injector measures the cycle overruns, the
+* deviation of the tracking error from the fault-free session and the time the controllers take to recover.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef FAULT_INJECTION_H
+#define FAULT_INJECTION_H
+
+// General includes
+#include <stdio.h>
+#include <vector>
+// Project includes
+#include "communication_struct_ABLE.h"
+
+// Fault campaign files
+#define FAULT_PROFILES_FILE "fault_profiles.txt"		// Fault profiles injected in every session of the sweep
+#define FAULT_RESULTS_FILE "fault_results.txt"			// Table of the metrics of every session and profile
+// Fault limits
+#define FAULT_MAX_PROFILES 32							// Maximal number of profiles of a campaign
+#define FAULT_MAX_RULES 16								// Maximal number of rules of a profile
+#define FAULT_NAME_LENGTH 32							// Maximal length of the name of a profile
+#define FAULT_LINE_LENGTH 512							// Maximal length of a line of the profiles file
+#define FAULT_HISTORY 64								// Published FT samples kept for the delayed deliveries
+#define FAULT_CORRUPT_BITS 16							// Low bits of the coder position a corruption may flip
+#define FAULT_RECOVERY_TOLERANCE 0.005f					// Deviation from the fault-free tracking error (rad)
+
+// Transports
+#define FAULT_DRIVE 0									// State frame of the drive (check_OrderTransmission)
+#define FAULT_FT 1										// Sample of the wrist FT thread (digitalFT_ReadData)
+#define FAULT_NB_TRANSPORTS 2
+
+// Faults, a stall is a drop lasting several cycles
+#define FAULT_DELAY 0									// Drive : frame received late ; FT : old sample read
+#define FAULT_DROP 1									// Frame lost, the previous one stays in the buffers
+#define FAULT_DUPLICATE 2								// Previous frame received again, not detected
+#define FAULT_CORRUPT 3									// Drive : coder bit flipped ; FT : checksum failure
+#define FAULT_NB_KINDS 4
+
+// ------------------------------------------------------ RULE STRUCT --------------------------------------------------
+struct fault_Rule
+{
+	int transport;									// FAULT_DRIVE or FAULT_FT
+	int kind;										// FAULT_DELAY, FAULT_DROP, FAULT_DUPLICATE or FAULT_CORRUPT
+	int start;										// Iteration of a scripted fault, -1 : random fault
+	float rate;										// Probability of a random fault starting at each iteration
+	int length;										// Consecutive faulty iterations
+	float delay;									// Delay of FAULT_DELAY (s)
+};
+
+// ----------------------------------------------------- PROFILE STRUCT ------------------------------------------------
+struct fault_Profile
+{
+	char name[FAULT_NAME_LENGTH];					// Name of the profile in the results table
+	unsigned int seed;								// Seed of the random faults
+	int nb_rules;									// Number of rules
+	fault_Rule rules[FAULT_MAX_RULES];				// Faults injected in the session
+};
+
+// ----------------------------------------------------- REPORT STRUCT -------------------------------------------------
+struct fault_Report
+{
+	int nb_faulty[FAULT_NB_TRANSPORTS];				// Iterations with a fault on each transport
+	int nb_episodes;								// Sequences of consecutive faulty iterations
+	int nb_overruns;								// Iterations longer than the period
+	float max_cycle;								// Longest iteration (s)
+	float stopped_time;								// Time at which the control loop stopped (s), -1 : not stopped
+	float max_deviation;							// Largest deviation from the fault-free tracking error (rad)
+	float max_recovery;								// Longest time from the end of an episode to the recovery (s)
+	float mean_recovery;							// Mean time from the end of an episode to the recovery (s)
+	int nb_unrecovered;								// Episodes not recovered before the next one or the end
+};
+
+// ---------------------------------------------------- INJECTOR STRUCT ------------------------------------------------
+struct fault_Injector
+{
+	const fault_Profile* profile;					// Injected profile, NULL : frames delivered untouched
+	unsigned int random;							// State of the random generator (xorshift)
+	float period;									// Nominal period of the control loop (s)
+	int remaining[FAULT_MAX_RULES];					// Faulty iterations left for each rule
+	int active[FAULT_NB_TRANSPORTS][FAULT_NB_KINDS];// Faults of the current iteration
+	float drive_delay;								// Delay of the drive frame of the current iteration (s)
+	int ft_delay;									// Age of the FT sample of the current iteration (iterations)
+	Rec_Moteur moteur[NB_MOTORS];					// Last state frame received from the drive
+	int entree_tor;									// Inputs of the last state frame received
+	int frame_received;								// 1 : a state frame was received
+	FT_meas_Global history[FAULT_HISTORY];			// Last samples published by the FT thread
+	int nb_published;								// Samples published since the start
+	int faulty;										// 1 : current iteration faulty
+	int in_episode;									// 1 : previous iteration faulty
+	float episode_end;								// Time of the end of the last episode (s), -1 : recovered
+	float sum_recovery;								// Sum of the recovery times (s)
+	int nb_recovered;								// Episodes recovered
+	const std::vector<float>* reference;			// Tracking error of the fault-free session, one per period
+	std::vector<float>* trace;						// Filled with the tracking error of the session if not NULL
+	fault_Report report;							// Metrics of the session
+};
+
+// Functions declaration
+int fault_ReadProfiles(FILE* err_file, const char* profiles_name, std::vector<fault_Profile>* profiles);
+void fault_Reset(fault_Injector* injector, const fault_Profile* profile, unsigned int seed, float period,
+	             const std::vector<float>* reference, std::vector<float>* trace);
+float fault_BeginCycle(fault_Injector* injector, int iteration);
+void fault_DriveFrame(fault_Injector* injector, ServoComEth* eth_ABLE, realTimeParams* rtValues);
+void fault_FTSample(fault_Injector* injector, const FT_meas_Global* published, FT_meas_Global* read);
+void fault_EndCycle(fault_Injector* injector, float time, float error);
+void fault_Stop(fault_Injector* injector, float time);
+void fault_Finish(fault_Injector* injector, fault_Report* report);
+#endif // !FAULT_INJECTION_H
\ No newline at end of file
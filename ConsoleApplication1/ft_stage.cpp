@@ -0,0 +1,201 @@
+/***********************************************************************************************************************
+* ft_stage.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Force stage executed by the FT measures threads. Every sensor sample is pushed in the stage, which is scheduled by
+* counting samples (no timer) : the raw wrench is integrated at every sample, the low-pass filter and its derivative
+* run every stage_decimation samples and the outputs are published to the control thread every publish_decimation
+* runs. The control thread reads the last publication at its own rate, compensates the age of the sample and the
+* delay of the filter with the derivative (ftstage_Predict), and uses the difference of the integrals between two of
+* its iterations for the integral terms of the force loops : this impulse is exact at the sensor rate whatever the
+* rate of the control loop.
+***********************************************************************************************************************/
+
+#include "ft_stage.h"
+#include "time_base.h"
+
+#include <math.h>
+
+// Pi in single precision (M_PI is defined with the control struct)
+static const float ftstage_Pi = 3.14159265f;
+
+/*---------------------------------------------------------------------------------------------------------------------
+| ftstage_Init - Design the filter and reset the stage
+|
+| Syntax --
+|	void ftstage_Init(ft_stage* stage, float sample_period, int stage_decimation, int publish_decimation, float cutoff)
+|
+| Inputs --
+|	ft_stage* stage -> stage to initialise
+|	float sample_period -> nominal period of the sensor samples (s)
+|	int stage_decimation -> sensor samples per run of the stage (at least 1)
+|	int publish_decimation -> runs of the stage per publication (at least 1)
+|	float cutoff -> cutoff frequency of the filter (Hz), below the Nyquist frequency of the stage
+|
+| Remarks --
+|	Second order Butterworth filter discretised by the bilinear transform with prewarping. The stage does not
+|	filter before decimating : keep stage_decimation at 1 unless the sensor is already filtered.
+----------------------------------------------------------------------------------------------------------------------*/
+void ftstage_Init(ft_stage* stage, float sample_period, int stage_decimation, int publish_decimation, float cutoff)
+{
+	// Initialise variables
+	float period, k, norm;
+
+	stage->sample_period = sample_period;
+	stage->stage_decimation = stage_decimation < 1 ? 1 : stage_decimation;
+	stage->publish_decimation = publish_decimation < 1 ? 1 : publish_decimation;
+	period = sample_period * stage->stage_decimation;
+
+	// Filter coefficients
+	k = tanf(ftstage_Pi * cutoff * period);
+	norm = 1.0f / (1.0f + sqrtf(2.0f) * k + k * k);
+	stage->b[0] = k * k * norm;
+	stage->b[1] = 2.0f * stage->b[0];
+	stage->b[2] = stage->b[0];
+	stage->a[0] = 2.0f * (k * k - 1.0f) * norm;
+	stage->a[1] = (1.0f - sqrtf(2.0f) * k + k * k) * norm;
+	stage->group_delay = sqrtf(2.0f) / (2.0f * ftstage_Pi * cutoff);
+
+	for (int c(0); c < FTSTAGE_NB_CHANNELS; c++)
+	{
+		stage->inputs[0][c] = stage->inputs[1][c] = 0.0f;
+		stage->outputs[0][c] = stage->outputs[1][c] = 0.0f;
+		stage->last_raw[c] = 0.0f;
+		stage->filtered[c] = 0.0f;
+		stage->derivative[c] = 0.0f;
+		stage->integral[c] = 0.0;
+	}
+	stage->tick = 0;
+	stage->nb_samples = 0;
+	stage->nb_runs = 0;
+	stage->nb_published = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| ftstage_InitForRate - Initialise the stage for the sensor and control rates of the session
+|
+| Syntax --
+|	void ftstage_InitForRate(ft_stage* stage, float sample_period, float ctrl_rate)
+|
+| Inputs --
+|	ft_stage* stage -> stage to initialise
+|	float sample_period -> nominal period of the sensor samples (s)
+|	float ctrl_rate -> rate of the control loop reading the stage (Hz)
+|
+| Remarks --
+|	The stage runs at every sample (the sensor is not filtered before), publishes FTSTAGE_PUBLISH_PER_CYCLE times per
+|	control iteration and filters at FTSTAGE_CUTOFF_RATIO of the control rate : 4 runs and 200 Hz at 8 kHz and 1 kHz.
+----------------------------------------------------------------------------------------------------------------------*/
+void ftstage_InitForRate(ft_stage* stage, float sample_period, float ctrl_rate)
+{
+	// Initialise variables
+	int stage_decimation = 1;
+	float stage_rate = 1.0f / (sample_period * stage_decimation);
+	int publish_decimation = (int)(stage_rate / (ctrl_rate * FTSTAGE_PUBLISH_PER_CYCLE) + 0.5f);
+	float cutoff = FTSTAGE_CUTOFF_RATIO * ctrl_rate;
+
+	if (cutoff > FTSTAGE_MAX_CUTOFF_RATIO * stage_rate)
+	{
+		cutoff = FTSTAGE_MAX_CUTOFF_RATIO * stage_rate;
+	}
+	ftstage_Init(stage, sample_period, stage_decimation, publish_decimation, cutoff);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| ftstage_Push - Push a sensor sample in the stage and run the stage if it is scheduled
+|
+| Syntax --
+|	int ftstage_Push(ft_stage* stage, const float* raw, long long tick)
+|
+| Inputs --
+|	ft_stage* stage -> initialised stage
+|	const float* raw -> resolved wrench of the sample (FTSTAGE_NB_CHANNELS values)
+|	long long tick -> acquisition tick of the sample (timebase_Now)
+|
+| Outputs --
+|	int -> 1 if the outputs have to be published to the control thread after this sample, 0 otherwise
+|
+| Remarks --
+|	The filter starts in steady state on the first sample (no transient from zero).
+----------------------------------------------------------------------------------------------------------------------*/
+int ftstage_Push(ft_stage* stage, const float* raw, long long tick)
+{
+	// Initialise variables
+	float output;
+
+	// Integral of the raw wrench (trapezoids), at every sample
+	for (int c(0); c < FTSTAGE_NB_CHANNELS; c++)
+	{
+		if (stage->nb_samples == 0)
+		{
+			stage->inputs[0][c] = stage->inputs[1][c] = raw[c];
+			stage->outputs[0][c] = stage->outputs[1][c] = raw[c];
+			stage->filtered[c] = raw[c];
+		}
+		else
+		{
+			stage->integral[c] += 0.5 * ((double)raw[c] + stage->last_raw[c]) * stage->sample_period;
+		}
+		stage->last_raw[c] = raw[c];
+	}
+	stage->tick = tick;
+	stage->nb_samples++;
+	if (stage->nb_samples % stage->stage_decimation != 0)
+	{
+		return 0;
+	}
+
+	// Filter and derivative
+	for (int c(0); c < FTSTAGE_NB_CHANNELS; c++)
+	{
+		output = stage->b[0] * raw[c] + stage->b[1] * stage->inputs[0][c] + stage->b[2] * stage->inputs[1][c]
+			   - stage->a[0] * stage->outputs[0][c] - stage->a[1] * stage->outputs[1][c];
+		stage->inputs[1][c] = stage->inputs[0][c];
+		stage->inputs[0][c] = raw[c];
+		stage->outputs[1][c] = stage->outputs[0][c];
+		stage->outputs[0][c] = output;
+		stage->derivative[c] = (output - stage->outputs[1][c]) / (stage->sample_period * stage->stage_decimation);
+		stage->filtered[c] = output;
+	}
+	stage->nb_runs++;
+	if (stage->nb_runs % stage->publish_decimation != 0)
+	{
+		return 0;
+	}
+	stage->nb_published++;
+	return 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| ftstage_Predict - Extrapolate the filtered wrench to the tick at which it is used
+|
+| Syntax --
+|	void ftstage_Predict(const float* filtered, const float* derivative, float group_delay, long long sample_tick,
+|	                     long long target_tick, float* predicted)
+|
+| Inputs --
+|	const float* filtered, derivative -> published outputs of the stage
+|	float group_delay -> delay of the filter (s)
+|	long long sample_tick -> acquisition tick of the published sample
+|	long long target_tick -> tick at which the wrench is used (state tick of the control iteration)
+|	float* predicted -> filled with the FTSTAGE_NB_CHANNELS extrapolated values
+|
+| Remarks --
+|	The horizon (age of the sample plus delay of the filter, times FTSTAGE_PREDICTION) is limited to
+|	FTSTAGE_MAX_HORIZON so that a stale sample is not extrapolated far away.
+----------------------------------------------------------------------------------------------------------------------*/
+void ftstage_Predict(const float* filtered, const float* derivative, float group_delay, long long sample_tick,
+	                 long long target_tick, float* predicted)
+{
+	// Initialise variables
+	float horizon = FTSTAGE_PREDICTION * ((float)timebase_Seconds(target_tick - sample_tick) + group_delay);
+
+	horizon = horizon < 0.0f ? 0.0f : (horizon > FTSTAGE_MAX_HORIZON ? FTSTAGE_MAX_HORIZON : horizon);
+	for (int c(0); c < FTSTAGE_NB_CHANNELS; c++)
+	{
+		predicted[c] = filtered[c] + derivative[c] * horizon;
+	}
+}
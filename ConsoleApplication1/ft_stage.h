@@ -0,0 +1,52 @@
+/***********************************************************************************************************************
+* ft_stage.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the declaration of the force stage executed by the FT measures threads at the sensor rate : low-pass
+* filtering, derivative and impulse of the measured wrench, handed to the control loop with its latency compensated.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef FT_STAGE_H
+#define FT_STAGE_H
+
+// Stage parameters
+#define FTSTAGE_NB_CHANNELS 6							// fx, fy, fz, tx, ty, tz
+#define FTSTAGE_CUTOFF_RATIO 0.2f						// Cutoff of the Butterworth filter, ratio of the control rate
+#define FTSTAGE_MAX_CUTOFF_RATIO 0.4f					// Largest cutoff, ratio of the stage rate (below Nyquist)
+#define FTSTAGE_PUBLISH_PER_CYCLE 2						// Publications to the control thread per control iteration
+#define FTSTAGE_PREDICTION 1.0f							// Part of the latency compensated (0 : filtered force only)
+#define FTSTAGE_MAX_HORIZON 0.002f						// Largest compensated latency (s)
+
+// ---------------------------------------------------- STAGE STRUCT ---------------------------------------------------
+struct ft_stage
+{
+	float sample_period;								// Period of the sensor samples (s)
+	int stage_decimation;								// Sensor samples per run of the stage
+	int publish_decimation;								// Runs of the stage per publication
+	float b[3];											// Numerator of the filter
+	float a[2];											// Denominator of the filter (a0 = 1)
+	float group_delay;									// Delay of the filter at low frequencies (s)
+	float inputs[2][FTSTAGE_NB_CHANNELS];				// Last two inputs of the filter
+	float outputs[2][FTSTAGE_NB_CHANNELS];				// Last two outputs of the filter
+	float last_raw[FTSTAGE_NB_CHANNELS];				// Last raw sample (integration)
+	float filtered[FTSTAGE_NB_CHANNELS];				// Filtered wrench (N and N.m)
+	float derivative[FTSTAGE_NB_CHANNELS];				// Derivative of the filtered wrench (N/s and N.m/s)
+	double integral[FTSTAGE_NB_CHANNELS];				// Integral of the raw wrench since the start (N.s and N.m.s)
+	long long tick;										// Acquisition tick of the last sample (timebase_Now)
+	long long nb_samples;								// Number of samples pushed
+	long long nb_runs;									// Number of runs of the stage
+	long long nb_published;								// Number of publications requested
+};
+
+// Functions declaration
+void ftstage_Init(ft_stage* stage, float sample_period, int stage_decimation, int publish_decimation, float cutoff);
+void ftstage_InitForRate(ft_stage* stage, float sample_period, float ctrl_rate);
+int ftstage_Push(ft_stage* stage, const float* raw, long long tick);
+void ftstage_Predict(const float* filtered, const float* derivative, float group_delay, long long sample_tick,
+	                 long long target_tick, float* predicted);
+#endif // !FT_STAGE_H
\ No newline at end of file
@@ -154,6 +154,9 @@ DWORD WINAPI run_real_time_Measures(LPVOID FT_comm)
 	int ownership_val;
 	BOOL buffer = FALSE;
 
+	// Priority, core and stack of the stream before anything else
+	placement_ApplyThread(FT_Comm_params->err_file_FT, FT_Comm_params->placement_role);
+
 	// Wait starting top from Control thread
 	while (1)
 	{
@@ -824,6 +827,8 @@ BOOL get_and_set_bias(FT_Comm_Struct* FT_Comm_params)
 {
 	// Initialize variables
 	All_FT_measures* All_FT = &FT_Comm_params->FT_measures;
+	FILE* bias_file = NULL;
+	sidecar_bias bias;
 	All_FT->use_bias = FALSE;
 	if (!FT_Comm_params->general_params_FT.bias_identified)
 	{
@@ -835,17 +840,28 @@ BOOL get_and_set_bias(FT_Comm_Struct* FT_Comm_params)
 		// Save bias
 		if (FT_Comm_params->general_params_FT.struct_FT_Arm)
 		{
-			fopen_s(&FT_Comm_params->bias_vector_file, "bias_vector_Arm.txt", "w");
+			FT_Comm_params->bias_vector_name = "bias_vector_Arm.txt";
 		}
 		else if (FT_Comm_params->general_params_FT.struct_FT_Wrist)
 		{
-			fopen_s(&FT_Comm_params->bias_vector_file, "bias_vector_Wrist.txt", "w");
+			FT_Comm_params->bias_vector_name = "bias_vector_Wrist.txt";
 		}
-		for (int i(0); i < 6; i++)
+		fopen_s(&bias_file, FT_Comm_params->bias_vector_name, "w");
+		if (bias_file != NULL)
 		{
-			fprintf(FT_Comm_params->bias_vector_file, "%i ", FT_Comm_params->FT_measures.id_bias[i]);
+			for (int i(0); i < 6; i++)
+			{
+				fprintf(bias_file, "%i ", FT_Comm_params->FT_measures.id_bias[i]);
+			}
+			fclose(bias_file);
+			// Write the binary sidecar applied at next launch
+			memcpy(bias.id_bias, All_FT->id_bias, sizeof(bias.id_bias));
+			sidecar_Write(FT_Comm_params->err_file_FT, FT_Comm_params->bias_vector_name,
+				          FT_Comm_params->general_params_FT.struct_FT_Arm ? SIDECAR_BIAS_ARM : SIDECAR_BIAS_WRIST,
+				          &bias, sizeof(sidecar_bias));
+		} else {
+			fprintf(FT_Comm_params->err_file_FT, "Bias vector file %s not opened !\n", FT_Comm_params->bias_vector_name);
 		}
-		fclose(FT_Comm_params->bias_vector_file);
 	} else {
 		retrieve_IdentifiedBias(FT_Comm_params);
 	}
@@ -861,7 +877,8 @@ BOOL get_and_set_bias(FT_Comm_Struct* FT_Comm_params)
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
-| retrieve_IdentifiedBias - Retrieve identified bias vector
+| retrieve_IdentifiedBias - Retrieve identified bias vector from its binary sidecar, or from the text file if the
+|                           sidecar is missing, stale or belongs to the other sensor
 |
 | Syntax --
 |	void retrieve_IdentifiedBias(FT_Comm_Struct* FT_Comm_params)
@@ -873,16 +890,43 @@ void retrieve_IdentifiedBias(FT_Comm_Struct* FT_Comm_params)
 {
 	// Initialize variables
 	All_FT_measures* All_FT = &FT_Comm_params->FT_measures;
-	FILE* h_File = FT_Comm_params->bias_vector_file;
+	const char* file_name = FT_Comm_params->bias_vector_name;
+	unsigned int kind = FT_Comm_params->general_params_FT.struct_FT_Arm ? SIDECAR_BIAS_ARM : SIDECAR_BIAS_WRIST;
+	FILE* h_File = NULL;
+	sidecar_bias bias;
+	auto start = high_resolution_clock::now();
+
+	// Apply the sidecar if it is valid and up to date
+	if (file_name != NULL &&
+		sidecar_Load(FT_Comm_params->err_file_FT, file_name, kind, &bias, sizeof(sidecar_bias)) == SIDECAR_OK)
+	{
+		memcpy(All_FT->id_bias, bias.id_bias, sizeof(bias.id_bias));
+		fprintf(FT_Comm_params->out_file_FT, "Bias vector applied from sidecar in %lld us\n",
+			    (long long)duration_cast<microseconds>(high_resolution_clock::now() - start).count());
+		return;
+	}
 
-	if (fscanf(h_File, "%hi %hi %hi %hi %hi %hi", &All_FT->id_bias[0], &All_FT->id_bias[1], &All_FT->id_bias[2],
-		                                          &All_FT->id_bias[3], &All_FT->id_bias[4], &All_FT->id_bias[5]) != 6)
+	// Otherwise parse the text file and refresh its sidecar
+	if (file_name != NULL)
+	{
+		fopen_s(&h_File, file_name, "rt");
+	}
+	if (h_File == NULL ||
+		fscanf(h_File, "%hi %hi %hi %hi %hi %hi", &All_FT->id_bias[0], &All_FT->id_bias[1], &All_FT->id_bias[2],
+		       &All_FT->id_bias[3], &All_FT->id_bias[4], &All_FT->id_bias[5]) != 6)
 	{
 		fprintf(FT_Comm_params->err_file_FT, "Error reading pre-existing bias.\n");
+		if (h_File != NULL)
+		{
+			fclose(h_File);
+		}
 		FT_Comm_params->general_params_FT.bias_identified = 0;
 		get_and_set_bias(FT_Comm_params);
+		return;
 	}
 	fclose(h_File);
+	memcpy(bias.id_bias, All_FT->id_bias, sizeof(bias.id_bias));
+	sidecar_Write(FT_Comm_params->err_file_FT, file_name, kind, &bias, sizeof(sidecar_bias));
 }
 
 
@@ -901,7 +945,8 @@ void retrieve_IdentifiedBias(FT_Comm_Struct* FT_Comm_params)
 BOOL start_streaming_data(FT_Comm_Struct* FT_Comm_params)
 {
 	// Initialize variables
-	int numsamples;
+	int numsamples, publish;
+	float raw[FTSTAGE_NB_CHANNELS];
 	unsigned char streamCommand[] = { 10, 70, 0x55, 0xA3, 0x9D };
 	DWORD numTransferred, error;
 	Current_FT_measures* Current_FT = &FT_Comm_params->FT_measures.Current_measures;
@@ -934,6 +979,8 @@ BOOL start_streaming_data(FT_Comm_Struct* FT_Comm_params)
 	}
 	// Start streaming loop
 	fprintf(FT_Comm_params->out_file_FT, "Starting streaming loop with %d samples...\n", numsamples);
+	align_InitLink(&FT_Comm_params->clock);
+	ftstage_InitForRate(&FT_Comm_params->stage, (float)FT_SAMPLE_PERIOD, FT_Comm_params->ctrl_rate);
 	for (int i(0); i < numsamples; i++)
 	{
 		//auto timestamp_0_w = high_resolution_clock::now();
@@ -942,6 +989,9 @@ BOOL start_streaming_data(FT_Comm_Struct* FT_Comm_params)
 		{
 			return FALSE;
 		}
+		// Stamp the sample as soon as it is received
+		Current_FT->tick = timebase_Now();
+		align_AddClock(&FT_Comm_params->clock, i * FT_SAMPLE_PERIOD, Current_FT->tick);
 		//auto timestamp_2_w = high_resolution_clock::now();
 		//duration<double> elapsed_readfile_w = timestamp_2_w - timestamp_0_w;
 
@@ -966,10 +1016,19 @@ BOOL start_streaming_data(FT_Comm_Struct* FT_Comm_params)
 		//duration<double> elapsed_getgauges_w = timestamp_2_w - timestamp_1_w;
 		//Resolve FT values
 		//timestamp_1_w = high_resolution_clock::now();
+		publish = 0;
 		if (FT_Comm_params->FT_measures.use_bias)
 		{
 			resolve_FT_components(FT_Comm_params);
 			//store_current_FT(FT_Comm_params);
+			// Force stage, scheduled on the sample counter
+			raw[0] = Current_FT->f_x;
+			raw[1] = Current_FT->f_y;
+			raw[2] = Current_FT->f_z;
+			raw[3] = Current_FT->t_x;
+			raw[4] = Current_FT->t_y;
+			raw[5] = Current_FT->t_z;
+			publish = ftstage_Push(&FT_Comm_params->stage, raw, Current_FT->tick);
 		}
 		//timestamp_2_w = high_resolution_clock::now();
 		//duration<double> elapsed_resFT_w = timestamp_2_w - timestamp_1_w;
@@ -978,7 +1037,7 @@ BOOL start_streaming_data(FT_Comm_Struct* FT_Comm_params)
 			store_current_gauges(FT_Comm_params);
 		}
 		// Send data to Control thread if needed
-		if (FT_Comm_params->general_params_FT.use_FT_for_Ctrl && i % 5 == 0 && FT_Comm_params->FT_measures.use_bias) // i % 21
+		if (FT_Comm_params->general_params_FT.use_FT_for_Ctrl && publish)
 		{
 			//timestamp_1_w = high_resolution_clock::now();
 			if (!send_current_FT(FT_Comm_params)) { return FALSE; }
@@ -998,8 +1057,11 @@ BOOL start_streaming_data(FT_Comm_Struct* FT_Comm_params)
 	}
 	fprintf(FT_Comm_params->out_file_FT, "Read %d samples and saw %d error codes.\n",
 		                                 numsamples, FT_Comm_params->FT_measures.status_bit_errors);
+	align_PrintLink(FT_Comm_params->out_file_FT, "FT stream", &FT_Comm_params->clock);
 	if (FT_Comm_params->FT_measures.use_bias)
 	{
+		fprintf(FT_Comm_params->out_file_FT, "Force stage : %lld runs, %lld publications, filter delay %f s\n",
+			    FT_Comm_params->stage.nb_runs, FT_Comm_params->stage.nb_published, FT_Comm_params->stage.group_delay);
 		send_null_frame(FT_Comm_params);
 	}
 	stop_streaming(FT_Comm_params);
@@ -1220,6 +1282,7 @@ void store_current_FT(FT_Comm_Struct* FT_Comm_params)
 	All_FT->tx_values.push_back(Current_FT->t_x);
 	All_FT->ty_values.push_back(Current_FT->t_y);
 	All_FT->tz_values.push_back(Current_FT->t_z);
+	All_FT->ticks.push_back(Current_FT->tick);
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
@@ -1243,6 +1306,7 @@ void store_current_gauges(FT_Comm_Struct* FT_Comm_params)
 	All_FT->g3_values.push_back(Current_FT->gauge_3);
 	All_FT->g4_values.push_back(Current_FT->gauge_4);
 	All_FT->g5_values.push_back(Current_FT->gauge_5);
+	All_FT->ticks.push_back(Current_FT->tick);
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
@@ -1275,6 +1339,14 @@ BOOL send_current_FT(FT_Comm_Struct* FT_Comm_params)
 	FT_Comm_params->FT_measures_Shared->tx = Current_FT->t_x;
 	FT_Comm_params->FT_measures_Shared->ty = Current_FT->t_y;
 	FT_Comm_params->FT_measures_Shared->tz = Current_FT->t_z;
+	FT_Comm_params->FT_measures_Shared->tick = Current_FT->tick;
+	for (int c(0); c < FTSTAGE_NB_CHANNELS; c++)
+	{
+		FT_Comm_params->FT_measures_Shared->filtered[c] = FT_Comm_params->stage.filtered[c];
+		FT_Comm_params->FT_measures_Shared->derivative[c] = FT_Comm_params->stage.derivative[c];
+		FT_Comm_params->FT_measures_Shared->integral[c] = FT_Comm_params->stage.integral[c];
+	}
+	FT_Comm_params->FT_measures_Shared->group_delay = FT_Comm_params->stage.group_delay;
 	if (Current_FT->f_x == Current_FT->f_z && Current_FT->t_z == 0.0f)
 	{
 		FT_Comm_params->FT_measures_Shared->streaming = FALSE;
@@ -17,6 +17,8 @@
 #include "NiSerial.h"
 #include "low_level_command_1DoF_main.h"
 #include "shared_FT_struct.h"				// Header containing the shared FT measures struct definition
+#include "parameter_sidecar.h"				// Binary sidecar of the identified bias vector
+#include "session_storage.h"				// Allocator of the session buffers
 
 // Communication parameters
 #define SERIAL_PORT_NAME_ARM L"COM4"
@@ -47,6 +49,7 @@
 // Custom constants
 #define BIAS_ID_N_SAMPLES 7000
 #define NB_SAMPLES_TO_CTRL 7
+#define FT_SAMPLE_PERIOD 0.000125			// Nominal period of the FT stream : 8 samples per control iteration (s)
 
 // --------------------------------------------------- PIPE SUBSTRUCT --------------------------------------------------
 struct Params_FT
@@ -104,6 +107,7 @@ struct Current_FT_measures
 	float t_x;              // Computed torque along x axis
 	float t_y;              // Computed torque along y axis
 	float t_z;              // Computed torque along z axis
+	long long tick;         // Acquisition tick of the sample (timebase_Now)
 };
 
 // ------------------------------------------------ ALL MEASURES SUBSTRUCT ---------------------------------------------
@@ -111,25 +115,27 @@ struct All_FT_measures
 {
 	Current_FT_measures Current_measures;  // Current data received from FT sensor
 	int16_t id_bias[6];                    // Identified bias vector
-	std::vector<int16_t> g0_values;        // All G0 values
-	std::vector<int16_t> g1_values;        // All G1 values
-	std::vector<int16_t> g2_values;        // All G2 values
-	std::vector<int16_t> g3_values;        // All G3 values
-	std::vector<int16_t> g4_values;        // All G4 values
-	std::vector<int16_t> g5_values;        // All G5 values
+	session_gauges g0_values;        // All G0 values
+	session_gauges g1_values;        // All G1 values
+	session_gauges g2_values;        // All G2 values
+	session_gauges g3_values;        // All G3 values
+	session_gauges g4_values;        // All G4 values
+	session_gauges g5_values;        // All G5 values
 	std::vector<float> fx_values;          // All computed forces along x axis
 	std::vector<float> fy_values;          // All computed forces along y axis
 	std::vector<float> fz_values;          // All computed forces along z axis
 	std::vector<float> tx_values;          // All computed torques along x axis
 	std::vector<float> ty_values;          // All computed torques along y axis
 	std::vector<float> tz_values;          // All computed torques along z axis
+	session_ticks ticks;               // Acquisition ticks of the stored samples
 	BOOL use_bias;						   // TRUE : Use bias ; FALSE : Do not use bias
 	int status_bit_errors;				   // Status errors counter
 	int nb_measures;					   // Number of measures to do
 };
 
 // ----------------------------------------- GLOBAL SERIAL COMMUNICATION STRUCT ----------------------------------------
-struct FT_Comm_Struct
+// Aligned on a cache line : the wrist and arm structs are updated by their own thread at the sensor rate
+struct alignas(64) FT_Comm_Struct
 {
 	HANDLE serial_port;									// Handle of the serial port file
 	DCB FT_Comm_DCB;									// DCB struct for serial communication
@@ -140,12 +146,16 @@ struct FT_Comm_Struct
 	Calib_Struct FT_Calib;								// Calibration struct containing all data
 	All_FT_measures FT_measures;						// Substruct containing all previous measures
 	FILE* f_t_sensor_file;								// File to write all measured forces and torques
-	FILE* bias_vector_file;								// File containing the identified bias vector to apply
+	const char* bias_vector_name;						// Text file containing the identified bias vector to apply
 	FT_meas_Global* FT_measures_Shared;					// Interlocked measures struct
 	CRITICAL_SECTION* pCritical_share_FT;				// Critical section
 	FILE* out_file_FT;									// Out file dedicated to digital FT communication
 	FILE* err_file_FT;									// Err file dedicated to digital FT communication
 	FILE* times;										// Debug file for time measurements
+	align_link clock;									// Drift of the sensor clock against the nominal period
+	ft_stage stage;										// Force stage executed at the sensor rate
+	float ctrl_rate;									// Rate of the control loop reading the stage (Hz)
+	int placement_role;									// PLACEMENT_ROLE_FT_WRIST or PLACEMENT_ROLE_FT_ARM
 };
 
 
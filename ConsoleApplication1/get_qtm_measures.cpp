@@ -9,6 +9,9 @@
 ***********************************************************************************************************************/
 
 #include "get_qtm_measures.h"
+#include <string.h>
+
+static_assert(sizeof(qtm_frame) == 40, "QTM frame must be 40 bytes");
 
 /*---------------------------------------------------------------------------------------------------------------------
 | get_RealTimeQTMMeas - Main thread function to get real-time QTM measures
@@ -25,129 +28,254 @@
 DWORD WINAPI get_RealTimeQTMMeas(LPVOID comArgs)
 {
 	// Variables declaration and transformation
-	int i = 0;
-	static ComStruct* comParams = (ComStruct*)comArgs;
+	int nb_frames;
+	u_long non_blocking = 1;
+	ComStruct* comParams = (ComStruct*)comArgs;
+	streamStruct* stream = &comParams->streamState;
 	FILE* out_qtm_file = NULL;
 	fopen_s(&out_qtm_file, "out_qtm_thread.txt", "w");
 
-	// Start to run
-	comParams->comPipeStruct.robot_activated = 1;
-	while (comParams->comPipeStruct.robot_activated && i < 500)
+	// Priority, core and stack of the stream before anything else
+	placement_ApplyThread(out_qtm_file, PLACEMENT_ROLE_QTM);
+
+	// Receive without blocking : the thread only waits in select, at most QTM_RECV_TIMEOUT_US
+	if (ioctlsocket(comParams->sockStruct.socket_com, FIONBIO, &non_blocking) != 0)
+	{
+		fprintf(out_qtm_file, "Socket could not be set non-blocking : %i\n", WSAGetLastError());
+	}
+
+	// Onsets are detected at the sample rate of the EMG stream
+	emg_InitDetector(&comParams->emgMeas.detector, EMG_SAMPLE_RATE);
+	comParams->emgMeas.pending_onsets = 0;
+	align_InitLink(&stream->clock);
+
+	// Start to run until the control thread stops or the sender closes the stream
+	comParams->comMailbox.robot_activated = 1;
+	while (comParams->comMailbox.robot_activated)
 	{
-		// Read the pipe from control thread
-		//readPipeContent(comParams);
-		// Get the content of the socket
-		get_SocketContent(comParams);
-		// Check if a movement is about to happen
-		check_MovInitialisation(comParams);
-		// Send measures to the control code
-		writePipeContent(comParams, out_qtm_file);
-		Sleep(5);
-		i++;
+		// Read the state of the control thread
+		readMailboxContent(comParams);
+		// Decode all the frames received since the last iteration
+		if ((nb_frames = get_SocketContent(comParams)) < 0)
+		{
+			fprintf(out_qtm_file, "QTM stream closed by the sender\n");
+			break;
+		}
+		if (nb_frames > 0)
+		{
+			// Check if a movement is about to happen
+			check_MovInitialisation(comParams);
+			// Send measures to the control code
+			writeMailboxContent(comParams);
+		}
+	}
+	fprintf(out_qtm_file, "Frames decoded : %lld ; lost : %lld ; late : %lld ; bytes skipped : %lld\n",
+		    stream->nb_frames, stream->nb_lost, stream->nb_late, stream->nb_skipped_bytes);
+	align_PrintLink(out_qtm_file, "QTM stream", &stream->clock);
+	fprintf(out_qtm_file, "EMG events dropped (queue full) : %u\n",
+		    comParams->comMailbox.mailbox->events_dropped.load(std::memory_order_relaxed));
+	for (int i(0); i < NB_EMG_MUSCLES; i++)
+	{
+		fprintf(out_qtm_file, "EMG channel %i : %lld onsets ; last detection delay : %lld us\n", i,
+			    comParams->emgMeas.detector.nb_onsets[i], comParams->emgMeas.detector.delay_us[i]);
 	}
 	fflush(out_qtm_file);
 	return 0;
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
-| get_SocketContent - Function retreiving socket content if there is some
+| get_SocketContent - Receive all the bytes available on the socket and decode the complete frames
 |
 | Syntax --
 |	int get_SocketContent(ComStruct* comParams)
 |
 | Inputs --
 |	ComStruct* comParams -> pointer towards the structure containing all communication parameters
+|
+| Outputs --
+|	int -> Number of decoded frames ; -1 : Stream closed or socket error
 ----------------------------------------------------------------------------------------------------------------------*/
-void get_SocketContent(ComStruct* comParams)
+int get_SocketContent(ComStruct* comParams)
 {
 	// Variables declaration
-	char* endptr;
-	char buffer[LENGTH_BUFFER];
-	int err = 0;
-	float current_pos;
 	socketStruct* sockParams = &comParams->sockStruct;
+	streamStruct* stream = &comParams->streamState;
+	fd_set read_set;
+	timeval timeout = { 0, QTM_RECV_TIMEOUT_US };
+	qtm_frame frame;
+	int nb_received, nb_frames = 0, offset = 0;
+	long long arrival_tick;
+
+	// Wait for new bytes without spinning
+	FD_ZERO(&read_set);
+	FD_SET(sockParams->socket_com, &read_set);
+	if (select(0, &read_set, NULL, NULL, &timeout) <= 0)
+	{
+		return 0;
+	}
+
+	// Batched receive : drain everything available in the free part of the buffer
+	while (stream->nb_buffered < (int)sizeof(stream->buffer))
+	{
+		nb_received = recv(sockParams->socket_com, stream->buffer + stream->nb_buffered,
+			               (int)sizeof(stream->buffer) - stream->nb_buffered, 0);
+		if (nb_received > 0)
+		{
+			stream->nb_buffered += nb_received;
+		}
+		else if (nb_received == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK)
+		{
+			break;
+		}
+		else
+		{
+			return -1;
+		}
+	}
+
+	// Stamp the received frames
+	arrival_tick = timebase_Now();
+
+	// Decode all the complete frames, skipping bytes until a valid header if the stream got desynchronised
+	while (stream->nb_buffered - offset >= (int)sizeof(qtm_frame))
+	{
+		memcpy(&frame, stream->buffer + offset, sizeof(qtm_frame));
+		if (frame.magic != QTM_FRAME_MAGIC || frame.version != QTM_FRAME_VERSION)
+		{
+			stream->nb_skipped_bytes++;
+			offset++;
+			continue;
+		}
+		apply_QTMFrame(comParams, &frame, arrival_tick);
+		offset += sizeof(qtm_frame);
+		nb_frames++;
+	}
+
+	// Keep the beginning of the next frame
+	memmove(stream->buffer, stream->buffer + offset, stream->nb_buffered - offset);
+	stream->nb_buffered -= offset;
+	return nb_frames;
+}
 
-	// Read socket if something has been transmitted
-	//if (WSAEventSelect(sockParams->socket_com, recv, FD_READ) == 0)
-	//{
-	recv(sockParams->socket_com, buffer, LENGTH_BUFFER, NULL);
+/*---------------------------------------------------------------------------------------------------------------------
+| apply_QTMFrame - Check the sequence number of a decoded frame and store its content
+|
+| Syntax --
+|	void apply_QTMFrame(ComStruct* comParams, const qtm_frame* frame, long long arrival_tick)
+|
+| Inputs --
+|	ComStruct* comParams -> pointer towards the structure containing all communication parameters
+|	const qtm_frame* frame -> decoded frame
+|	long long arrival_tick -> reception tick of the frame (timebase_Now)
+----------------------------------------------------------------------------------------------------------------------*/
+void apply_QTMFrame(ComStruct* comParams, const qtm_frame* frame, long long arrival_tick)
+{
+	// Extract substructs
+	streamStruct* stream = &comParams->streamState;
+	emgMeasures* emgValues = &comParams->emgMeas;
+	int index;
 
-	// Split transmitted string and fill the structure with new values
-	current_pos = strtof(strtok(buffer, " ;"), &endptr);
-	if (current_pos != 0.0f)
+	// Drop frames older than the last one, count the missing ones
+	if (stream->nb_frames > 0 && frame->sequence != stream->last_sequence + 1)
 	{
-		comParams->qualMeas.sliderPos = current_pos;
+		if ((int)(frame->sequence - stream->last_sequence) <= 0)
+		{
+			stream->nb_late++;
+			return;
+		}
+		stream->nb_lost += frame->sequence - stream->last_sequence - 1;
+	}
+	stream->last_sequence = frame->sequence;
+	stream->last_timestamp_us = frame->timestamp_us;
+	stream->last_arrival_tick = arrival_tick;
+	stream->nb_frames++;
+	align_AddClock(&stream->clock, frame->timestamp_us * 1e-6, arrival_tick);
+
+	// Store the new values
+	if (frame->flags & QTM_FRAME_SLIDER)
+	{
+		comParams->qualMeas.sliderPos = frame->slider_pos;
+	}
+	if (frame->flags & QTM_FRAME_EMG)
+	{
+		index = (int)(emgValues->nb_emg_samples & (EMG_HISTORY - 1));
+		for (int i(0); i < NB_EMG_CHANNELS; i++)
+		{
+			emgValues->emg_values[i][index] = frame->emg[i];
+		}
+		emgValues->emg_timestamps[index] = frame->timestamp_us;
+		emgValues->emg_ticks[index] = arrival_tick;
+		emgValues->nb_emg_samples++;
+		// Detect the onsets sample by sample, a batch of frames can hold a whole activation
+		emgValues->pending_onsets |= emg_ProcessSample(&emgValues->detector, frame->emg, frame->timestamp_us);
 	}
-	comParams->emgMeas.emg_BB.push_back(strtof(strtok(buffer, " ;"), &endptr));
-	comParams->emgMeas.emg_BR.push_back(strtof(strtok(buffer, " ;"), &endptr));
-	comParams->emgMeas.emg_TBLoH.push_back(strtof(strtok(buffer, " ;"), &endptr));
-	comParams->emgMeas.emg_TBLaH.push_back(strtof(strtok(buffer, " ;"), &endptr));
-	//}
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
-| readPipeContent - Read messages sent by control thread in the pipe
+| readMailboxContent - Read the control state published by the control thread
 |
 | Syntax --
-|	void readPipeContent(ComStruct* comParams)
+|	void readMailboxContent(ComStruct* comParams)
 |
 | Inputs --
 |	ComStruct* comParams -> pointer towards the structure containing all communication parameters
 ----------------------------------------------------------------------------------------------------------------------*/
-void readPipeContent(ComStruct* comParams)
+void readMailboxContent(ComStruct* comParams)
 {
 	// Variables declaration
-	LPVOID buffer_pipe = new ReadStruct;
-	bool err;
-	DWORD nBytesRead;
-	DWORD nBytesToRead;
-	ReadStruct* readData;
-
-	// Compute number of bytes to read
-	nBytesToRead = sizeof(ReadStruct);
-
-	// Read the pipe
-	err = ReadFile(comParams->comPipeStruct.readPipeCtrl, buffer_pipe, nBytesToRead, &nBytesRead, NULL);
-	readData = (ReadStruct*)buffer_pipe;
-	comParams->comPipeStruct.iter_counter = readData->iter_counter;
-	comParams->comPipeStruct.robot_activated = readData->robot_activated;
-
-	// Free memory from buffer_pipe
-	delete buffer_pipe;
+	mailboxStruct* mbValues = &comParams->comMailbox;
+	qtm_ctrlSample ctrl_state;
+	long long age_us;
+
+	// Keep the previous state if nothing new was published
+	if (mailbox_ReadCtrl(mbValues->mailbox, &mbValues->last_ctrl_version, &ctrl_state, &age_us) == MAILBOX_NEW)
+	{
+		mbValues->iter_counter = ctrl_state.iter_counter;
+		mbValues->robot_activated = ctrl_state.robot_activated;
+	}
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
-| writePipeContent - Write messages containing measures to the control thread
+| writeMailboxContent - Publish the measures to the control thread and queue an event for each new EMG onset
 |
 | Syntax --
-|	void writePipeContent(ComStruct* comParams)
+|	void writeMailboxContent(ComStruct* comParams)
 |
 | Inputs --
 |	ComStruct* comParams -> pointer towards the structure containing all communication parameters
 ----------------------------------------------------------------------------------------------------------------------*/
-void writePipeContent(ComStruct* comParams, FILE* out_qtm_file)
+void writeMailboxContent(ComStruct* comParams)
 {
 	// Variables declaration
-	bool err;
-	DWORD nBytesWritten;
-	DWORD nBytesToWrite;
-	TransStruct struct_ToTransmit;
-	LPVOID buffer1 = VirtualAlloc(NULL, sizeof(TransStruct), MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+	mailboxStruct* mbValues = &comParams->comMailbox;
+	emg_detector* detector = &comParams->emgMeas.detector;
+	qtm_measSample sample;
+	emg_event event;
 
 	// Retrieve useful informations
-	struct_ToTransmit.ping_BB = comParams->emgMeas.ping_BicepsBrachial;
-	struct_ToTransmit.ping_BR = comParams->emgMeas.ping_BrachioRadialis;
-	struct_ToTransmit.ping_TBLatH = comParams->emgMeas.ping_TricepsBrachialLatH;
-	struct_ToTransmit.ping_TBLongH = comParams->emgMeas.ping_TricepsBrachialLongH;
-	struct_ToTransmit.s_pos = comParams->qualMeas.sliderPos;
-
-	// Compute number of bytes to write
-	buffer1 = &struct_ToTransmit;
-	nBytesToWrite = sizeof(struct_ToTransmit);
-
-	// Write informations into communication pipe
-	err = WriteFile(comParams->comPipeStruct.writePipeMeas, &struct_ToTransmit, nBytesToWrite, &nBytesWritten, NULL);
-	fprintf(out_qtm_file, "Sortie WriteFile : %i ; nBytesToWrite-nBytesWritten = %i \n", err, nBytesToWrite - nBytesWritten);
+	sample.s_pos = comParams->qualMeas.sliderPos;
+	sample.pings[EMG_MUSCLE_BB] = comParams->emgMeas.ping_BicepsBrachial;
+	sample.pings[EMG_MUSCLE_BR] = comParams->emgMeas.ping_BrachioRadialis;
+	sample.pings[EMG_MUSCLE_TBLONGH] = comParams->emgMeas.ping_TricepsBrachialLongH;
+	sample.pings[EMG_MUSCLE_TBLATH] = comParams->emgMeas.ping_TricepsBrachialLatH;
+	sample.sequence = comParams->streamState.last_sequence;
+	sample.timestamp_us = comParams->streamState.last_timestamp_us;
+	sample.arrival_tick = comParams->streamState.last_arrival_tick;
+	mailbox_PublishMeas(mbValues->mailbox, &sample);
+
+	// Queue the onsets detected since the last publication
+	for (int i(0); i < NB_EMG_MUSCLES; i++)
+	{
+		if (comParams->emgMeas.pending_onsets & (1 << i))
+		{
+			event.muscle = i;
+			event.sequence = sample.sequence;
+			event.timestamp_us = detector->first_above_us[i] + detector->delay_us[i];
+			event.detection_delay_us = detector->delay_us[i];
+			mailbox_PushEvent(mbValues->mailbox, &event);
+		}
+	}
+	comParams->emgMeas.pending_onsets = 0;
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
@@ -161,10 +289,19 @@ void writePipeContent(ComStruct* comParams, FILE* out_qtm_file)
 ----------------------------------------------------------------------------------------------------------------------*/
 void check_MovInitialisation(ComStruct* comParams)
 {
-	comParams->emgMeas.ping_BicepsBrachial = 0;
-	comParams->emgMeas.ping_BrachioRadialis = 0;
-	comParams->emgMeas.ping_TricepsBrachialLatH = 0;
-	comParams->emgMeas.ping_TricepsBrachialLongH = 0;
+	// Extract substructs
+	emgMeasures* emgValues = &comParams->emgMeas;
+	emg_detector* detector = &emgValues->detector;
+
+	// A muscle is pinged while it is active or if it was activated since the last publication
+	emgValues->ping_BicepsBrachial = detector->active[EMG_MUSCLE_BB]
+		                             || (emgValues->pending_onsets & (1 << EMG_MUSCLE_BB));
+	emgValues->ping_BrachioRadialis = detector->active[EMG_MUSCLE_BR]
+		                              || (emgValues->pending_onsets & (1 << EMG_MUSCLE_BR));
+	emgValues->ping_TricepsBrachialLongH = detector->active[EMG_MUSCLE_TBLONGH]
+		                                   || (emgValues->pending_onsets & (1 << EMG_MUSCLE_TBLONGH));
+	emgValues->ping_TricepsBrachialLatH = detector->active[EMG_MUSCLE_TBLATH]
+		                                  || (emgValues->pending_onsets & (1 << EMG_MUSCLE_TBLATH));
 }
 
 void ErrorExit(LPTSTR lpszFunction, FILE* out_qtm_file)
@@ -16,15 +16,21 @@
 // Project includes
 #include "communication_struct.h"
 #include <strsafe.h>
+#include "thread_placement.h"
 
 // Constants definition
-#define LENGTH_BUFFER 100    // Length of the buffer for recv (receive python values)
+#define QTM_FRAME_MAGIC 0xAB51		// First two bytes of every frame
+#define QTM_FRAME_VERSION 1			// Version of the frame layout
+#define QTM_FRAME_SLIDER 0x01		// Flag : slider_pos is valid
+#define QTM_FRAME_EMG 0x02			// Flag : emg samples are valid
+#define QTM_RECV_TIMEOUT_US 1000	// Maximum wait for new frames in the measures thread (us)
 
 // Functions declaration
 DWORD WINAPI get_RealTimeQTMMeas(LPVOID comArgs);	// Main thread function to get real-time QTM measures
-void get_SocketContent(ComStruct* comParams);		// Read and translate the content of the socket if needed
-void readPipeContent(ComStruct* comParams);			// Read messages sent by control thread in the pipe
-void writePipeContent(ComStruct* comParams, FILE* out_qtm_file);		// Write messages to robot control thread
+int get_SocketContent(ComStruct* comParams);		// Receive and decode all the frames available on the socket
+void apply_QTMFrame(ComStruct* comParams, const qtm_frame* frame, long long arrival_tick);	// Store the content of a decoded frame
+void readMailboxContent(ComStruct* comParams);		// Read the control state published by the control thread
+void writeMailboxContent(ComStruct* comParams);		// Publish the measures and EMG events to the control thread
 void check_MovInitialisation(ComStruct* comParams);	// Check if a movement is about to happen
 void ErrorExit(LPTSTR lpszFunction, FILE* out_qtm_file);
 #endif // !GET_QTM_MEASURES_H
\ No newline at end of file
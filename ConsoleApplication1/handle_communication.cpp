@@ -9,6 +9,7 @@
 ***********************************************************************************************************************/
 // Includes
 #include "handle_communication.h"
+#include "session_replay.h"
 
 // Namespaces
 using namespace std;
@@ -88,7 +89,7 @@ int able_InitCommunication(ServoComEth *eth_ABLE, AbleControlStruct *ctrl_ABLE,
 	// Get current position of coders
 	for (int i(0); i < NB_MOTORS; i++)
 	{
-		ctrl_ABLE->rtParams.currentCoderPosition[i] = eth_ABLE->moteur[i].Position_Codeur;
+		ctrl_ABLE->state.coder[i] = eth_ABLE->moteur[i].Position_Codeur;
 	}
 	return 0;
 }
@@ -168,25 +169,34 @@ void able_SendMotorParameters(ServoComEth *eth_ABLE, AbleControlStruct *ctrl_ABL
 DWORD WINAPI able_UpdateRealTimeProcess(LPVOID ableArgs)
 {
 	// Variables declaration
-	static int err = 0;
+	int err = 0, inputs_read;
 	
 	// Retrieve informations sent by main code
-	static ThreadInformations* ableInfos = (ThreadInformations*)ableArgs;
+	ThreadInformations* ableInfos = (ThreadInformations*)ableArgs;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
 	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 
-	// Initialise counter
+	// Real time priority, dedicated core and locked stack before the first iteration
+	placement_ApplyThread(ableInfos->err_file, PLACEMENT_ROLE_CONTROL);
+
+	// Initialise counter and control time
 	rtValues->iter_counter = 0;
+	rtValues->elapsed_time = 0.0;
+	storage_InitFaults(&ableInfos->ctrl_ABLE->timing.faults);
 
 	// Start command loop
 	while ((rtValues->order_counter <= NB_MEASURES_GEOM_ID && oValues->ctrl_type == STATIC_IDENT) ||
 		   (rtValues->iter_counter <= rtValues->nb_iterations_dyn_ident && oValues->ctrl_type == DYN_IDENT) ||
 		   (rtValues->iter_counter <= rtValues->limit_iterCom && oValues->ctrl_type == TORQUE_CTRL) ||
-		   (oValues->ctrl_type == MINJERK_TRAJS && (rtValues->current_minJerkMove < NB_REP * NB_JERK_TRAJS ||
-		   rtValues->current_minJerkMove >= NB_REP * NB_JERK_TRAJS && rtValues->jerkBlockWithFatigueTest)))
+		   (rtValues->iter_counter <= rtValues->limit_iterCom && oValues->ctrl_type == CARTESIAN_CTRL) ||
+		   (rtValues->iter_counter <= rtValues->limit_iterCom && oValues->ctrl_type == HAPTIC_CTRL) ||
+		   (oValues->ctrl_type == MINJERK_TRAJS && (!minjerk_BlockEnded(&ableInfos->ctrl_ABLE->minJerk, rtValues->current_minJerkMove) ||
+		   !rtValues->robot_stopAfterTrajs || rtValues->jerkBlockWithFatigueTest)))
 	{
 		auto timestamp_0 = high_resolution_clock::now();
+		long long cycle_tick = timebase_Now();
+		alloc_BeginCycle(rtValues->iter_counter);
 		// Check the real time command boolean
 		if (rtValues->able_RealTimeCommand == true)
 		{
@@ -200,12 +210,14 @@ DWORD WINAPI able_UpdateRealTimeProcess(LPVOID ableArgs)
 			}
 			//auto timestamp_2 = high_resolution_clock::now();
 			//duration<double> elapsed_CheckCo = timestamp_2 - timestamp_1;
-			// Send data to the QTM thread through Pipe
-			// qtm_WriteData(ableInfos->ctrl_ABLE, iter_counter);
+			// Send the control state to the QTM thread through the mailbox (nothing done if QTM is not used)
+			qtm_WriteData(ableInfos->ctrl_ABLE, rtValues->iter_counter);
 
 			// Saturation of the speed order to protect motors
 			//timestamp_1 = high_resolution_clock::now();
 			sature_SpeedOrders(ableInfos);
+			// Capture the orders sent (nothing done if the session is not captured)
+			replay_CaptureCommand(ableInfos->ctrl_ABLE);
 			//timestamp_2 = high_resolution_clock::now();
 			//duration<double> elapsed_SatSpeed = timestamp_2 - timestamp_1;
 
@@ -226,23 +238,29 @@ DWORD WINAPI able_UpdateRealTimeProcess(LPVOID ableArgs)
 			//duration<double> elapsed_CheckOrd = timestamp_2 - timestamp_1;
 			// Wait to respect sampling frequency
 			//timestamp_1 = high_resolution_clock::now();
-			able_OneMsWait();
+			able_WaitPeriod(cycle_tick, rtValues->sampling_frequency);
 			//timestamp_2 = high_resolution_clock::now();
 			//duration<double> elapsed_WaitOneMs = timestamp_2 - timestamp_1;
 			// Check if the order was correctly transmitted to ABLE and receive state frame
 			//timestamp_1 = high_resolution_clock::now();
 			check_OrderTransmission(ableInfos);
+			// Stamp the received state frame and measure the duration of the iteration
+			able_StampStateFrame(ableInfos);
 			//timestamp_2 = high_resolution_clock::now();
 			//duration<double> elapsed_CheckOrdTrans = timestamp_2 - timestamp_1;
 			// Translate state frame into current data of ABLE
 			//timestamp_1 = high_resolution_clock::now();
 			ETH_carte_variateur_V3_Datas(ableInfos->eth_ABLE);
+			// Extract the state of every axis once for the cycle
+			state_Update(ableInfos);
 			//timestamp_2 = high_resolution_clock::now();
 			//duration<double> elapsed_Data = timestamp_2 - timestamp_1;
 			// Get current measures of the QTM API
+			inputs_read = 0;
 			if (ableInfos->ctrl_ABLE->aOrders.ctrl_type > TORQUE_CTRL && rtValues->use_QTM)
 			{
 				qtm_ReadData(ableInfos->ctrl_ABLE);
+				inputs_read |= REPLAY_INPUT_QTM;
 			}
 			// Get current FT measures
 			//timestamp_1 = high_resolution_clock::now();
@@ -254,7 +272,10 @@ DWORD WINAPI able_UpdateRealTimeProcess(LPVOID ableArgs)
 					digitalFT_WriteData(ableInfos->ctrl_ABLE);
 				}
 				digitalFT_ReadData(ableInfos);
+				inputs_read |= REPLAY_INPUT_FT;
 			}
+			// Capture the inputs of the iteration (nothing done if the session is not captured)
+			replay_CaptureInputs(ableInfos, inputs_read);
 			//timestamp_2 = high_resolution_clock::now();
 			//duration<double> elapsed_RecFT = timestamp_2 - timestamp_1;
 			// fprintf(ableInfos->out_file, "AFTER FT SENSOR\n");
@@ -263,11 +284,15 @@ DWORD WINAPI able_UpdateRealTimeProcess(LPVOID ableArgs)
 			deadman_CheckButtons(ableInfos);
 			//timestamp_2 = high_resolution_clock::now();
 			//duration<double> elapsed_CheckButtons = timestamp_2 - timestamp_1;
+			// Estimate the slider position used by the dynamic model
+			qtm_EstimateSlider(ableInfos->ctrl_ABLE);
 			// Compute orders for next iteration
 			//timestamp_1 = high_resolution_clock::now();
 			able_UpdateOrders(ableInfos);
 			//timestamp_2 = high_resolution_clock::now();
 			//duration<double> elapsed_UpdateOrd = timestamp_2 - timestamp_1;
+			// Publish the state of this iteration for the telemetry readers
+			telemetry_Publish(ableInfos->ctrl_ABLE);
 			// Check order state every "able_CheckTargetReachedNbIt" iterations
 			//timestamp_1 = high_resolution_clock::now();
 			if ((err = switch_OrderReached(ableInfos)) == 0)
@@ -280,11 +305,15 @@ DWORD WINAPI able_UpdateRealTimeProcess(LPVOID ableArgs)
 			//duration<double> elapsed_SwitchOrd = timestamp_2 - timestamp_1;
 			// Store iteration duration for time analysis
 			duration<double> elapsed = timestamp_2 - timestamp_0;
-			ableInfos->ctrl_ABLE->aMeasures.execution_times.push_back(elapsed.count());
+			ableInfos->ctrl_ABLE->aMeasures->execution_times.push_back(elapsed.count());
+			ableInfos->ctrl_ABLE->aMeasures->cycle_ticks.push_back(cycle_tick);
+			// Count the page faults taken during the iteration
+			storage_SampleFaults(&ableInfos->ctrl_ABLE->timing.faults, rtValues->iter_counter);
 			//timestamp_1 = high_resolution_clock::now();
 			//fflush(ableInfos->times);
 			fflush(ableInfos->out_file);
 			fflush(ableInfos->err_file);
+			alloc_EndCycle();
 			/*timestamp_2 = high_resolution_clock::now();
 			duration<double> elapsed_fflush = timestamp_2 - timestamp_1;
 			duration<double> elapsed = timestamp_2 - timestamp_0;
@@ -318,7 +347,7 @@ void deadman_CheckButtons(ThreadInformations* ableInfos)
 	//fprintf(ableInfos->out_file, "CHECK BUTTONS\n");
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
 	// Initialize byte variables
-	int entree_tor = ableInfos->eth_ABLE->entree_tor;
+	int entree_tor = ableInfos->ctrl_ABLE->state.inputs;
 	uint8_t start_Byte = entree_tor & 0x000F;
 	// Check bit 2
 	ableInfos->ctrl_ABLE->dead_buttons.leftb_pushed = (((start_Byte >> 2) & 1) == 1);
@@ -367,6 +396,46 @@ void check_OrderTransmission(ThreadInformations* ableInfos)
 	}
 }
 
+/*---------------------------------------------------------------------------------------------------------------------
+| able_StampStateFrame - Stamp the state frame received from ABLE and measure the duration of the iteration
+|
+| Syntax --
+|	void able_StampStateFrame(ThreadInformations* ableInfos)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+|
+| Remarks --
+|	The integrators use cycle_dt, bounded around the nominal period so that a single late frame cannot make them jump.
+|	elapsed_time accumulates cycle_dt and is the clock of every timer and trajectory expressed in seconds.
+----------------------------------------------------------------------------------------------------------------------*/
+void able_StampStateFrame(ThreadInformations* ableInfos)
+{
+	// Extract real time parameters
+	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+
+	// Initialise variables
+	long long tick = timebase_Now();
+	float dt;
+
+	if (rtValues->state_tick != 0)
+	{
+		dt = (float)timebase_Seconds(tick - rtValues->state_tick);
+		if (dt < TIMEBASE_DT_MIN_RATIO * rtValues->sampling_frequency)
+		{
+			dt = TIMEBASE_DT_MIN_RATIO * rtValues->sampling_frequency;
+		} else if (dt > TIMEBASE_DT_MAX_RATIO * rtValues->sampling_frequency)
+		{
+			dt = TIMEBASE_DT_MAX_RATIO * rtValues->sampling_frequency;
+		}
+		rtValues->cycle_dt = dt;
+	}
+	rtValues->elapsed_time += rtValues->cycle_dt;
+	rtValues->state_tick = tick;
+	align_AddClock(&ableInfos->ctrl_ABLE->timing.drive, rtValues->iter_counter * (double)rtValues->sampling_frequency,
+		           tick);
+}
+
 /*---------------------------------------------------------------------------------------------------------------------
 | able_SendOrders - Send current orders contained in the control structure to ABLE
 |
@@ -29,6 +29,10 @@ extern "C"
 #include "able_Control_QTMData.h"
 #include "able_Control_FTData.h"
 #include "able_OrdersManagement.h"
+#include "telemetry_publisher.h"
+#include "thread_placement.h"
+#include "alloc_tracker.h"
+#include "robot_state.h"
 #include <sal.h>
 
 // Constants of communication definition
@@ -41,6 +45,7 @@ int able_InitCommunication(ServoComEth *eth_ABLE, AbleControlStruct *ctrl_ABLE,
 int able_CloseCommunication(ServoComEth *eth_ABLE, AbleControlStruct *ctrl_ABLE);
 void able_SendMotorParameters(ServoComEth *eth_ABLE, AbleControlStruct *ctrl_ABLE);
 void check_OrderTransmission(ThreadInformations* ableInfos);
+void able_StampStateFrame(ThreadInformations* ableInfos);
 void deadman_CheckButtons(ThreadInformations* ableInfos);
 int able_SendOrders(ThreadInformations* ableInfos);
 
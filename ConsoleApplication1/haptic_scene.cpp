@@ -0,0 +1,710 @@
+/***********************************************************************************************************************
+* haptic_scene.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Renders a haptic virtual environment at the hand. The scene holds up to SCENE_MAX_PRIMITIVES primitives in fixed
+* arrays. Spheres, viscous regions and force fields are indexed in a uniform grid built once before the motions
+* (compressed lists of primitive indexes per cell), planes are tested at every query. The grid build rejects scenes
+* with more than SCENE_MAX_PER_CELL primitives overlapping a cell, so that the work of a query is bounded whatever the
+* hand position : at most SCENE_MAX_PLANES + SCENE_MAX_PER_CELL primitives are evaluated. The duration of the queries
+* is checked against SCENE_BUDGET_US while the cell is evaluated : a query out of budget is stopped and returns the
+* last force fully computed, so that the control cycle keeps its period.
+***********************************************************************************************************************/
+
+#include "haptic_scene.h"
+#include "time_base.h"
+
+#include <math.h>
+#include <string.h>
+
+// ------------------------------------------------- SCENE DESCRIPTION -------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_Clear - Remove all the primitives and reset the statistics of a scene
+|
+| Syntax --
+|	void scene_Clear(haptic_Scene* scene)
+|
+| Inputs --
+|	haptic_Scene* scene -> scene to clear
+----------------------------------------------------------------------------------------------------------------------*/
+void scene_Clear(haptic_Scene* scene)
+{
+	scene->ready = 0;
+	scene->nb_primitives = 0;
+	scene->nb_planes = 0;
+	scene->cell_size = SCENE_CELL_SIZE;
+	scene->inv_cell_size = 1.0f / SCENE_CELL_SIZE;
+	scene->max_per_cell = 0;
+	scene->nb_queries = 0;
+	scene->nb_overruns = 0;
+	scene->nb_stopped = 0;
+	scene->max_query_ticks = 0;
+	scene->max_evaluated = 0;
+	for (int k(0); k < 3; k++)
+	{
+		scene->last_force[k] = 0.0f;
+		scene->offset[k] = 0.0f;
+		scene->grid_min[k] = 0.0f;
+		scene->dims[k] = 0;
+	}
+	scene->cell_start[0] = 0;
+}
+
+// Reserve a primitive (NULL if the scene is full), the scene has to be built again
+static scene_Primitive* scene_NewPrimitive(haptic_Scene* scene, int type)
+{
+	scene_Primitive* primitive;
+
+	if (scene->nb_primitives >= SCENE_MAX_PRIMITIVES)
+	{
+		return NULL;
+	}
+	primitive = &scene->primitives[scene->nb_primitives++];
+	memset(primitive, 0, sizeof(scene_Primitive));
+	primitive->type = type;
+	scene->ready = 0;
+	return primitive;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_AddPlane - Add a wall : half-space below a plane, pushed back along its normal
+|
+| Syntax --
+|	int scene_AddPlane(haptic_Scene* scene, const float* point, const float* normal, float stiffness, float damping)
+|
+| Inputs --
+|	haptic_Scene* scene -> scene to complete
+|	const float* point -> point of the plane (m)
+|	const float* normal -> normal pointing out of the wall (normalised here)
+|	float stiffness, damping -> contact stiffness (N/m) and damping (N.s/m)
+|
+| Outputs --
+|	int -> index of the primitive, -1 if the scene or the planes are full or the normal is null
+----------------------------------------------------------------------------------------------------------------------*/
+int scene_AddPlane(haptic_Scene* scene, const float* point, const float* normal, float stiffness, float damping)
+{
+	scene_Primitive* primitive;
+	float norm = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+	if (scene->nb_planes >= SCENE_MAX_PLANES || !(norm > 0.0f) || (primitive = scene_NewPrimitive(scene,
+		SCENE_PLANE)) == NULL)
+	{
+		return -1;
+	}
+	for (int k(0); k < 3; k++)
+	{
+		primitive->center[k] = point[k];
+		primitive->normal[k] = normal[k] / norm;
+	}
+	primitive->stiffness = stiffness;
+	primitive->damping = damping;
+	scene->planes[scene->nb_planes++] = scene->nb_primitives - 1;
+	return scene->nb_primitives - 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_AddSphere - Add a solid sphere
+|
+| Syntax --
+|	int scene_AddSphere(haptic_Scene* scene, const float* center, float radius, float stiffness, float damping)
+|
+| Inputs --
+|	haptic_Scene* scene -> scene to complete
+|	const float* center -> center of the sphere (m)
+|	float radius -> radius of the sphere (m)
+|	float stiffness, damping -> contact stiffness (N/m) and damping (N.s/m)
+|
+| Outputs --
+|	int -> index of the primitive, -1 if the scene is full or the radius is not positive
+----------------------------------------------------------------------------------------------------------------------*/
+int scene_AddSphere(haptic_Scene* scene, const float* center, float radius, float stiffness, float damping)
+{
+	scene_Primitive* primitive;
+
+	if (!(radius > 0.0f) || (primitive = scene_NewPrimitive(scene, SCENE_SPHERE)) == NULL)
+	{
+		return -1;
+	}
+	for (int k(0); k < 3; k++)
+	{
+		primitive->center[k] = center[k];
+		primitive->box_min[k] = center[k] - radius;
+		primitive->box_max[k] = center[k] + radius;
+	}
+	primitive->radius = radius;
+	primitive->stiffness = stiffness;
+	primitive->damping = damping;
+	return scene->nb_primitives - 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_AddViscous - Add a box in which the hand is slowed down by a viscous friction
+|
+| Syntax --
+|	int scene_AddViscous(haptic_Scene* scene, const float* box_min, const float* box_max, float viscosity)
+|
+| Inputs --
+|	haptic_Scene* scene -> scene to complete
+|	const float* box_min, box_max -> corners of the box (m)
+|	float viscosity -> viscosity (N.s/m)
+|
+| Outputs --
+|	int -> index of the primitive, -1 if the scene is full or the box is empty
+----------------------------------------------------------------------------------------------------------------------*/
+int scene_AddViscous(haptic_Scene* scene, const float* box_min, const float* box_max, float viscosity)
+{
+	scene_Primitive* primitive;
+
+	if (!(box_min[0] < box_max[0] && box_min[1] < box_max[1] && box_min[2] < box_max[2]) ||
+		(primitive = scene_NewPrimitive(scene, SCENE_VISCOUS)) == NULL)
+	{
+		return -1;
+	}
+	for (int k(0); k < 3; k++)
+	{
+		primitive->box_min[k] = box_min[k];
+		primitive->box_max[k] = box_max[k];
+	}
+	primitive->damping = viscosity;
+	return scene->nb_primitives - 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_AddField - Add a box in which the hand undergoes a force linear in its speed (curl field, ...)
+|
+| Syntax --
+|	int scene_AddField(haptic_Scene* scene, const float* box_min, const float* box_max, const float* field)
+|
+| Inputs --
+|	haptic_Scene* scene -> scene to complete
+|	const float* box_min, box_max -> corners of the box (m)
+|	const float* field -> 3x3 row-major matrix, force = field x speed (N.s/m)
+|
+| Outputs --
+|	int -> index of the primitive, -1 if the scene is full or the box is empty
+----------------------------------------------------------------------------------------------------------------------*/
+int scene_AddField(haptic_Scene* scene, const float* box_min, const float* box_max, const float* field)
+{
+	scene_Primitive* primitive;
+
+	if (!(box_min[0] < box_max[0] && box_min[1] < box_max[1] && box_min[2] < box_max[2]) ||
+		(primitive = scene_NewPrimitive(scene, SCENE_FIELD)) == NULL)
+	{
+		return -1;
+	}
+	for (int k(0); k < 3; k++)
+	{
+		primitive->box_min[k] = box_min[k];
+		primitive->box_max[k] = box_max[k];
+	}
+	for (int k(0); k < 9; k++)
+	{
+		primitive->field[k] = field[k];
+	}
+	return scene->nb_primitives - 1;
+}
+
+// ------------------------------------------------------ GRID INDEX ---------------------------------------------------
+
+// Cell coordinate of a value along a dimension, clamped to the grid
+static int scene_CellCoordinate(const haptic_Scene* scene, int k, float value)
+{
+	int cell = (int)floorf((value - scene->grid_min[k]) * scene->inv_cell_size);
+	return cell < 0 ? 0 : (cell >= scene->dims[k] ? scene->dims[k] - 1 : cell);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_Build - Index the primitives of a scene in the uniform grid
+|
+| Syntax --
+|	int scene_Build(FILE* err_file, haptic_Scene* scene, float cell_size)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	haptic_Scene* scene -> scene to index
+|	float cell_size -> requested size of the cells (m), enlarged if the scene needs more than SCENE_GRID_SIZE cells
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : too many primitives in a cell or in the grid (scene not ready)
+|
+| Remarks --
+|	Two passes over the primitives : the first counts the references of every cell, the second fills the lists.
+----------------------------------------------------------------------------------------------------------------------*/
+int scene_Build(FILE* err_file, haptic_Scene* scene, float cell_size)
+{
+	// Initialise variables
+	float bounds_min[3] = { 0.0f, 0.0f, 0.0f }, bounds_max[3] = { 0.0f, 0.0f, 0.0f }, extent = 0.0f;
+	int lo[3], hi[3], nb_cells, nb_indexed = 0, nb_refs = 0;
+	const scene_Primitive* primitive;
+
+	scene->ready = 0;
+	scene->max_per_cell = 0;
+
+	// Bounds of the indexed primitives
+	for (int p(0); p < scene->nb_primitives; p++)
+	{
+		primitive = &scene->primitives[p];
+		if (primitive->type == SCENE_PLANE)
+		{
+			continue;
+		}
+		for (int k(0); k < 3; k++)
+		{
+			if (nb_indexed == 0 || primitive->box_min[k] < bounds_min[k])
+			{
+				bounds_min[k] = primitive->box_min[k];
+			}
+			if (nb_indexed == 0 || primitive->box_max[k] > bounds_max[k])
+			{
+				bounds_max[k] = primitive->box_max[k];
+			}
+		}
+		nb_indexed++;
+	}
+
+	// Grid dimensions
+	for (int k(0); k < 3; k++)
+	{
+		extent = bounds_max[k] - bounds_min[k] > extent ? bounds_max[k] - bounds_min[k] : extent;
+	}
+	scene->cell_size = cell_size > extent / SCENE_GRID_SIZE ? cell_size : extent / SCENE_GRID_SIZE;
+	scene->inv_cell_size = 1.0f / scene->cell_size;
+	nb_cells = 1;
+	for (int k(0); k < 3; k++)
+	{
+		scene->grid_min[k] = bounds_min[k];
+		scene->dims[k] = nb_indexed == 0 ? 0 : (int)ceilf((bounds_max[k] - bounds_min[k]) * scene->inv_cell_size);
+		scene->dims[k] = scene->dims[k] < 1 ? 1 : (scene->dims[k] > SCENE_GRID_SIZE ? SCENE_GRID_SIZE : scene->dims[k]);
+		nb_cells *= scene->dims[k];
+	}
+	if (nb_indexed == 0)
+	{
+		scene->dims[0] = scene->dims[1] = scene->dims[2] = 0;
+		nb_cells = 0;
+	}
+
+	// First pass : count the references of every cell (shifted by one for the prefix sum)
+	for (int c(0); c <= nb_cells; c++)
+	{
+		scene->cell_start[c] = 0;
+	}
+	for (int p(0); p < scene->nb_primitives; p++)
+	{
+		primitive = &scene->primitives[p];
+		if (primitive->type == SCENE_PLANE)
+		{
+			continue;
+		}
+		for (int k(0); k < 3; k++)
+		{
+			lo[k] = scene_CellCoordinate(scene, k, primitive->box_min[k]);
+			hi[k] = scene_CellCoordinate(scene, k, primitive->box_max[k]);
+		}
+		for (int x(lo[0]); x <= hi[0]; x++)
+		{
+			for (int y(lo[1]); y <= hi[1]; y++)
+			{
+				for (int z(lo[2]); z <= hi[2]; z++)
+				{
+					scene->cell_start[(x * scene->dims[1] + y) * scene->dims[2] + z + 1]++;
+					nb_refs++;
+				}
+			}
+		}
+	}
+	if (nb_refs > SCENE_MAX_REFS)
+	{
+		fprintf(err_file, "Haptic scene rejected : %d grid references (max %d)\n", nb_refs, SCENE_MAX_REFS);
+		return 1;
+	}
+	for (int c(0); c < nb_cells; c++)
+	{
+		if (scene->cell_start[c + 1] > SCENE_MAX_PER_CELL)
+		{
+			fprintf(err_file, "Haptic scene rejected : %d primitives in a cell of %f m (max %d)\n",
+				    scene->cell_start[c + 1], scene->cell_size, SCENE_MAX_PER_CELL);
+			return 1;
+		}
+		scene->max_per_cell = scene->cell_start[c + 1] > scene->max_per_cell ? scene->cell_start[c + 1] :
+			                  scene->max_per_cell;
+		scene->cell_start[c + 1] += scene->cell_start[c];
+	}
+
+	// Second pass : fill the lists (cell_start is used as a cursor, then shifted back)
+	for (int p(0); p < scene->nb_primitives; p++)
+	{
+		primitive = &scene->primitives[p];
+		if (primitive->type == SCENE_PLANE)
+		{
+			continue;
+		}
+		for (int k(0); k < 3; k++)
+		{
+			lo[k] = scene_CellCoordinate(scene, k, primitive->box_min[k]);
+			hi[k] = scene_CellCoordinate(scene, k, primitive->box_max[k]);
+		}
+		for (int x(lo[0]); x <= hi[0]; x++)
+		{
+			for (int y(lo[1]); y <= hi[1]; y++)
+			{
+				for (int z(lo[2]); z <= hi[2]; z++)
+				{
+					scene->refs[scene->cell_start[(x * scene->dims[1] + y) * scene->dims[2] + z]++] = p;
+				}
+			}
+		}
+	}
+	for (int c(nb_cells); c > 0; c--)
+	{
+		scene->cell_start[c] = scene->cell_start[c - 1];
+	}
+	scene->cell_start[0] = 0;
+	scene->budget_ticks = (long long)(SCENE_BUDGET_US * 1e-6 * timebase_Frequency());
+	scene->ready = 1;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_Load - Read a scene from a text file and build its grid
+|
+| Syntax --
+|	int scene_Load(FILE* err_file, FILE* out_file, haptic_Scene* scene, const char* file_name)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	haptic_Scene* scene -> scene to fill
+|	const char* file_name -> name of the scene file
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : File not opened ; 2 : Invalid file ; 3 : Grid not built
+|
+| Remarks --
+|	One primitive per line, coordinates in m relatively to the hand position when the control starts :
+|		plane px py pz nx ny nz stiffness damping
+|		sphere cx cy cz radius stiffness damping
+|		viscous xmin ymin zmin xmax ymax zmax viscosity
+|		field xmin ymin zmin xmax ymax zmax m00 m01 m02 m10 m11 m12 m20 m21 m22
+----------------------------------------------------------------------------------------------------------------------*/
+int scene_Load(FILE* err_file, FILE* out_file, haptic_Scene* scene, const char* file_name)
+{
+	// Initialise variables
+	FILE* scene_file = NULL;
+	char key[16];
+	float values[15];
+	int nb_values, index, status = 0;
+
+	scene_Clear(scene);
+	fopen_s(&scene_file, file_name, "rt");
+	if (scene_file == NULL)
+	{
+		fprintf(err_file, "Haptic scene file %s not opened !\n", file_name);
+		return 1;
+	}
+	while (status == 0 && fscanf(scene_file, "%15s", key) == 1)
+	{
+		nb_values = strcmp(key, "plane") == 0 ? 8 : (strcmp(key, "sphere") == 0 ? 6 : (strcmp(key, "viscous") == 0 ?
+			        7 : (strcmp(key, "field") == 0 ? 15 : 0)));
+		if (nb_values == 0)
+		{
+			fprintf(err_file, "Unknown haptic primitive %s in %s\n", key, file_name);
+			status = 2;
+			break;
+		}
+		for (int i(0); i < nb_values; i++)
+		{
+			if (fscanf(scene_file, "%f", &values[i]) != 1 || !isfinite(values[i]))
+			{
+				fprintf(err_file, "Invalid value of haptic primitive %s in %s\n", key, file_name);
+				status = 2;
+				break;
+			}
+		}
+		if (status != 0)
+		{
+			break;
+		}
+		if (nb_values == 8)
+		{
+			index = scene_AddPlane(scene, values, values + 3, values[6], values[7]);
+		}
+		else if (nb_values == 6)
+		{
+			index = scene_AddSphere(scene, values, values[3], values[4], values[5]);
+		}
+		else if (nb_values == 7)
+		{
+			index = scene_AddViscous(scene, values, values + 3, values[6]);
+		}
+		else
+		{
+			index = scene_AddField(scene, values, values + 3, values + 6);
+		}
+		if (index < 0)
+		{
+			fprintf(err_file, "Haptic primitive %d (%s) of %s rejected\n", scene->nb_primitives, key, file_name);
+			status = 2;
+		}
+	}
+	fclose(scene_file);
+	if (status != 0)
+	{
+		return status;
+	}
+	if (scene_Build(err_file, scene, SCENE_CELL_SIZE) != 0)
+	{
+		return 3;
+	}
+	fprintf(out_file, "Haptic scene %s : %d primitives (%d planes), grid %dx%dx%d of %f m, %d primitives per cell max\n",
+		    file_name, scene->nb_primitives, scene->nb_planes, scene->dims[0], scene->dims[1], scene->dims[2],
+		    scene->cell_size, scene->max_per_cell);
+	return 0;
+}
+
+// ------------------------------------------------------ RENDERING ----------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_Render - Add the force of a primitive on the hand
+|
+| Syntax --
+|	int scene_Render(const scene_Primitive* primitive, const float* position, const float* speed, float* force)
+|
+| Inputs --
+|	const scene_Primitive* primitive -> primitive to render
+|	const float* position, speed -> hand position (m) and speed (m/s) in the scene frame
+|	float* force -> force (N) incremented by the force of the primitive
+|
+| Outputs --
+|	int -> 1 if the primitive acts on the hand, 0 otherwise
+|
+| Remarks --
+|	Contacts are spring-dampers along the normal, the damping is cut so that walls and spheres never pull the hand.
+----------------------------------------------------------------------------------------------------------------------*/
+int scene_Render(const scene_Primitive* primitive, const float* position, const float* speed, float* force)
+{
+	// Initialise variables
+	float delta[3], normal[3], depth, distance, normal_force;
+
+	if (primitive->type == SCENE_PLANE || primitive->type == SCENE_SPHERE)
+	{
+		if (primitive->type == SCENE_PLANE)
+		{
+			depth = -((position[0] - primitive->center[0]) * primitive->normal[0] + (position[1] -
+				    primitive->center[1]) * primitive->normal[1] + (position[2] - primitive->center[2]) *
+				    primitive->normal[2]);
+			if (depth <= 0.0f)
+			{
+				return 0;
+			}
+			for (int k(0); k < 3; k++)
+			{
+				normal[k] = primitive->normal[k];
+			}
+		}
+		else
+		{
+			for (int k(0); k < 3; k++)
+			{
+				delta[k] = position[k] - primitive->center[k];
+			}
+			distance = delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2];
+			if (distance >= primitive->radius * primitive->radius || distance == 0.0f)
+			{
+				return 0;
+			}
+			distance = sqrtf(distance);
+			depth = primitive->radius - distance;
+			for (int k(0); k < 3; k++)
+			{
+				normal[k] = delta[k] / distance;
+			}
+		}
+		normal_force = primitive->stiffness * depth - primitive->damping * (speed[0] * normal[0] + speed[1] *
+			           normal[1] + speed[2] * normal[2]);
+		if (normal_force > 0.0f)
+		{
+			for (int k(0); k < 3; k++)
+			{
+				force[k] += normal_force * normal[k];
+			}
+		}
+		return 1;
+	}
+	for (int k(0); k < 3; k++)
+	{
+		if (position[k] < primitive->box_min[k] || position[k] > primitive->box_max[k])
+		{
+			return 0;
+		}
+	}
+	for (int k(0); k < 3; k++)
+	{
+		force[k] += primitive->type == SCENE_VISCOUS ? -primitive->damping * speed[k] : primitive->field[3 * k] *
+			        speed[0] + primitive->field[3 * k + 1] * speed[1] + primitive->field[3 * k + 2] * speed[2];
+	}
+	return 1;
+}
+
+// Saturate the norm of the rendered force
+static void scene_Saturate(float* force)
+{
+	float norm = sqrtf(force[0] * force[0] + force[1] * force[1] + force[2] * force[2]);
+
+	if (norm > SCENE_MAX_FORCE)
+	{
+		for (int k(0); k < 3; k++)
+		{
+			force[k] *= SCENE_MAX_FORCE / norm;
+		}
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_Query - Compute the force of the scene on the hand using the grid
+|
+| Syntax --
+|	int scene_Query(haptic_Scene* scene, const float* position, const float* speed, float* force)
+|
+| Inputs --
+|	haptic_Scene* scene -> built scene, query statistics updated
+|	const float* position, speed -> hand position (m) and speed (m/s) in the base frame
+|	float* force -> filled with the force (N) in the base frame, saturated at SCENE_MAX_FORCE
+|
+| Outputs --
+|	int -> number of primitives acting on the hand, -1 (null force) if the scene is not built, SCENE_OVERRUN if the
+|	       query was stopped on its budget (force of the last complete query)
+|
+| Remarks --
+|	The budget is checked every SCENE_BUDGET_CHECK primitives of the cell : the walls are always evaluated.
+----------------------------------------------------------------------------------------------------------------------*/
+int scene_Query(haptic_Scene* scene, const float* position, const float* speed, float* force)
+{
+	// Initialise variables
+	long long start_tick = timebase_Now(), ticks;
+	float local[3];
+	int cell[3], nb_active = 0, nb_evaluated = scene->nb_planes, first, last;
+	bool stopped = false;
+
+	force[0] = force[1] = force[2] = 0.0f;
+	if (!scene->ready)
+	{
+		return -1;
+	}
+	for (int k(0); k < 3; k++)
+	{
+		local[k] = position[k] - scene->offset[k];
+	}
+
+	// Walls, then the primitives of the cell containing the hand
+	for (int p(0); p < scene->nb_planes; p++)
+	{
+		nb_active += scene_Render(&scene->primitives[scene->planes[p]], local, speed, force);
+	}
+	for (int k(0); k < 3; k++)
+	{
+		cell[k] = (int)floorf((local[k] - scene->grid_min[k]) * scene->inv_cell_size);
+	}
+	if (cell[0] >= 0 && cell[0] < scene->dims[0] && cell[1] >= 0 && cell[1] < scene->dims[1] && cell[2] >= 0 &&
+		cell[2] < scene->dims[2])
+	{
+		first = scene->cell_start[(cell[0] * scene->dims[1] + cell[1]) * scene->dims[2] + cell[2]];
+		last = scene->cell_start[(cell[0] * scene->dims[1] + cell[1]) * scene->dims[2] + cell[2] + 1];
+		for (int r(first); r < last; r++)
+		{
+			if ((r - first) % SCENE_BUDGET_CHECK == 0 && timebase_Now() - start_tick > scene->budget_ticks)
+			{
+				stopped = true;
+				break;
+			}
+			nb_active += scene_Render(&scene->primitives[scene->refs[r]], local, speed, force);
+			nb_evaluated++;
+		}
+	}
+
+	// Force of the last complete query if out of budget
+	if (stopped)
+	{
+		for (int k(0); k < 3; k++)
+		{
+			force[k] = scene->last_force[k];
+		}
+	}
+	else
+	{
+		scene_Saturate(force);
+		for (int k(0); k < 3; k++)
+		{
+			scene->last_force[k] = force[k];
+		}
+	}
+
+	// Statistics
+	ticks = timebase_Now() - start_tick;
+	scene->nb_queries++;
+	scene->max_query_ticks = ticks > scene->max_query_ticks ? ticks : scene->max_query_ticks;
+	scene->max_evaluated = nb_evaluated > scene->max_evaluated ? nb_evaluated : scene->max_evaluated;
+	if (ticks > scene->budget_ticks)
+	{
+		scene->nb_overruns++;
+	}
+	if (stopped)
+	{
+		scene->nb_stopped++;
+		return SCENE_OVERRUN;
+	}
+	return nb_active;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_QueryAll - Compute the force of the scene on the hand by evaluating every primitive (reference of the grid)
+|
+| Syntax --
+|	int scene_QueryAll(const haptic_Scene* scene, const float* position, const float* speed, float* force)
+|
+| Inputs --
+|	const haptic_Scene* scene -> scene, built or not
+|	const float* position, speed -> hand position (m) and speed (m/s) in the base frame
+|	float* force -> filled with the force (N) in the base frame, saturated at SCENE_MAX_FORCE
+|
+| Outputs --
+|	int -> number of primitives acting on the hand
+----------------------------------------------------------------------------------------------------------------------*/
+int scene_QueryAll(const haptic_Scene* scene, const float* position, const float* speed, float* force)
+{
+	// Initialise variables
+	float local[3];
+	int nb_active = 0;
+
+	force[0] = force[1] = force[2] = 0.0f;
+	for (int k(0); k < 3; k++)
+	{
+		local[k] = position[k] - scene->offset[k];
+	}
+	for (int p(0); p < scene->nb_primitives; p++)
+	{
+		nb_active += scene_Render(&scene->primitives[p], local, speed, force);
+	}
+	scene_Saturate(force);
+	return nb_active;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| scene_PrintStats - Print the query statistics of a scene
+|
+| Syntax --
+|	void scene_PrintStats(FILE* out_file, const haptic_Scene* scene)
+|
+| Inputs --
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	const haptic_Scene* scene -> scene
+----------------------------------------------------------------------------------------------------------------------*/
+void scene_PrintStats(FILE* out_file, const haptic_Scene* scene)
+{
+	fprintf(out_file, "Haptic scene : %lld queries, longest %lld us (budget %.0f us, %lld overruns, %lld stopped), %d "
+		    "primitives evaluated max\n", scene->nb_queries, timebase_Micro(scene->max_query_ticks), SCENE_BUDGET_US,
+		    scene->nb_overruns, scene->nb_stopped, scene->max_evaluated);
+}
@@ -0,0 +1,91 @@
+/***********************************************************************************************************************
+* haptic_scene.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the declaration of the haptic virtual environment : primitives rendered at the hand (walls, spheres,
+* viscous regions, velocity dependent force fields) indexed in a uniform grid of fixed capacity.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef HAPTIC_SCENE_H
+#define HAPTIC_SCENE_H
+
+// General includes
+#include <stdio.h>
+
+// Primitive types
+#define SCENE_PLANE 0									// Half-space wall (not indexed, tested at every query)
+#define SCENE_SPHERE 1									// Solid sphere
+#define SCENE_VISCOUS 2									// Box with viscous friction
+#define SCENE_FIELD 3									// Box with a force field linear in the hand speed
+
+// Capacities (the scene struct has a fixed size, a query evaluates at most SCENE_MAX_PLANES + SCENE_MAX_PER_CELL)
+#define SCENE_MAX_PRIMITIVES 1024
+#define SCENE_MAX_PLANES 16
+#define SCENE_GRID_SIZE 32								// Maximal number of cells along each dimension
+#define SCENE_MAX_REFS 16384							// Maximal number of primitive references in the grid
+#define SCENE_MAX_PER_CELL 32							// Maximal number of primitives overlapping a cell
+#define SCENE_CELL_SIZE 0.04f							// Default size of the cells (m)
+
+// Rendering
+#define SCENE_MAX_FORCE 40.0f							// Saturation of the rendered force (N)
+#define SCENE_BUDGET_US 50.0f							// Computation budget of a query (us), stopped above it
+#define SCENE_BUDGET_CHECK 8							// Primitives of the cell evaluated between two budget checks
+#define SCENE_OVERRUN -2								// Query stopped on its budget, last valid force returned
+#define SCENE_FILE "haptic_scene.txt"					// Scene used by HAPTIC_CTRL
+
+// -------------------------------------------------- PRIMITIVE STRUCT -------------------------------------------------
+struct scene_Primitive
+{
+	int type;								// SCENE_PLANE, SCENE_SPHERE, SCENE_VISCOUS or SCENE_FIELD
+	float center[3];						// Plane : point, sphere : center (m)
+	float normal[3];						// Plane : outward unit normal
+	float radius;							// Sphere : radius (m)
+	float stiffness;						// Plane, sphere : contact stiffness (N/m)
+	float damping;							// Plane, sphere : contact damping, viscous : viscosity (N.s/m)
+	float field[9];							// Field : force = field x speed (row-major, N.s/m)
+	float box_min[3], box_max[3];			// Bounding box (m), region of the viscous and field primitives
+};
+
+// ---------------------------------------------------- SCENE STRUCT ---------------------------------------------------
+struct haptic_Scene
+{
+	int ready;										// 1 : grid built, 0 : not built
+	int nb_primitives;								// Number of primitives
+	scene_Primitive primitives[SCENE_MAX_PRIMITIVES];
+	int nb_planes;									// Number of planes
+	int planes[SCENE_MAX_PLANES];					// Indexes of the planes
+	float offset[3];								// Position of the scene origin in the base frame (m)
+	float grid_min[3];								// Corner of the grid in the scene frame (m)
+	float cell_size;								// Size of the cells (m)
+	float inv_cell_size;							// Inverse of the cell size
+	int dims[3];									// Number of cells along each dimension
+	int cell_start[SCENE_GRID_SIZE * SCENE_GRID_SIZE * SCENE_GRID_SIZE + 1];	// First reference of each cell
+	int refs[SCENE_MAX_REFS];						// Primitive indexes, cell by cell
+	int max_per_cell;								// Largest number of primitives in a cell
+	long long nb_queries;							// Number of queries
+	long long nb_overruns;							// Number of queries above SCENE_BUDGET_US
+	long long nb_stopped;							// Number of queries stopped on their budget (SCENE_OVERRUN)
+	long long budget_ticks;							// SCENE_BUDGET_US in timebase ticks (set by scene_Build)
+	float last_force[3];							// Last force fully computed (N), returned by stopped queries
+	long long max_query_ticks;						// Longest query (timebase ticks)
+	int max_evaluated;								// Largest number of primitives evaluated by a query
+};
+
+// Functions declaration
+void scene_Clear(haptic_Scene* scene);
+int scene_AddPlane(haptic_Scene* scene, const float* point, const float* normal, float stiffness, float damping);
+int scene_AddSphere(haptic_Scene* scene, const float* center, float radius, float stiffness, float damping);
+int scene_AddViscous(haptic_Scene* scene, const float* box_min, const float* box_max, float viscosity);
+int scene_AddField(haptic_Scene* scene, const float* box_min, const float* box_max, const float* field);
+int scene_Build(FILE* err_file, haptic_Scene* scene, float cell_size);
+int scene_Load(FILE* err_file, FILE* out_file, haptic_Scene* scene, const char* file_name);
+int scene_Query(haptic_Scene* scene, const float* position, const float* speed, float* force);
+int scene_QueryAll(const haptic_Scene* scene, const float* position, const float* speed, float* force);
+int scene_Render(const scene_Primitive* primitive, const float* position, const float* speed, float* force);
+void scene_PrintStats(FILE* out_file, const haptic_Scene* scene);
+#endif // !HAPTIC_SCENE_H
\ No newline at end of file
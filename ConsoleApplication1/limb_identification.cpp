@@ -22,7 +22,7 @@
 void limbIdentification_Main(ThreadInformations* ableInfos)
 {
 	// Open storing file
-	fopen_s(&ableInfos->ctrl_ABLE->hDynId.idDyn_File, "human_limb_identification.txt", "w");
+	fopen_s(&ableInfos->ctrl_ABLE->hDynId.idDyn_File, HUMAN_LIMB_FILE, "w");
 
 	// Estimate human forearm 
 
@@ -33,7 +33,7 @@ void limbIdentification_Main(ThreadInformations* ableInfos)
 	//std::vector<float> a_currents4_model;
 	//std::vector<float> a_currents4_human;
 	//// Extract measured values during the experiment and identified dynamics
-	//ableMeasures* measValues = &ableInfos->ctrl_ABLE->aMeasures;
+	//ableMeasures* measValues = ableInfos->ctrl_ABLE->aMeasures;
 	//ableDynamics* identDyn = &ableInfos->ctrl_ABLE->aDynamics;
 	//
 	//// Compute theoretical currents without human limb
@@ -107,7 +107,7 @@ void compute_HumanCurrents(ableMeasures* measValues, std::vector<float>* a_curre
 void compute_HumanMass(ThreadInformations* ableInfos, std::vector<float>* a_currents4_human)
 {
 	// Extract measured values during the experiment
-	ableMeasures* measValues = &ableInfos->ctrl_ABLE->aMeasures;
+	ableMeasures* measValues = ableInfos->ctrl_ABLE->aMeasures;
 	ableDynamics* identDyn = &ableInfos->ctrl_ABLE->aDynamics;
 	motorsParams* mVals = &ableInfos->ctrl_ABLE->mParams;
 	// Variables extraction
@@ -136,7 +136,7 @@ void compute_HumanMass(ThreadInformations* ableInfos, std::vector<float>* a_curr
 void compute_HumanMass_FT(ThreadInformations* ableInfos)
 {
 	// Extract measured values during the experiment
-	ableMeasures* measValues = &ableInfos->ctrl_ABLE->aMeasures;
+	ableMeasures* measValues = ableInfos->ctrl_ABLE->aMeasures;
 	// Variables extraction
 	int nValues = measValues->fz_FTW_sensor.size();
 	float somme = 0;
@@ -147,7 +147,8 @@ void compute_HumanMass_FT(ThreadInformations* ableInfos)
 		fprintf(ableInfos->identification_file, "Not the same number of measures of position and forces\n");
 	}
 
-	for (int i(1000); i < nValues; i++)
+	// Skip the first second of measures, whatever the control rate
+	for (int i((int)(ableInfos->ctrl_ABLE->rtParams.ctrl_rate + 0.5f)); i < nValues; i++)
 	{
 		mass_i = - measValues->fz_FTW_sensor.at(i) / (G_VAL * cos(measValues->able_artpos_4.at(i)+0.53f));
 		fprintf(ableInfos->identification_file, "At iteration %i : Angle : %f, Force : %f, Mass : %f\n",
@@ -169,28 +170,80 @@ void compute_HumanMass_FT(ThreadInformations* ableInfos)
 void store_IdentifiedHDyn(ThreadInformations* ableInfos)
 {
 	FILE* h_File = ableInfos->ctrl_ABLE->hDynId.idDyn_File;
+	sidecar_humanDyn hDyn = { ableInfos->ctrl_ABLE->hDynId.mass, HUMAN_DEFAULT_DELTA_THETA, HUMAN_DEFAULT_INERTIA,
+		                      SIDECAR_HUMAN_DEFAULT_DELTA_THETA | SIDECAR_HUMAN_DEFAULT_INERTIA };
 	fprintf(h_File, "%f ", ableInfos->ctrl_ABLE->hDynId.mass);
-	fprintf(h_File, "0.5 0.0 ");
+	fprintf(h_File, "%.1f %.1f ", HUMAN_DEFAULT_DELTA_THETA, HUMAN_DEFAULT_INERTIA);
 	fclose(h_File);
+	// Write the binary sidecar applied at next launch, only the mass was identified
+	sidecar_Write(ableInfos->err_file, HUMAN_LIMB_FILE, SIDECAR_HUMAN_DYN, &hDyn, sizeof(sidecar_humanDyn));
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
-| retrieve_IdentifiedDyn - Retrieve identified dynamic parameters
+| retrieve_IdentifiedDyn - Retrieve identified dynamic parameters from their binary sidecar, or from the text file if
+|                          the sidecar is missing, stale or invalid
 |
 | Syntax --
-|	void retrieve_IdentifiedDyn(ThreadInformations* ableInfos)
+|	void retrieve_IdentifiedDyn(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, const char* file_name)
 |
 | Inputs --
-|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	AbleControlStruct* ctrl_ABLE -> Struct containing all ABLE informations
+|	const char* file_name -> name of the text file containing the identified parameters
+|
+| Remarks --
+|	The values marked as defaults in the sidecar (not identified) are replaced by the current built-in ones. Every value
+|	parsed from the text file is considered as supplied.
 ----------------------------------------------------------------------------------------------------------------------*/
-void retrieve_IdentifiedDyn(AbleControlStruct* ctrl_ABLE)
+void retrieve_IdentifiedDyn(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, const char* file_name)
 {
-	FILE* h_File = ctrl_ABLE->hDynId.idDyn_File;
-	if (fscanf(h_File, "%f %f %f", &ctrl_ABLE->hDynId.mass, &ctrl_ABLE->hDynId.delta_theta, &ctrl_ABLE->hDynId.farm_FE_inertia) == 3)
+	// Initialise variables
+	FILE* h_File = NULL;
+	sidecar_humanDyn hDyn;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// Apply the sidecar if it is valid and up to date
+	if (sidecar_Load(err_file, file_name, SIDECAR_HUMAN_DYN, &hDyn, sizeof(sidecar_humanDyn)) == SIDECAR_OK)
+	{
+		ctrl_ABLE->hDynId.mass = hDyn.mass;
+		ctrl_ABLE->hDynId.delta_theta = (hDyn.defaults & SIDECAR_HUMAN_DEFAULT_DELTA_THETA) ?
+			                            HUMAN_DEFAULT_DELTA_THETA : hDyn.delta_theta;
+		ctrl_ABLE->hDynId.farm_FE_inertia = (hDyn.defaults & SIDECAR_HUMAN_DEFAULT_INERTIA) ?
+			                                HUMAN_DEFAULT_INERTIA : hDyn.farm_FE_inertia;
+		ctrl_ABLE->hDynId.check_ExtractData = 1;
+		if (hDyn.defaults != 0)
+		{
+			fprintf(out_file, "Human dynamics : built-in %s%s%s used (not identified)\n",
+				    (hDyn.defaults & SIDECAR_HUMAN_DEFAULT_DELTA_THETA) ? "delta_theta" : "",
+				    (hDyn.defaults == (SIDECAR_HUMAN_DEFAULT_DELTA_THETA | SIDECAR_HUMAN_DEFAULT_INERTIA)) ? " and " : "",
+				    (hDyn.defaults & SIDECAR_HUMAN_DEFAULT_INERTIA) ? "inertia" : "");
+		}
+		fprintf(out_file, "Human dynamics applied from sidecar in %lld us\n", (long long)std::chrono::duration_cast
+			    <std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count());
+		return;
+	}
+
+	// Otherwise parse the text file and refresh its sidecar
+	fopen_s(&h_File, file_name, "rt");
+	if (h_File != NULL &&
+		fscanf(h_File, "%f %f %f", &hDyn.mass, &hDyn.delta_theta, &hDyn.farm_FE_inertia) == 3)
 	{
+		hDyn.defaults = 0;
+		ctrl_ABLE->hDynId.mass = hDyn.mass;
+		ctrl_ABLE->hDynId.delta_theta = hDyn.delta_theta;
+		ctrl_ABLE->hDynId.farm_FE_inertia = hDyn.farm_FE_inertia;
 		ctrl_ABLE->hDynId.check_ExtractData = 1;
 	}else {
+		fprintf(err_file, "Error reading human dynamics in %s\n", file_name);
 		ctrl_ABLE->hDynId.check_ExtractData = 0;
 	}
-	fclose(h_File);
+	if (h_File != NULL)
+	{
+		fclose(h_File);
+	}
+	if (ctrl_ABLE->hDynId.check_ExtractData)
+	{
+		sidecar_Write(err_file, file_name, SIDECAR_HUMAN_DYN, &hDyn, sizeof(sidecar_humanDyn));
+	}
 }
\ No newline at end of file
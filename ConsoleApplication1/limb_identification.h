@@ -16,6 +16,13 @@
 // Project includes
 #include "control_struct.h"
 #include "handle_communication.h"
+#include "parameter_sidecar.h"
+
+// File storing the identified dynamic parameters of the human limb
+#define HUMAN_LIMB_FILE "human_limb_identification.txt"
+// Built-in values of the parameters not identified by the procedure (computed under matlab afterwards)
+#define HUMAN_DEFAULT_DELTA_THETA 0.5f
+#define HUMAN_DEFAULT_INERTIA 0.0f
 
 // Functions declaration
 // Main function of limb identification
@@ -32,5 +39,5 @@ void compute_HumanMass_FT(ThreadInformations* ableInfos);
 // Store identified dynamic parameters in a text file for further use
 void store_IdentifiedHDyn(ThreadInformations* ableInfos);
 // Extract identified dynamic parameters of the human limb
-void retrieve_IdentifiedDyn(AbleControlStruct* ctrl_ABLE);
+void retrieve_IdentifiedDyn(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, const char* file_name);
 #endif // !LIMB_IDENTIFICATION_H
\ No newline at end of file
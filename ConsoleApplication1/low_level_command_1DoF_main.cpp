@@ -18,17 +18,24 @@ static ThreadHandles all_Threads;
 static ServoComEth eth_ABLE;
 // Creation of AbleControlStruct structure to store real time data
 static AbleControlStruct ctrl_ABLE;
+// Creation of the cold data of the control struct (measures storage, haptic scene), kept out of its cache lines
+static ableMeasures able_Measures;
+static haptic_Scene able_Scene;
 // Creation of ComStruct structure to store real time data
 static ComStruct qtm_ComStruct;
+// Creation of the mailbox between QTM measures and control threads
+static qtm_mailbox qtm_Mailbox;
 // Creation of the FT_Comm_Struct to communicate with Digital FT sensor
 static FT_Comm_Struct FT_Comm_params_Wrist;
 static FT_Comm_Struct FT_Comm_params_Arm;
 // Creation of the global measures structs for Critical communication
 FT_meas_Global FT_measures_Interlocked_Wrist;
 FT_meas_Global FT_measures_Interlocked_Arm;
-// Creation of the critical section structs
-CRITICAL_SECTION Critical_share_FT_Wrist;
-CRITICAL_SECTION Critical_share_FT_Arm;
+// Creation of the critical section structs, on separate cache lines (each FT thread enters its own at the sensor rate)
+alignas(64) CRITICAL_SECTION Critical_share_FT_Wrist;
+alignas(64) CRITICAL_SECTION Critical_share_FT_Arm;
+// Iterations replayed repeatedly after the captured session (REPLAY_PLAY)
+static replay_Window replay_window = { 0, -1, 1 };
 
 /*---------------------------------------------------------------------------------------------------------------------
 | main - Main function
@@ -38,7 +45,16 @@ CRITICAL_SECTION Critical_share_FT_Arm;
 |
 | Inputs --
 |	int argc -> length of argv
-|	char* argv[] -> name, identification phase, port, char position, duration, friction, id method, human parameters
+|	char* argv[] -> name, identification phase, port, char position, duration, friction, id method, human parameters,
+|	                ..., optional control rate in Hz (argv[22], CTRL_MIN_RATE to CTRL_MAX_RATE, default 1 kHz),
+|	                optional thread placement (argv[23], PLACEMENT_NONE to PLACEMENT_FULL, default PLACEMENT_NONE),
+|	                optional allocation tracking of the control loop (argv[24], 0 or 1, default 0),
+|	                optional capture or replay of the session (argv[25], REPLAY_OFF to REPLAY_PLAY, default REPLAY_OFF),
+|	                optional replayed window (argv[26], "first;last;repeats", default whole session once),
+|	                optional Cartesian impedance (argv[27], "stiffness pos;damping pos;stiffness rot;damping rot;
+|	                max force;max moment;FT gain", default CART_STIFFNESS_POS to CART_FT_GAIN),
+|	                optional backend of the dynamic model (argv[28], MODEL_BACKEND_ANALYTIC, MODEL_BACKEND_MAP or
+|	                MODEL_BACKEND_RNEA, default DEFAULT_MODEL_BACKEND)
 |
 | Outputs --
 |	int -> 0 : Success ; else : Failure
@@ -57,16 +73,61 @@ int main(int argc, char *argv[])
 	freopen_s(&out_file, "outputs.txt", "w", stdout);
 	fprintf(out_file, "All files successfully opened\n");
 
+	// Link the cold data to the control struct
+	ctrl_ABLE.aMeasures = &able_Measures;
+	ctrl_ABLE.scene = &able_Scene;
+
 	// Extract and store input data
-	extract_InputData(argc, argv, out_file, err_file);
+	if (extract_InputData(argc, argv, out_file, err_file) != 0)
+	{
+		fprintf(err_file, "Input data rejected, motions cancelled\n");
+		fflush(err_file);
+		fflush(out_file);
+		return -1;
+	}
 	fprintf(out_file, "Input data extracted\n");
 
 	// Set all robot parameters
 	able_SetAllParams(&ctrl_ABLE);
+	if (able_LoadRobotDynamics(err_file, out_file, &ctrl_ABLE, ROBOT_DYNAMICS_FILE) != 0)
+	{
+		fprintf(err_file, "Robot dynamics rejected, motions cancelled\n");
+		fflush(err_file);
+		fflush(out_file);
+		return -1;
+	}
 
-	// Preallocate vectors memory
+	// Run offline benchmarks instead of motions if requested
+	if (ctrl_ABLE.aOrders.ctrl_type == MODEL_BENCH)
+	{
+		return bench_RunAll(err_file, out_file, &ctrl_ABLE);
+	}
+	model_InitBackend(err_file, out_file, &ctrl_ABLE, ctrl_ABLE.rtParams.model_backend);
+	// Run the simulated sessions of the sweep file instead of motions if requested, with the fault profiles if any
+	if (ctrl_ABLE.aOrders.ctrl_type == BATCH_SIM)
+	{
+		return sim_RunBatch(err_file, out_file, &ctrl_ABLE, SIM_SWEEP_FILE, NULL, SIM_RESULTS_FILE);
+	}
+	if (ctrl_ABLE.aOrders.ctrl_type == FAULT_SIM)
+	{
+		return sim_RunBatch(err_file, out_file, &ctrl_ABLE, SIM_SWEEP_FILE, FAULT_PROFILES_FILE, FAULT_RESULTS_FILE);
+	}
+	if (ctrl_ABLE.aOrders.ctrl_type == HAPTIC_CTRL && scene_Load(err_file, out_file, ctrl_ABLE.scene, SCENE_FILE) != 0)
+	{
+		fprintf(err_file, "Haptic scene rejected, motions cancelled\n");
+		fflush(err_file);
+		fflush(out_file);
+		return -1;
+	}
+
+	// Preallocate vectors memory, committed and locked by the session storage (large pages when available)
+	storage_Init(err_file, out_file);
 	preallocate_memory();
 
+	// Place the process before creating the real time threads : priority class and resident memory
+	placement_Init(ctrl_ABLE.rtParams.placement_level);
+	placement_SetupProcess(err_file, out_file, &ctrl_ABLE, sizeof(ctrl_ABLE));
+
 	// Initialise FT shared struct in any case
 	initialise_FT_Shared();
 	fprintf(out_file, "Shared structs initialised\n");
@@ -90,14 +151,20 @@ int main(int argc, char *argv[])
 
 	fprintf(out_file, "Critical sections initialised\n");
 	fflush(out_file);
+
+	// Replay the captured session instead of driving ABLE if requested
+	if (ctrl_ABLE.rtParams.replay_mode == REPLAY_PLAY)
+	{
+		return replaySession(err_file, out_file);
+	}
 	
 	// Initialize communication with Python
 	if (ctrl_ABLE.aOrders.ctrl_type >= TORQUE_CTRL && ctrl_ABLE.rtParams.use_QTM)
 	{
 		err = initComPython(err_file, out_file);
 		if (err == -1) { return -1; }
-		// Initialize pipes between threads
-		initQTMComPipes(err_file, out_file);
+		// Initialize mailbox between threads
+		initQTMMailbox(err_file, out_file);
 	}
 	// Prepare identification orders
 	setIdentificationOrders(err_file, out_file, &ctrl_ABLE);
@@ -148,10 +215,10 @@ int main(int argc, char *argv[])
 	fflush(out_file);
 	fflush(err_file);
 
-	// Launch QTM measures thread
-	if (ctrl_ABLE.aOrders.ctrl_type > TORQUE_CTRL && ctrl_ABLE.rtParams.use_QTM)
+	// Launch QTM measures thread (only when the socket and mailbox were initialised, runtime flag use_QTM)
+	if (ctrl_ABLE.aOrders.ctrl_type >= TORQUE_CTRL && ctrl_ABLE.rtParams.use_QTM)
 	{
-		//err = launch_QTM_Measures(&qtm_ComStruct, xs_slider_file);
+		launch_QTM_Measures(&qtm_ComStruct, ableInformations.xs_slider_file);
 	}
 
 	// Wait nominal voltage to protect the system
@@ -161,8 +228,12 @@ int main(int argc, char *argv[])
 	err = executeMotions(&ableInformations);
 	exit_flag = getErrorMessage(err, err_file, out_file);
 
-	// Wait for all threads to end
+	// Wait for all threads to end (the QTM thread leaves its loop on the state published by qtm_EndSession)
 	Sleep(1000);
+	if (all_Threads.qtm_thread != NULL)
+	{
+		WaitForSingleObject(all_Threads.qtm_thread, INFINITE);
+	}
 	CloseHandle(_Post_ _Notnull_ all_Threads.digital_FT_thread_Arm);
 	CloseHandle(_Post_ _Notnull_ all_Threads.digital_FT_thread_Wrist);
 	CloseHandle(_Post_ _Notnull_ all_Threads.qtm_thread);
@@ -179,6 +250,9 @@ int main(int argc, char *argv[])
 	// Release resources used by the critical section object.
 	DeleteCriticalSection(&Critical_share_FT_Wrist);
 
+	// Wait for the end of the export of the measures
+	export_WaitSession(&ableInformations);
+
 	// Flush and close all files
 	clean_Files(&ableInformations);
 
@@ -190,13 +264,16 @@ int main(int argc, char *argv[])
 | extract_InputData - Extract data sent by python script
 |
 | Syntax --
-|	void extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file)
+|	int extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file)
 |
 | Inputs --
 |	int argc -> length of argv
 |	char* argv[] -> name, identification phase, port, char position, duration, friction, id method, human parameters
+|
+| Outputs --
+|	int -> 0 : Success ; -1 : Minimum jerk block not loaded
 ----------------------------------------------------------------------------------------------------------------------*/
-void extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file)
+int extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file)
 {
 	int identification, correction;
 	char* endptr;
@@ -215,11 +292,91 @@ void extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file)
 	ctrl_ABLE.aDynamics.axis4_mod.x_slider = -strtof(argv[3], &endptr);
 	qtm_ComStruct.qualMeas.sliderPos = -strtof(argv[3], &endptr);
 	fprintf(out_file, "Current position of char : %f\n", ctrl_ABLE.aDynamics.axis4_mod.x_slider);
+	slider_Init(&ctrl_ABLE.sliderEst, ctrl_ABLE.aDynamics.axis4_mod.x_slider);
+
+	// Set rate of the control loop (optional, default 1 kHz), every duration below is converted with its period
+	ctrl_ABLE.rtParams.ctrl_rate = CTRL_DEFAULT_RATE;
+	if (argc > 22)
+	{
+		ctrl_ABLE.rtParams.ctrl_rate = strtof(argv[22], &endptr);
+	}
+	if (ctrl_ABLE.rtParams.ctrl_rate < CTRL_MIN_RATE || ctrl_ABLE.rtParams.ctrl_rate > CTRL_MAX_RATE)
+	{
+		fprintf(err_file, "Control rate %f Hz out of [%.0f, %.0f] Hz, default rate used !\n",
+			    ctrl_ABLE.rtParams.ctrl_rate, CTRL_MIN_RATE, CTRL_MAX_RATE);
+		ctrl_ABLE.rtParams.ctrl_rate = CTRL_DEFAULT_RATE;
+	}
+	ctrl_ABLE.rtParams.sampling_frequency = 1.0f / ctrl_ABLE.rtParams.ctrl_rate;
+	fprintf(out_file, "Control rate : %.0f Hz\n", ctrl_ABLE.rtParams.ctrl_rate);
+
+	// Set placement of the real time threads (optional, default scheduling of Windows unless requested)
+	ctrl_ABLE.rtParams.placement_level = PLACEMENT_DEFAULT_LEVEL;
+	if (argc > 23)
+	{
+		ctrl_ABLE.rtParams.placement_level = strtol(argv[23], &endptr, 10);
+	}
+	if (ctrl_ABLE.rtParams.placement_level < PLACEMENT_NONE || ctrl_ABLE.rtParams.placement_level > PLACEMENT_FULL)
+	{
+		fprintf(err_file, "Thread placement %i unknown, default placement used !\n", ctrl_ABLE.rtParams.placement_level);
+		ctrl_ABLE.rtParams.placement_level = PLACEMENT_DEFAULT_LEVEL;
+	}
+
+	// Set allocation tracking of the control loop (optional, debug and benchmark sessions)
+	ctrl_ABLE.rtParams.track_allocs = 0;
+	if (argc > 24)
+	{
+		ctrl_ABLE.rtParams.track_allocs = strtol(argv[24], &endptr, 10) != 0;
+	}
+
+	// Set capture or replay of the session (optional), and the window replayed repeatedly
+	ctrl_ABLE.rtParams.replay_mode = REPLAY_OFF;
+	if (argc > 25)
+	{
+		ctrl_ABLE.rtParams.replay_mode = strtol(argv[25], &endptr, 10);
+	}
+	if (ctrl_ABLE.rtParams.replay_mode < REPLAY_OFF || ctrl_ABLE.rtParams.replay_mode > REPLAY_PLAY)
+	{
+		fprintf(err_file, "Replay mode %i unknown, session neither captured nor replayed !\n",
+			    ctrl_ABLE.rtParams.replay_mode);
+		ctrl_ABLE.rtParams.replay_mode = REPLAY_OFF;
+	}
+	if (argc > 26 && (sscanf(argv[26], "%i;%i;%i", &replay_window.first, &replay_window.last,
+		                     &replay_window.repeats) != 3 || replay_window.first < 0 || replay_window.repeats < 1))
+	{
+		fprintf(err_file, "Replay window %s invalid, whole session replayed once !\n", argv[26]);
+		replay_window = { 0, -1, 1 };
+	}
+
+	// Set impedance of the Cartesian control (optional), its saturations and the feedback of the wrist FT wrench
+	if (cart_SetSessionImpedance(&ctrl_ABLE.aOrders.cartesian, argc > 27 ? argv[27] : NULL) != 0)
+	{
+		fprintf(err_file, "Cartesian impedance %s invalid, default impedance used !\n", argv[27]);
+	}
+	fprintf(out_file, "Cartesian impedance : %f %f %f %f, saturations %f %f, FT gain %f\n",
+		    ctrl_ABLE.aOrders.cartesian.session_stiffness[0], ctrl_ABLE.aOrders.cartesian.session_damping[0],
+		    ctrl_ABLE.aOrders.cartesian.session_stiffness[1], ctrl_ABLE.aOrders.cartesian.session_damping[1],
+		    ctrl_ABLE.aOrders.cartesian.max_wrench[0], ctrl_ABLE.aOrders.cartesian.max_wrench[1],
+		    ctrl_ABLE.aOrders.cartesian.ft_gain);
+
+	// Set backend of the dynamic model (optional), selected by model_InitBackend once the dynamics are loaded
+	ctrl_ABLE.rtParams.model_backend = DEFAULT_MODEL_BACKEND;
+	if (argc > 28)
+	{
+		ctrl_ABLE.rtParams.model_backend = strtol(argv[28], &endptr, 10);
+	}
+	if (ctrl_ABLE.rtParams.model_backend < MODEL_BACKEND_ANALYTIC || ctrl_ABLE.rtParams.model_backend > MODEL_BACKEND_RNEA)
+	{
+		fprintf(err_file, "Model backend %i unknown, default backend used !\n", ctrl_ABLE.rtParams.model_backend);
+		ctrl_ABLE.rtParams.model_backend = DEFAULT_MODEL_BACKEND;
+	}
 
 	// Set experimentation time given by user
-	ctrl_ABLE.rtParams.limit_iterCom = strtol(argv[4], &endptr, 10) * 1000;
-	FT_Comm_params_Wrist.FT_measures.nb_measures = ctrl_ABLE.rtParams.limit_iterCom * 8;
-	FT_Comm_params_Arm.FT_measures.nb_measures = ctrl_ABLE.rtParams.limit_iterCom * 8;
+	ctrl_ABLE.rtParams.duration_Com = (float)strtol(argv[4], &endptr, 10);
+	ctrl_ABLE.rtParams.limit_iterCom = (int)(ctrl_ABLE.rtParams.duration_Com * ctrl_ABLE.rtParams.ctrl_rate + 0.5f);
+	FT_Comm_params_Wrist.FT_measures.nb_measures = (int)(ctrl_ABLE.rtParams.duration_Com / FT_SAMPLE_PERIOD + 0.5);
+	FT_Comm_params_Arm.FT_measures.nb_measures = FT_Comm_params_Wrist.FT_measures.nb_measures;
+	FT_Comm_params_Wrist.ctrl_rate = ctrl_ABLE.rtParams.ctrl_rate;
+	FT_Comm_params_Arm.ctrl_rate = ctrl_ABLE.rtParams.ctrl_rate;
 	fprintf(out_file, "Requested number of iterations : %i\n", ctrl_ABLE.rtParams.limit_iterCom);
 
 	// Extract compensation of friction presence
@@ -244,8 +401,7 @@ void extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file)
 	if (ctrl_ABLE.aOrders.antiG_value != 0 && identification == TORQUE_CTRL)
 	{
 		file_name = argv[9];
-		fopen_s(&ctrl_ABLE.hDynId.idDyn_File, file_name, "rt");
-		retrieve_IdentifiedDyn(&ctrl_ABLE);
+		retrieve_IdentifiedDyn(err_file, out_file, &ctrl_ABLE, file_name);
 		// Extract antigravity correction
 		correction = strtol(argv[10], &endptr, 10);
 		if (correction == 0)
@@ -277,28 +433,26 @@ void extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file)
 	// Extract the name of the file containing the FT sensor bias
 	if (FT_Comm_params_Wrist.general_params_FT.bias_identified && FT_Comm_params_Arm.general_params_FT.bias_identified)
 	{
-		file_name = argv[12];
-		fopen_s(&FT_Comm_params_Arm.bias_vector_file, file_name, "rt");
-		file_name = argv[13];
-		fopen_s(&FT_Comm_params_Wrist.bias_vector_file, file_name, "rt");
+		FT_Comm_params_Arm.bias_vector_name = argv[12];
+		FT_Comm_params_Wrist.bias_vector_name = argv[13];
 	}
 
 	// Extract the name of the file containing pre-computed minimum jerk trajectories and regulation value
 	if (identification == MINJERK_TRAJS)
 	{
-		// Extract trajectories
+		// Extract fatigue test value
+		ctrl_ABLE.rtParams.jerkBlockWithFatigueTest = strtol(argv[17], &endptr, 10);
+		// Extract this block is a familiarisation block (sets the repetitions of legacy files)
+		ctrl_ABLE.rtParams.jerkFamiliarisation = strtol(argv[18], &endptr, 10);
+		// Extract trajectories (block descriptor of this session type, built from the legacy file the first time)
 		file_name = argv[14];
-		ctrl_ABLE.minJerk.minjerk_file.open(file_name);
-		fprintf(out_file, "Minimimum jerk trajectories file successfully opened !\n");
-		extractJerkPositions(err_file, &ctrl_ABLE);
-		fprintf(out_file, "Minimimum jerk trajectories extracted and duplicated \n");
+		if (extractJerkPositions(err_file, out_file, &ctrl_ABLE, file_name) != 0)
+		{
+			return -1;
+		}
 		// Extract regulation forces
 		ctrl_ABLE.aOrders.max_resistanceIFPos_biceps = strtof(argv[15],&endptr);
 		ctrl_ABLE.aOrders.max_resistanceIFPos_triceps = -strtof(argv[16], &endptr);
-		// Extract fatigue test value
-		ctrl_ABLE.rtParams.jerkBlockWithFatigueTest = strtol(argv[17], &endptr, 10);
-		// Extract this block is a familiarisation block
-		ctrl_ABLE.rtParams.jerkFamiliarisation = strtol(argv[18], &endptr, 10);
 	}
 
 	// Extract boolean for use of digital FT in Control thread
@@ -323,6 +477,7 @@ void extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file)
 	// Extract boolean for use of digital FT in Control thread
 	ctrl_ABLE.rtParams.use_fx_lockedSlider = strtol(argv[21], &endptr, 10);
 	fprintf(out_file, "Use Fx Wrist on slider locked and 2DDL : %i\n", ctrl_ABLE.rtParams.use_fx_lockedSlider);
+	return 0;
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
@@ -333,32 +488,36 @@ void extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file)
 ----------------------------------------------------------------------------------------------------------------------*/
 void preallocate_memory()
 {
-	ctrl_ABLE.aMeasures.able_xs_slider.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_currents_1.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_currents_2.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_currents_3.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_currents_4.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_artpos_1.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_artpos_2.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_artpos_3.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_artpos_4.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_speeds_1.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_speeds_2.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_speeds_3.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.able_speeds_4.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.execution_times.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.fx_FTA_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.fy_FTA_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.fz_FTA_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.tx_FTA_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.ty_FTA_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.tz_FTA_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.fx_FTW_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.fy_FTW_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.fz_FTW_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.tx_FTW_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.ty_FTW_sensor.reserve(SIZE_VECS);
-	ctrl_ABLE.aMeasures.tz_FTW_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_xs_slider.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_currents_1.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_currents_2.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_currents_3.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_currents_4.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_artpos_1.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_artpos_2.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_artpos_3.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_artpos_4.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_speeds_1.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_speeds_2.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_speeds_3.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_speeds_4.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->execution_times.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->cycle_ticks.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->able_ticks.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->ftA_ticks.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->ftW_ticks.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->fx_FTA_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->fy_FTA_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->fz_FTA_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->tx_FTA_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->ty_FTA_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->tz_FTA_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->fx_FTW_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->fy_FTW_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->fz_FTW_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->tx_FTW_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->ty_FTW_sensor.reserve(SIZE_VECS);
+	ctrl_ABLE.aMeasures->tz_FTW_sensor.reserve(SIZE_VECS);
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
@@ -377,6 +536,10 @@ void initialise_FT_Shared()
 	FT_measures_Interlocked_Arm.ty = 0.0f;
 	FT_measures_Interlocked_Arm.tz = 0.0f;
 	FT_measures_Interlocked_Arm.streaming = FALSE;
+	memset(FT_measures_Interlocked_Arm.filtered, 0, sizeof(FT_measures_Interlocked_Arm.filtered));
+	memset(FT_measures_Interlocked_Arm.derivative, 0, sizeof(FT_measures_Interlocked_Arm.derivative));
+	memset(FT_measures_Interlocked_Arm.integral, 0, sizeof(FT_measures_Interlocked_Arm.integral));
+	FT_measures_Interlocked_Arm.group_delay = 0.0f;
 	// Initialise wrist interlocked struct
 	FT_measures_Interlocked_Wrist.fx = 0.0f;
 	FT_measures_Interlocked_Wrist.fy = 0.0f;
@@ -385,6 +548,10 @@ void initialise_FT_Shared()
 	FT_measures_Interlocked_Wrist.ty = 0.0f;
 	FT_measures_Interlocked_Wrist.tz = 0.0f;
 	FT_measures_Interlocked_Wrist.streaming = FALSE;
+	memset(FT_measures_Interlocked_Wrist.filtered, 0, sizeof(FT_measures_Interlocked_Wrist.filtered));
+	memset(FT_measures_Interlocked_Wrist.derivative, 0, sizeof(FT_measures_Interlocked_Wrist.derivative));
+	memset(FT_measures_Interlocked_Wrist.integral, 0, sizeof(FT_measures_Interlocked_Wrist.integral));
+	FT_measures_Interlocked_Wrist.group_delay = 0.0f;
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
@@ -409,6 +576,7 @@ void prefill_FT_Comm_Structs()
 	FT_Comm_params_Arm.err_file_FT = err_file_FT_Arm;
 	FT_Comm_params_Arm.FT_measures_Shared = &FT_measures_Interlocked_Arm;
 	FT_Comm_params_Arm.pCritical_share_FT = &Critical_share_FT_Arm;
+	FT_Comm_params_Arm.placement_role = PLACEMENT_ROLE_FT_ARM;
 	FT_Comm_params_Arm.general_params_FT.struct_FT_Arm = TRUE;
 	FT_Comm_params_Arm.general_params_FT.struct_FT_Wrist = FALSE;
 
@@ -426,8 +594,36 @@ void prefill_FT_Comm_Structs()
 	FT_Comm_params_Wrist.err_file_FT = err_file_FT_Wrist;
 	FT_Comm_params_Wrist.FT_measures_Shared = &FT_measures_Interlocked_Wrist;
 	FT_Comm_params_Wrist.pCritical_share_FT = &Critical_share_FT_Wrist;
+	FT_Comm_params_Wrist.placement_role = PLACEMENT_ROLE_FT_WRIST;
 	FT_Comm_params_Wrist.general_params_FT.struct_FT_Arm = FALSE;
 	FT_Comm_params_Wrist.general_params_FT.struct_FT_Wrist = TRUE;
+
+	// Reserve the gauges stored during the bias identification in the session storage
+	reserve_FT_Storage(&FT_Comm_params_Arm.FT_measures);
+	reserve_FT_Storage(&FT_Comm_params_Wrist.FT_measures);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| reserve_FT_Storage - Reserve the vectors filled by a FT measures thread
+|
+| Syntax --
+|	void reserve_FT_Storage(All_FT_measures* FT_measures)
+|
+| Inputs --
+|	All_FT_measures* FT_measures -> measures of one FT sensor
+|
+| Remarks --
+|	Only the gauges and their ticks are stored (bias identification), the computed forces are not kept by the thread.
+----------------------------------------------------------------------------------------------------------------------*/
+void reserve_FT_Storage(All_FT_measures* FT_measures)
+{
+	FT_measures->g0_values.reserve(BIAS_ID_N_SAMPLES);
+	FT_measures->g1_values.reserve(BIAS_ID_N_SAMPLES);
+	FT_measures->g2_values.reserve(BIAS_ID_N_SAMPLES);
+	FT_measures->g3_values.reserve(BIAS_ID_N_SAMPLES);
+	FT_measures->g4_values.reserve(BIAS_ID_N_SAMPLES);
+	FT_measures->g5_values.reserve(BIAS_ID_N_SAMPLES);
+	FT_measures->ticks.reserve(BIAS_ID_N_SAMPLES);
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
@@ -491,6 +687,7 @@ void prefill_ABLE_Thread_Comm_Struct(ThreadInformations* ableInformations, FILE*
 	ableInformations->ft_Wrist_sensor_file = ft_Wrist_sensor_file;
 	ableInformations->times_file = times_file;
 	ableInformations->times = times_CommLoop;
+	ableInformations->export_measures = false;
 
 	// Initialise FT sensors gains
 	if (ableInformations->ctrl_ABLE->rtParams.use_FT && ableInformations->ctrl_ABLE->aOrders.antiG_value == 0)
@@ -510,37 +707,22 @@ void prefill_ABLE_Thread_Comm_Struct(ThreadInformations* ableInformations, FILE*
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
-| initQTMComPipes - Initialize Pipes to communicate between threads (QTM -- CTRL)
+| initQTMMailbox - Initialize the mailbox to communicate between threads (QTM -- CTRL)
 |
 | Syntax --
-|	int initQTMComPipes(FILE* err_file, FILE* out_file)
+|	void initQTMMailbox(FILE* err_file, FILE* out_file)
 |
 | Inputs --
 |	FILE* err_file -> pointer towards "errors.txt" (stderr)
 |	FILE* out_file -> pointer towards "outputs.txt" (stdout)
 ----------------------------------------------------------------------------------------------------------------------*/
-void initQTMComPipes(FILE* err_file, FILE* out_file)
+void initQTMMailbox(FILE* err_file, FILE* out_file)
 {
-	// Initialize pipe between Control (write) and QTM Measures (read)
-	bool returnPipe1 = CreatePipe(&qtm_ComStruct.comPipeStruct.readPipeCtrl, &ctrl_ABLE.pipeHandlesQTM.writePipeCtrl,
-		                          NULL, PIPE_BUFFER_LENGTH);
-	if (!returnPipe1)
-	{
-		fprintf(err_file, "Pipe between Control (write) and QTM Measures (read) could not be openned.\n");
-	} else {
-		fprintf(out_file, "Pipe between Control (write) and QTM Measures (read) is openned.\n");
-	}
-
-	// Initialize pipe between Control (read) and QTM Measures (write)
-	bool returnPipe2 = CreatePipe(&ctrl_ABLE.pipeHandlesQTM.readPipeMeas, &qtm_ComStruct.comPipeStruct.writePipeMeas,
-		                          NULL, PIPE_BUFFER_LENGTH);
-	if (!returnPipe2)
-	{
-		fprintf(err_file, "Pipe between Control (read) and QTM Measures (write) could not be openned.\n");
-	}
-	else {
-		fprintf(out_file, "Pipe between Control (read) and QTM Measures (write) is openned.\n");
-	}
+	// Empty the mailbox and give it to both threads
+	mailbox_Init(&qtm_Mailbox);
+	ctrl_ABLE.qtmLink.mailbox = &qtm_Mailbox;
+	qtm_ComStruct.comMailbox.mailbox = &qtm_Mailbox;
+	fprintf(out_file, "Mailbox between Control and QTM Measures initialised.\n");
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
@@ -750,6 +932,48 @@ int launch_QTM_Measures(ComStruct* qtm_ComStruct, FILE* xs_slider2)
 	return 0;
 }
 
+/*---------------------------------------------------------------------------------------------------------------------
+| prepareMotions - Set the orders, timers and controllers states before the motion thread
+|
+| Syntax --
+|	void prepareMotions(ThreadInformations* ableInfos)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> Struct containing all command informations
+----------------------------------------------------------------------------------------------------------------------*/
+void prepareMotions(ThreadInformations* ableInfos)
+{
+	// Compute parameters for initialization move
+	initializationOrdersComputation(ableInfos->err_file, ableInfos->out_file, &ctrl_ABLE);
+	fflush(ableInfos->out_file);
+
+	// Set check orders number of iterations from the control period (set in extract_InputData)
+	ableInfos->ctrl_ABLE->rtParams.cycle_dt = ableInfos->ctrl_ABLE->rtParams.sampling_frequency;
+	ableInfos->ctrl_ABLE->rtParams.elapsed_time = 0.0;
+	ableInfos->ctrl_ABLE->rtParams.state_tick = 0;
+	align_InitLink(&ableInfos->ctrl_ABLE->timing.drive);
+	align_InitLink(&ableInfos->ctrl_ABLE->timing.ft_arm);
+	align_InitLink(&ableInfos->ctrl_ABLE->timing.ft_wrist);
+	align_InitLink(&ableInfos->ctrl_ABLE->timing.qtm);
+	if (ableInfos->ctrl_ABLE->aOrders.ctrl_type == STATIC_IDENT)
+	{
+		ableInfos->ctrl_ABLE->rtParams.able_CheckTargetReachedNbIt =
+			(int)(CHECK_TARGET_TIME_STATIC * ableInfos->ctrl_ABLE->rtParams.ctrl_rate + 0.5f);
+	} else if (ableInfos->ctrl_ABLE->aOrders.ctrl_type == HDYN_IDENT)
+	{
+		ableInfos->ctrl_ABLE->rtParams.able_CheckTargetReachedNbIt =
+			(int)(CHECK_TARGET_TIME_HDYN * ableInfos->ctrl_ABLE->rtParams.ctrl_rate + 0.5f);
+	} else
+	{
+		ableInfos->ctrl_ABLE->rtParams.able_CheckTargetReachedNbIt =
+			(int)(CHECK_TARGET_TIME * ableInfos->ctrl_ABLE->rtParams.ctrl_rate + 0.5f);
+	}
+	// Constant configuration of the axes read by the controllers
+	state_BuildConfig(ableInfos->ctrl_ABLE);
+	// Controllers start from their initial state
+	ctrlstate_Reset(&ableInfos->ctrl_ABLE->ctrlStates);
+}
+
 /*---------------------------------------------------------------------------------------------------------------------
 | executeMotions - Function launching the motion thread
 |
@@ -767,26 +991,23 @@ int executeMotions(ThreadInformations* ableInfos)
 	// Variables declaration
 	int execution_status;
 
-	// Compute parameters for initialization move
-	initializationOrdersComputation(ableInfos->err_file, ableInfos->out_file, &ctrl_ABLE);
-	fflush(ableInfos->out_file);
-
-	// Set check orders number of iterations and sampling frequency
-	ableInfos->ctrl_ABLE->rtParams.sampling_frequency = 0.001f;
-	if (ableInfos->ctrl_ABLE->aOrders.ctrl_type == STATIC_IDENT)
-	{
-		ableInfos->ctrl_ABLE->rtParams.able_CheckTargetReachedNbIt = 2500;
-	} else if (ableInfos->ctrl_ABLE->aOrders.ctrl_type == HDYN_IDENT)
+	prepareMotions(ableInfos);
+	// Create the shared memory ring in which the control thread publishes its state
+	telemetry_Open(ableInfos->err_file, ableInfos->out_file, ableInfos->ctrl_ABLE->rtParams.sampling_frequency);
+	// Capture the inputs and orders of the session to replay it
+	if (ableInfos->ctrl_ABLE->rtParams.replay_mode == REPLAY_CAPTURE)
 	{
-		ableInfos->ctrl_ABLE->rtParams.able_CheckTargetReachedNbIt = 5000;
-	} else
+		replay_OpenCapture(ableInfos->err_file, ableInfos->out_file, ableInfos->ctrl_ABLE);
+	}
+	// Record the allocations made during the cycles of the control thread
+	if (ableInfos->ctrl_ABLE->rtParams.track_allocs)
 	{
-		ableInfos->ctrl_ABLE->rtParams.able_CheckTargetReachedNbIt = 500;
+		alloc_Enable(1);
 	}
 	// Initialize thread for orders execution
 	DWORD ableCommandThread, threadReturnValue;        // Create identifier for the tread and exit value
-	// SetThreadPriority(hThread_ableCommand, THREAD_PRIORITY_HIGHEST); // Not critical now
 
+	// The thread sets its own priority, core and stack when it starts (placement_ApplyThread)
 	all_Threads.control_thread = CreateThread(NULL,                         // Security attributes (default if NULL)
 											  0,                            // Stack SIZE default if 0
 											  &able_UpdateRealTimeProcess,  // Start address (function to be executed)
@@ -802,11 +1023,91 @@ int executeMotions(ThreadInformations* ableInfos)
 
 	// Destroy thread object
 	CloseHandle(_Post_ _Notnull_ all_Threads.control_thread);
+	// Stop the QTM measures thread (nothing done if QTM is not used)
+	qtm_EndSession(ableInfos->ctrl_ABLE, ableInfos->ctrl_ABLE->rtParams.iter_counter);
+	telemetry_Close();
+	if (ableInfos->ctrl_ABLE->rtParams.replay_mode == REPLAY_CAPTURE)
+	{
+		replay_CloseCapture(ableInfos->err_file, ableInfos->out_file, REPLAY_CAPTURE_FILE);
+	}
+
+	// Export of the measures in the identification files (same cases as recordValuesInFile) and archive of the
+	// measures whatever the control type, off the control thread
+	export_StartSession(ableInfos);
+	recordMeasuresInArchive(ableInfos->err_file, ableInfos->out_file, ableInfos->ctrl_ABLE->aMeasures,
+		                    ableInfos->ctrl_ABLE->rtParams.sampling_frequency);
+
+	// Report the latency and drift of the streams measured during the motion
+	align_PrintLink(ableInfos->out_file, "Drive", &ableInfos->ctrl_ABLE->timing.drive);
+	align_PrintLink(ableInfos->out_file, "FT arm", &ableInfos->ctrl_ABLE->timing.ft_arm);
+	align_PrintLink(ableInfos->out_file, "FT wrist", &ableInfos->ctrl_ABLE->timing.ft_wrist);
+	align_PrintLink(ableInfos->out_file, "QTM", &ableInfos->ctrl_ABLE->timing.qtm);
+	placement_PrintReport(ableInfos->out_file);
+	export_ReportTiming(ableInfos->out_file, ableInfos->ctrl_ABLE->aMeasures,
+		                ableInfos->ctrl_ABLE->rtParams.sampling_frequency);
+	storage_PrintReport(ableInfos->out_file);
+	storage_PrintFaults(ableInfos->out_file, &ableInfos->ctrl_ABLE->timing.faults);
+	if (ableInfos->ctrl_ABLE->rtParams.track_allocs)
+	{
+		alloc_Enable(0);
+		alloc_PrintReport(ableInfos->out_file);
+	}
+	if (ableInfos->ctrl_ABLE->aOrders.ctrl_type == HAPTIC_CTRL)
+	{
+		scene_PrintStats(ableInfos->out_file, ableInfos->ctrl_ABLE->scene);
+	}
 
 	// Return value associated with thread exit status for error message description
 	return execution_status;
 }
 
+/*---------------------------------------------------------------------------------------------------------------------
+| replaySession - Replay the captured session through the orders computation instead of driving ABLE
+|
+| Syntax --
+|	int replaySession(FILE* err_file, FILE* out_file)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|
+| Outputs --
+|	int -> 0 : Same orders as the captured session ; 1 : Different orders ; -1 : Capture not replayed
+|
+| Remarks --
+|	The input data must be those of the captured session. The session files are written again by the replay, it must
+|	be run in a copy of the session folder.
+----------------------------------------------------------------------------------------------------------------------*/
+int replaySession(FILE* err_file, FILE* out_file)
+{
+	// Variables declaration
+	replay_Capture capture;
+	ThreadInformations ableInformations;
+	int err;
+
+	// Parameters received from ABLE before the captured session
+	if (replay_Load(err_file, REPLAY_CAPTURE_FILE, &capture) != 0 ||
+		replay_ApplyHeader(err_file, &capture.header, &ctrl_ABLE) != 0)
+	{
+		fprintf(err_file, "Captured session rejected, replay cancelled\n");
+		fflush(err_file);
+		fflush(out_file);
+		return -1;
+	}
+
+	// Same preparation as the captured session
+	setIdentificationOrders(err_file, out_file, &ctrl_ABLE);
+	targetsComputationGeomID_1DoF(&ctrl_ABLE);
+	prefill_ABLE_Thread_Comm_Struct(&ableInformations, out_file, err_file);
+	prepareMotions(&ableInformations);
+
+	err = replay_Run(&ableInformations, &capture, &replay_window);
+	export_StartSession(&ableInformations);
+	export_WaitSession(&ableInformations);
+	clean_Files(&ableInformations);
+	return err;
+}
+
 /*---------------------------------------------------------------------------------------------------------------------
 | getErrorMessage - Print error message into required files
 |
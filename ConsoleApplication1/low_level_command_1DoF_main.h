@@ -32,8 +32,13 @@
 #include "handle_communication.h"			// Header of the code containing the functions to communicate with ABLE
 #include "get_qtm_measures.h"				// Header of the file containing the thread communicating with python
 #include "get_FT_measures_WinAPI.h"			// Header of the file communicating with the FT sensor
+#include "data_export.h"					// Header of the parallel export of the measures
+#include "able_Benchmarks.h"				// Header of the offline benchmarks of the control computations
+#include "batch_simulation.h"				// Header of the batch of simulated sessions
+#include "session_replay.h"				// Header of the capture and replay of the sessions
 
 struct ComStruct;
+struct All_FT_measures;
 
 // Thread handles struct
 struct ThreadHandles
@@ -46,18 +51,21 @@ struct ThreadHandles
 
 // Functions declaration
 int main(int argc, char *argv[]);										        // Declaration of the main command function
-void extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file); // Extract input data from python script
+int extract_InputData(int argc, char* argv[], FILE* out_file, FILE* err_file); // Extract input data from python script
 void preallocate_memory();														// Pre allocate vectors memory
 void initialise_FT_Shared();													// Initialise shared structs
 void prefill_FT_Comm_Structs();													// Pre-fill structs with their respective data
+void reserve_FT_Storage(All_FT_measures* FT_measures);							// Reserve the vectors of a FT thread
 void prefill_ABLE_Thread_Comm_Struct(ThreadInformations* ableInformations, FILE* out_file, FILE* err_file);
-void initQTMComPipes(FILE* err_file, FILE* out_file);							// Init QTM communication pipes
+void initQTMMailbox(FILE* err_file, FILE* out_file);							// Init QTM communication mailbox
 int initComPython(FILE* err_file, FILE* out_file);                              // Function initializing the communication
 void waitNomVoltage(FILE* err_file, FILE* out_file);					        // Wait nominal voltage to protect ABLE
 int launch_FT_Measures_Arm();													// Function launching the FT measures at arm Thread
 int launch_FT_Measures_Wrist();													// Function launching the FT measures at wrist Thread
 int launch_QTM_Measures(ComStruct* qtm_ComStruct, FILE* xs_slider_file2);		// Function launching the QTM measures Thread
+void prepareMotions(ThreadInformations* ableInfos);						        // Set the orders and states before the motion
 int executeMotions(ThreadInformations* ableInfos);						        // Function executing the Thread of command
+int replaySession(FILE* err_file, FILE* out_file);						        // Replay the captured session
 int getErrorMessage(int err, FILE* err_file, FILE* out_file);			        // Get error message associated with Thread exit
 void clean_Files(ThreadInformations* ableInfos);                                // Clean all files used during command
 #endif // !LOW_LEVEL_COMMAND_1DOF_MAIN_H
\ No newline at end of file
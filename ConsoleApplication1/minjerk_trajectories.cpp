@@ -0,0 +1,484 @@
+/***********************************************************************************************************************
+* minjerk_trajectories.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Evaluates minimum jerk trajectories from their start, end and duration and loads the block descriptors giving the
+* order and the repetitions of the moves. No sample is stored : each order is computed when it is sent.
+***********************************************************************************************************************/
+
+#include "minjerk_trajectories.h"
+#include "parameter_sidecar.h"
+#include <charconv>
+#include <string>
+#include <string.h>
+
+using namespace std;
+
+static_assert(sizeof(minjerk_blockHeader) == 32, "Block descriptor header must be 32 bytes");
+static_assert(sizeof(minjerk_moveRecord) == 12, "Move record must be 12 bytes");
+static_assert(sizeof(minjerk_segment) == 4, "Block segment must be 4 bytes");
+
+// ------------------------------------------------- LOAD BLOCK FUNCTIONS ----------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| minjerk_LoadBlock - Load a minimum jerk block, either from a binary descriptor or from a legacy trajectories file
+|
+| Syntax --
+|	int minjerk_LoadBlock(FILE* err_file, FILE* out_file, minjerk_trajs* minJerk, const char* file_name,
+|						  int familiarisation)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	minjerk_trajs* minJerk -> struct receiving the moves and the block sequence
+|	const char* file_name -> binary descriptor (MINJERK_BLOCK_MAGIC) or legacy ';'-separated trajectories file
+|	int familiarisation -> legacy files only : repeat each pair of moves NB_REP_FAM times instead of NB_REP
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : File not opened ; 2 : Invalid content
+|
+| Remarks --
+|	A legacy file is only parsed the first time : its descriptor is written next to it with the session type in its
+|	name (file_name + MINJERK_FAM_SUFFIX or MINJERK_BLOCK_SUFFIX + MINJERK_BLOCK_EXTENSION) and is read instead by the
+|	following sessions of the same type. The descriptor keeps the size and last write time of the legacy file, it is
+|	rebuilt when they differ or when its checksum does not match.
+----------------------------------------------------------------------------------------------------------------------*/
+int minjerk_LoadBlock(FILE* err_file, FILE* out_file, minjerk_trajs* minJerk, const char* file_name, int familiarisation)
+{
+	// Initialise variables
+	FILE* block_file = NULL;
+	char magic[4] = { 0 };
+	minjerk_blockHeader header;
+	unsigned long long source_size, source_time;
+	int err;
+	string descriptor_name = string(file_name) + (familiarisation ? MINJERK_FAM_SUFFIX : MINJERK_BLOCK_SUFFIX)
+		                   + MINJERK_BLOCK_EXTENSION;
+
+	// Descriptor previously built from this legacy file for this session type
+	if (fopen_s(&block_file, descriptor_name.c_str(), "rb") == 0 && block_file != NULL)
+	{
+		// The legacy file must not have been modified since the descriptor was written
+		err = 1;
+		if (fread(&header, sizeof(header), 1, block_file) == 1 && sidecar_SourceStamp(file_name, &source_size, &source_time) &&
+			header.source_size == source_size && header.source_time == source_time)
+		{
+			rewind(block_file);
+			err = minjerk_ReadBlock(err_file, block_file, minJerk);
+		}
+		fclose(block_file);
+		block_file = NULL;
+		if (err == 0 && minjerk_ExpandSequence(err_file, minJerk) == 0)
+		{
+			fprintf(out_file, "Minimum jerk block descriptor %s loaded : %i moves, %i segments\n", descriptor_name.c_str(),
+				    minJerk->nb_moves, minJerk->nb_segments);
+			return 0;
+		}
+		fprintf(err_file, "Minimum jerk block descriptor %s rejected, %s parsed again\n", descriptor_name.c_str(), file_name);
+	}
+
+	if (fopen_s(&block_file, file_name, "rb") != 0 || block_file == NULL)
+	{
+		fprintf(err_file, "File containing minimum jerk trajectories not opened !\n");
+		return 1;
+	}
+
+	// Select the reader according to the first bytes of the file
+	if (fread(magic, 1, sizeof(magic), block_file) == sizeof(magic) && memcmp(magic, MINJERK_BLOCK_MAGIC, sizeof(magic)) == 0)
+	{
+		rewind(block_file);
+		err = minjerk_ReadBlock(err_file, block_file, minJerk);
+		fclose(block_file);
+		if (err != 0)
+		{
+			return 2;
+		}
+		fprintf(out_file, "Minimum jerk block descriptor loaded : %i moves, %i segments\n", minJerk->nb_moves, minJerk->nb_segments);
+	}
+	else
+	{
+		rewind(block_file);
+		err = minjerk_ImportLegacy(err_file, block_file, minJerk, familiarisation ? NB_REP_FAM : NB_REP);
+		fclose(block_file);
+		if (err != 0)
+		{
+			return 2;
+		}
+		fprintf(out_file, "Legacy minimum jerk trajectories imported : %i moves\n", minJerk->nb_moves);
+		// Keep the descriptor so that the next sessions of this type do not parse the text file anymore
+		if (minjerk_WriteBlock(err_file, descriptor_name.c_str(), minJerk, file_name) == 0)
+		{
+			fprintf(out_file, "Minimum jerk block descriptor written in %s\n", descriptor_name.c_str());
+		}
+	}
+	return (minjerk_ExpandSequence(err_file, minJerk) == 0) ? 0 : 2;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| minjerk_ReadBlock - Read a binary block descriptor
+|
+| Syntax --
+|	int minjerk_ReadBlock(FILE* err_file, FILE* block_file, minjerk_trajs* minJerk)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* block_file -> binary descriptor opened in "rb" mode and positioned at its beginning
+|	minjerk_trajs* minJerk -> struct receiving the moves and the segments
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Invalid descriptor
+----------------------------------------------------------------------------------------------------------------------*/
+int minjerk_ReadBlock(FILE* err_file, FILE* block_file, minjerk_trajs* minJerk)
+{
+	// Initialise variables
+	minjerk_blockHeader header;
+	minjerk_moveRecord record;
+	vector<unsigned char> payload;
+	size_t records_size;
+
+	if (fread(&header, sizeof(header), 1, block_file) != 1 ||
+		memcmp(header.magic, MINJERK_BLOCK_MAGIC, sizeof(header.magic)) != 0 || header.version != MINJERK_BLOCK_VERSION)
+	{
+		fprintf(err_file, "Minimum jerk block descriptor header invalid or version not supported !\n");
+		return 1;
+	}
+	if (header.nb_moves == 0 || header.nb_moves > MAX_JERK_MOVES || header.nb_segments == 0 ||
+		header.nb_segments > MAX_JERK_SEGMENTS || header.sampling_period <= 0.0f)
+	{
+		fprintf(err_file, "Minimum jerk block descriptor sizes invalid !\n");
+		return 1;
+	}
+
+	// Read the move records and the segments at once and check them against the header
+	records_size = header.nb_moves * sizeof(minjerk_moveRecord);
+	payload.resize(records_size + header.nb_segments * sizeof(minjerk_segment));
+	if (fread(payload.data(), 1, payload.size(), block_file) != payload.size())
+	{
+		fprintf(err_file, "Minimum jerk block descriptor truncated !\n");
+		return 1;
+	}
+	if (sidecar_Checksum(payload.data(), payload.size()) != header.checksum)
+	{
+		fprintf(err_file, "Minimum jerk block descriptor checksum mismatch !\n");
+		return 1;
+	}
+
+	// Moves, and their number of samples
+	minJerk->sampling_period = header.sampling_period;
+	minJerk->nb_moves = header.nb_moves;
+	for (int i(0); i < minJerk->nb_moves; i++)
+	{
+		memcpy(&record, payload.data() + i * sizeof(minjerk_moveRecord), sizeof(record));
+		if (record.duration < 0.0f)
+		{
+			fprintf(err_file, "Minimum jerk block descriptor move %i invalid !\n", i);
+			return 1;
+		}
+		minJerk->moves[i].start = record.start;
+		minJerk->moves[i].end = record.end;
+		minJerk->moves[i].duration = record.duration;
+		minJerk->moves[i].nb_samples = (int)(record.duration / header.sampling_period + 0.5f) + 1;
+	}
+
+	// Segments
+	minJerk->nb_segments = header.nb_segments;
+	memcpy(minJerk->segments, payload.data() + records_size, minJerk->nb_segments * sizeof(minjerk_segment));
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| minjerk_ImportLegacy - Import a legacy file of pre-computed trajectories (one ';'-separated move per line, 1 sample
+|                        per ms). Only the first value, the last value and the number of samples of each line are kept.
+|                        Successive pairs of lines are repeated "repetitions" times, as was done with the duplicated
+|                        vectors.
+|
+| Syntax --
+|	int minjerk_ImportLegacy(FILE* err_file, FILE* legacy_file, minjerk_trajs* minJerk, int repetitions)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* legacy_file -> legacy trajectories file opened in "rb" mode
+|	minjerk_trajs* minJerk -> struct receiving the moves and the segments
+|	int repetitions -> number of repetitions of each pair of moves
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Invalid file
+----------------------------------------------------------------------------------------------------------------------*/
+int minjerk_ImportLegacy(FILE* err_file, FILE* legacy_file, minjerk_trajs* minJerk, int repetitions)
+{
+	// Initialise variables
+	string content;
+	long file_size;
+	float value;
+	int nb_values;
+	const char *line, *line_end, *token, *delimiter, *content_end;
+
+	// Read the whole file at once
+	fseek(legacy_file, 0, SEEK_END);
+	file_size = ftell(legacy_file);
+	rewind(legacy_file);
+	if (file_size <= 0)
+	{
+		fprintf(err_file, "File containing minimum jerk trajectories is empty !\n");
+		return 1;
+	}
+	content.resize(file_size);
+	if (fread(&content[0], 1, file_size, legacy_file) != (size_t)file_size)
+	{
+		fprintf(err_file, "File containing minimum jerk trajectories could not be read !\n");
+		return 1;
+	}
+
+	// Parse each line, keeping only its first value, last value and number of values
+	minJerk->sampling_period = MINJERK_LEGACY_PERIOD;
+	minJerk->nb_moves = 0;
+	content_end = content.data() + content.size();
+	for (line = content.data(); line < content_end; line = line_end + 1)
+	{
+		line_end = (const char*)memchr(line, '\n', content_end - line);
+		if (line_end == NULL)
+		{
+			line_end = content_end;
+		}
+		nb_values = 0;
+		for (token = line; (delimiter = (const char*)memchr(token, ';', line_end - token)) != NULL; token = delimiter + 1)
+		{
+			// from_chars neither skips blanks nor accepts an explicit '+'
+			while (token < delimiter && (*token == ' ' || *token == '\t' || *token == '\r' || *token == '+'))
+			{
+				token++;
+			}
+			if (from_chars(token, delimiter, value).ec != errc())
+			{
+				fprintf(err_file, "Invalid value in minimum jerk move %i !\n", minJerk->nb_moves + 1);
+				return 1;
+			}
+			if (nb_values == 0 && minJerk->nb_moves < MAX_JERK_MOVES)
+			{
+				minJerk->moves[minJerk->nb_moves].start = value;
+			}
+			if (minJerk->nb_moves < MAX_JERK_MOVES)
+			{
+				minJerk->moves[minJerk->nb_moves].end = value;
+			}
+			nb_values++;
+		}
+		// Skip blank lines
+		if (nb_values == 0)
+		{
+			continue;
+		}
+		if (minJerk->nb_moves >= MAX_JERK_MOVES)
+		{
+			fprintf(err_file, "Too many minimum jerk moves in file (maximum %i) !\n", MAX_JERK_MOVES);
+			return 1;
+		}
+		minJerk->moves[minJerk->nb_moves].nb_samples = nb_values;
+		minJerk->moves[minJerk->nb_moves].duration = (float)(nb_values - 1) * MINJERK_LEGACY_PERIOD;
+		minJerk->nb_moves++;
+	}
+	if (minJerk->nb_moves == 0 || minJerk->nb_moves % 2 != 0)
+	{
+		fprintf(err_file, "Minimum jerk moves must be given by pairs (%i moves found) !\n", minJerk->nb_moves);
+		return 1;
+	}
+
+	// One segment per pair of moves
+	minJerk->nb_segments = minJerk->nb_moves / 2;
+	for (int i(0); i < minJerk->nb_segments; i++)
+	{
+		minJerk->segments[i].first_move = (unsigned char)(2 * i);
+		minJerk->segments[i].nb_moves = 2;
+		minJerk->segments[i].repetitions = (unsigned short)repetitions;
+	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| minjerk_WriteBlock - Write the moves and segments of a block into a binary descriptor
+|
+| Syntax --
+|	int minjerk_WriteBlock(FILE* err_file, const char* file_name, minjerk_trajs* minJerk, const char* source_name)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	const char* file_name -> name of the descriptor to write
+|	minjerk_trajs* minJerk -> struct containing the moves and the segments
+|	const char* source_name -> legacy file the block was imported from, stamped in the header (can be NULL)
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : File not opened ; 2 : Write error
+----------------------------------------------------------------------------------------------------------------------*/
+int minjerk_WriteBlock(FILE* err_file, const char* file_name, minjerk_trajs* minJerk, const char* source_name)
+{
+	// Initialise variables
+	FILE* block_file = NULL;
+	minjerk_blockHeader header;
+	minjerk_moveRecord record;
+	size_t records_size = minJerk->nb_moves * sizeof(minjerk_moveRecord);
+	vector<unsigned char> payload(records_size + minJerk->nb_segments * sizeof(minjerk_segment));
+	int err = 0;
+
+	// Move records and segments, in the order of the file
+	for (int i(0); i < minJerk->nb_moves; i++)
+	{
+		record.start = minJerk->moves[i].start;
+		record.end = minJerk->moves[i].end;
+		record.duration = minJerk->moves[i].duration;
+		memcpy(payload.data() + i * sizeof(minjerk_moveRecord), &record, sizeof(record));
+	}
+	memcpy(payload.data() + records_size, minJerk->segments, minJerk->nb_segments * sizeof(minjerk_segment));
+
+	if (fopen_s(&block_file, file_name, "wb") != 0 || block_file == NULL)
+	{
+		fprintf(err_file, "Minimum jerk block descriptor %s not opened !\n", file_name);
+		return 1;
+	}
+
+	// Header
+	memcpy(header.magic, MINJERK_BLOCK_MAGIC, sizeof(header.magic));
+	header.version = MINJERK_BLOCK_VERSION;
+	header.nb_moves = (unsigned char)minJerk->nb_moves;
+	header.nb_segments = (unsigned char)minJerk->nb_segments;
+	header.sampling_period = minJerk->sampling_period;
+	header.checksum = sidecar_Checksum(payload.data(), payload.size());
+	header.source_size = 0;
+	header.source_time = 0;
+	if (source_name != NULL)
+	{
+		sidecar_SourceStamp(source_name, &header.source_size, &header.source_time);
+	}
+	if (fwrite(&header, sizeof(header), 1, block_file) != 1 || fwrite(payload.data(), 1, payload.size(), block_file) != payload.size())
+	{
+		err = 2;
+	}
+	fclose(block_file);
+	if (err != 0)
+	{
+		fprintf(err_file, "Minimum jerk block descriptor %s not written !\n", file_name);
+		// Never leave a truncated descriptor behind
+		remove(file_name);
+	}
+	return err;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| minjerk_ExpandSequence - Expand the segments into the sequence of move indexes executed during the block
+|
+| Syntax --
+|	int minjerk_ExpandSequence(FILE* err_file, minjerk_trajs* minJerk)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	minjerk_trajs* minJerk -> struct containing the moves and the segments
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Invalid segment or sequence too long
+----------------------------------------------------------------------------------------------------------------------*/
+int minjerk_ExpandSequence(FILE* err_file, minjerk_trajs* minJerk)
+{
+	// Initialise variables
+	minjerk_segment* segment;
+
+	minJerk->nb_blockMoves = 0;
+	for (int i(0); i < minJerk->nb_segments; i++)
+	{
+		segment = &minJerk->segments[i];
+		if (segment->nb_moves == 0 || segment->first_move + segment->nb_moves > minJerk->nb_moves)
+		{
+			fprintf(err_file, "Minimum jerk segment %i refers to unknown moves !\n", i);
+			return 1;
+		}
+		for (int j(0); j < segment->repetitions; j++)
+		{
+			for (int k(0); k < segment->nb_moves; k++)
+			{
+				if (minJerk->nb_blockMoves >= MAX_JERK_SEQUENCE)
+				{
+					fprintf(err_file, "Too many minimum jerk moves in block (maximum %i) !\n", MAX_JERK_SEQUENCE);
+					return 1;
+				}
+				minJerk->sequence[minJerk->nb_blockMoves] = (unsigned char)(segment->first_move + k);
+				minJerk->nb_blockMoves++;
+			}
+		}
+	}
+	return 0;
+}
+
+// -------------------------------------------------- EVALUATION FUNCTIONS ---------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| minjerk_BlockMove - Get the move executed at a given position of the block (last move once the block is ended)
+|
+| Syntax --
+|	const minjerk_move* minjerk_BlockMove(minjerk_trajs* minJerk, int block_index)
+|
+| Inputs --
+|	minjerk_trajs* minJerk -> struct containing the moves and the block sequence
+|	int block_index -> position in the block (current_minJerkMove)
+|
+| Outputs --
+|	const minjerk_move* -> move to execute
+----------------------------------------------------------------------------------------------------------------------*/
+const minjerk_move* minjerk_BlockMove(minjerk_trajs* minJerk, int block_index)
+{
+	if (block_index >= minJerk->nb_blockMoves)
+	{
+		block_index = minJerk->nb_blockMoves - 1;
+	}
+	if (block_index < 0)
+	{
+		block_index = 0;
+	}
+	return &minJerk->moves[minJerk->sequence[block_index]];
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| minjerk_Position - Evaluate the quintic minimum jerk profile of a move at a given time
+|                    x(tau) = start + (end - start) * (10 tau^3 - 15 tau^4 + 6 tau^5), tau = time / duration
+|
+| Syntax --
+|	float minjerk_Position(const minjerk_move* move, float time)
+|
+| Inputs --
+|	const minjerk_move* move -> move to evaluate
+|	float time -> time since the move start (s, current_timeMinJerk)
+|
+| Outputs --
+|	float -> position order (rad)
+----------------------------------------------------------------------------------------------------------------------*/
+float minjerk_Position(const minjerk_move* move, float time)
+{
+	// Normalised time, saturated at both ends of the move (independent of the control rate)
+	float tau = (move->duration > 0.0f) ? time / move->duration : 1.0f;
+	if (tau < 0.0f)
+	{
+		tau = 0.0f;
+	}
+	else if (tau > 1.0f)
+	{
+		tau = 1.0f;
+	}
+	return move->start + (move->end - move->start) * tau * tau * tau * (10.0f + tau * (-15.0f + 6.0f * tau));
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| minjerk_BlockEnded - Check if all the moves of the block have been executed
+|
+| Syntax --
+|	bool minjerk_BlockEnded(minjerk_trajs* minJerk, int block_index)
+|
+| Inputs --
+|	minjerk_trajs* minJerk -> struct containing the block sequence
+|	int block_index -> position in the block (current_minJerkMove)
+|
+| Outputs --
+|	bool -> true : Block ended ; false : Moves remaining
+----------------------------------------------------------------------------------------------------------------------*/
+bool minjerk_BlockEnded(minjerk_trajs* minJerk, int block_index)
+{
+	return block_index >= minJerk->nb_blockMoves;
+}
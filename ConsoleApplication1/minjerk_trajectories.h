@@ -0,0 +1,62 @@
+/***********************************************************************************************************************
+* minjerk_trajectories.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the functions evaluating minimum jerk trajectories and loading their block descriptors.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef MINJERK_TRAJECTORIES_H
+#define MINJERK_TRAJECTORIES_H
+
+// General includes
+#include <stdio.h>
+
+// Project includes
+#include "control_struct.h"			// Header containing the full declaration of the control struct
+
+// Block descriptor constants
+#define MINJERK_BLOCK_MAGIC "MJBK"						// Identifier of binary block descriptors
+#define MINJERK_BLOCK_VERSION 2							// Version of the binary block descriptor layout (2 : source stamp)
+#define MINJERK_BLOCK_EXTENSION ".mjb"					// Extension of the descriptor written after a legacy import
+#define MINJERK_BLOCK_SUFFIX ".block"					// Session type of descriptors of normal blocks (NB_REP)
+#define MINJERK_FAM_SUFFIX ".fam"						// Session type of descriptors of familiarisation blocks (NB_REP_FAM)
+#define MINJERK_LEGACY_PERIOD 0.001f					// Sampling period of the legacy pre-computed trajectories (s)
+
+// ------------------------------------------------ BLOCK DESCRIPTOR LAYOUT --------------------------------------------
+// File layout : header, then nb_moves move records, then nb_segments segments (minjerk_segment)
+struct minjerk_blockHeader
+{
+	char magic[4];					// MINJERK_BLOCK_MAGIC
+	unsigned short version;			// MINJERK_BLOCK_VERSION
+	unsigned char nb_moves;			// Number of move records following the header
+	unsigned char nb_segments;		// Number of segments following the move records
+	float sampling_period;			// Control period the durations were expressed for (s)
+	unsigned int checksum;			// CRC-32 of the move records and segments
+	unsigned long long source_size;	// Size of the legacy file the descriptor was built from (bytes, 0 : none)
+	unsigned long long source_time;	// Last write time of the legacy file the descriptor was built from (0 : none)
+};
+
+struct minjerk_moveRecord
+{
+	float start;					// Startpoint of the move (rad)
+	float end;						// Endpoint of the move (rad)
+	float duration;					// Duration of the move (s)
+};
+
+// Load block function definition
+int minjerk_LoadBlock(FILE* err_file, FILE* out_file, minjerk_trajs* minJerk, const char* file_name, int familiarisation);
+int minjerk_ReadBlock(FILE* err_file, FILE* block_file, minjerk_trajs* minJerk);
+int minjerk_ImportLegacy(FILE* err_file, FILE* legacy_file, minjerk_trajs* minJerk, int repetitions);
+int minjerk_WriteBlock(FILE* err_file, const char* file_name, minjerk_trajs* minJerk, const char* source_name);
+int minjerk_ExpandSequence(FILE* err_file, minjerk_trajs* minJerk);
+
+// Evaluation function definition
+const minjerk_move* minjerk_BlockMove(minjerk_trajs* minJerk, int block_index);
+float minjerk_Position(const minjerk_move* move, float time);
+bool minjerk_BlockEnded(minjerk_trajs* minJerk, int block_index);
+#endif // !MINJERK_TRAJECTORIES_H
@@ -0,0 +1,225 @@
+/***********************************************************************************************************************
+* parameter_sidecar.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Writes and loads the binary sidecars of the identified parameters files. A sidecar is only applied if its magic,
+* version, kind, size and CRC-32 match, and if the text file it was written from has not been modified since (size
+* and last write time). Otherwise the caller parses the text file and writes a new sidecar.
+***********************************************************************************************************************/
+
+#include "parameter_sidecar.h"
+#include <string.h>
+
+using namespace std;
+
+static_assert(sizeof(sidecar_header) == 40, "Sidecar header must be 40 bytes");
+
+// Build the name of the sidecar of a text file
+static BOOL sidecar_Name(char* sidecar_name, const char* text_name)
+{
+	size_t length = strlen(text_name);
+	if (length + sizeof(SIDECAR_EXTENSION) > SIDECAR_MAX_NAME)
+	{
+		return FALSE;
+	}
+	memcpy(sidecar_name, text_name, length);
+	memcpy(sidecar_name + length, SIDECAR_EXTENSION, sizeof(SIDECAR_EXTENSION));
+	return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sidecar_SourceStamp - Get the size and last write time of the text file a binary copy is built from
+|
+| Syntax --
+|	BOOL sidecar_SourceStamp(const char* text_name, unsigned long long* size, unsigned long long* time)
+|
+| Inputs --
+|	const char* text_name -> name of the text file
+|	unsigned long long* size -> receives the size of the file (bytes)
+|	unsigned long long* time -> receives the last write time of the file
+|
+| Outputs --
+|	BOOL -> TRUE : Stamp read ; FALSE : File not found
+----------------------------------------------------------------------------------------------------------------------*/
+BOOL sidecar_SourceStamp(const char* text_name, unsigned long long* size, unsigned long long* time)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(text_name, GetFileExInfoStandard, &attributes))
+	{
+		return FALSE;
+	}
+	*size = ((unsigned long long)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	*time = ((unsigned long long)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+		    attributes.ftLastWriteTime.dwLowDateTime;
+	return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sidecar_Load - Map the sidecar of a text file and copy its payload if it is valid and up to date
+|
+| Syntax --
+|	int sidecar_Load(FILE* err_file, const char* text_name, unsigned int kind, void* payload,
+|	                 unsigned int payload_size)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	const char* text_name -> name of the text file (the sidecar is "<text_name>.bin")
+|	unsigned int kind -> kind of parameters expected (SIDECAR_BIAS_ARM, ..., SIDECAR_ROBOT_DYN)
+|	void* payload -> filled with the parameters if the sidecar is valid, untouched otherwise
+|	unsigned int payload_size -> size of the payload expected for this kind (bytes)
+|
+| Outputs --
+|	int -> SIDECAR_OK ; SIDECAR_MISSING ; SIDECAR_STALE ; SIDECAR_INVALID
+----------------------------------------------------------------------------------------------------------------------*/
+int sidecar_Load(FILE* err_file, const char* text_name, unsigned int kind, void* payload, unsigned int payload_size)
+{
+	// Initialise variables
+	char sidecar_name[SIDECAR_MAX_NAME];
+	HANDLE file, mapping = NULL;
+	const unsigned char* base = NULL;
+	const sidecar_header* header;
+	LARGE_INTEGER file_size;
+	unsigned long long source_size, source_time;
+	int status = SIDECAR_INVALID;
+
+	if (!sidecar_Name(sidecar_name, text_name))
+	{
+		return SIDECAR_MISSING;
+	}
+	file = CreateFileA(sidecar_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return SIDECAR_MISSING;
+	}
+
+	// Map the file only if its size is the one expected for this kind
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart == (LONGLONG)(sizeof(sidecar_header) + payload_size))
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL)
+		{
+			base = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		}
+	}
+	if (base != NULL)
+	{
+		header = (const sidecar_header*)base;
+		if (memcmp(header->magic, SIDECAR_MAGIC, sizeof(header->magic)) != 0 || header->version != SIDECAR_VERSION ||
+			header->kind != kind || header->payload_size != payload_size ||
+			header->checksum != sidecar_Checksum(base + sizeof(sidecar_header), payload_size))
+		{
+			status = SIDECAR_INVALID;
+		}
+		else if (sidecar_SourceStamp(text_name, &source_size, &source_time) &&
+			     (source_size != header->source_size || source_time != header->source_time))
+		{
+			status = SIDECAR_STALE;
+		}
+		else
+		{
+			memcpy(payload, base + sizeof(sidecar_header), payload_size);
+			status = SIDECAR_OK;
+		}
+		UnmapViewOfFile(base);
+	}
+	if (mapping != NULL)
+	{
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+
+	if (status == SIDECAR_INVALID)
+	{
+		fprintf(err_file, "Parameters sidecar %s rejected (size, kind, version or checksum mismatch) !\n", sidecar_name);
+	}
+	else if (status == SIDECAR_STALE)
+	{
+		fprintf(err_file, "Parameters sidecar %s older than %s, text file used instead.\n", sidecar_name, text_name);
+	}
+	return status;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sidecar_Write - Write the sidecar of a text file (to call once the text file is written and closed)
+|
+| Syntax --
+|	int sidecar_Write(FILE* err_file, const char* text_name, unsigned int kind, const void* payload,
+|	                  unsigned int payload_size)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	const char* text_name -> name of the text file the parameters were read from or written to
+|	unsigned int kind -> kind of parameters (SIDECAR_BIAS_ARM, ..., SIDECAR_ROBOT_DYN)
+|	const void* payload -> parameters to store
+|	unsigned int payload_size -> size of the payload (bytes)
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : File not opened ; 2 : Writing error
+----------------------------------------------------------------------------------------------------------------------*/
+int sidecar_Write(FILE* err_file, const char* text_name, unsigned int kind, const void* payload,
+	              unsigned int payload_size)
+{
+	// Initialise variables
+	char sidecar_name[SIDECAR_MAX_NAME];
+	sidecar_header header;
+	FILE* file = NULL;
+	int status = 0;
+
+	memset(&header, 0, sizeof(sidecar_header));
+	memcpy(header.magic, SIDECAR_MAGIC, sizeof(header.magic));
+	header.version = SIDECAR_VERSION;
+	header.kind = kind;
+	header.payload_size = payload_size;
+	header.checksum = sidecar_Checksum(payload, payload_size);
+	// Stamp the text file so that a later edition makes the sidecar stale
+	sidecar_SourceStamp(text_name, &header.source_size, &header.source_time);
+
+	if (!sidecar_Name(sidecar_name, text_name) || fopen_s(&file, sidecar_name, "wb") != 0 || file == NULL)
+	{
+		fprintf(err_file, "Parameters sidecar of %s not opened !\n", text_name);
+		return 1;
+	}
+	if (fwrite(&header, sizeof(sidecar_header), 1, file) != 1 || fwrite(payload, payload_size, 1, file) != 1)
+	{
+		fprintf(err_file, "Error writing parameters sidecar %s !\n", sidecar_name);
+		status = 2;
+	}
+	fclose(file);
+	if (status != 0)
+	{
+		// Never leave a truncated sidecar behind
+		remove(sidecar_name);
+	}
+	return status;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| sidecar_Checksum - Compute the CRC-32 (IEEE 802.3) of a buffer
+|
+| Syntax --
+|	unsigned int sidecar_Checksum(const void* data, size_t size)
+|
+| Inputs --
+|	const void* data -> buffer to check
+|	size_t size -> size of the buffer (bytes)
+|
+| Outputs --
+|	unsigned int -> CRC-32 of the buffer
+----------------------------------------------------------------------------------------------------------------------*/
+unsigned int sidecar_Checksum(const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned int crc = 0xFFFFFFFF;
+	for (size_t i(0); i < size; i++)
+	{
+		crc ^= bytes[i];
+		for (int k(0); k < 8; k++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+		}
+	}
+	return ~crc;
+}
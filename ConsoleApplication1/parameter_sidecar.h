@@ -0,0 +1,79 @@
+/***********************************************************************************************************************
+* parameter_sidecar.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the binary sidecars of the identified parameters files (FT biases, human and robot
+* dynamics). The text files remain the import/export format, the sidecar "<text file>.bin" is a checksummed copy of
+* their content that is mapped and applied at launch without any parsing.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef PARAMETER_SIDECAR_H
+#define PARAMETER_SIDECAR_H
+
+// General includes
+#include <stdio.h>
+#include <stdint.h>
+#include <Windows.h>
+
+// Sidecar constants
+#define SIDECAR_MAGIC "ABPS"							// Identifier of parameters sidecars
+#define SIDECAR_VERSION 2								// Version of the sidecar layout (2 : defaults marked)
+#define SIDECAR_EXTENSION ".bin"						// Appended to the name of the text file
+#define SIDECAR_MAX_NAME 260							// Maximum length of a sidecar file name
+
+// Kinds of parameters stored in a sidecar
+#define SIDECAR_BIAS_ARM 1								// Bias vector of the arm FT sensor
+#define SIDECAR_BIAS_WRIST 2							// Bias vector of the wrist FT sensor
+#define SIDECAR_HUMAN_DYN 3								// Identified dynamics of the human forearm
+#define SIDECAR_ROBOT_DYN 4								// Identified dynamics of ABLE
+
+// Human dynamics not identified, built-in values used (bits of sidecar_humanDyn::defaults)
+#define SIDECAR_HUMAN_DEFAULT_DELTA_THETA 0x01			// delta_theta
+#define SIDECAR_HUMAN_DEFAULT_INERTIA 0x02				// farm_FE_inertia
+
+// Values returned by sidecar_Load
+#define SIDECAR_OK 0									// Parameters applied from the sidecar
+#define SIDECAR_MISSING 1								// No sidecar next to the text file
+#define SIDECAR_STALE 2									// Text file modified after the sidecar was written
+#define SIDECAR_INVALID 3								// Bad magic, version, kind, size or checksum
+
+// -------------------------------------------------- SIDECAR FILE LAYOUT ----------------------------------------------
+// File : header | payload (payload_size bytes, layout given by the kind)
+struct sidecar_header
+{
+	char magic[4];							// SIDECAR_MAGIC
+	unsigned int version;					// SIDECAR_VERSION
+	unsigned int kind;						// SIDECAR_BIAS_ARM, SIDECAR_BIAS_WRIST, SIDECAR_HUMAN_DYN or SIDECAR_ROBOT_DYN
+	unsigned int payload_size;				// Size of the payload (bytes)
+	unsigned long long source_size;			// Size of the text file when the sidecar was written (bytes)
+	unsigned long long source_time;			// Last write time of the text file when the sidecar was written
+	unsigned int checksum;					// CRC-32 of the payload
+	unsigned int reserved;					// Kept to 0
+};
+
+// ----------------------------------------------------- PAYLOADS ------------------------------------------------------
+struct sidecar_bias
+{
+	int16_t id_bias[6];						// Identified bias vector of the FT sensor
+};
+
+struct sidecar_humanDyn
+{
+	float mass;								// Mass of the human forearm
+	float delta_theta;						// Angular difference between human and robot forearms
+	float farm_FE_inertia;					// Equivalent inertia at the elbow for movements of flexion/extension
+	unsigned int defaults;					// SIDECAR_HUMAN_DEFAULT_* : values not supplied, built-in ones applied
+};
+
+// Functions declaration
+int sidecar_Load(FILE* err_file, const char* text_name, unsigned int kind, void* payload, unsigned int payload_size);
+int sidecar_Write(FILE* err_file, const char* text_name, unsigned int kind, const void* payload,
+	              unsigned int payload_size);
+unsigned int sidecar_Checksum(const void* data, size_t size);
+BOOL sidecar_SourceStamp(const char* text_name, unsigned long long* size, unsigned long long* time);
+#endif // !PARAMETER_SIDECAR_H
@@ -23,18 +23,18 @@
 void able_PositionAsserv(ThreadInformations* ableInfos)
 {
 	// Variables declaration
-	static float pos_dif, gain_Kp_P_i, gain_Ki_P_i, measured_current;
-	static float integral_sum[NB_MOTORS] = { 0.0f,0.0f,0.0f,0.0f };
-	static int old_counter;
+	float pos_dif, gain_Kp_P_i, gain_Ki_P_i;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
+	position_ctrlState* ctrlState = &ableInfos->ctrl_ABLE->ctrlStates.position;
 
 	// Check if order has changed since previous iteration
-	if (old_counter != rtValues->order_counter && oValues->ctrl_type != MINJERK_TRAJS)
+	if (ctrlState->old_counter != rtValues->order_counter && oValues->ctrl_type != MINJERK_TRAJS)
 	{
 		// Update old counter to the current order
-		old_counter = rtValues->order_counter;
+		ctrlState->old_counter = rtValues->order_counter;
 		fprintf(ableInfos->out_file, "Order counter : %d ; Position order : %f\n", rtValues->order_counter,
 			ableInfos->ctrl_ABLE->aOrders.positionOrder[3]);
 		// Reset the sum for integral correction to avoid uncontrolled behaviour
@@ -42,25 +42,23 @@ void able_PositionAsserv(ThreadInformations* ableInfos)
 		{
 			if (mValues->inhibition_State[i] == 0)
 			{
-				integral_sum[i] = 0.0f;
+				ctrlState->integral_sum[i] = 0.0f;
 			}
 		}
 	}
 	// Asserv position for setting home position
 	for (int i(0); i < NB_MOTORS; i++)
 	{
-		// Extract current data
-		able_ExtractData(ableInfos, i);
 		// Compute diference in coder position
-		pos_dif = oValues->positionOrder[i] - rtValues->currentPosition[i];
+		pos_dif = oValues->positionOrder[i] - state->position[i];
 		// Compute next iteration speed order based on position diference and proportionnal gain
 		// Cast gains into float
 		gain_Kp_P_i = static_cast<float>(ableInfos->ctrl_ABLE->mParams.Kp_P[i]);
 		gain_Ki_P_i = static_cast<float>(ableInfos->ctrl_ABLE->mParams.Ki_P[i]);
 		// Compute sum for integral correction
-		integral_sum[i] += pos_dif * ableInfos->ctrl_ABLE->rtParams.sampling_frequency;
+		ctrlState->integral_sum[i] += pos_dif * ableInfos->ctrl_ABLE->rtParams.cycle_dt;
 		// Store the computed order into the control struct
-		oValues->speedOrder[i] = gain_Kp_P_i * pos_dif + gain_Ki_P_i * integral_sum[i];
+		oValues->speedOrder[i] = gain_Kp_P_i * pos_dif + gain_Ki_P_i * ctrlState->integral_sum[i];
 		// Regulate interaction force for CoT experimentation
 		if (i == NB_MOTORS - 1 && oValues->ctrl_type == MINJERK_TRAJS && rtValues->jerkMove_started)
 		{
@@ -93,32 +91,33 @@ void able_RegulateIFPos(ThreadInformations* ableInfos)
 {
 	// Initialise variables
 	float direction;
-	static float integral_sum, speed_sign_old;
 	// Extract substructs
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
 	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
-	ableMeasures* measValues = &ableInfos->ctrl_ABLE->aMeasures;
+	ableMeasures* measValues = ableInfos->ctrl_ABLE->aMeasures;
 	received_FT_meas* ftValues = &ableInfos->ctrl_ABLE->current_FT_meas_Wrist;
+	position_ctrlState* ctrlState = &ableInfos->ctrl_ABLE->ctrlStates.position;
 	// Re-initialise integral sum if change of direction
-	if (speed_sign_old != rtValues->currentSpeed[3] / abs(rtValues->currentSpeed[3]))
+	if (ctrlState->if_speed_sign != state->speed[3] / abs(state->speed[3]))
 	{
-		speed_sign_old = rtValues->currentSpeed[3] / abs(rtValues->currentSpeed[3]);
-		integral_sum = 0.0f;
+		ctrlState->if_speed_sign = state->speed[3] / abs(state->speed[3]);
+		ctrlState->if_integral_sum = 0.0f;
 	}
 	// Regulate interaction forces
 	direction = rtValues->current_endMinJerk - rtValues->current_startMinJerk;
-	if (rtValues->use_FT && rtValues->currentPosition[3] < oValues->positionOrder[3] - 0.005f && direction < 0)
+	if (rtValues->use_FT && state->position[3] < oValues->positionOrder[3] - 0.005f && direction < 0)
 	{
-		integral_sum += (oValues->max_resistanceIFPos_biceps - ftValues->f_z) * rtValues->sampling_frequency;
+		ctrlState->if_integral_sum += (oValues->max_resistanceIFPos_biceps - ftValues->f_z) * rtValues->cycle_dt;
 		oValues->speedOrder[3] = (oValues->max_resistanceIFPos_biceps - ftValues->f_z) * ftValues->k_fp * 0.13f
-				                + (double)ftValues->k_fi * 12000.0 * (double)integral_sum;
+				                + (double)ftValues->k_fi * 12000.0 * (double)ctrlState->if_integral_sum;
 	}
-	else if (rtValues->use_FT && rtValues->currentPosition[3] > oValues->positionOrder[3] + 0.005f && direction > 0)
+	else if (rtValues->use_FT && state->position[3] > oValues->positionOrder[3] + 0.005f && direction > 0)
 	{
-		integral_sum += (oValues->max_resistanceIFPos_triceps - ftValues->f_z) * rtValues->sampling_frequency;
+		ctrlState->if_integral_sum += (oValues->max_resistanceIFPos_triceps - ftValues->f_z) * rtValues->cycle_dt;
 		oValues->speedOrder[3] = (oValues->max_resistanceIFPos_triceps - ftValues->f_z) * ftValues->k_fp * 0.1f
-			                    + (double)ftValues->k_fi * 8000.0 * (double)integral_sum;
+			                    + (double)ftValues->k_fi * 8000.0 * (double)ctrlState->if_integral_sum;
 	}
 }
 
@@ -126,51 +125,61 @@ void able_RegulateIFPos(ThreadInformations* ableInfos)
 | able_DynIdentAsserv - Updates the contents of the control struct and dynamic identification orders
 |
 | Syntax --
-|	void able_DynIdentAsserv(ThreadInformations* ableInfos, int iter_counter)
+|	void able_DynIdentAsserv(ThreadInformations* ableInfos, float time_order)
 |
 | Inputs --
 |	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
-|   int counter -> index of the order being executed
-|   int iter_counter -> number of the current iteration for dynamic identification orders indexing
+|   float time_order -> time since the start of the dynamic identification (s)
+|
+| Remarks --
+|	The orders table is sampled at DYN_IDENT_PERIOD and interpolated linearly at time_order, so that the trajectory
+|	does not depend on the control rate.
 ----------------------------------------------------------------------------------------------------------------------*/
-void able_DynIdentAsserv(ThreadInformations* ableInfos, int iter_counter)
+void able_DynIdentAsserv(ThreadInformations* ableInfos, float time_order)
 {
 	// Variables declaration
-	static float pos_dif, speed_dif, sampling;
-	static float gain_Kp_P_i, gain_Ki_P_i, gain_Kp_V, gain_Kp_V_r, gain_Ki_V, integral_sum_speed;
-	static float integral_sum[NB_MOTORS];
-	static int old_counter;
+	float pos_dif;
+	float index_f = time_order / DYN_IDENT_PERIOD, alpha, pos_order;
+	int index = (int)index_f;
+	float gain_Kp_P_i, gain_Ki_P_i;
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
 	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
+	dynIdent_ctrlState* ctrlState = &ableInfos->ctrl_ABLE->ctrlStates.dynIdent;
 
 	// Check if order has changed since previous iteration
-	if (old_counter != rtValues->order_counter)
+	if (ctrlState->old_counter != rtValues->order_counter)
 	{
 		// Update old counter to the current order
-		old_counter = rtValues->order_counter;
+		ctrlState->old_counter = rtValues->order_counter;
 		// Reset the sum for integral correction to avoid uncontrolled behaviour
-		integral_sum[3] = 0.0f;
-		integral_sum_speed = 0.0f;
+		ctrlState->integral_sum[3] = 0.0f;
+		ctrlState->integral_sum_speed = 0.0f;
 	}
 	for (int i(0); i < NB_MOTORS; i++)
 	{
-		// Extract current data
-		able_ExtractData(ableInfos, i);
 		// Compute next iteration speed order and store it into the control struct
 		if (mValues->inhibition_State[i] == 0)
 		{
-			if (iter_counter < (int)oValues->dynamicOrdersIdAll[i].size())
+			if (index < (int)oValues->dynamicOrdersIdAll[i].size())
 			{
 				// Cast gains into float
 				gain_Kp_P_i = static_cast<float>(mValues->Kp_P[i]);
 				gain_Ki_P_i = static_cast<float>(mValues->Ki_P[i]);
+				// Interpolate the order between the two surrounding samples of the table
+				pos_order = oValues->dynamicOrdersIdAll[i].at(index);
+				if (index + 1 < (int)oValues->dynamicOrdersIdAll[i].size())
+				{
+					alpha = index_f - (float)index;
+					pos_order += alpha * (oValues->dynamicOrdersIdAll[i].at(index + 1) - pos_order);
+				}
 				// Compute position difference (orders are a sinusod)
-				pos_dif = oValues->dynamicOrdersIdAll[i].at(iter_counter) - rtValues->currentPosition[i];
+				pos_dif = pos_order - state->position[i];
 				// Compute integral sum of error
-				integral_sum[i] += pos_dif * rtValues->sampling_frequency;
+				ctrlState->integral_sum[i] += pos_dif * rtValues->cycle_dt;
 				// Compute order to send
-				oValues->speedOrder[i] = gain_Kp_P_i * pos_dif + gain_Ki_P_i * integral_sum[i];
+				oValues->speedOrder[i] = gain_Kp_P_i * pos_dif + gain_Ki_P_i * ctrlState->integral_sum[i];
 			}
 			else
 			{
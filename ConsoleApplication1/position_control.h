@@ -23,6 +23,6 @@ void able_PositionAsserv(ThreadInformations* ableInfos);
 // Regulation of interaction force during minimum jerk trajectory control
 void able_RegulateIFPos(ThreadInformations* ableInfos);
 // Position control for dynamic identifications
-void able_DynIdentAsserv(ThreadInformations* ableInfos, int iter_counter);
+void able_DynIdentAsserv(ThreadInformations* ableInfos, float time_order);
 
 #endif // !POSITION_CONTROL_H
\ No newline at end of file
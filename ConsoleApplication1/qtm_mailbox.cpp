@@ -0,0 +1,244 @@
+/***********************************************************************************************************************
+* qtm_mailbox.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Exchanges the latest QTM/EMG measures, the latest control state and the EMG events between the QTM measures thread
+* and the control thread. The writer of a value never waits : a reader that is overtaken retries a few times and
+* otherwise keeps its previous value. Every read reports the age of the value it returns.
+***********************************************************************************************************************/
+
+#include "qtm_mailbox.h"
+#include "time_base.h"
+#include <string.h>
+
+using namespace std;
+
+// Write a value protected by a sequence lock (single writer)
+static void mailbox_Store(atomic<unsigned long long>* version, void* value, const void* sample, size_t size)
+{
+	unsigned long long current = version->load(memory_order_relaxed);
+	version->store(current + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	memcpy(value, sample, size);
+	version->store(current + 2, memory_order_release);
+}
+
+// Largest value exchanged through a sequence lock
+#define MAILBOX_MAX_VALUE_SIZE 64
+static_assert(sizeof(qtm_measSample) <= MAILBOX_MAX_VALUE_SIZE, "Measures larger than the copy of mailbox_Load");
+static_assert(sizeof(qtm_ctrlSample) <= MAILBOX_MAX_VALUE_SIZE, "Control state larger than the copy of mailbox_Load");
+
+// Copy a value protected by a sequence lock : the value is copied locally and given to the caller only once the
+// version shows it was not overwritten during the copy
+static int mailbox_Load(atomic<unsigned long long>* version, unsigned long long* last_version, const void* value,
+	                    void* sample, size_t size)
+{
+	alignas(8) unsigned char copy[MAILBOX_MAX_VALUE_SIZE];
+	unsigned long long before, after;
+	for (int i(0); i < MAILBOX_READ_RETRIES; i++)
+	{
+		before = version->load(memory_order_acquire);
+		if (before == 0)
+		{
+			return MAILBOX_EMPTY;
+		}
+		if (before & 1)
+		{
+			continue;
+		}
+		memcpy(copy, value, size);
+		atomic_thread_fence(memory_order_acquire);
+		after = version->load(memory_order_relaxed);
+		if (before == after)
+		{
+			memcpy(sample, copy, size);
+			if (before == *last_version)
+			{
+				return MAILBOX_SAME;
+			}
+			*last_version = before;
+			return MAILBOX_NEW;
+		}
+	}
+	return MAILBOX_BUSY;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| mailbox_Init - Empty the mailbox (before launching the threads)
+|
+| Syntax --
+|	void mailbox_Init(qtm_mailbox* mailbox)
+|
+| Inputs --
+|	qtm_mailbox* mailbox -> mailbox to initialise
+----------------------------------------------------------------------------------------------------------------------*/
+void mailbox_Init(qtm_mailbox* mailbox)
+{
+	memset(&mailbox->meas, 0, sizeof(qtm_measSample));
+	memset(&mailbox->ctrl, 0, sizeof(qtm_ctrlSample));
+	memset(mailbox->events, 0, sizeof(mailbox->events));
+	mailbox->meas_version.store(0, memory_order_relaxed);
+	mailbox->ctrl_version.store(0, memory_order_relaxed);
+	mailbox->events_head.store(0, memory_order_relaxed);
+	mailbox->events_tail.store(0, memory_order_relaxed);
+	mailbox->events_dropped.store(0, memory_order_release);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| mailbox_Now - Time base of the mailbox (common time base, us)
+|
+| Syntax --
+|	long long mailbox_Now()
+|
+| Outputs --
+|	long long -> current time (us)
+----------------------------------------------------------------------------------------------------------------------*/
+long long mailbox_Now()
+{
+	return timebase_Micro(timebase_Now());
+}
+
+// ------------------------------------------------- LATEST VALUES FUNCTIONS -------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| mailbox_PublishMeas - Publish the latest measures (QTM thread only)
+|
+| Syntax --
+|	void mailbox_PublishMeas(qtm_mailbox* mailbox, const qtm_measSample* sample)
+|
+| Inputs --
+|	qtm_mailbox* mailbox -> shared mailbox
+|	const qtm_measSample* sample -> measures to publish (publish_time_us is set here)
+----------------------------------------------------------------------------------------------------------------------*/
+void mailbox_PublishMeas(qtm_mailbox* mailbox, const qtm_measSample* sample)
+{
+	qtm_measSample stamped = *sample;
+	stamped.publish_time_us = mailbox_Now();
+	mailbox_Store(&mailbox->meas_version, &mailbox->meas, &stamped, sizeof(qtm_measSample));
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| mailbox_ReadMeas - Copy the latest measures (control thread only)
+|
+| Syntax --
+|	int mailbox_ReadMeas(qtm_mailbox* mailbox, unsigned long long* last_version, qtm_measSample* sample,
+|	                     long long* age_us)
+|
+| Inputs --
+|	qtm_mailbox* mailbox -> shared mailbox
+|	unsigned long long* last_version -> version returned by the previous read (0 at first), updated
+|	qtm_measSample* sample -> filled with the latest measures if MAILBOX_NEW or MAILBOX_SAME, untouched otherwise
+|	long long* age_us -> filled with the time elapsed since their publication (us)
+|
+| Outputs --
+|	int -> MAILBOX_NEW ; MAILBOX_SAME ; MAILBOX_EMPTY ; MAILBOX_BUSY
+----------------------------------------------------------------------------------------------------------------------*/
+int mailbox_ReadMeas(qtm_mailbox* mailbox, unsigned long long* last_version, qtm_measSample* sample, long long* age_us)
+{
+	int status = mailbox_Load(&mailbox->meas_version, last_version, &mailbox->meas, sample, sizeof(qtm_measSample));
+	if (status <= MAILBOX_SAME)
+	{
+		*age_us = mailbox_Now() - sample->publish_time_us;
+	}
+	return status;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| mailbox_PublishCtrl - Publish the latest control state (control thread only)
+|
+| Syntax --
+|	void mailbox_PublishCtrl(qtm_mailbox* mailbox, const qtm_ctrlSample* sample)
+|
+| Inputs --
+|	qtm_mailbox* mailbox -> shared mailbox
+|	const qtm_ctrlSample* sample -> control state to publish (publish_time_us is set here)
+----------------------------------------------------------------------------------------------------------------------*/
+void mailbox_PublishCtrl(qtm_mailbox* mailbox, const qtm_ctrlSample* sample)
+{
+	qtm_ctrlSample stamped = *sample;
+	stamped.publish_time_us = mailbox_Now();
+	mailbox_Store(&mailbox->ctrl_version, &mailbox->ctrl, &stamped, sizeof(qtm_ctrlSample));
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| mailbox_ReadCtrl - Copy the latest control state (QTM thread only)
+|
+| Syntax --
+|	int mailbox_ReadCtrl(qtm_mailbox* mailbox, unsigned long long* last_version, qtm_ctrlSample* sample,
+|	                     long long* age_us)
+|
+| Inputs --
+|	qtm_mailbox* mailbox -> shared mailbox
+|	unsigned long long* last_version -> version returned by the previous read (0 at first), updated
+|	qtm_ctrlSample* sample -> filled with the latest control state if MAILBOX_NEW or MAILBOX_SAME, untouched otherwise
+|	long long* age_us -> filled with the time elapsed since its publication (us)
+|
+| Outputs --
+|	int -> MAILBOX_NEW ; MAILBOX_SAME ; MAILBOX_EMPTY ; MAILBOX_BUSY
+----------------------------------------------------------------------------------------------------------------------*/
+int mailbox_ReadCtrl(qtm_mailbox* mailbox, unsigned long long* last_version, qtm_ctrlSample* sample, long long* age_us)
+{
+	int status = mailbox_Load(&mailbox->ctrl_version, last_version, &mailbox->ctrl, sample, sizeof(qtm_ctrlSample));
+	if (status <= MAILBOX_SAME)
+	{
+		*age_us = mailbox_Now() - sample->publish_time_us;
+	}
+	return status;
+}
+
+// -------------------------------------------------- EMG EVENTS FUNCTIONS ---------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| mailbox_PushEvent - Queue an EMG event (QTM thread only)
+|
+| Syntax --
+|	BOOL mailbox_PushEvent(qtm_mailbox* mailbox, const emg_event* event)
+|
+| Inputs --
+|	qtm_mailbox* mailbox -> shared mailbox
+|	const emg_event* event -> event to queue
+|
+| Outputs --
+|	BOOL -> TRUE : Event queued ; FALSE : Queue full, event dropped and counted
+----------------------------------------------------------------------------------------------------------------------*/
+BOOL mailbox_PushEvent(qtm_mailbox* mailbox, const emg_event* event)
+{
+	unsigned int head = mailbox->events_head.load(memory_order_relaxed);
+	if (head - mailbox->events_tail.load(memory_order_acquire) >= EMG_EVENTS_CAPACITY)
+	{
+		mailbox->events_dropped.fetch_add(1, memory_order_relaxed);
+		return FALSE;
+	}
+	mailbox->events[head & (EMG_EVENTS_CAPACITY - 1)] = *event;
+	mailbox->events[head & (EMG_EVENTS_CAPACITY - 1)].publish_time_us = mailbox_Now();
+	mailbox->events_head.store(head + 1, memory_order_release);
+	return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| mailbox_PopEvent - Get the oldest pending EMG event (control thread only)
+|
+| Syntax --
+|	BOOL mailbox_PopEvent(qtm_mailbox* mailbox, emg_event* event)
+|
+| Inputs --
+|	qtm_mailbox* mailbox -> shared mailbox
+|	emg_event* event -> filled with the event
+|
+| Outputs --
+|	BOOL -> TRUE : Event returned ; FALSE : No pending event
+----------------------------------------------------------------------------------------------------------------------*/
+BOOL mailbox_PopEvent(qtm_mailbox* mailbox, emg_event* event)
+{
+	unsigned int tail = mailbox->events_tail.load(memory_order_relaxed);
+	if (tail == mailbox->events_head.load(memory_order_acquire))
+	{
+		return FALSE;
+	}
+	*event = mailbox->events[tail & (EMG_EVENTS_CAPACITY - 1)];
+	mailbox->events_tail.store(tail + 1, memory_order_release);
+	return TRUE;
+}
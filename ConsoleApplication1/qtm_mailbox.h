@@ -0,0 +1,94 @@
+/***********************************************************************************************************************
+* qtm_mailbox.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the mailbox between the QTM/EMG measures thread and the control thread : the latest
+* measures and the latest control state are exchanged through sequence locks, and the EMG pings through a bounded
+* single producer / single consumer queue. Nothing is allocated and no system call is made.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef QTM_MAILBOX_H
+#define QTM_MAILBOX_H
+
+// General includes
+#include <atomic>
+#include <Windows.h>
+
+// Mailbox constants
+#define NB_EMG_MUSCLES 4						// Number of muscles monitored
+#define EMG_MUSCLE_BB 0							// Biceps Brachii
+#define EMG_MUSCLE_BR 1							// Brachio Radialis
+#define EMG_MUSCLE_TBLONGH 2					// Triceps Brachii Long Head
+#define EMG_MUSCLE_TBLATH 3						// Triceps Brachii Lateral Head
+#define EMG_EVENTS_CAPACITY 64					// Number of pending EMG events (power of 2)
+#define MAILBOX_READ_RETRIES 8					// Attempts of a reader to get a consistent value
+#define QTM_MAX_STALENESS_US 20000				// Measures older than this are not applied (us)
+
+// Values returned by the mailbox reads
+#define MAILBOX_NEW 0							// Value published since the previous read
+#define MAILBOX_SAME 1							// Same value as the previous read
+#define MAILBOX_EMPTY 2							// Nothing published yet
+#define MAILBOX_BUSY 3							// Overwritten during every attempt, nothing copied
+
+// ------------------------------------------------- MAILBOX VALUES ----------------------------------------------------
+// Measures published by the QTM thread
+struct qtm_measSample
+{
+	float s_pos;								// Current position of the slider
+	int pings[NB_EMG_MUSCLES];					// Activation detected for each muscle (0 : no ; 1 : yes)
+	unsigned int sequence;						// Sequence number of the last frame received
+	unsigned long long timestamp_us;			// Source timestamp of the last frame received (us)
+	long long arrival_tick;						// Reception tick of the last frame received (timebase_Now)
+	long long publish_time_us;					// Publication time (mailbox_Now)
+};
+
+// Control state published by the control thread
+struct qtm_ctrlSample
+{
+	int iter_counter;							// Iteration of the control loop
+	int robot_activated;						// 1 : robot still controlled ; 0 : control ended
+	int mvt_ended;								// 1 : movement ended
+	long long publish_time_us;					// Publication time (mailbox_Now)
+};
+
+// Activation of a muscle detected by the QTM thread
+struct emg_event
+{
+	int muscle;									// EMG_MUSCLE_BB, ..., EMG_MUSCLE_TBLATH
+	unsigned int sequence;						// Sequence number of the frame of the detection
+	unsigned long long timestamp_us;			// Source timestamp of the detection (us)
+	long long detection_delay_us;				// Time between the first sample above threshold and the detection (us)
+	long long publish_time_us;					// Time the event was queued (mailbox_Now)
+};
+
+// --------------------------------------------------- MAILBOX STRUCT --------------------------------------------------
+// Versions are odd while the value is written. Each group is on its own cache line.
+struct qtm_mailbox
+{
+	alignas(64) std::atomic<unsigned long long> meas_version;	// Version of the measures
+	qtm_measSample meas;										// Latest measures
+	alignas(64) std::atomic<unsigned long long> ctrl_version;	// Version of the control state
+	qtm_ctrlSample ctrl;										// Latest control state
+	alignas(64) std::atomic<unsigned int> events_head;			// Number of events pushed
+	alignas(64) std::atomic<unsigned int> events_tail;			// Number of events popped
+	emg_event events[EMG_EVENTS_CAPACITY];						// Pending events
+	std::atomic<unsigned int> events_dropped;					// Events lost because the queue was full
+};
+
+// Functions declaration
+void mailbox_Init(qtm_mailbox* mailbox);
+long long mailbox_Now();
+// Latest values
+void mailbox_PublishMeas(qtm_mailbox* mailbox, const qtm_measSample* sample);
+int mailbox_ReadMeas(qtm_mailbox* mailbox, unsigned long long* last_version, qtm_measSample* sample, long long* age_us);
+void mailbox_PublishCtrl(qtm_mailbox* mailbox, const qtm_ctrlSample* sample);
+int mailbox_ReadCtrl(qtm_mailbox* mailbox, unsigned long long* last_version, qtm_ctrlSample* sample, long long* age_us);
+// EMG events
+BOOL mailbox_PushEvent(qtm_mailbox* mailbox, const emg_event* event);
+BOOL mailbox_PopEvent(qtm_mailbox* mailbox, emg_event* event);
+#endif // !QTM_MAILBOX_H
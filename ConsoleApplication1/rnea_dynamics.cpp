@@ -0,0 +1,56 @@
+/***********************************************************************************************************************
+* rnea_dynamics.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Construction of the links of the recursive Newton-Euler inverse dynamics (the recursion itself is in the header).
+***********************************************************************************************************************/
+
+#include "rnea_dynamics.h"
+#include <cmath>
+
+/*---------------------------------------------------------------------------------------------------------------------
+| rnea_SetGeometry - Set the modified Denavit-Hartenberg parameters of a link
+|
+| Syntax --
+|	void rnea_SetGeometry(rnea_Link* link, float alpha, float a, float d)
+|
+| Inputs --
+|	rnea_Link* link -> link to set
+|	float alpha -> twist about the x axis of the previous frame (rad)
+|	float a -> distance along the x axis of the previous frame (m)
+|	float d -> offset along the joint axis (m)
+----------------------------------------------------------------------------------------------------------------------*/
+void rnea_SetGeometry(rnea_Link* link, float alpha, float a, float d)
+{
+	link->cos_alpha = cosf(alpha);
+	link->sin_alpha = sinf(alpha);
+	link->p[0] = a;
+	link->p[1] = -link->sin_alpha * d;
+	link->p[2] = link->cos_alpha * d;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| rnea_ClearInertia - Set all inertial parameters of a link to zero (massless link)
+|
+| Syntax --
+|	void rnea_ClearInertia(rnea_Link* link)
+|
+| Inputs --
+|	rnea_Link* link -> link to clear
+----------------------------------------------------------------------------------------------------------------------*/
+void rnea_ClearInertia(rnea_Link* link)
+{
+	link->mass = 0.0f;
+	for (int k(0); k < 3; k++)
+	{
+		link->first_moment[k] = 0.0f;
+	}
+	for (int k(0); k < 6; k++)
+	{
+		link->inertia[k] = 0.0f;
+	}
+	link->rotor_inertia = 0.0f;
+}
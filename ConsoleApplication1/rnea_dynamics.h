@@ -0,0 +1,196 @@
+/***********************************************************************************************************************
+* rnea_dynamics.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the declaration of the recursive Newton-Euler inverse dynamics of a serial chain of revolute joints
+* (modified Denavit-Hartenberg convention). The number of links is a template parameter : the recursion over the
+* links is resolved at compile time and every link is computed inline, without loops nor dynamic memory.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef RNEA_DYNAMICS_H
+#define RNEA_DYNAMICS_H
+
+// ---------------------------------------------------- LINK STRUCT ----------------------------------------------------
+// Geometry and inertial parameters of a link, expressed in its own frame (joint axis = z)
+struct rnea_Link
+{
+	float cos_alpha, sin_alpha;				// Twist between the previous joint axis and this one
+	float p[3];								// Origin of the frame in the previous frame (a, -sin(alpha) d, cos(alpha) d)
+	float mass;								// Mass of the link (kg)
+	float first_moment[3];					// Mass times center of mass position (kg.m)
+	float inertia[6];						// Inertia about the frame origin : xx, yy, zz, xy, xz, yz (kg.m^2)
+	float rotor_inertia;					// Inertia of the motor and gearbox, articular side (kg.m^2)
+};
+
+// ---------------------------------------------------- FRAME STRUCT ---------------------------------------------------
+// Kinematics and efforts of a link during an evaluation
+struct rnea_Frame
+{
+	float c, s;								// cos and sin of the joint angle
+	float w[3];								// Angular speed
+	float dw[3];							// Angular acceleration
+	float dv[3];							// Linear acceleration of the origin (gravity included)
+	float f[3];								// Force applied by the previous link
+	float n[3];								// Moment about the origin applied by the previous link
+};
+
+// Functions declaration
+void rnea_SetGeometry(rnea_Link* link, float alpha, float a, float d);
+void rnea_ClearInertia(rnea_Link* link);
+
+// ------------------------------------------------- VECTOR OPERATIONS -------------------------------------------------
+// r = a x b
+inline void rnea_Cross(const float* a, const float* b, float* r)
+{
+	r[0] = a[1] * b[2] - a[2] * b[1];
+	r[1] = a[2] * b[0] - a[0] * b[2];
+	r[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// r = R^T v, R rotation from the frame of the link to the previous frame
+inline void rnea_RotateIn(const rnea_Link* link, const rnea_Frame* frame, const float* v, float* r)
+{
+	float y = link->cos_alpha * v[1] + link->sin_alpha * v[2];
+	r[0] = frame->c * v[0] + frame->s * y;
+	r[1] = -frame->s * v[0] + frame->c * y;
+	r[2] = -link->sin_alpha * v[1] + link->cos_alpha * v[2];
+}
+
+// r = R v
+inline void rnea_RotateOut(const rnea_Link* link, const rnea_Frame* frame, const float* v, float* r)
+{
+	float x = frame->c * v[0] - frame->s * v[1];
+	float y = frame->s * v[0] + frame->c * v[1];
+	r[0] = x;
+	r[1] = link->cos_alpha * y - link->sin_alpha * v[2];
+	r[2] = link->sin_alpha * y + link->cos_alpha * v[2];
+}
+
+// r = I v, I symmetric inertia (xx, yy, zz, xy, xz, yz)
+inline void rnea_Inertia(const float* inertia, const float* v, float* r)
+{
+	r[0] = inertia[0] * v[0] + inertia[3] * v[1] + inertia[4] * v[2];
+	r[1] = inertia[3] * v[0] + inertia[1] * v[1] + inertia[5] * v[2];
+	r[2] = inertia[4] * v[0] + inertia[5] * v[1] + inertia[2] * v[2];
+}
+
+// --------------------------------------------------- RECURSION -------------------------------------------------------
+// Link I : kinematics on the way down the recursion, efforts on the way back (children already accumulated)
+template <int I, int N>
+struct rnea_Step
+{
+	static inline void run(const rnea_Link* links, const float* qd, const float* qdd, rnea_Frame* frames, float* tau)
+	{
+		const rnea_Link* link = &links[I];
+		const rnea_Frame* parent = &frames[I];
+		rnea_Frame* frame = &frames[I + 1];
+		float t1[3], t2[3], t3[3], force[3], moment[3];
+
+		// Linear acceleration : R^T (dw x p + w x (w x p) + dv)
+		rnea_Cross(parent->dw, link->p, t1);
+		rnea_Cross(parent->w, link->p, t2);
+		rnea_Cross(parent->w, t2, t3);
+		for (int k(0); k < 3; k++)
+		{
+			t1[k] += t3[k] + parent->dv[k];
+		}
+		rnea_RotateIn(link, frame, t1, frame->dv);
+
+		// Angular speed and acceleration : R^T w + qd z, R^T dw + (R^T w) x qd z + qdd z
+		rnea_RotateIn(link, frame, parent->w, t1);
+		rnea_RotateIn(link, frame, parent->dw, t2);
+		frame->w[0] = t1[0];
+		frame->w[1] = t1[1];
+		frame->w[2] = t1[2] + qd[I];
+		frame->dw[0] = t2[0] + t1[1] * qd[I];
+		frame->dw[1] = t2[1] - t1[0] * qd[I];
+		frame->dw[2] = t2[2] + qdd[I];
+		for (int k(0); k < 3; k++)
+		{
+			frame->f[k] = 0.0f;
+			frame->n[k] = 0.0f;
+		}
+
+		// Distal links
+		rnea_Step<I + 1, N>::run(links, qd, qdd, frames, tau);
+
+		// Force of the link : m dv + dw x h + w x (w x h)
+		rnea_Cross(frame->dw, link->first_moment, t1);
+		rnea_Cross(frame->w, link->first_moment, t2);
+		rnea_Cross(frame->w, t2, t3);
+		for (int k(0); k < 3; k++)
+		{
+			frame->f[k] += link->mass * frame->dv[k] + t1[k] + t3[k];
+		}
+		// Moment of the link about its origin : I dw + w x (I w) + h x dv
+		rnea_Inertia(link->inertia, frame->w, t1);
+		rnea_Cross(frame->w, t1, t2);
+		rnea_Inertia(link->inertia, frame->dw, t1);
+		rnea_Cross(link->first_moment, frame->dv, t3);
+		for (int k(0); k < 3; k++)
+		{
+			frame->n[k] += t1[k] + t2[k] + t3[k];
+		}
+
+		// Joint torque, then efforts transmitted to the previous link
+		tau[I] = frame->n[2] + link->rotor_inertia * qdd[I];
+		rnea_RotateOut(link, frame, frame->f, force);
+		rnea_RotateOut(link, frame, frame->n, moment);
+		rnea_Cross(link->p, force, t1);
+		for (int k(0); k < 3; k++)
+		{
+			frames[I].f[k] += force[k];
+			frames[I].n[k] += moment[k] + t1[k];
+		}
+	}
+};
+
+// End of the chain
+template <int N>
+struct rnea_Step<N, N>
+{
+	static inline void run(const rnea_Link*, const float*, const float*, rnea_Frame*, float*) {}
+};
+
+/*---------------------------------------------------------------------------------------------------------------------
+| rnea_InverseDynamics - Compute the joint torques of a chain of N links
+|
+| Syntax --
+|	template <int N> void rnea_InverseDynamics(const rnea_Link* links, const float* cos_q, const float* sin_q,
+|	                                           const float* qd, const float* qdd, const float* base_acc, float* tau)
+|
+| Inputs --
+|	const rnea_Link* links -> N links, from the base
+|	const float* cos_q, sin_q -> cos and sin of the N joint angles
+|	const float* qd, qdd -> N joint speeds (rad/s) and accelerations (rad/s^2)
+|	const float* base_acc -> acceleration of the base in its frame, opposite of gravity for a fixed base (m/s^2)
+|	float* tau -> filled with the N joint torques (N.m)
+----------------------------------------------------------------------------------------------------------------------*/
+template <int N>
+inline void rnea_InverseDynamics(const rnea_Link* links, const float* cos_q, const float* sin_q, const float* qd,
+	                             const float* qdd, const float* base_acc, float* tau)
+{
+	rnea_Frame frames[N + 1];
+
+	// Fixed base
+	for (int k(0); k < 3; k++)
+	{
+		frames[0].w[k] = 0.0f;
+		frames[0].dw[k] = 0.0f;
+		frames[0].dv[k] = base_acc[k];
+		frames[0].f[k] = 0.0f;
+		frames[0].n[k] = 0.0f;
+	}
+	for (int i(0); i < N; i++)
+	{
+		frames[i + 1].c = cos_q[i];
+		frames[i + 1].s = sin_q[i];
+	}
+	rnea_Step<0, N>::run(links, qd, qdd, frames, tau);
+}
+#endif // !RNEA_DYNAMICS_H
\ No newline at end of file
@@ -0,0 +1,86 @@
+/***********************************************************************************************************************
+* robot_state.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Fills the state of the axes from the drive frame once per cycle.
+***********************************************************************************************************************/
+
+#include "robot_state.h"
+
+/*---------------------------------------------------------------------------------------------------------------------
+| state_BuildConfig - Build the configuration of the axes read by the controllers
+|
+| Syntax --
+|	void state_BuildConfig(AbleControlStruct* ctrl_ABLE)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> control struct, motors parameters and ADC offsets received
+|
+| Remarks --
+|	To be called before the control thread is created : the block is not modified during the motions. The gains
+|	changed by the orders (Kp_P, Kp_V_r) stay in motorsParams.
+----------------------------------------------------------------------------------------------------------------------*/
+void state_BuildConfig(AbleControlStruct* ctrl_ABLE)
+{
+	// Extract substructs
+	motorsParams* mValues = &ctrl_ABLE->mParams;
+	RobotConfig* config = &ctrl_ABLE->config;
+
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		config->reduction[i] = mValues->able_AxisReductions[i];
+		config->current_gain[i] = static_cast<float>(mValues->Kconv_I[i]);
+		config->current_offset[i] = static_cast<float>(mValues->offset_ADC[i]);
+		config->speed_gain[i] = static_cast<float>(mValues->Kp_V[i]);
+		config->active[i] = mValues->inhibition_State[i] == 0;
+	}
+	config->kt_gain = mValues->kt_gain;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| state_Extract - Read the state of every axis from the drive frame
+|
+| Syntax --
+|	void state_Extract(const ServoComEth* eth_ABLE, const RobotConfig* config, RobotState* state)
+|
+| Inputs --
+|	const ServoComEth* eth_ABLE -> communication struct, state frame translated (ETH_carte_variateur_V3_Datas)
+|	const RobotConfig* config -> configuration of the axes
+|	RobotState* state -> filled with the state of the axes
+----------------------------------------------------------------------------------------------------------------------*/
+void state_Extract(const ServoComEth* eth_ABLE, const RobotConfig* config, RobotState* state)
+{
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		state->coder[i] = eth_ABLE->moteur[i].Position_Codeur;
+		state->speed[i] = eth_ABLE->moteur[i].Vitesse_Filtree;
+		state->voltage[i] = eth_ABLE->moteur[i].ADC_Potentiometre;
+		// Expression of the current given by the constructor of ABLE
+		state->current[i] = config->current_gain[i] * (eth_ABLE->moteur[i].ADC_Courant - config->current_offset[i]);
+		state->position[i] = able_ComputeCurrentPosition(state->coder[i], config->reduction[i]);
+	}
+	state->inputs = eth_ABLE->entree_tor;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| state_Update - Fill the state of the current cycle, once the state frame is stamped and translated
+|
+| Syntax --
+|	void state_Update(ThreadInformations* ableInfos)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+|
+| Remarks --
+|	The tick of the frame and the duration of the cycle stay in realTimeParams (able_StampStateFrame).
+----------------------------------------------------------------------------------------------------------------------*/
+void state_Update(ThreadInformations* ableInfos)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+
+	state_Extract(ableInfos->eth_ABLE, &ctrl_ABLE->config, &ctrl_ABLE->state);
+}
@@ -0,0 +1,27 @@
+/***********************************************************************************************************************
+* robot_state.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the functions filling the state of the axes once per cycle. The drive frame is read in a
+* single pass into RobotState (one array per quantity, two cache lines), with the constants of RobotConfig built
+* before the motions. The controllers, the model, the recording and the telemetry read these two blocks instead of the
+* scattered fields of the control struct.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef ROBOT_STATE_H
+#define ROBOT_STATE_H
+
+// Project includes
+#include "communication_struct_ABLE.h"
+#include "utils_for_ABLE_Com.h"
+
+// Robot state functions
+void state_BuildConfig(AbleControlStruct* ctrl_ABLE);
+void state_Extract(const ServoComEth* eth_ABLE, const RobotConfig* config, RobotState* state);
+void state_Update(ThreadInformations* ableInfos);
+#endif // !ROBOT_STATE_H
\ No newline at end of file
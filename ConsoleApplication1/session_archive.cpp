@@ -0,0 +1,668 @@
+/***********************************************************************************************************************
+* session_archive.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Writes and reads session archives : a single binary file containing all the channels of a session, stored by chunks
+* of columns with the min, max and mean of each channel per chunk. Archives are read through a file mapping, so that
+* queries only touch the chunks whose statistics can change their result.
+***********************************************************************************************************************/
+
+#include "session_archive.h"
+#include <cmath>
+#include <string.h>
+
+using namespace std;
+
+static_assert(sizeof(archive_fileHeader) == 64, "Archive header must be 64 bytes");
+static_assert(sizeof(archive_channelDesc) == 32, "Archive channel descriptor must be 32 bytes");
+static_assert(sizeof(archive_chunkHeader) == 16, "Archive chunk header must be 16 bytes");
+static_assert(sizeof(archive_chunkStats) == 16, "Archive chunk stats must be 16 bytes");
+
+// Round a size to the next multiple of ARCHIVE_ALIGNMENT
+static unsigned long long archive_Align(unsigned long long size)
+{
+	return (size + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+}
+
+// Size of a chunk : chunk header, stats and column of each channel, padded to ARCHIVE_ALIGNMENT
+static unsigned long long archive_ChunkSize(unsigned long long nb_channels, unsigned long long chunk_samples)
+{
+	return archive_Align(sizeof(archive_chunkHeader) + nb_channels * sizeof(archive_chunkStats) +
+						 nb_channels * chunk_samples * sizeof(float));
+}
+
+// -------------------------------------------------- WRITER FUNCTIONS -------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_FlushChunk - Compute the statistics of the buffered chunk and write it (padded to a full chunk)
+|
+| Syntax --
+|	static int archive_FlushChunk(archive_writer* writer)
+|
+| Inputs --
+|	archive_writer* writer -> writer containing the buffered chunk
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Write error
+----------------------------------------------------------------------------------------------------------------------*/
+static int archive_FlushChunk(archive_writer* writer)
+{
+	// Initialise variables
+	archive_fileHeader* header = &writer->header;
+	archive_chunkHeader chunk_header;
+	archive_chunkStats stats;
+	const float* column;
+	double sum;
+	unsigned long long written;
+	static const char padding[ARCHIVE_ALIGNMENT] = { 0 };
+
+	if (writer->nb_buffered == 0)
+	{
+		return 0;
+	}
+
+	// Chunk header
+	chunk_header.first_sample = header->nb_samples;
+	chunk_header.nb_samples = writer->nb_buffered;
+	chunk_header.reserved = 0;
+	if (fwrite(&chunk_header, sizeof(chunk_header), 1, writer->file) != 1)
+	{
+		return 1;
+	}
+
+	// Statistics of each channel, NaN samples are ignored
+	for (unsigned int i(0); i < header->nb_channels; i++)
+	{
+		column = &writer->columns[(size_t)i * header->chunk_samples];
+		stats.min = NAN;
+		stats.max = NAN;
+		stats.nb_valid = 0;
+		sum = 0.0;
+		for (unsigned int j(0); j < writer->nb_buffered; j++)
+		{
+			if (isnan(column[j]))
+			{
+				continue;
+			}
+			if (stats.nb_valid == 0 || column[j] < stats.min)
+			{
+				stats.min = column[j];
+			}
+			if (stats.nb_valid == 0 || column[j] > stats.max)
+			{
+				stats.max = column[j];
+			}
+			sum += column[j];
+			stats.nb_valid++;
+		}
+		stats.mean = (stats.nb_valid > 0) ? (float)(sum / stats.nb_valid) : NAN;
+		if (fwrite(&stats, sizeof(stats), 1, writer->file) != 1)
+		{
+			return 1;
+		}
+	}
+
+	// Columns (unused samples are NaN) and padding up to the chunk size
+	for (unsigned int j(writer->nb_buffered); j < header->chunk_samples; j++)
+	{
+		for (unsigned int i(0); i < header->nb_channels; i++)
+		{
+			writer->columns[(size_t)i * header->chunk_samples + j] = NAN;
+		}
+	}
+	if (fwrite(writer->columns.data(), sizeof(float), writer->columns.size(), writer->file) != writer->columns.size())
+	{
+		return 1;
+	}
+	written = sizeof(archive_chunkHeader) + header->nb_channels * sizeof(archive_chunkStats) + writer->columns.size() * sizeof(float);
+	if (header->chunk_size > written && fwrite(padding, 1, (size_t)(header->chunk_size - written), writer->file) != header->chunk_size - written)
+	{
+		return 1;
+	}
+
+	header->nb_samples += writer->nb_buffered;
+	header->nb_chunks++;
+	writer->nb_buffered = 0;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_OpenWriter - Create an archive and write its header and channel descriptors
+|
+| Syntax --
+|	int archive_OpenWriter(FILE* err_file, archive_writer* writer, const char* file_name,
+|						   const archive_channelDesc* channels, int nb_channels, double sampling_period)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	archive_writer* writer -> writer to initialise
+|	const char* file_name -> name of the archive to create
+|	const archive_channelDesc* channels -> names and units of the channels
+|	int nb_channels -> number of channels
+|	double sampling_period -> time between two samples (s)
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Invalid channels ; 2 : File not opened ; 3 : Write error
+----------------------------------------------------------------------------------------------------------------------*/
+int archive_OpenWriter(FILE* err_file, archive_writer* writer, const char* file_name, const archive_channelDesc* channels,
+					   int nb_channels, double sampling_period)
+{
+	// Initialise variables
+	archive_fileHeader* header = &writer->header;
+	unsigned long long descriptors_end;
+	static const char padding[ARCHIVE_ALIGNMENT] = { 0 };
+
+	writer->file = NULL;
+	if (nb_channels <= 0 || nb_channels > ARCHIVE_MAX_CHANNELS)
+	{
+		fprintf(err_file, "Session archive : invalid number of channels (%i) !\n", nb_channels);
+		return 1;
+	}
+	if (fopen_s(&writer->file, file_name, "wb") != 0 || writer->file == NULL)
+	{
+		fprintf(err_file, "Session archive %s not opened !\n", file_name);
+		writer->file = NULL;
+		return 2;
+	}
+
+	// Fill header, counts are patched when closing
+	memset(header, 0, sizeof(archive_fileHeader));
+	memcpy(header->magic, ARCHIVE_MAGIC, sizeof(header->magic));
+	header->version = ARCHIVE_VERSION;
+	header->nb_channels = nb_channels;
+	header->chunk_samples = ARCHIVE_CHUNK_SAMPLES;
+	header->sampling_period = sampling_period;
+	descriptors_end = sizeof(archive_fileHeader) + nb_channels * sizeof(archive_channelDesc);
+	header->data_offset = archive_Align(descriptors_end);
+	header->chunk_size = archive_ChunkSize(nb_channels, ARCHIVE_CHUNK_SAMPLES);
+
+	if (fwrite(header, sizeof(archive_fileHeader), 1, writer->file) != 1 ||
+		fwrite(channels, sizeof(archive_channelDesc), nb_channels, writer->file) != (size_t)nb_channels ||
+		fwrite(padding, 1, (size_t)(header->data_offset - descriptors_end), writer->file) != header->data_offset - descriptors_end)
+	{
+		fprintf(err_file, "Session archive %s : header not written !\n", file_name);
+		fclose(writer->file);
+		writer->file = NULL;
+		return 3;
+	}
+
+	// Chunk buffer
+	writer->columns.assign((size_t)nb_channels * ARCHIVE_CHUNK_SAMPLES, 0.0f);
+	writer->nb_buffered = 0;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_AppendSample - Append one sample of every channel, the chunk is written once full
+|
+| Syntax --
+|	int archive_AppendSample(archive_writer* writer, const float* values)
+|
+| Inputs --
+|	archive_writer* writer -> opened writer
+|	const float* values -> one value per channel (NaN if not measured)
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Write error
+----------------------------------------------------------------------------------------------------------------------*/
+int archive_AppendSample(archive_writer* writer, const float* values)
+{
+	// Extract header
+	archive_fileHeader* header = &writer->header;
+
+	for (unsigned int i(0); i < header->nb_channels; i++)
+	{
+		writer->columns[(size_t)i * header->chunk_samples + writer->nb_buffered] = values[i];
+	}
+	writer->nb_buffered++;
+	if (writer->nb_buffered == header->chunk_samples)
+	{
+		return archive_FlushChunk(writer);
+	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_CloseWriter - Write the last chunk, patch the header counts and close the archive
+|
+| Syntax --
+|	int archive_CloseWriter(FILE* err_file, archive_writer* writer)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	archive_writer* writer -> opened writer
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Write error
+----------------------------------------------------------------------------------------------------------------------*/
+int archive_CloseWriter(FILE* err_file, archive_writer* writer)
+{
+	// Initialise variables
+	int err = 0;
+
+	if (writer->file == NULL)
+	{
+		return 1;
+	}
+	if (archive_FlushChunk(writer) != 0)
+	{
+		err = 1;
+	}
+	rewind(writer->file);
+	if (fwrite(&writer->header, sizeof(archive_fileHeader), 1, writer->file) != 1)
+	{
+		err = 1;
+	}
+	fclose(writer->file);
+	writer->file = NULL;
+	writer->columns.clear();
+	writer->columns.shrink_to_fit();
+	if (err != 0)
+	{
+		fprintf(err_file, "Session archive : write error, archive incomplete !\n");
+	}
+	return err;
+}
+
+// -------------------------------------------------- READER FUNCTIONS -------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_OpenReader - Map an archive in memory and check its header
+|
+| Syntax --
+|	int archive_OpenReader(FILE* err_file, archive_reader* reader, const char* file_name)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	archive_reader* reader -> reader to initialise
+|	const char* file_name -> name of the archive
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : File not opened ; 2 : Mapping error ; 3 : Invalid archive
+|
+| Remarks --
+|	Every chunk header is checked against the layout of archive_CloseWriter (full chunks, the last one excepted), so
+|	that the queries never read past the mapped file.
+----------------------------------------------------------------------------------------------------------------------*/
+int archive_OpenReader(FILE* err_file, archive_reader* reader, const char* file_name)
+{
+	// Initialise variables
+	LARGE_INTEGER file_size;
+	const archive_fileHeader* header;
+	const archive_chunkHeader* chunk_header;
+	unsigned long long nb_chunks, chunk_first, chunk_samples;
+
+	memset(reader, 0, sizeof(archive_reader));
+	reader->file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (reader->file == INVALID_HANDLE_VALUE)
+	{
+		fprintf(err_file, "Session archive %s not opened !\n", file_name);
+		reader->file = NULL;
+		return 1;
+	}
+	if (!GetFileSizeEx(reader->file, &file_size) || file_size.QuadPart < (LONGLONG)sizeof(archive_fileHeader))
+	{
+		fprintf(err_file, "Session archive %s too small !\n", file_name);
+		archive_CloseReader(reader);
+		return 3;
+	}
+	reader->mapping = CreateFileMappingA(reader->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (reader->mapping != NULL)
+	{
+		reader->base = (const unsigned char*)MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (reader->base == NULL)
+	{
+		fprintf(err_file, "Session archive %s not mapped (error %lu) !\n", file_name, GetLastError());
+		archive_CloseReader(reader);
+		return 2;
+	}
+
+	// Check header consistency against the chunk layout and the file size, before any chunk is read
+	header = (const archive_fileHeader*)reader->base;
+	if (memcmp(header->magic, ARCHIVE_MAGIC, sizeof(header->magic)) != 0 || header->version != ARCHIVE_VERSION ||
+		header->nb_channels == 0 || header->nb_channels > ARCHIVE_MAX_CHANNELS || header->chunk_samples == 0 ||
+		header->chunk_samples > ARCHIVE_CHUNK_SAMPLES ||
+		header->chunk_size != archive_ChunkSize(header->nb_channels, header->chunk_samples) ||
+		header->data_offset < sizeof(archive_fileHeader) + header->nb_channels * sizeof(archive_channelDesc) ||
+		header->data_offset > (unsigned long long)file_size.QuadPart ||
+		header->nb_chunks > ((unsigned long long)file_size.QuadPart - header->data_offset) / header->chunk_size ||
+		!(header->sampling_period > 0.0))
+	{
+		fprintf(err_file, "Session archive %s invalid or truncated !\n", file_name);
+		archive_CloseReader(reader);
+		return 3;
+	}
+
+	// Check the number of samples against the chunks, then every chunk header
+	nb_chunks = header->nb_samples / header->chunk_samples + ((header->nb_samples % header->chunk_samples) != 0);
+	if (header->nb_chunks != nb_chunks)
+	{
+		fprintf(err_file, "Session archive %s : %llu samples in %llu chunks, invalid !\n", file_name,
+			header->nb_samples, header->nb_chunks);
+		archive_CloseReader(reader);
+		return 3;
+	}
+	for (unsigned long long k(0); k < nb_chunks; k++)
+	{
+		chunk_header = (const archive_chunkHeader*)(reader->base + header->data_offset + k * header->chunk_size);
+		chunk_first = k * header->chunk_samples;
+		chunk_samples = header->nb_samples - chunk_first;
+		if (chunk_samples > header->chunk_samples)
+		{
+			chunk_samples = header->chunk_samples;
+		}
+		if (chunk_header->first_sample != chunk_first || chunk_header->nb_samples != chunk_samples)
+		{
+			fprintf(err_file, "Session archive %s : chunk %llu invalid !\n", file_name, k);
+			archive_CloseReader(reader);
+			return 3;
+		}
+	}
+	reader->header = header;
+	reader->channels = (const archive_channelDesc*)(reader->base + sizeof(archive_fileHeader));
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_CloseReader - Unmap an archive
+|
+| Syntax --
+|	void archive_CloseReader(archive_reader* reader)
+|
+| Inputs --
+|	archive_reader* reader -> reader to close
+----------------------------------------------------------------------------------------------------------------------*/
+void archive_CloseReader(archive_reader* reader)
+{
+	if (reader->base != NULL)
+	{
+		UnmapViewOfFile(reader->base);
+	}
+	if (reader->mapping != NULL)
+	{
+		CloseHandle(reader->mapping);
+	}
+	if (reader->file != NULL)
+	{
+		CloseHandle(reader->file);
+	}
+	memset(reader, 0, sizeof(archive_reader));
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_FindChannel - Get the index of a channel from its name
+|
+| Syntax --
+|	int archive_FindChannel(const archive_reader* reader, const char* name)
+|
+| Inputs --
+|	const archive_reader* reader -> opened reader
+|	const char* name -> name of the channel
+|
+| Outputs --
+|	int -> index of the channel ; -1 : Channel not found
+----------------------------------------------------------------------------------------------------------------------*/
+int archive_FindChannel(const archive_reader* reader, const char* name)
+{
+	for (unsigned int i(0); i < reader->header->nb_channels; i++)
+	{
+		if (strncmp(reader->channels[i].name, name, ARCHIVE_NAME_LENGTH) == 0)
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_ChunkStats - Get the statistics of a channel over a chunk, without touching the chunk data
+|
+| Syntax --
+|	const archive_chunkStats* archive_ChunkStats(const archive_reader* reader, unsigned long long chunk, int channel)
+|
+| Inputs --
+|	const archive_reader* reader -> opened reader
+|	unsigned long long chunk -> index of the chunk
+|	int channel -> index of the channel
+|
+| Outputs --
+|	const archive_chunkStats* -> statistics in the mapped file
+----------------------------------------------------------------------------------------------------------------------*/
+const archive_chunkStats* archive_ChunkStats(const archive_reader* reader, unsigned long long chunk, int channel)
+{
+	const unsigned char* chunk_base = reader->base + reader->header->data_offset + chunk * reader->header->chunk_size;
+	return (const archive_chunkStats*)(chunk_base + sizeof(archive_chunkHeader)) + channel;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_ChunkColumn - Get the samples of a channel over a chunk (zero-copy)
+|
+| Syntax --
+|	const float* archive_ChunkColumn(const archive_reader* reader, unsigned long long chunk, int channel,
+|									 unsigned int* nb_samples)
+|
+| Inputs --
+|	const archive_reader* reader -> opened reader
+|	unsigned long long chunk -> index of the chunk
+|	int channel -> index of the channel
+|	unsigned int* nb_samples -> receives the number of samples used in the chunk
+|
+| Outputs --
+|	const float* -> first sample of the column in the mapped file
+----------------------------------------------------------------------------------------------------------------------*/
+const float* archive_ChunkColumn(const archive_reader* reader, unsigned long long chunk, int channel, unsigned int* nb_samples)
+{
+	const unsigned char* chunk_base = reader->base + reader->header->data_offset + chunk * reader->header->chunk_size;
+	const float* columns = (const float*)(chunk_base + sizeof(archive_chunkHeader) +
+										  reader->header->nb_channels * sizeof(archive_chunkStats));
+	*nb_samples = ((const archive_chunkHeader*)chunk_base)->nb_samples;
+	return columns + (size_t)channel * reader->header->chunk_samples;
+}
+
+// -------------------------------------------------- QUERY FUNCTIONS --------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_SampleRange - Convert a time interval into an inclusive sample interval
+|
+| Syntax --
+|	static bool archive_SampleRange(const archive_reader* reader, double t_start, double t_end,
+|									unsigned long long* first, unsigned long long* last)
+|
+| Outputs --
+|	bool -> true : Interval contains samples ; false : Empty interval
+----------------------------------------------------------------------------------------------------------------------*/
+static bool archive_SampleRange(const archive_reader* reader, double t_start, double t_end, unsigned long long* first,
+								unsigned long long* last)
+{
+	// Extract header
+	const archive_fileHeader* header = reader->header;
+	double first_d = ceil((t_start < 0.0 ? 0.0 : t_start) / header->sampling_period);
+	double last_d = floor(t_end / header->sampling_period);
+
+	if (header->nb_samples == 0 || t_end < t_start || last_d < 0.0 || first_d >= (double)header->nb_samples)
+	{
+		return false;
+	}
+	*first = (unsigned long long)first_d;
+	*last = (last_d >= (double)header->nb_samples) ? header->nb_samples - 1 : (unsigned long long)last_d;
+	return *first <= *last;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_QueryMaxAbs - Compute the maximum absolute value of a channel between two times. Chunks entirely inside the
+|                       interval are answered from their statistics, and partial chunks are only scanned if their
+|                       statistics can exceed the current result.
+|
+| Syntax --
+|	int archive_QueryMaxAbs(const archive_reader* reader, int channel, double t_start, double t_end, float* max_abs,
+|							unsigned long long* nb_scanned_chunks)
+|
+| Inputs --
+|	const archive_reader* reader -> opened reader
+|	int channel -> index of the channel
+|	double t_start, t_end -> time interval (s)
+|	float* max_abs -> receives the result
+|	unsigned long long* nb_scanned_chunks -> receives the number of chunks whose data was read (can be NULL)
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : No valid sample in the interval ; 2 : Invalid channel
+----------------------------------------------------------------------------------------------------------------------*/
+int archive_QueryMaxAbs(const archive_reader* reader, int channel, double t_start, double t_end, float* max_abs,
+						unsigned long long* nb_scanned_chunks)
+{
+	// Initialise variables
+	unsigned long long first, last, chunk_first, chunk_last, nb_scanned = 0;
+	const archive_chunkStats* stats;
+	const float* column;
+	unsigned int nb_samples, chunk_samples = reader->header->chunk_samples;
+	float bound, best = 0.0f;
+	bool found = false;
+
+	if (channel < 0 || channel >= (int)reader->header->nb_channels)
+	{
+		return 2;
+	}
+	if (archive_SampleRange(reader, t_start, t_end, &first, &last))
+	{
+		for (unsigned long long k(first / chunk_samples); k <= last / chunk_samples; k++)
+		{
+			stats = archive_ChunkStats(reader, k, channel);
+			if (stats->nb_valid == 0)
+			{
+				continue;
+			}
+			bound = (fabsf(stats->min) > fabsf(stats->max)) ? fabsf(stats->min) : fabsf(stats->max);
+			if (found && bound <= best)
+			{
+				// This chunk cannot change the result
+				continue;
+			}
+			chunk_first = k * chunk_samples;
+			column = archive_ChunkColumn(reader, k, channel, &nb_samples);
+			chunk_last = chunk_first + nb_samples - 1;
+			if (first <= chunk_first && chunk_last <= last)
+			{
+				// Chunk entirely inside the interval
+				best = bound;
+				found = true;
+				continue;
+			}
+			nb_scanned++;
+			for (unsigned long long j((first > chunk_first) ? first : chunk_first); j <= ((last < chunk_last) ? last : chunk_last); j++)
+			{
+				if (!isnan(column[j - chunk_first]) && (!found || fabsf(column[j - chunk_first]) > best))
+				{
+					best = fabsf(column[j - chunk_first]);
+					found = true;
+				}
+			}
+		}
+	}
+	if (nb_scanned_chunks != NULL)
+	{
+		*nb_scanned_chunks = nb_scanned;
+	}
+	*max_abs = best;
+	return found ? 0 : 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| archive_QueryStats - Compute the min, max and mean of a channel between two times, using the chunk statistics for the
+|                      chunks entirely inside the interval
+|
+| Syntax --
+|	int archive_QueryStats(const archive_reader* reader, int channel, double t_start, double t_end,
+|						   archive_chunkStats* stats, unsigned long long* nb_scanned_chunks)
+|
+| Inputs --
+|	const archive_reader* reader -> opened reader
+|	int channel -> index of the channel
+|	double t_start, t_end -> time interval (s)
+|	archive_chunkStats* stats -> receives the result (nb_valid : number of valid samples in the interval)
+|	unsigned long long* nb_scanned_chunks -> receives the number of chunks whose data was read (can be NULL)
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : No valid sample in the interval ; 2 : Invalid channel
+----------------------------------------------------------------------------------------------------------------------*/
+int archive_QueryStats(const archive_reader* reader, int channel, double t_start, double t_end, archive_chunkStats* stats,
+					   unsigned long long* nb_scanned_chunks)
+{
+	// Initialise variables
+	unsigned long long first, last, chunk_first, chunk_last, nb_scanned = 0;
+	const archive_chunkStats* chunk_stats;
+	const float* column;
+	unsigned int nb_samples, chunk_samples = reader->header->chunk_samples;
+	double sum = 0.0;
+	float value;
+
+	if (channel < 0 || channel >= (int)reader->header->nb_channels)
+	{
+		return 2;
+	}
+	stats->min = NAN;
+	stats->max = NAN;
+	stats->mean = NAN;
+	stats->nb_valid = 0;
+	if (archive_SampleRange(reader, t_start, t_end, &first, &last))
+	{
+		for (unsigned long long k(first / chunk_samples); k <= last / chunk_samples; k++)
+		{
+			chunk_stats = archive_ChunkStats(reader, k, channel);
+			if (chunk_stats->nb_valid == 0)
+			{
+				continue;
+			}
+			chunk_first = k * chunk_samples;
+			column = archive_ChunkColumn(reader, k, channel, &nb_samples);
+			chunk_last = chunk_first + nb_samples - 1;
+			if (first <= chunk_first && chunk_last <= last)
+			{
+				// Chunk entirely inside the interval
+				if (stats->nb_valid == 0 || chunk_stats->min < stats->min)
+				{
+					stats->min = chunk_stats->min;
+				}
+				if (stats->nb_valid == 0 || chunk_stats->max > stats->max)
+				{
+					stats->max = chunk_stats->max;
+				}
+				sum += (double)chunk_stats->mean * chunk_stats->nb_valid;
+				stats->nb_valid += chunk_stats->nb_valid;
+				continue;
+			}
+			nb_scanned++;
+			for (unsigned long long j((first > chunk_first) ? first : chunk_first); j <= ((last < chunk_last) ? last : chunk_last); j++)
+			{
+				value = column[j - chunk_first];
+				if (isnan(value))
+				{
+					continue;
+				}
+				if (stats->nb_valid == 0 || value < stats->min)
+				{
+					stats->min = value;
+				}
+				if (stats->nb_valid == 0 || value > stats->max)
+				{
+					stats->max = value;
+				}
+				sum += value;
+				stats->nb_valid++;
+			}
+		}
+	}
+	if (nb_scanned_chunks != NULL)
+	{
+		*nb_scanned_chunks = nb_scanned;
+	}
+	if (stats->nb_valid == 0)
+	{
+		return 1;
+	}
+	stats->mean = (float)(sum / stats->nb_valid);
+	return 0;
+}
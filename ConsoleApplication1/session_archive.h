@@ -0,0 +1,105 @@
+/***********************************************************************************************************************
+* session_archive.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the session archive format, of its writer and of its memory-mapped reader.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef SESSION_ARCHIVE_H
+#define SESSION_ARCHIVE_H
+
+// General includes
+#include <stdio.h>
+#include <vector>
+#include <Windows.h>
+
+// Archive constants
+#define ARCHIVE_MAGIC "ABSA"							// Identifier of session archives
+#define ARCHIVE_VERSION 1								// Version of the archive layout
+#define ARCHIVE_MAX_CHANNELS 64							// Maximum number of channels in an archive
+#define ARCHIVE_CHUNK_SAMPLES 4096						// Number of samples per chunk and per channel
+#define ARCHIVE_NAME_LENGTH 24							// Size of the channel name field (with terminating 0)
+#define ARCHIVE_UNIT_LENGTH 8							// Size of the channel unit field (with terminating 0)
+#define ARCHIVE_ALIGNMENT 64							// Alignment of the chunks in the file
+
+// ------------------------------------------------- ARCHIVE FILE LAYOUT -----------------------------------------------
+// File : header | channel descriptors | padding | chunk 0 | chunk 1 | ... (every chunk has the same size)
+// Chunk : chunk header | stats of each channel | column of each channel (chunk_samples floats, NaN if missing)
+struct archive_fileHeader
+{
+	char magic[4];							// ARCHIVE_MAGIC
+	unsigned int version;					// ARCHIVE_VERSION
+	unsigned int nb_channels;				// Number of channels
+	unsigned int chunk_samples;				// Number of samples per chunk
+	unsigned long long nb_samples;			// Number of samples written (patched when the writer is closed)
+	unsigned long long nb_chunks;			// Number of chunks written (patched when the writer is closed)
+	unsigned long long data_offset;			// Offset of the first chunk (bytes)
+	unsigned long long chunk_size;			// Size of a chunk (bytes)
+	double sampling_period;					// Time between two samples (s)
+	unsigned long long reserved;			// Kept to 0
+};
+
+struct archive_channelDesc
+{
+	char name[ARCHIVE_NAME_LENGTH];			// Channel name, e.g. "fz_FTA"
+	char unit[ARCHIVE_UNIT_LENGTH];			// Channel unit, e.g. "N"
+};
+
+struct archive_chunkHeader
+{
+	unsigned long long first_sample;		// Index of the first sample of the chunk
+	unsigned int nb_samples;				// Number of samples used in the chunk (<= chunk_samples)
+	unsigned int reserved;					// Kept to 0
+};
+
+struct archive_chunkStats
+{
+	float min;								// Minimum of the valid samples of the chunk
+	float max;								// Maximum of the valid samples of the chunk
+	float mean;								// Mean of the valid samples of the chunk
+	unsigned int nb_valid;					// Number of valid (not NaN) samples of the chunk
+};
+
+// ---------------------------------------------------- WRITER STRUCT --------------------------------------------------
+struct archive_writer
+{
+	FILE* file;								// Archive being written
+	archive_fileHeader header;				// Header patched at closing
+	std::vector<float> columns;				// Current chunk, one column of chunk_samples floats per channel
+	unsigned int nb_buffered;				// Number of samples in the current chunk
+};
+
+// ---------------------------------------------------- READER STRUCT --------------------------------------------------
+struct archive_reader
+{
+	HANDLE file;							// Handle of the archive file
+	HANDLE mapping;							// Handle of the file mapping
+	const unsigned char* base;				// First byte of the mapped archive
+	const archive_fileHeader* header;		// Mapped header
+	const archive_channelDesc* channels;	// Mapped channel descriptors
+};
+
+// Writer function definition
+int archive_OpenWriter(FILE* err_file, archive_writer* writer, const char* file_name, const archive_channelDesc* channels,
+					   int nb_channels, double sampling_period);
+int archive_AppendSample(archive_writer* writer, const float* values);
+int archive_CloseWriter(FILE* err_file, archive_writer* writer);
+
+// Reader function definition
+int archive_OpenReader(FILE* err_file, archive_reader* reader, const char* file_name);
+void archive_CloseReader(archive_reader* reader);
+int archive_FindChannel(const archive_reader* reader, const char* name);
+const archive_chunkStats* archive_ChunkStats(const archive_reader* reader, unsigned long long chunk, int channel);
+const float* archive_ChunkColumn(const archive_reader* reader, unsigned long long chunk, int channel, unsigned int* nb_samples);
+
+// Query function definition
+int archive_QueryMaxAbs(const archive_reader* reader, int channel, double t_start, double t_end, float* max_abs,
+						unsigned long long* nb_scanned_chunks);
+int archive_QueryStats(const archive_reader* reader, int channel, double t_start, double t_end, archive_chunkStats* stats,
+					   unsigned long long* nb_scanned_chunks);
+#endif // !SESSION_ARCHIVE_H
@@ -0,0 +1,514 @@
+/***********************************************************************************************************************
+* session_replay.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Captures the inputs and orders of the control loop, and replays captured sessions through the orders computation.
+***********************************************************************************************************************/
+
+#include "session_replay.h"
+
+// Capture of the current session (control thread)
+static replay_Recorder recorder;
+
+// ----------------------------------------------------- CAPTURE -------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| replay_OpenCapture - Allocate the capture of the session before the control loop
+|
+| Syntax --
+|	int replay_OpenCapture(FILE* err_file, FILE* out_file, const AbleControlStruct* ctrl_ABLE)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	const AbleControlStruct* ctrl_ABLE -> control struct, communication with ABLE initialised
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Memory not committed, session not captured
+|
+| Remarks --
+|	The frames are committed and locked before the motion (storage_Allocate) : the capture does not allocate nor
+|	write files during the control loop. The sessions without fixed duration are captured during REPLAY_MAX_SECONDS.
+----------------------------------------------------------------------------------------------------------------------*/
+int replay_OpenCapture(FILE* err_file, FILE* out_file, const AbleControlStruct* ctrl_ABLE)
+{
+	// Extract substructs
+	const realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+	const RobotState* state = &ctrl_ABLE->state;
+	int ctrl_type = ctrl_ABLE->aOrders.ctrl_type;
+
+	memset(&recorder, 0, sizeof(replay_Recorder));
+	if (ctrl_type == TORQUE_CTRL || ctrl_type == CARTESIAN_CTRL || ctrl_type == HAPTIC_CTRL)
+	{
+		recorder.capacity = rtValues->limit_iterCom + REPLAY_EXTRA_FRAMES;
+	} else if (ctrl_type == DYN_IDENT)
+	{
+		recorder.capacity = rtValues->nb_iterations_dyn_ident + REPLAY_EXTRA_FRAMES;
+	} else
+	{
+		recorder.capacity = (int)(REPLAY_MAX_SECONDS * rtValues->ctrl_rate + 0.5f);
+	}
+	recorder.frames = (replay_Frame*)storage_Allocate(recorder.capacity * sizeof(replay_Frame));
+	if (recorder.frames == NULL)
+	{
+		fprintf(err_file, "Capture of %i iterations not allocated, session not captured\n", recorder.capacity);
+		recorder.capacity = 0;
+		return 1;
+	}
+
+	// Parameters received from the drive before the control loop
+	memcpy(recorder.header.magic, REPLAY_MAGIC, sizeof(recorder.header.magic));
+	recorder.header.version = REPLAY_VERSION;
+	recorder.header.frame_size = sizeof(replay_Frame);
+	recorder.header.ctrl_type = ctrl_type;
+	recorder.header.sampling_frequency = rtValues->sampling_frequency;
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		recorder.header.offset_ADC[i] = ctrl_ABLE->mParams.offset_ADC[i];
+		recorder.header.coder_position[i] = state->coder[i];
+	}
+	recorder.header.able_Calibrated = rtValues->able_Calibrated;
+	fprintf(out_file, "Session captured : %i iterations allocated (%.1f MB)\n", recorder.capacity,
+		    recorder.capacity * sizeof(replay_Frame) / 1048576.0);
+	return 0;
+}
+
+// Orders sent at the start of the iteration, after their saturation
+void replay_CaptureCommand(const AbleControlStruct* ctrl_ABLE)
+{
+	// Initialise variables
+	replay_Frame* frame;
+
+	if (recorder.header.nb_frames >= recorder.capacity)
+	{
+		recorder.header.truncated = recorder.frames != NULL;
+		return;
+	}
+	frame = &recorder.frames[recorder.header.nb_frames];
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		frame->command.speedOrder[i] = ctrl_ABLE->aOrders.speedOrder[i];
+		frame->command.inhibition_State[i] = ctrl_ABLE->mParams.inhibition_State[i];
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| replay_CaptureInputs - Capture the inputs read during the iteration, before the orders computation
+|
+| Syntax --
+|	void replay_CaptureInputs(ThreadInformations* ableInfos, int inputs)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+|	int inputs -> REPLAY_INPUT_ values read during the iteration
+|
+| Remarks --
+|	Completes the frame of the iteration started by replay_CaptureCommand.
+----------------------------------------------------------------------------------------------------------------------*/
+void replay_CaptureInputs(ThreadInformations* ableInfos, int inputs)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+
+	// Initialise variables
+	replay_Frame* frame;
+
+	if (recorder.header.nb_frames >= recorder.capacity)
+	{
+		return;
+	}
+	frame = &recorder.frames[recorder.header.nb_frames];
+	frame->iter_counter = rtValues->iter_counter;
+	frame->inputs = inputs;
+	frame->order_not_transmitted = rtValues->able_OrderNotTransmitted;
+	frame->entree_tor = ableInfos->eth_ABLE->entree_tor;
+	frame->state_tick = rtValues->state_tick;
+	frame->cycle_dt = rtValues->cycle_dt;
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		frame->axes[i].coder = ableInfos->eth_ABLE->moteur[i].Position_Codeur;
+		frame->axes[i].speed = ableInfos->eth_ABLE->moteur[i].Vitesse_Filtree;
+		frame->axes[i].adc_current = ableInfos->eth_ABLE->moteur[i].ADC_Courant;
+		frame->axes[i].adc_voltage = ableInfos->eth_ABLE->moteur[i].ADC_Potentiometre;
+	}
+	if (inputs & REPLAY_INPUT_QTM)
+	{
+		frame->qtm = ctrl_ABLE->qtmLink.input;
+	}
+	if (inputs & REPLAY_INPUT_FT)
+	{
+		frame->ft_Arm = ctrl_ABLE->FT_sample_Arm;
+		frame->ft_Wrist = ctrl_ABLE->FT_sample_Wrist;
+	}
+	recorder.header.nb_frames++;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| replay_CloseCapture - Write the captured session and release its memory
+|
+| Syntax --
+|	int replay_CloseCapture(FILE* err_file, FILE* out_file, const char* file_name)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	const char* file_name -> name of the capture file
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Nothing captured ; -1 : File not written
+----------------------------------------------------------------------------------------------------------------------*/
+int replay_CloseCapture(FILE* err_file, FILE* out_file, const char* file_name)
+{
+	// Initialise variables
+	FILE* capture_file = NULL;
+	int status = 0;
+
+	if (recorder.frames == NULL)
+	{
+		return 1;
+	}
+	fopen_s(&capture_file, file_name, "wb");
+	if (capture_file == NULL)
+	{
+		fprintf(err_file, "Capture file %s not opened !\n", file_name);
+		status = -1;
+	} else
+	{
+		if (fwrite(&recorder.header, sizeof(replay_Header), 1, capture_file) != 1 ||
+			fwrite(recorder.frames, sizeof(replay_Frame), recorder.header.nb_frames, capture_file) !=
+			(size_t)recorder.header.nb_frames)
+		{
+			fprintf(err_file, "Capture file %s not written !\n", file_name);
+			status = -1;
+		}
+		fclose(capture_file);
+	}
+	if (status == 0)
+	{
+		fprintf(out_file, "Session captured in %s : %i iterations%s\n", file_name, recorder.header.nb_frames,
+			    recorder.header.truncated ? " (capture full before the end of the session)" : "");
+	}
+	storage_Free(recorder.frames, recorder.capacity * sizeof(replay_Frame));
+	recorder.frames = NULL;
+	recorder.capacity = 0;
+	return status;
+}
+
+// ------------------------------------------------------ REPLAY -------------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| replay_Load - Read a session written by replay_CloseCapture
+|
+| Syntax --
+|	int replay_Load(FILE* err_file, const char* file_name, replay_Capture* capture)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	const char* file_name -> name of the capture file
+|	replay_Capture* capture -> filled with the captured session
+|
+| Outputs --
+|	int -> 0 : Success ; -1 : File not opened, not a capture of this version or incomplete
+----------------------------------------------------------------------------------------------------------------------*/
+int replay_Load(FILE* err_file, const char* file_name, replay_Capture* capture)
+{
+	// Initialise variables
+	FILE* capture_file = NULL;
+	int status = 0;
+
+	fopen_s(&capture_file, file_name, "rb");
+	if (capture_file == NULL)
+	{
+		fprintf(err_file, "Capture file %s not opened !\n", file_name);
+		return -1;
+	}
+	if (fread(&capture->header, sizeof(replay_Header), 1, capture_file) != 1 ||
+		memcmp(capture->header.magic, REPLAY_MAGIC, sizeof(capture->header.magic)) != 0 ||
+		capture->header.version != REPLAY_VERSION || capture->header.frame_size != sizeof(replay_Frame) ||
+		capture->header.nb_frames < 0)
+	{
+		fprintf(err_file, "%s is not a capture of this version (%s, version %i)\n", file_name, REPLAY_MAGIC,
+			    REPLAY_VERSION);
+		status = -1;
+	} else
+	{
+		capture->frames.resize(capture->header.nb_frames);
+		if (capture->header.nb_frames > 0 &&
+			fread(capture->frames.data(), sizeof(replay_Frame), capture->header.nb_frames, capture_file) !=
+			(size_t)capture->header.nb_frames)
+		{
+			fprintf(err_file, "Capture file %s incomplete\n", file_name);
+			status = -1;
+		}
+	}
+	fclose(capture_file);
+	return status;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| replay_ApplyHeader - Set the parameters received from the drive before the captured session
+|
+| Syntax --
+|	int replay_ApplyHeader(FILE* err_file, const replay_Header* header, AbleControlStruct* ctrl_ABLE)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	const replay_Header* header -> header of the captured session
+|	AbleControlStruct* ctrl_ABLE -> control struct, set from the same input data as the captured session
+|
+| Outputs --
+|	int -> 0 : Success ; -1 : Control type or rate different from the captured session
+----------------------------------------------------------------------------------------------------------------------*/
+int replay_ApplyHeader(FILE* err_file, const replay_Header* header, AbleControlStruct* ctrl_ABLE)
+{
+	// Extract substructs
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+	RobotState* state = &ctrl_ABLE->state;
+
+	if (header->ctrl_type != ctrl_ABLE->aOrders.ctrl_type || header->sampling_frequency != rtValues->sampling_frequency)
+	{
+		fprintf(err_file, "Captured session of control type %i at %f s, input data give control type %i at %f s\n",
+			    header->ctrl_type, header->sampling_frequency, ctrl_ABLE->aOrders.ctrl_type,
+			    rtValues->sampling_frequency);
+		return -1;
+	}
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		ctrl_ABLE->mParams.offset_ADC[i] = header->offset_ADC[i];
+		state->coder[i] = header->coder_position[i];
+	}
+	rtValues->able_Calibrated = header->able_Calibrated;
+	rtValues->able_Connected = true;
+	rtValues->able_RealTimeCommand = true;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| replay_Cycle - Replay one captured iteration as the control loop runs it
+|
+| Syntax --
+|	int replay_Cycle(ThreadInformations* ableInfos, const replay_Frame* frame, replay_Command* command)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
+|	const replay_Frame* frame -> captured iteration
+|	replay_Command* command -> filled with the orders sent at the start of the iteration
+|
+| Outputs --
+|	int -> value of switch_OrderReached, 0 when the session ends at this iteration
+|
+| Remarks --
+|	Same sequence as able_UpdateRealTimeProcess, the exchanges with the drive and the sensor threads being replaced by
+|	the captured values : saturation of the orders, state frame, QTM and FT inputs, deadman buttons, slider estimation,
+|	orders computation (able_UpdateOrders, able_SelectAdaptedControl) and check of the order.
+----------------------------------------------------------------------------------------------------------------------*/
+int replay_Cycle(ThreadInformations* ableInfos, const replay_Frame* frame, replay_Command* command)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+
+	// Orders of the previous iteration, saturated before their sending
+	sature_SpeedOrders(ableInfos);
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		command->speedOrder[i] = ctrl_ABLE->aOrders.speedOrder[i];
+		command->inhibition_State[i] = ctrl_ABLE->mParams.inhibition_State[i];
+	}
+
+	// State frame, stamped as during the session
+	rtValues->able_OrderNotTransmitted = frame->order_not_transmitted != 0;
+	rtValues->cycle_dt = frame->cycle_dt;
+	rtValues->elapsed_time += rtValues->cycle_dt;
+	rtValues->state_tick = frame->state_tick;
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		ableInfos->eth_ABLE->moteur[i].Position_Codeur = frame->axes[i].coder;
+		ableInfos->eth_ABLE->moteur[i].Vitesse_Filtree = frame->axes[i].speed;
+		ableInfos->eth_ABLE->moteur[i].ADC_Courant = frame->axes[i].adc_current;
+		ableInfos->eth_ABLE->moteur[i].ADC_Potentiometre = frame->axes[i].adc_voltage;
+	}
+	ableInfos->eth_ABLE->entree_tor = frame->entree_tor;
+	state_Update(ableInfos);
+
+	// Measures of the sensor threads
+	if (frame->inputs & REPLAY_INPUT_QTM)
+	{
+		ctrl_ABLE->qtmLink.input = frame->qtm;
+		qtm_ApplyInput(ctrl_ABLE, &ctrl_ABLE->qtmLink.input);
+	}
+	if (frame->inputs & REPLAY_INPUT_FT)
+	{
+		ctrl_ABLE->FT_sample_Arm = frame->ft_Arm;
+		ctrl_ABLE->FT_sample_Wrist = frame->ft_Wrist;
+		digitalFT_ApplySamples(ableInfos);
+	}
+
+	// Orders of the next iteration
+	deadman_CheckButtons(ableInfos);
+	qtm_EstimateSlider(ctrl_ABLE);
+	able_UpdateOrders(ableInfos);
+	return switch_OrderReached(ableInfos);
+}
+
+// Orders of an iteration in a text file : iteration, speed orders, inhibition states
+static void replay_WriteCommand(FILE* file, int iter_counter, const replay_Command* command)
+{
+	fprintf(file, "%i", iter_counter);
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		fprintf(file, " ; %.9g", command->speedOrder[i]);
+	}
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		fprintf(file, " ; %i", command->inhibition_State[i]);
+	}
+	fprintf(file, "\n");
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| replay_Run - Replay a captured session and compare the orders with the captured ones
+|
+| Syntax --
+|	int replay_Run(ThreadInformations* ableInfos, const replay_Capture* capture, const replay_Window* window)
+|
+| Inputs --
+|	ThreadInformations* ableInfos -> informations struct, prepared as before the control loop (replay_ApplyHeader)
+|	const replay_Capture* capture -> captured session
+|	const replay_Window* window -> iterations replayed repeatedly after the whole session
+|
+| Outputs --
+|	int -> 0 : Same orders as the captured session ; 1 : Different orders ; -1 : Files not opened
+|
+| Remarks --
+|	The orders are compared bit by bit and written in REPLAY_RECORDED_FILE and REPLAY_REPLAYED_FILE, one line per
+|	iteration, to be compared with any diff tool. The control struct is copied at the start of the window, each
+|	repetition restarts from this copy. Only the replayed cycles are timed, not the writing of the orders.
+----------------------------------------------------------------------------------------------------------------------*/
+int replay_Run(ThreadInformations* ableInfos, const replay_Capture* capture, const replay_Window* window)
+{
+	// Extract substructs
+	AbleControlStruct* ctrl_ABLE = ableInfos->ctrl_ABLE;
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+
+	// Initialise variables
+	FILE* recorded_file = NULL;
+	FILE* replayed_file = NULL;
+	AbleControlStruct* snapshot = NULL;
+	replay_Command command;
+	const replay_Frame* frame;
+	int nb_frames = capture->header.nb_frames, nb_replayed = 0, nb_different = 0, first_different = -1;
+	int first = window->first, last = window->last < 0 ? nb_frames - 1 : window->last, ended = 0;
+	long long start_tick, cycle_ticks, total_ticks = 0, min_ticks = 0, max_ticks = 0, window_ticks = 0;
+	long long nb_window_cycles = 0;
+	int nb_passes = 1;
+	float max_difference = 0.0f;
+
+	fopen_s(&recorded_file, REPLAY_RECORDED_FILE, "w");
+	fopen_s(&replayed_file, REPLAY_REPLAYED_FILE, "w");
+	if (recorded_file == NULL || replayed_file == NULL)
+	{
+		fprintf(ableInfos->err_file, "Replay files %s and %s not opened !\n", REPLAY_RECORDED_FILE,
+			    REPLAY_REPLAYED_FILE);
+		if (recorded_file != NULL) { fclose(recorded_file); }
+		if (replayed_file != NULL) { fclose(replayed_file); }
+		return -1;
+	}
+	last = last >= nb_frames ? nb_frames - 1 : last;
+
+	// Whole session
+	rtValues->iter_counter = 0;
+	rtValues->elapsed_time = 0.0;
+	for (int k(0); k < nb_frames && !ended && rtValues->able_RealTimeCommand; k++)
+	{
+		frame = &capture->frames[k];
+		if (k == first && first <= last && window->repeats > 1)
+		{
+			snapshot = new AbleControlStruct(*ctrl_ABLE);
+		}
+		start_tick = timebase_Now();
+		ended = replay_Cycle(ableInfos, frame, &command) == 0;
+		cycle_ticks = timebase_Now() - start_tick;
+		total_ticks += cycle_ticks;
+		if (k >= first && k <= last)
+		{
+			min_ticks = nb_window_cycles == 0 || cycle_ticks < min_ticks ? cycle_ticks : min_ticks;
+			max_ticks = cycle_ticks > max_ticks ? cycle_ticks : max_ticks;
+			window_ticks += cycle_ticks;
+			nb_window_cycles++;
+		}
+
+		// Orders compared bit by bit
+		if (memcmp(&command, &frame->command, sizeof(replay_Command)) != 0)
+		{
+			first_different = nb_different == 0 ? frame->iter_counter : first_different;
+			nb_different++;
+			for (int i(0); i < NB_MOTORS; i++)
+			{
+				max_difference = fmaxf(max_difference, fabsf(command.speedOrder[i] - frame->command.speedOrder[i]));
+			}
+		}
+		replay_WriteCommand(recorded_file, frame->iter_counter, &frame->command);
+		replay_WriteCommand(replayed_file, rtValues->iter_counter, &command);
+		rtValues->iter_counter++;
+		nb_replayed++;
+	}
+	fclose(recorded_file);
+	fclose(replayed_file);
+
+	// Window replayed from the copy of its first iteration
+	for (int r(1); snapshot != NULL && r < window->repeats; r++)
+	{
+		// Controllers and orders restored, the measures stored out of the struct are not
+		*ctrl_ABLE = *snapshot;
+		for (int k(first); k <= last && k < nb_replayed; k++)
+		{
+			start_tick = timebase_Now();
+			replay_Cycle(ableInfos, &capture->frames[k], &command);
+			cycle_ticks = timebase_Now() - start_tick;
+			min_ticks = cycle_ticks < min_ticks ? cycle_ticks : min_ticks;
+			max_ticks = cycle_ticks > max_ticks ? cycle_ticks : max_ticks;
+			window_ticks += cycle_ticks;
+			nb_window_cycles++;
+			rtValues->iter_counter++;
+		}
+		nb_passes++;
+	}
+	delete snapshot;
+
+	// Report
+	fprintf(ableInfos->out_file, "Replay : %i of %i captured iterations replayed in %.3f s (%.1f s captured)\n",
+		    nb_replayed, nb_frames, timebase_Seconds(total_ticks), nb_replayed * capture->header.sampling_frequency);
+	if (nb_replayed < nb_frames)
+	{
+		fprintf(ableInfos->out_file, "Replay : orders computation ended at iteration %i, before the capture\n",
+			    nb_replayed - 1);
+	}
+	if (capture->header.truncated)
+	{
+		fprintf(ableInfos->out_file, "Replay : capture full before the end of the session\n");
+	}
+	if (nb_different == 0)
+	{
+		fprintf(ableInfos->out_file, "Replay : orders identical to the captured session\n");
+	} else
+	{
+		fprintf(ableInfos->out_file, "Replay : %i iterations with different orders, first at iteration %i "
+			    "(largest speed order difference %g)\n", nb_different, first_different, max_difference);
+	}
+	if (nb_window_cycles > 0)
+	{
+		fprintf(ableInfos->out_file, "Replay window [%i, %i] : %i passes, %.2f us mean, %.2f us min, %.2f us max "
+			    "per iteration\n", first, last, nb_passes,
+			    timebase_Seconds(window_ticks) * 1e6 / nb_window_cycles, timebase_Seconds(min_ticks) * 1e6,
+			    timebase_Seconds(max_ticks) * 1e6);
+	}
+	fprintf(ableInfos->out_file, "Replayed orders written in %s (captured orders in %s)\n", REPLAY_REPLAYED_FILE,
+		    REPLAY_RECORDED_FILE);
+	fflush(ableInfos->out_file);
+	return nb_different == 0 ? 0 : 1;
+}
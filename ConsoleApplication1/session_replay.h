@@ -0,0 +1,128 @@
+/***********************************************************************************************************************
+* session_replay.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the capture and replay of the control sessions. During a captured session the control
+* thread records every input of each iteration (drive state frame with the deadman bits, FT samples, QTM measures and
+* EMG events, time stamps) and the orders sent to ABLE. The replay feeds the captured inputs to the orders computation
+* of the current code in the same order, as fast as possible, and compares the orders it obtains with the captured
+* ones. A window of iterations can be replayed repeatedly to profile it.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef SESSION_REPLAY_H
+#define SESSION_REPLAY_H
+
+// General includes
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+// Project includes
+#include "handle_communication.h"
+#include "session_storage.h"
+#include "time_base.h"
+
+// Replay modes (rtParams.replay_mode)
+#define REPLAY_OFF 0									// Session neither captured nor replayed
+#define REPLAY_CAPTURE 1								// Inputs and orders of the session captured
+#define REPLAY_PLAY 2									// Captured session replayed instead of driving ABLE
+// Replay files
+#define REPLAY_CAPTURE_FILE "session_capture.bin"		// Captured session
+#define REPLAY_RECORDED_FILE "replay_recorded.txt"		// Orders sent during the captured session
+#define REPLAY_REPLAYED_FILE "replay_replayed.txt"		// Orders computed by the replay
+#define REPLAY_MAGIC "ABRP"								// Identifier of the captured sessions
+#define REPLAY_VERSION 1								// Version of the replay_Frame layout
+// Capture limits
+#define REPLAY_MAX_SECONDS 300.0f						// Captured duration of the sessions without fixed duration (s)
+#define REPLAY_EXTRA_FRAMES 16							// Frames captured after the expected end of the session
+// Inputs read during an iteration (replay_Frame.inputs)
+#define REPLAY_INPUT_QTM 1								// QTM mailbox read (qtm_ReadData)
+#define REPLAY_INPUT_FT 2								// FT samples read (digitalFT_ReadData)
+
+// ------------------------------------------------- CAPTURE HEADER ----------------------------------------------------
+// Parameters of the session set before the control loop from the drive
+struct replay_Header
+{
+	char magic[4];								// REPLAY_MAGIC
+	unsigned int version;						// REPLAY_VERSION
+	unsigned int frame_size;					// sizeof(replay_Frame)
+	int nb_frames;								// Number of captured iterations
+	int truncated;								// 1 : capture stopped before the end of the session
+	int ctrl_type;								// Control type of the session
+	float sampling_frequency;					// Nominal period of the control loop (s)
+	float offset_ADC[NB_MOTORS];				// Current offsets received from the drive
+	int coder_position[NB_MOTORS];				// Coder positions before the control loop
+	int able_Calibrated;						// Calibration state of the drive
+};
+
+// ------------------------------------------------- CAPTURED ORDERS ---------------------------------------------------
+struct replay_Command
+{
+	float speedOrder[NB_MOTORS];				// Saturated speed orders sent to the drive
+	int inhibition_State[NB_MOTORS];			// Inhibition state sent to the drive
+};
+
+// -------------------------------------------------- CAPTURED AXIS ----------------------------------------------------
+struct replay_Axis
+{
+	int coder;									// Position_Codeur of the state frame
+	float speed;								// Vitesse_Filtree of the state frame
+	float adc_current;							// ADC_Courant of the state frame
+	float adc_voltage;							// ADC_Potentiometre of the state frame
+};
+
+// ------------------------------------------------- CAPTURED ITERATION ------------------------------------------------
+struct replay_Frame
+{
+	int iter_counter;							// Iteration of the control loop
+	int inputs;									// REPLAY_INPUT_ values read during the iteration
+	int order_not_transmitted;					// 1 : state frame not received (check_OrderTransmission)
+	int entree_tor;								// Digital inputs of the drive (deadman buttons)
+	long long state_tick;						// Tick of the state frame (able_StampStateFrame)
+	float cycle_dt;								// Bounded duration of the iteration (able_StampStateFrame)
+	replay_Command command;						// Orders sent at the start of the iteration
+	replay_Axis axes[NB_MOTORS];				// State frame of the drive
+	qtm_input qtm;								// Values read from the QTM mailbox
+	FT_meas_Global ft_Arm;						// Sample of the arm FT thread
+	FT_meas_Global ft_Wrist;					// Sample of the wrist FT thread
+};
+
+// ---------------------------------------------------- RECORDER -------------------------------------------------------
+struct replay_Recorder
+{
+	replay_Header header;						// Header written before the frames
+	replay_Frame* frames;						// Captured iterations, committed before the control loop
+	int capacity;								// Number of frames allocated
+};
+
+// ------------------------------------------------- LOADED CAPTURE ----------------------------------------------------
+struct replay_Capture
+{
+	replay_Header header;						// Header of the captured session
+	std::vector<replay_Frame> frames;			// Captured iterations
+};
+
+// ------------------------------------------------- REPLAYED WINDOW ---------------------------------------------------
+struct replay_Window
+{
+	int first;									// First iteration of the window
+	int last;									// Last iteration of the window (-1 : last captured iteration)
+	int repeats;								// Number of replays of the window
+};
+
+// Capture functions (control thread)
+int replay_OpenCapture(FILE* err_file, FILE* out_file, const AbleControlStruct* ctrl_ABLE);
+void replay_CaptureCommand(const AbleControlStruct* ctrl_ABLE);
+void replay_CaptureInputs(ThreadInformations* ableInfos, int inputs);
+int replay_CloseCapture(FILE* err_file, FILE* out_file, const char* file_name);
+
+// Replay functions
+int replay_Load(FILE* err_file, const char* file_name, replay_Capture* capture);
+int replay_ApplyHeader(FILE* err_file, const replay_Header* header, AbleControlStruct* ctrl_ABLE);
+int replay_Run(ThreadInformations* ableInfos, const replay_Capture* capture, const replay_Window* window);
+int replay_Cycle(ThreadInformations* ableInfos, const replay_Frame* frame, replay_Command* command);
+#endif // !SESSION_REPLAY_H
\ No newline at end of file
@@ -0,0 +1,320 @@
+/***********************************************************************************************************************
+* session_storage.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Allocates the session buffers in committed, touched and locked regions (large pages when available) and counts the
+* page faults taken during the control loop.
+***********************************************************************************************************************/
+
+#include "session_storage.h"
+#include "alloc_tracker.h"
+#include <atomic>
+
+// ------------------------------------------------ SESSION STORAGE STRUCT ---------------------------------------------
+struct session_Storage
+{
+	SIZE_T page_size;									// Size of a normal page (bytes)
+	SIZE_T large_page_size;								// Size of a large page (bytes), 0 : large pages not available
+	std::atomic<long long> nb_regions;					// Regions currently allocated
+	std::atomic<long long> large_bytes;					// Bytes allocated in large pages
+	std::atomic<long long> locked_bytes;				// Bytes allocated in locked normal pages
+	std::atomic<long long> unlocked_bytes;				// Bytes committed and touched, but that could not be locked
+};
+
+// Storage of the process, initialised by the main thread before any session vector is reserved
+static session_Storage storage = {};
+
+// ---------------------------------------------------- STORAGE FUNCTIONS ----------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| storage_Init - Get the page sizes and the privilege needed by large pages
+|
+| Syntax --
+|	int storage_Init(FILE* err_file, FILE* out_file)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|
+| Outputs --
+|	int -> 0 : large pages available ; 1 : normal pages, locked in the working set
+|
+| Remarks --
+|	Large pages need SeLockMemoryPrivilege in the account ("Lock pages in memory" local policy). Without it the
+|	regions are made of normal pages, touched then locked, which removes the faults but not the TLB misses.
+----------------------------------------------------------------------------------------------------------------------*/
+int storage_Init(FILE* err_file, FILE* out_file)
+{
+	// Initialise variables
+	SYSTEM_INFO system_info;
+	TOKEN_PRIVILEGES privileges;
+	HANDLE token;
+	BOOL granted = FALSE;
+
+	GetSystemInfo(&system_info);
+	storage.page_size = system_info.dwPageSize;
+	storage.large_page_size = 0;
+
+	// Enable the privilege of the account, if it holds it
+	if (OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+	{
+		privileges.PrivilegeCount = 1;
+		privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+		if (LookupPrivilegeValueA(NULL, STORAGE_LOCK_PRIVILEGE, &privileges.Privileges[0].Luid) &&
+			AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL))
+		{
+			granted = (GetLastError() == ERROR_SUCCESS);
+		}
+		CloseHandle(token);
+	}
+	if (granted)
+	{
+		storage.large_page_size = GetLargePageMinimum();
+	}
+	if (storage.large_page_size == 0)
+	{
+		fprintf(err_file, "Large pages not available (%s not held), session buffers in locked %zu B pages\n",
+			    STORAGE_LOCK_PRIVILEGE, (size_t)storage.page_size);
+		return 1;
+	}
+	fprintf(out_file, "Session buffers in large pages of %zu kB\n", (size_t)(storage.large_page_size / 1024));
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| storage_Allocate - Allocate a region resident in memory
+|
+| Syntax --
+|	void* storage_Allocate(size_t nb_bytes)
+|
+| Inputs --
+|	size_t nb_bytes -> size of the region (bytes)
+|
+| Outputs --
+|	void* -> region, NULL if the memory could not be committed
+|
+| Remarks --
+|	Regions of at least one large page are allocated in large pages, which are always resident. Otherwise, every page
+|	is touched and the region is locked after growing the working set by its size. A region that cannot be locked is
+|	kept (touched, but may be trimmed) and counted in the report.
+----------------------------------------------------------------------------------------------------------------------*/
+void* storage_Allocate(size_t nb_bytes)
+{
+	// Initialise variables
+	SYSTEM_INFO system_info;
+	SIZE_T size, working_min, working_max;
+	void* region = NULL;
+
+	alloc_Record(ALLOC_EVENT_STORAGE, nb_bytes);
+	if (nb_bytes == 0)
+	{
+		nb_bytes = 1;
+	}
+	// Normal pages if storage_Init was not called (benchmarks)
+	if (storage.page_size == 0)
+	{
+		GetSystemInfo(&system_info);
+		storage.page_size = system_info.dwPageSize;
+	}
+
+	// Large pages, size rounded to a multiple of the large page
+	if (storage.large_page_size != 0 && nb_bytes >= storage.large_page_size)
+	{
+		size = (nb_bytes + storage.large_page_size - 1) / storage.large_page_size * storage.large_page_size;
+		region = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (region != NULL)
+		{
+			storage.large_bytes += size;
+			storage.nb_regions++;
+			return region;
+		}
+	}
+
+	// Normal pages, touched then locked
+	size = (nb_bytes + storage.page_size - 1) / storage.page_size * storage.page_size;
+	region = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (region == NULL)
+	{
+		return NULL;
+	}
+	for (SIZE_T i(0); i < size; i += storage.page_size)
+	{
+		((volatile char*)region)[i] = 0;
+	}
+	if (GetProcessWorkingSetSize(GetCurrentProcess(), &working_min, &working_max) &&
+		SetProcessWorkingSetSize(GetCurrentProcess(), working_min + size, working_max + size) &&
+		VirtualLock(region, size))
+	{
+		storage.locked_bytes += size;
+	}
+	else
+	{
+		storage.unlocked_bytes += size;
+	}
+	storage.nb_regions++;
+	return region;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| storage_Free - Release a region allocated by storage_Allocate
+|
+| Syntax --
+|	void storage_Free(void* region, size_t nb_bytes)
+|
+| Inputs --
+|	void* region -> region to release
+|	size_t nb_bytes -> size requested at the allocation (bytes)
+|
+| Remarks --
+|	The counter the region was added to (large pages, locked or not locked) is found from the state of its first page,
+|	and the working set grown by storage_Allocate for a locked region is shrunk back.
+----------------------------------------------------------------------------------------------------------------------*/
+void storage_Free(void* region, size_t nb_bytes)
+{
+	// Initialise variables
+	PSAPI_WORKING_SET_EX_INFORMATION page = {};
+	SIZE_T size, working_min, working_max;
+
+	alloc_Record(ALLOC_EVENT_STORAGE_FREE, 0);
+	if (region == NULL)
+	{
+		return;
+	}
+	if (nb_bytes == 0)
+	{
+		nb_bytes = 1;
+	}
+	page.VirtualAddress = region;
+	QueryWorkingSetEx(GetCurrentProcess(), &page, sizeof(page));
+	if (!VirtualFree(region, 0, MEM_RELEASE))
+	{
+		return;
+	}
+	storage.nb_regions--;
+
+	// Same size as counted by storage_Allocate
+	if (page.VirtualAttributes.LargePage)
+	{
+		storage.large_bytes -= (nb_bytes + storage.large_page_size - 1) / storage.large_page_size *
+			                   storage.large_page_size;
+		return;
+	}
+	size = (nb_bytes + storage.page_size - 1) / storage.page_size * storage.page_size;
+	if (!page.VirtualAttributes.Locked)
+	{
+		storage.unlocked_bytes -= size;
+		return;
+	}
+	storage.locked_bytes -= size;
+	if (GetProcessWorkingSetSize(GetCurrentProcess(), &working_min, &working_max) && working_min > size)
+	{
+		SetProcessWorkingSetSize(GetCurrentProcess(), working_min - size, working_max - size);
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| storage_PrintReport - Print the memory allocated for the session buffers
+|
+| Syntax --
+|	void storage_PrintReport(FILE* out_file)
+|
+| Inputs --
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+----------------------------------------------------------------------------------------------------------------------*/
+void storage_PrintReport(FILE* out_file)
+{
+	fprintf(out_file, "Session buffers : %lld regions, %.1f MB in large pages, %.1f MB locked, %.1f MB not locked\n",
+		    storage.nb_regions.load(), storage.large_bytes.load() / 1048576.0, storage.locked_bytes.load() / 1048576.0,
+		    storage.unlocked_bytes.load() / 1048576.0);
+}
+
+// ------------------------------------------------- PAGE FAULTS FUNCTIONS ---------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| storage_InitFaults - Reset the page faults statistics before the control loop
+|
+| Syntax --
+|	void storage_InitFaults(storage_Faults* faults)
+|
+| Inputs --
+|	storage_Faults* faults -> statistics to reset
+----------------------------------------------------------------------------------------------------------------------*/
+void storage_InitFaults(storage_Faults* faults)
+{
+	// Initialise variables
+	PROCESS_MEMORY_COUNTERS counters;
+
+	memset(faults, 0, sizeof(storage_Faults));
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		faults->last_count = counters.PageFaultCount;
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| storage_SampleFaults - Count the page faults taken since the previous iteration
+|
+| Syntax --
+|	void storage_SampleFaults(storage_Faults* faults, int iter_counter)
+|
+| Inputs --
+|	storage_Faults* faults -> statistics to update
+|	int iter_counter -> current iteration of the control loop
+|
+| Remarks --
+|	The counter is the one of the process (hard and soft faults of every thread) : faults of the FT and QTM threads
+|	delay the control loop as well.
+----------------------------------------------------------------------------------------------------------------------*/
+void storage_SampleFaults(storage_Faults* faults, int iter_counter)
+{
+	// Initialise variables
+	PROCESS_MEMORY_COUNTERS counters;
+	DWORD nb_faults;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return;
+	}
+	nb_faults = counters.PageFaultCount - faults->last_count;
+	faults->last_count = counters.PageFaultCount;
+	faults->nb_cycles++;
+	if (nb_faults == 0)
+	{
+		return;
+	}
+	faults->faulty_cycles++;
+	faults->total_faults += nb_faults;
+	if (nb_faults > faults->max_per_cycle)
+	{
+		faults->max_per_cycle = nb_faults;
+	}
+	if (faults->nb_events < STORAGE_MAX_FAULT_EVENTS)
+	{
+		faults->event_iters[faults->nb_events] = iter_counter;
+		faults->event_faults[faults->nb_events] = nb_faults;
+		faults->nb_events++;
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| storage_PrintFaults - Print the page faults taken during the control loop
+|
+| Syntax --
+|	void storage_PrintFaults(FILE* out_file, const storage_Faults* faults)
+|
+| Inputs --
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	const storage_Faults* faults -> statistics of the control loop
+----------------------------------------------------------------------------------------------------------------------*/
+void storage_PrintFaults(FILE* out_file, const storage_Faults* faults)
+{
+	fprintf(out_file, "Page faults during the control loop : %lld faults in %lld of %lld iterations (max %lu per "
+		    "iteration)\n", faults->total_faults, faults->faulty_cycles, faults->nb_cycles, faults->max_per_cycle);
+	for (int i(0); i < faults->nb_events; i++)
+	{
+		fprintf(out_file, "   iteration %i : %lu faults\n", faults->event_iters[i], faults->event_faults[i]);
+	}
+}
@@ -0,0 +1,89 @@
+/***********************************************************************************************************************
+* session_storage.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the storage of the session buffers. The measurement vectors allocate their memory through
+* session_Allocator : each reservation gets its own region, committed and touched when it is made, locked in memory
+* and backed by large pages when the account holds SeLockMemoryPrivilege. The page faults of the process are counted
+* at every iteration of the control loop, so that any fault taken during the motion is reported.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef SESSION_STORAGE_H
+#define SESSION_STORAGE_H
+
+// General includes
+#include <stdio.h>
+#include <new>
+#include <vector>
+#include <Windows.h>
+#include <psapi.h>
+
+// Storage constants
+#define STORAGE_LOCK_PRIVILEGE "SeLockMemoryPrivilege"	// Privilege needed by large pages
+#define STORAGE_MAX_FAULT_EVENTS 32						// Faulty iterations kept for the report
+
+// ----------------------------------------------- PAGE FAULTS STATISTICS STRUCT ---------------------------------------
+struct storage_Faults
+{
+	DWORD last_count;									// Page fault counter of the process at the last sample
+	long long nb_cycles;								// Iterations sampled
+	long long faulty_cycles;							// Iterations during which at least one fault was taken
+	long long total_faults;								// Faults taken during the sampled iterations
+	DWORD max_per_cycle;								// Largest number of faults during one iteration
+	int nb_events;										// Faulty iterations kept (at most STORAGE_MAX_FAULT_EVENTS)
+	int event_iters[STORAGE_MAX_FAULT_EVENTS];			// Iteration of the first faulty iterations
+	DWORD event_faults[STORAGE_MAX_FAULT_EVENTS];		// Faults taken during these iterations
+};
+
+// Storage functions
+int storage_Init(FILE* err_file, FILE* out_file);
+void* storage_Allocate(size_t nb_bytes);
+void storage_Free(void* region, size_t nb_bytes);
+void storage_PrintReport(FILE* out_file);
+
+// Page faults functions
+void storage_InitFaults(storage_Faults* faults);
+void storage_SampleFaults(storage_Faults* faults, int iter_counter);
+void storage_PrintFaults(FILE* out_file, const storage_Faults* faults);
+
+// ------------------------------------------------- SESSION ALLOCATOR -------------------------------------------------
+// Allocator of the session vectors : reserve() commits, touches and locks the whole capacity at once
+template <class T>
+struct session_Allocator
+{
+	typedef T value_type;
+
+	session_Allocator() {}
+	template <class U> session_Allocator(const session_Allocator<U>&) {}
+
+	T* allocate(size_t nb_elements)
+	{
+		void* region = storage_Allocate(nb_elements * sizeof(T));
+		if (region == NULL)
+		{
+			throw std::bad_alloc();
+		}
+		return (T*)region;
+	}
+	void deallocate(T* region, size_t nb_elements)
+	{
+		storage_Free(region, nb_elements * sizeof(T));
+	}
+};
+
+template <class T, class U>
+bool operator==(const session_Allocator<T>&, const session_Allocator<U>&) { return true; }
+template <class T, class U>
+bool operator!=(const session_Allocator<T>&, const session_Allocator<U>&) { return false; }
+
+// Session vectors
+typedef std::vector<float, session_Allocator<float> > session_floats;
+typedef std::vector<double, session_Allocator<double> > session_doubles;
+typedef std::vector<long long, session_Allocator<long long> > session_ticks;
+typedef std::vector<int16_t, session_Allocator<int16_t> > session_gauges;
+#endif // !SESSION_STORAGE_H
\ No newline at end of file
@@ -9,6 +9,8 @@
 ***********************************************************************************************************************/
 
 #include "set_ABLEParameters.h"
+#include <cmath>
+#include <string.h>
 
 
 // ------------------------------------------------- CENTRALISED FUNCTION ----------------------------------------------
@@ -171,8 +173,249 @@ void set_IdentifiedDynamics(AbleControlStruct* ctrl_ABLE)
 	ax4_mod->cm_top[0] = 0.0022253f;
 	ax4_mod->cm_top[1] = -0.63042f;
 	ax4_mod->cm_top[2] = -0.33312f;*/
-	// Identified inertia model for different speeds (Inertia not compensated while no intention detection)
-	//imds->inertia_model[0] = 0.0045f;
-	//imds->inertia_model[1] = -0.0064f;
-	//imds->inertia_model[2] = 0.0041f;
+	// Identified inertia model of axis 4 (compensated by the RNEA backend only), axis 3 and rotors not identified
+	ax4_mod->inertias4.inertia_model[0] = 0.0045f;
+	ax4_mod->inertias4.inertia_model[1] = -0.0064f;
+	ax4_mod->inertias4.inertia_model[2] = 0.0041f;
+	for (int i(0); i < 3; i++)
+	{
+		ax3_mod->inertias3.inertia_model[i] = 0.0f;
+	}
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		aDyns->rotor_inertias[i] = 0.0f;
+	}
+}
+
+// ------------------------------------------------ ROBOT DYNAMICS FILES -----------------------------------------------
+
+// Named entry of the robot dynamics text file ("key value [value ...]" per line)
+struct able_dynParam
+{
+	const char* key;						// Name of the parameter in the text file
+	float* values;							// Values in the dynamics struct
+	int nb_values;							// Number of values
+	int optional;							// 1 : built-in values kept if missing (added after the first files)
+};
+
+// Build the table of the named parameters of a dynamics struct (x_slider is estimated online and not stored)
+static void able_DynParamsTable(ableDynamics* aDyns, able_dynParam* table)
+{
+	able_Axis3_model* ax3_mod = &aDyns->axis3_mod;
+	able_Axis4_model* ax4_mod = &aDyns->axis4_mod;
+	able_dynParam entries[ROBOT_DYN_PARAMS] = {
+		{ "adhfric3", &ax3_mod->frictions3.adhfric, 1, 0 },
+		{ "dry_frics3", ax3_mod->frictions3.dry_frics, 2, 0 },
+		{ "visc_frics3", ax3_mod->frictions3.visc_frics, 2, 0 },
+		{ "length3", &ax3_mod->length3, 1, 0 },
+		{ "gm_stat3", ax3_mod->gm_stat, 2, 0 },
+		{ "gm_top3", ax3_mod->gm_top, 2, 0 },
+		{ "gm_bot3", ax3_mod->gm_bot, 2, 0 },
+		{ "adhfric4", &ax4_mod->frictions4.adhfric, 1, 0 },
+		{ "dry_frics4", ax4_mod->frictions4.dry_frics, 2, 0 },
+		{ "visc_frics4", ax4_mod->frictions4.visc_frics, 2, 0 },
+		{ "mass4", &ax4_mod->mass4, 1, 0 },
+		{ "cm_stat4", ax4_mod->cm_stat, 3, 0 },
+		{ "cm_top4", ax4_mod->cm_top, 3, 0 },
+		{ "cm_bot4", ax4_mod->cm_bot, 3, 0 },
+		{ "inertia3", ax3_mod->inertias3.inertia_model, 3, 1 },
+		{ "inertia4", ax4_mod->inertias4.inertia_model, 3, 1 },
+		{ "rotor_inertias", aDyns->rotor_inertias, NB_MOTORS, 1 } };
+	memcpy(table, entries, sizeof(entries));
+}
+
+// Print the parameters at their built-in value (bit per entry of the table), nothing if all were supplied
+static void able_PrintDefaultParams(FILE* out_file, unsigned int defaults)
+{
+	able_dynParam table[ROBOT_DYN_PARAMS];
+	ableDynamics aDyns;
+
+	if (defaults == 0)
+	{
+		return;
+	}
+	able_DynParamsTable(&aDyns, table);
+	fprintf(out_file, "Robot dynamics at built-in values :");
+	for (int param(0); param < ROBOT_DYN_PARAMS; param++)
+	{
+		if (defaults & (1u << param))
+		{
+			fprintf(out_file, " %s", table[param].key);
+		}
+	}
+	fprintf(out_file, "\n");
+}
+
+// Copy the parameters that are not marked as defaults (bit per entry of the table) from a dynamics struct to another
+static void able_ApplySuppliedParams(ableDynamics* aDyns, ableDynamics* supplied, unsigned int defaults)
+{
+	able_dynParam table[ROBOT_DYN_PARAMS], supplied_table[ROBOT_DYN_PARAMS];
+
+	able_DynParamsTable(aDyns, table);
+	able_DynParamsTable(supplied, supplied_table);
+	for (int param(0); param < ROBOT_DYN_PARAMS; param++)
+	{
+		if (!(defaults & (1u << param)))
+		{
+			memcpy(table[param].values, supplied_table[param].values, table[param].nb_values * sizeof(float));
+		}
+	}
+}
+
+// Parse a robot dynamics text file (0 : Success ; 1 : File not opened ; 2 : Invalid or incomplete file), the optional
+// parameters missing in the file keep their built-in values and are marked in defaults
+static int able_ImportRobotDynamics(FILE* err_file, ableDynamics* aDyns, const char* file_name, unsigned int* defaults)
+{
+	// Initialise variables
+	able_dynParam table[ROBOT_DYN_PARAMS];
+	int found[ROBOT_DYN_PARAMS] = { 0 };
+	char key[32];
+	FILE* dyn_file = NULL;
+	int status = 0, param;
+
+	able_DynParamsTable(aDyns, table);
+	*defaults = ROBOT_DYN_ALL_DEFAULTS;
+	fopen_s(&dyn_file, file_name, "rt");
+	if (dyn_file == NULL)
+	{
+		return 1;
+	}
+	while (status == 0 && fscanf(dyn_file, "%31s", key) == 1)
+	{
+		for (param = 0; param < ROBOT_DYN_PARAMS && strcmp(key, table[param].key) != 0; param++) {}
+		if (param == ROBOT_DYN_PARAMS)
+		{
+			fprintf(err_file, "Unknown robot dynamics parameter %s in %s\n", key, file_name);
+			status = 2;
+			break;
+		}
+		for (int i(0); i < table[param].nb_values; i++)
+		{
+			if (fscanf(dyn_file, "%f", &table[param].values[i]) != 1 || !isfinite(table[param].values[i]))
+			{
+				fprintf(err_file, "Invalid value of robot dynamics parameter %s in %s\n", key, file_name);
+				status = 2;
+				break;
+			}
+		}
+		found[param] = 1;
+		*defaults &= ~(1u << param);
+	}
+	fclose(dyn_file);
+	for (param = 0; status == 0 && param < ROBOT_DYN_PARAMS; param++)
+	{
+		if (!found[param] && !table[param].optional)
+		{
+			fprintf(err_file, "Robot dynamics parameter %s missing in %s\n", table[param].key, file_name);
+			status = 2;
+		}
+	}
+	return status;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------
+| able_ExportRobotDynamics - Write the robot dynamics in a text file and its binary sidecar
+|
+| Syntax --
+|	int able_ExportRobotDynamics(FILE* err_file, AbleControlStruct* ctrl_ABLE, const char* file_name,
+|	                             unsigned int defaults)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	AbleControlStruct* ctrl_ABLE -> Struct containing all ABLE informations
+|	const char* file_name -> name of the text file
+|	unsigned int defaults -> parameters at their built-in value (bit per entry of the file), marked in the sidecar
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : File not opened ; 2 : Sidecar not written
+----------------------------------------------------------------------------------------------------------------------*/
+int able_ExportRobotDynamics(FILE* err_file, AbleControlStruct* ctrl_ABLE, const char* file_name, unsigned int defaults)
+{
+	// Initialise variables
+	able_dynParam table[ROBOT_DYN_PARAMS];
+	sidecar_robotDyn payload = { ctrl_ABLE->aDynamics, defaults };
+	FILE* dyn_file = NULL;
+
+	able_DynParamsTable(&ctrl_ABLE->aDynamics, table);
+	fopen_s(&dyn_file, file_name, "w");
+	if (dyn_file == NULL)
+	{
+		fprintf(err_file, "Robot dynamics file %s not opened !\n", file_name);
+		return 1;
+	}
+	// 9 significant digits so that the text file gives back exactly the same floats
+	for (int param(0); param < ROBOT_DYN_PARAMS; param++)
+	{
+		fprintf(dyn_file, "%s", table[param].key);
+		for (int i(0); i < table[param].nb_values; i++)
+		{
+			fprintf(dyn_file, " %.9g", table[param].values[i]);
+		}
+		fprintf(dyn_file, "\n");
+	}
+	fclose(dyn_file);
+	if (sidecar_Write(err_file, file_name, SIDECAR_ROBOT_DYN, &payload, sizeof(sidecar_robotDyn)) != 0)
+	{
+		return 2;
+	}
+	return 0;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------
+| able_LoadRobotDynamics - Override the built-in robot dynamics with the ones of the robot dynamics file. The binary
+|                          sidecar is applied if it is up to date, otherwise the text file is parsed and the sidecar
+|                          rewritten. If there is no file yet, the built-in values are exported to it.
+|
+| Syntax --
+|	int able_LoadRobotDynamics(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, const char* file_name)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	AbleControlStruct* ctrl_ABLE -> Struct containing all ABLE informations
+|	const char* file_name -> name of the text file
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Invalid robot dynamics file (the robot must not move)
+|
+| Remarks --
+|	The sidecar marks the parameters the file did not supply : they take the current built-in values, not the ones of
+|	the build that wrote the sidecar. The file exported when there is none is marked as defaults only.
+----------------------------------------------------------------------------------------------------------------------*/
+int able_LoadRobotDynamics(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, const char* file_name)
+{
+	// Initialise variables
+	ableDynamics aDyns = ctrl_ABLE->aDynamics;
+	sidecar_robotDyn payload;
+	auto start = std::chrono::high_resolution_clock::now();
+	int status;
+
+	// Apply the supplied parameters of the sidecar if it is valid and up to date
+	if (sidecar_Load(err_file, file_name, SIDECAR_ROBOT_DYN, &payload, sizeof(sidecar_robotDyn)) == SIDECAR_OK)
+	{
+		able_ApplySuppliedParams(&ctrl_ABLE->aDynamics, &payload.dynamics, payload.defaults);
+		fprintf(out_file, "Robot dynamics applied from sidecar in %lld us\n", (long long)std::chrono::duration_cast
+			    <std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count());
+		able_PrintDefaultParams(out_file, payload.defaults);
+		return 0;
+	}
+
+	// Otherwise parse the text file and refresh its sidecar
+	status = able_ImportRobotDynamics(err_file, &aDyns, file_name, &payload.defaults);
+	if (status == 1)
+	{
+		fprintf(out_file, "No robot dynamics file, built-in values exported to %s\n", file_name);
+		able_ExportRobotDynamics(err_file, ctrl_ABLE, file_name, ROBOT_DYN_ALL_DEFAULTS);
+		return 0;
+	}
+	if (status != 0)
+	{
+		return 1;
+	}
+	ctrl_ABLE->aDynamics = aDyns;
+	payload.dynamics = aDyns;
+	sidecar_Write(err_file, file_name, SIDECAR_ROBOT_DYN, &payload, sizeof(sidecar_robotDyn));
+	fprintf(out_file, "Robot dynamics imported from %s\n", file_name);
+	able_PrintDefaultParams(out_file, payload.defaults);
+	return 0;
 }
\ No newline at end of file
@@ -17,6 +17,19 @@
 #include "communication_struct_ABLE.h"
 #include "control_struct.h"
 #include "motors_type_params.h"
+#include "parameter_sidecar.h"
+
+// Robot dynamics file (text import/export format, applied through its binary sidecar)
+#define ROBOT_DYNAMICS_FILE "able_dynamics.txt"
+#define ROBOT_DYN_PARAMS 17
+#define ROBOT_DYN_ALL_DEFAULTS ((1u << ROBOT_DYN_PARAMS) - 1)	// Every parameter at its built-in value
+
+// Payload of the robot dynamics sidecar (SIDECAR_ROBOT_DYN)
+struct sidecar_robotDyn
+{
+	ableDynamics dynamics;					// Robot dynamics of the session
+	unsigned int defaults;					// Bit per parameter of the file : not supplied, built-in value applied
+};
 
 // Centralised function
 void able_SetAllParams(AbleControlStruct* ctrl_ABLE);
@@ -26,4 +39,9 @@ void able_SetMotorParams(AbleControlStruct* ctrl_ABLE);
 void able_SetReductionsValues(AbleControlStruct* ctrl_ABLE);
 void able_SetMotionRanges(AbleControlStruct* ctrl_ABLE);
 void set_IdentifiedDynamics(AbleControlStruct* ctrl_ABLE);
+
+// Robot dynamics file
+int able_LoadRobotDynamics(FILE* err_file, FILE* out_file, AbleControlStruct* ctrl_ABLE, const char* file_name);
+int able_ExportRobotDynamics(FILE* err_file, AbleControlStruct* ctrl_ABLE, const char* file_name,
+	                         unsigned int defaults);
 #endif // !SET_ABLEPARAMETERS_H
\ No newline at end of file
@@ -13,8 +13,11 @@
 #ifndef SHARED_FT_STRUCT_H
 #define SHARED_FT_STRUCT_H
 
+#include "ft_stage.h"		// Header containing the force stage executed at the sensor rate
+
 // FT measures global variable struct --> for Critical section use
-struct FT_meas_Global
+// Aligned on a cache line : the arm and wrist structs are written by two threads and must not share a line
+struct alignas(64) FT_meas_Global
 {
 	BOOL streaming;
 	float fx;
@@ -23,6 +26,11 @@ struct FT_meas_Global
 	float tx;
 	float ty;
 	float tz;
+	long long tick;		// Acquisition tick of the sample (timebase_Now)
+	float filtered[FTSTAGE_NB_CHANNELS];	// Filtered wrench (force stage)
+	float derivative[FTSTAGE_NB_CHANNELS];	// Derivative of the filtered wrench (force stage)
+	double integral[FTSTAGE_NB_CHANNELS];	// Integral of the raw wrench since the start of the stream (force stage)
+	float group_delay;						// Delay of the filter of the force stage (s)
 };
 
 #endif // !SHARED_FT_STRUCT_H
\ No newline at end of file
@@ -0,0 +1,134 @@
+/***********************************************************************************************************************
+* slider_estimator.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Estimates the slider position at the rate of the control loop. The speed follows a first order Gauss-Markov model
+* driven by the acceleration noise, so that the estimate holds when the QTM measures stop. A measure of age d is
+* compared to the position predicted d seconds earlier (H = [1 -d]), which compensates its latency without storing
+* the past states.
+***********************************************************************************************************************/
+
+#include "slider_estimator.h"
+
+/*---------------------------------------------------------------------------------------------------------------------
+| slider_Init - Initialise the estimator at the position given by the user
+|
+| Syntax --
+|	void slider_Init(slider_estimator* estimator, float position)
+|
+| Inputs --
+|	slider_estimator* estimator -> estimator to initialise
+|	float position -> initial position of the slider (m)
+----------------------------------------------------------------------------------------------------------------------*/
+void slider_Init(slider_estimator* estimator, float position)
+{
+	estimator->position = position;
+	estimator->speed = 0.0f;
+	estimator->p_pp = SLIDER_INIT_POS_STD * SLIDER_INIT_POS_STD;
+	estimator->p_ps = 0.0f;
+	estimator->p_ss = SLIDER_INIT_SPEED_STD * SLIDER_INIT_SPEED_STD;
+	estimator->meas_pending = 0;
+	estimator->meas_position = 0.0f;
+	estimator->meas_delay = 0.0f;
+	estimator->nb_updates = 0;
+	estimator->nb_rejected = 0;
+	estimator->nb_overwritten = 0;
+	estimator->last_innovation = 0.0f;
+	estimator->last_delay = 0.0f;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| slider_AddMeasure - Store a measure, applied by the next call to slider_Step
+|
+| Syntax --
+|	void slider_AddMeasure(slider_estimator* estimator, float position, float delay)
+|
+| Inputs --
+|	slider_estimator* estimator -> initialised estimator
+|	float position -> measured position of the slider (m)
+|	float delay -> age of the measure (s)
+----------------------------------------------------------------------------------------------------------------------*/
+void slider_AddMeasure(slider_estimator* estimator, float position, float delay)
+{
+	if (estimator->meas_pending)
+	{
+		estimator->nb_overwritten++;
+	}
+	estimator->meas_pending = 1;
+	estimator->meas_position = position;
+	estimator->meas_delay = delay;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| slider_Step - Propagate the estimation over one iteration and apply the pending measure
+|
+| Syntax --
+|	float slider_Step(slider_estimator* estimator, float dt, float acc_std)
+|
+| Inputs --
+|	slider_estimator* estimator -> initialised estimator
+|	float dt -> duration of the iteration (s)
+|	float acc_std -> standard deviation of the slider acceleration during the iteration (m/s^2)
+|
+| Outputs --
+|	float -> estimated position of the slider at the end of the iteration (m)
+----------------------------------------------------------------------------------------------------------------------*/
+float slider_Step(slider_estimator* estimator, float dt, float acc_std)
+{
+	// Initialise variables
+	float decay, q, p_pp, p_ps, p_ss;
+	float delay, h_ps, s, k_p, k_s, innovation;
+
+	// Prediction : x = F x, P = F P F' + Q with F = [1 dt ; 0 decay]
+	decay = 1.0f - dt / SLIDER_SPEED_TAU;
+	q = acc_std * acc_std;
+	p_pp = estimator->p_pp + 2.0f * dt * estimator->p_ps + dt * dt * estimator->p_ss + q * dt * dt * dt * dt / 4.0f;
+	p_ps = decay * (estimator->p_ps + dt * estimator->p_ss) + q * dt * dt * dt / 2.0f;
+	p_ss = decay * decay * estimator->p_ss + q * dt * dt;
+	estimator->position += dt * estimator->speed;
+	estimator->speed *= decay;
+	estimator->p_pp = p_pp;
+	estimator->p_ps = p_ps;
+	estimator->p_ss = p_ss;
+
+	if (!estimator->meas_pending)
+	{
+		return estimator->position;
+	}
+
+	// Correction by the pending measure, compared to the position predicted at its acquisition time
+	estimator->meas_pending = 0;
+	delay = estimator->meas_delay;
+	if (delay > SLIDER_MAX_DELAY)
+	{
+		estimator->nb_rejected++;
+		return estimator->position;
+	}
+	h_ps = estimator->p_ps - delay * estimator->p_ss;							// P H' (speed row)
+	k_p = estimator->p_pp - delay * estimator->p_ps;							// P H' (position row)
+	s = k_p - delay * h_ps + SLIDER_MEAS_STD * SLIDER_MEAS_STD;					// H P H' + R
+	innovation = estimator->meas_position - (estimator->position - delay * estimator->speed);
+	if (innovation * innovation > SLIDER_GATE * s)
+	{
+		estimator->nb_rejected++;
+		return estimator->position;
+	}
+	k_s = h_ps / s;
+	k_p = k_p / s;
+	estimator->position += k_p * innovation;
+	estimator->speed += k_s * innovation;
+	// P = P - K H P
+	p_pp = estimator->p_pp - k_p * (estimator->p_pp - delay * estimator->p_ps);
+	p_ps = estimator->p_ps - k_p * (estimator->p_ps - delay * estimator->p_ss);
+	p_ss = estimator->p_ss - k_s * (estimator->p_ps - delay * estimator->p_ss);
+	estimator->p_pp = p_pp;
+	estimator->p_ps = p_ps;
+	estimator->p_ss = p_ss;
+	estimator->nb_updates++;
+	estimator->last_innovation = innovation;
+	estimator->last_delay = delay;
+	return estimator->position;
+}
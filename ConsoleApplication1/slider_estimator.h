@@ -0,0 +1,50 @@
+/***********************************************************************************************************************
+* slider_estimator.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the estimator of the slider position x_slider. A two states Kalman filter (position,
+* speed) is propagated at each control iteration and corrected by the timestamped QTM measures, which arrive late and
+* at a lower rate. The cost of an iteration is constant.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef SLIDER_ESTIMATOR_H
+#define SLIDER_ESTIMATOR_H
+
+// Estimator constants
+#define SLIDER_MEAS_STD 0.0005f					// Standard deviation of a QTM slider measure (m)
+#define SLIDER_INIT_POS_STD 0.005f				// Initial uncertainty on the position given by the user (m)
+#define SLIDER_INIT_SPEED_STD 0.01f				// Initial uncertainty on the speed of the slider (m/s)
+#define SLIDER_SPEED_TAU 0.2f					// Time constant of the speed decay without measures (s)
+#define SLIDER_QTM_LATENCY 0.0f					// Latency of QTM before the measure is published (s)
+#define SLIDER_MAX_DELAY 0.05f					// Measures older than this are rejected (s)
+#define SLIDER_GATE 16.0f						// Rejection threshold on the normalised squared innovation
+#define SLIDER_ACC_STD_REST 0.05f				// Slider acceleration std when the robot is static (m/s^2)
+#define SLIDER_ACC_STD_SPEED 0.5f				// Increase of the acceleration std per rad/s of the axes (m/s^2)
+#define SLIDER_ACC_STD_FORCE 0.01f				// Increase of the acceleration std per N on the wrist sensor (m/s^2)
+
+// ------------------------------------------------- ESTIMATOR STRUCT --------------------------------------------------
+struct slider_estimator
+{
+	float position;							// Estimated position of the slider (m)
+	float speed;							// Estimated speed of the slider (m/s)
+	float p_pp, p_ps, p_ss;					// Covariance of the estimation (position, cross, speed)
+	int meas_pending;						// 1 : a measure is waiting for the next iteration
+	float meas_position;					// Position of the pending measure (m)
+	float meas_delay;						// Age of the pending measure (s)
+	long long nb_updates;					// Number of measures applied
+	long long nb_rejected;					// Number of measures rejected (too old or outliers)
+	long long nb_overwritten;				// Number of measures replaced by a newer one before being applied
+	float last_innovation;					// Innovation of the last measure applied (m)
+	float last_delay;						// Latency compensated for the last measure applied (s)
+};
+
+// Functions declaration
+void slider_Init(slider_estimator* estimator, float position);
+void slider_AddMeasure(slider_estimator* estimator, float position, float delay);
+float slider_Step(slider_estimator* estimator, float dt, float acc_std);
+#endif // !SLIDER_ESTIMATOR_H
\ No newline at end of file
@@ -0,0 +1,270 @@
+/***********************************************************************************************************************
+* stream_alignment.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Aligns the stamped streams on the control timeline and measures their latency and drift. The drift is the slope of
+* the least squares fit of the local time on the remote time of the samples : the source timestamps for QTM, the
+* nominal sample times (index times period) for the drive and FT streams.
+***********************************************************************************************************************/
+
+#include "stream_alignment.h"
+#include <cmath>
+
+/*---------------------------------------------------------------------------------------------------------------------
+| align_InitLink - Reset the statistics of a stream
+|
+| Syntax --
+|	void align_InitLink(align_link* link)
+|
+| Inputs --
+|	align_link* link -> statistics to reset
+----------------------------------------------------------------------------------------------------------------------*/
+void align_InitLink(align_link* link)
+{
+	link->nb_latencies = 0;
+	link->min_latency = 0;
+	link->max_latency = 0;
+	link->sum_latency = 0.0;
+	link->nb_clock = 0;
+	link->remote_0 = 0.0;
+	link->local_0 = 0;
+	link->sum_r = 0.0;
+	link->sum_l = 0.0;
+	link->sum_rr = 0.0;
+	link->sum_rl = 0.0;
+	link->sum_ll = 0.0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| align_AddLatency - Add the latency of a sample used by a consumer
+|
+| Syntax --
+|	void align_AddLatency(align_link* link, long long acquisition_tick, long long use_tick)
+|
+| Inputs --
+|	align_link* link -> statistics of the stream
+|	long long acquisition_tick -> tick stamped at the acquisition of the sample
+|	long long use_tick -> tick of the iteration using the sample
+----------------------------------------------------------------------------------------------------------------------*/
+void align_AddLatency(align_link* link, long long acquisition_tick, long long use_tick)
+{
+	long long latency = use_tick - acquisition_tick;
+
+	if (acquisition_tick == 0)
+	{
+		return;
+	}
+	if (link->nb_latencies == 0 || latency < link->min_latency)
+	{
+		link->min_latency = latency;
+	}
+	if (link->nb_latencies == 0 || latency > link->max_latency)
+	{
+		link->max_latency = latency;
+	}
+	link->sum_latency += (double)latency;
+	link->nb_latencies++;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| align_AddClock - Add the remote time and the local tick of a sample
+|
+| Syntax --
+|	void align_AddClock(align_link* link, double remote_time, long long local_tick)
+|
+| Inputs --
+|	align_link* link -> statistics of the stream
+|	double remote_time -> time of the sample given by the source, or its nominal time (s)
+|	long long local_tick -> tick stamped at the acquisition of the sample
+----------------------------------------------------------------------------------------------------------------------*/
+void align_AddClock(align_link* link, double remote_time, long long local_tick)
+{
+	double r, l;
+
+	if (link->nb_clock == 0)
+	{
+		link->remote_0 = remote_time;
+		link->local_0 = local_tick;
+	}
+	r = remote_time - link->remote_0;
+	l = timebase_Seconds(local_tick - link->local_0);
+	link->sum_r += r;
+	link->sum_l += l;
+	link->sum_rr += r * r;
+	link->sum_rl += r * l;
+	link->sum_ll += l * l;
+	link->nb_clock++;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| align_LatencyMean - Get the mean latency of a stream
+|
+| Syntax --
+|	double align_LatencyMean(const align_link* link)
+|
+| Inputs --
+|	const align_link* link -> statistics of the stream
+|
+| Outputs --
+|	double -> mean latency (s), 0 without sample
+----------------------------------------------------------------------------------------------------------------------*/
+double align_LatencyMean(const align_link* link)
+{
+	if (link->nb_latencies == 0)
+	{
+		return 0.0;
+	}
+	return timebase_Seconds(1) * link->sum_latency / (double)link->nb_latencies;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| align_DriftPpm - Get the drift of the stream clock against the common time base
+|
+| Syntax --
+|	double align_DriftPpm(const align_link* link)
+|
+| Inputs --
+|	const align_link* link -> statistics of the stream
+|
+| Outputs --
+|	double -> (local duration / remote duration - 1) in parts per million, 0 with less than two samples
+----------------------------------------------------------------------------------------------------------------------*/
+double align_DriftPpm(const align_link* link)
+{
+	double n = (double)link->nb_clock;
+	double var_r = n * link->sum_rr - link->sum_r * link->sum_r;
+
+	if (link->nb_clock < 2 || var_r <= 0.0)
+	{
+		return 0.0;
+	}
+	return ((n * link->sum_rl - link->sum_r * link->sum_l) / var_r - 1.0) * 1e6;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| align_ClockJitter - Get the standard deviation of the local times around the fitted clock
+|
+| Syntax --
+|	double align_ClockJitter(const align_link* link)
+|
+| Inputs --
+|	const align_link* link -> statistics of the stream
+|
+| Outputs --
+|	double -> residual standard deviation (s), 0 with less than three samples
+----------------------------------------------------------------------------------------------------------------------*/
+double align_ClockJitter(const align_link* link)
+{
+	double n = (double)link->nb_clock;
+	double var_r, cov_rl, var_l, residual;
+
+	if (link->nb_clock < 3)
+	{
+		return 0.0;
+	}
+	var_r = link->sum_rr / n - (link->sum_r / n) * (link->sum_r / n);
+	cov_rl = link->sum_rl / n - (link->sum_r / n) * (link->sum_l / n);
+	var_l = link->sum_ll / n - (link->sum_l / n) * (link->sum_l / n);
+	residual = (var_r > 0.0) ? var_l - cov_rl * cov_rl / var_r : var_l;
+	return (residual > 0.0) ? sqrt(residual) : 0.0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| align_PrintLink - Print the latency and drift of a stream
+|
+| Syntax --
+|	void align_PrintLink(FILE* file, const char* name, const align_link* link)
+|
+| Inputs --
+|	FILE* file -> destination of the report
+|	const char* name -> name of the stream
+|	const align_link* link -> statistics of the stream
+----------------------------------------------------------------------------------------------------------------------*/
+void align_PrintLink(FILE* file, const char* name, const align_link* link)
+{
+	if (link->nb_latencies > 0)
+	{
+		fprintf(file, "%s latency : mean %.3f ms ; min %.3f ms ; max %.3f ms (%lld samples)\n", name,
+			    align_LatencyMean(link) * 1e3, timebase_Seconds(link->min_latency) * 1e3,
+			    timebase_Seconds(link->max_latency) * 1e3, link->nb_latencies);
+	}
+	if (link->nb_clock > 1)
+	{
+		fprintf(file, "%s clock : drift %.1f ppm ; jitter %.3f ms (%lld samples)\n", name,
+			    align_DriftPpm(link), align_ClockJitter(link) * 1e3, link->nb_clock);
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| align_Resample - Resample a stamped stream on other ticks (e.g. the control timeline)
+|
+| Syntax --
+|	int align_Resample(const long long* src_ticks, const float* src_values, int nb_src,
+|	                   const long long* dst_ticks, float* dst_values, int nb_dst, int mode)
+|
+| Inputs --
+|	const long long* src_ticks -> acquisition ticks of the stream (increasing)
+|	const float* src_values -> values of the stream
+|	int nb_src -> number of samples of the stream
+|	const long long* dst_ticks -> target ticks (increasing)
+|	float* dst_values -> filled with the resampled values, NAN where the stream gives no value
+|	int nb_dst -> number of target ticks
+|	int mode -> ALIGN_HOLD, ALIGN_LINEAR or ALIGN_CUBIC
+|
+| Outputs --
+|	int -> number of target ticks with a value
+----------------------------------------------------------------------------------------------------------------------*/
+int align_Resample(const long long* src_ticks, const float* src_values, int nb_src,
+	               const long long* dst_ticks, float* dst_values, int nb_dst, int mode)
+{
+	// Initialise variables
+	int k = 0, nb_valid = 0;
+	double h, u, m_k, m_kp1;
+
+	for (int j(0); j < nb_dst; j++)
+	{
+		// Last sample acquired before the target tick
+		while (k + 1 < nb_src && src_ticks[k + 1] <= dst_ticks[j])
+		{
+			k++;
+		}
+		if (nb_src == 0 || dst_ticks[j] < src_ticks[0])
+		{
+			dst_values[j] = NAN;
+			continue;
+		}
+		if (mode == ALIGN_HOLD || dst_ticks[j] == src_ticks[k])
+		{
+			dst_values[j] = src_values[k];
+			nb_valid++;
+			continue;
+		}
+		if (k + 1 >= nb_src)
+		{
+			// No sample after the target tick to interpolate
+			dst_values[j] = NAN;
+			continue;
+		}
+		h = (double)(src_ticks[k + 1] - src_ticks[k]);
+		u = (double)(dst_ticks[j] - src_ticks[k]) / h;
+		if (mode == ALIGN_LINEAR)
+		{
+			dst_values[j] = (float)(src_values[k] + u * (src_values[k + 1] - src_values[k]));
+		} else {
+			// Slopes from the neighbouring samples (one-sided at the ends of the stream)
+			m_k = (k > 0) ? (src_values[k + 1] - src_values[k - 1]) / (double)(src_ticks[k + 1] - src_ticks[k - 1])
+				          : (src_values[k + 1] - src_values[k]) / h;
+			m_kp1 = (k + 2 < nb_src) ? (src_values[k + 2] - src_values[k]) / (double)(src_ticks[k + 2] - src_ticks[k])
+				                     : (src_values[k + 1] - src_values[k]) / h;
+			dst_values[j] = (float)((2 * u * u * u - 3 * u * u + 1) * src_values[k]
+				                    + (u * u * u - 2 * u * u + u) * h * m_k
+				                    + (-2 * u * u * u + 3 * u * u) * src_values[k + 1]
+				                    + (u * u * u - u * u) * h * m_kp1);
+		}
+		nb_valid++;
+	}
+	return nb_valid;
+}
@@ -0,0 +1,56 @@
+/***********************************************************************************************************************
+* stream_alignment.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the alignment of the measured streams on the control timeline : resampling of a stamped
+* stream on other ticks, and running statistics of the latency (acquisition to use) and of the drift of a stream clock
+* against the common time base.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef STREAM_ALIGNMENT_H
+#define STREAM_ALIGNMENT_H
+
+// General includes
+#include <stdio.h>
+
+// Project includes
+#include "time_base.h"
+
+// Resampling modes
+#define ALIGN_HOLD 0							// Last sample acquired before the target tick
+#define ALIGN_LINEAR 1							// Linear interpolation between the surrounding samples
+#define ALIGN_CUBIC 2							// Cubic Hermite interpolation (slopes from the neighbouring samples)
+
+// ------------------------------------------------- LINK STATS STRUCT -------------------------------------------------
+// Constant cost per sample, can be updated in the real-time threads and read at any time
+struct align_link
+{
+	// Latency : ticks between the acquisition of a sample and its use
+	long long nb_latencies;					// Number of latencies added
+	long long min_latency;					// Smallest latency (ticks)
+	long long max_latency;					// Largest latency (ticks)
+	double sum_latency;						// Sum of the latencies (ticks)
+	// Clock : local time of the samples against their remote (or nominal) time, relatively to the first sample
+	long long nb_clock;						// Number of samples added
+	double remote_0;						// Remote time of the first sample (s)
+	long long local_0;						// Local tick of the first sample
+	double sum_r, sum_l;					// Sums of the remote and local times (s)
+	double sum_rr, sum_rl, sum_ll;			// Sums of the products (s^2)
+};
+
+// Functions declaration
+void align_InitLink(align_link* link);
+void align_AddLatency(align_link* link, long long acquisition_tick, long long use_tick);
+void align_AddClock(align_link* link, double remote_time, long long local_tick);
+double align_LatencyMean(const align_link* link);
+double align_DriftPpm(const align_link* link);
+double align_ClockJitter(const align_link* link);
+void align_PrintLink(FILE* file, const char* name, const align_link* link);
+int align_Resample(const long long* src_ticks, const float* src_values, int nb_src,
+	               const long long* dst_ticks, float* dst_values, int nb_dst, int mode);
+#endif // !STREAM_ALIGNMENT_H
\ No newline at end of file
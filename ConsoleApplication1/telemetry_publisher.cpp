@@ -0,0 +1,309 @@
+/***********************************************************************************************************************
+* telemetry_publisher.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Publishes the state of ABLE at each iteration of the control loop in a shared memory ring. The control thread
+* never waits for the readers : each slot is protected by a sequence number, and a reader that was overtaken by the
+* control thread simply drops the record. Nothing is written to the disk.
+***********************************************************************************************************************/
+
+#include "telemetry_publisher.h"
+#include <string.h>
+
+using namespace std;
+
+static_assert(sizeof(telemetry_header) == 64, "Telemetry header must be 64 bytes");
+static_assert(sizeof(telemetry_state) == 168, "Telemetry state must be 168 bytes");
+static_assert(sizeof(telemetry_slot) == 176, "Telemetry slot must be 176 bytes");
+static_assert((TELEMETRY_CAPACITY & (TELEMETRY_CAPACITY - 1)) == 0, "Telemetry capacity must be a power of 2");
+
+// Publisher of the control process
+struct telemetry_publisher
+{
+	HANDLE mapping;								// Handle of the mapping
+	telemetry_header* header;					// Mapped header
+	telemetry_slot* slots;						// Mapped ring
+	long long nb_published;						// Number of records published
+	long long start_tick;						// Opening tick (timebase_Now)
+};
+static telemetry_publisher publisher;
+
+// ------------------------------------------------- PUBLISHER FUNCTIONS -----------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| telemetry_Open - Create the telemetry mapping (a failure only disables the telemetry)
+|
+| Syntax --
+|	int telemetry_Open(FILE* err_file, FILE* out_file, float sampling_period)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	float sampling_period -> period of the control loop (s)
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Mapping error
+----------------------------------------------------------------------------------------------------------------------*/
+int telemetry_Open(FILE* err_file, FILE* out_file, float sampling_period)
+{
+	// Initialise variables
+	size_t map_size = sizeof(telemetry_header) + TELEMETRY_CAPACITY * sizeof(telemetry_slot);
+
+	memset(&publisher, 0, sizeof(telemetry_publisher));
+	publisher.mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)map_size,
+		                                   TELEMETRY_MAPPING_NAME);
+	if (publisher.mapping != NULL)
+	{
+		publisher.header = (telemetry_header*)MapViewOfFile(publisher.mapping, FILE_MAP_ALL_ACCESS, 0, 0, map_size);
+	}
+	if (publisher.header == NULL)
+	{
+		fprintf(err_file, "Telemetry mapping not created (error %lu), telemetry disabled\n", GetLastError());
+		telemetry_Close();
+		return 1;
+	}
+	publisher.slots = (telemetry_slot*)((unsigned char*)publisher.header + sizeof(telemetry_header));
+
+	// Reset the ring (a reader may have kept the mapping of a previous run alive)
+	publisher.header->nb_published.store(0, memory_order_relaxed);
+	memset(publisher.slots, 0, TELEMETRY_CAPACITY * sizeof(telemetry_slot));
+	publisher.header->version = TELEMETRY_VERSION;
+	publisher.header->header_size = sizeof(telemetry_header);
+	publisher.header->slot_size = sizeof(telemetry_slot);
+	publisher.header->capacity = TELEMETRY_CAPACITY;
+	publisher.header->writer_pid = GetCurrentProcessId();
+	publisher.header->sampling_period = sampling_period;
+	publisher.header->tick_frequency = timebase_Frequency();
+	atomic_thread_fence(memory_order_release);
+	memcpy(publisher.header->magic, TELEMETRY_MAGIC, sizeof(publisher.header->magic));
+	publisher.start_tick = timebase_Now();
+
+	fprintf(out_file, "Telemetry published in %s (%zu bytes)\n", TELEMETRY_MAPPING_NAME, map_size);
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| telemetry_Publish - Publish the current state of ABLE (called once per iteration by the control thread)
+|
+| Syntax --
+|	void telemetry_Publish(AbleControlStruct* ctrl_ABLE)
+|
+| Inputs --
+|	AbleControlStruct* ctrl_ABLE -> Struct containing all ABLE informations
+----------------------------------------------------------------------------------------------------------------------*/
+void telemetry_Publish(AbleControlStruct* ctrl_ABLE)
+{
+	if (publisher.header == NULL)
+	{
+		return;
+	}
+	// Extract substructs
+	realTimeParams* rtValues = &ctrl_ABLE->rtParams;
+	const RobotState* axes = &ctrl_ABLE->state;
+	received_FT_meas* ftArm = &ctrl_ABLE->current_FT_meas_Arm;
+	received_FT_meas* ftWrist = &ctrl_ABLE->current_FT_meas_Wrist;
+	long long index = publisher.nb_published;
+	telemetry_slot* slot = &publisher.slots[index & (TELEMETRY_CAPACITY - 1)];
+	telemetry_state* state = &slot->state;
+
+	// Odd sequence : readers drop the slot while it is written
+	slot->sequence.store(2 * index + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	state->index = index;
+	state->time = timebase_Seconds(timebase_Now() - publisher.start_tick);
+	state->iter_counter = rtValues->iter_counter;
+	state->ctrl_type = ctrl_ABLE->aOrders.ctrl_type;
+	state->order_counter = rtValues->order_counter;
+	state->current_minJerkMove = rtValues->current_minJerkMove;
+	state->current_posMinJerk = (int)(rtValues->current_timeMinJerk / rtValues->sampling_frequency + 0.5f);
+	state->jerk_flags = (rtValues->jerkMove_goStart ? TELEMETRY_JERK_GO_START : 0) |
+		                (rtValues->jerkMove_startReached ? TELEMETRY_JERK_START_REACHED : 0) |
+		                (rtValues->jerkMove_started ? TELEMETRY_JERK_STARTED : 0) |
+		                (rtValues->jerkTrajs_AllEnded ? TELEMETRY_JERK_ALL_ENDED : 0) |
+		                (rtValues->jerkHomePosAfterTrajs ? TELEMETRY_JERK_HOME_AFTER : 0) |
+		                (rtValues->robot_stopAfterTrajs ? TELEMETRY_JERK_ROBOT_STOP : 0);
+	for (int i(0); i < NB_MOTORS; i++)
+	{
+		state->position[i] = axes->position[i];
+		state->speed[i] = axes->speed[i];
+		state->current[i] = axes->current[i];
+	}
+	state->wrench_arm[0] = ftArm->f_x;
+	state->wrench_arm[1] = ftArm->f_y;
+	state->wrench_arm[2] = ftArm->f_z;
+	state->wrench_arm[3] = ftArm->t_x;
+	state->wrench_arm[4] = ftArm->t_y;
+	state->wrench_arm[5] = ftArm->t_z;
+	state->wrench_wrist[0] = ftWrist->f_x;
+	state->wrench_wrist[1] = ftWrist->f_y;
+	state->wrench_wrist[2] = ftWrist->f_z;
+	state->wrench_wrist[3] = ftWrist->t_x;
+	state->wrench_wrist[4] = ftWrist->t_y;
+	state->wrench_wrist[5] = ftWrist->t_z;
+	state->state_tick = rtValues->state_tick;
+	state->ft_tick_arm = ftArm->tick;
+	state->ft_tick_wrist = ftWrist->tick;
+	state->qtm_tick = ctrl_ABLE->qtmLink.last_arrival_tick;
+
+	// Even sequence, then make the record visible
+	slot->sequence.store(2 * index + 2, memory_order_release);
+	publisher.header->nb_published.store(index + 1, memory_order_release);
+	publisher.nb_published = index + 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| telemetry_Close - Unmap the telemetry ring of the control process
+|
+| Syntax --
+|	void telemetry_Close()
+----------------------------------------------------------------------------------------------------------------------*/
+void telemetry_Close()
+{
+	if (publisher.header != NULL)
+	{
+		UnmapViewOfFile(publisher.header);
+	}
+	if (publisher.mapping != NULL)
+	{
+		CloseHandle(publisher.mapping);
+	}
+	memset(&publisher, 0, sizeof(telemetry_publisher));
+}
+
+// -------------------------------------------------- READER FUNCTIONS -------------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| telemetry_OpenReader - Map the telemetry ring read-only
+|
+| Syntax --
+|	int telemetry_OpenReader(FILE* err_file, telemetry_reader* reader)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	telemetry_reader* reader -> reader to initialise
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : No controller running ; 2 : Mapping error ; 3 : Invalid layout
+----------------------------------------------------------------------------------------------------------------------*/
+int telemetry_OpenReader(FILE* err_file, telemetry_reader* reader)
+{
+	memset(reader, 0, sizeof(telemetry_reader));
+	reader->mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, TELEMETRY_MAPPING_NAME);
+	if (reader->mapping == NULL)
+	{
+		fprintf(err_file, "Telemetry mapping %s not found !\n", TELEMETRY_MAPPING_NAME);
+		return 1;
+	}
+	reader->header = (const telemetry_header*)MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (reader->header == NULL)
+	{
+		fprintf(err_file, "Telemetry mapping not mapped (error %lu) !\n", GetLastError());
+		telemetry_CloseReader(reader);
+		return 2;
+	}
+	if (memcmp(reader->header->magic, TELEMETRY_MAGIC, sizeof(reader->header->magic)) != 0 ||
+		reader->header->version != TELEMETRY_VERSION || reader->header->slot_size != sizeof(telemetry_slot) ||
+		reader->header->capacity != TELEMETRY_CAPACITY)
+	{
+		fprintf(err_file, "Telemetry mapping layout not supported !\n");
+		telemetry_CloseReader(reader);
+		return 3;
+	}
+	reader->slots = (const telemetry_slot*)((const unsigned char*)reader->header + reader->header->header_size);
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| telemetry_ReadRecord - Copy a record of the ring
+|
+| Syntax --
+|	int telemetry_ReadRecord(const telemetry_reader* reader, long long index, telemetry_state* state)
+|
+| Inputs --
+|	const telemetry_reader* reader -> opened reader
+|	long long index -> index of the record since the opening of the publisher
+|	telemetry_state* state -> filled with the record
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Not published yet ; 2 : Overwritten by the control thread
+----------------------------------------------------------------------------------------------------------------------*/
+int telemetry_ReadRecord(const telemetry_reader* reader, long long index, telemetry_state* state)
+{
+	long long nb_published = reader->header->nb_published.load(memory_order_acquire);
+	const telemetry_slot* slot = &reader->slots[index & (TELEMETRY_CAPACITY - 1)];
+	long long sequence;
+
+	if (index < 0 || index >= nb_published)
+	{
+		return 1;
+	}
+	if (nb_published - index > TELEMETRY_CAPACITY)
+	{
+		return 2;
+	}
+	sequence = slot->sequence.load(memory_order_acquire);
+	if (sequence != 2 * index + 2)
+	{
+		return 2;
+	}
+	memcpy(state, &slot->state, sizeof(telemetry_state));
+	atomic_thread_fence(memory_order_acquire);
+	if (slot->sequence.load(memory_order_relaxed) != sequence)
+	{
+		return 2;
+	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| telemetry_ReadLatest - Copy the last published record
+|
+| Syntax --
+|	int telemetry_ReadLatest(const telemetry_reader* reader, telemetry_state* state)
+|
+| Inputs --
+|	const telemetry_reader* reader -> opened reader
+|	telemetry_state* state -> filled with the record
+|
+| Outputs --
+|	int -> 0 : Success ; 1 : Nothing published yet ; 2 : Overtaken TELEMETRY_READ_RETRIES times
+----------------------------------------------------------------------------------------------------------------------*/
+int telemetry_ReadLatest(const telemetry_reader* reader, telemetry_state* state)
+{
+	int status = 1;
+	for (int i(0); i < TELEMETRY_READ_RETRIES; i++)
+	{
+		status = telemetry_ReadRecord(reader, reader->header->nb_published.load(memory_order_acquire) - 1, state);
+		if (status != 2)
+		{
+			break;
+		}
+	}
+	return status;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| telemetry_CloseReader - Unmap the telemetry ring of a reader
+|
+| Syntax --
+|	void telemetry_CloseReader(telemetry_reader* reader)
+|
+| Inputs --
+|	telemetry_reader* reader -> reader to close
+----------------------------------------------------------------------------------------------------------------------*/
+void telemetry_CloseReader(telemetry_reader* reader)
+{
+	if (reader->header != NULL)
+	{
+		UnmapViewOfFile(reader->header);
+	}
+	if (reader->mapping != NULL)
+	{
+		CloseHandle(reader->mapping);
+	}
+	memset(reader, 0, sizeof(telemetry_reader));
+}
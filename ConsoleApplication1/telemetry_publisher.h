@@ -0,0 +1,110 @@
+/***********************************************************************************************************************
+* telemetry_publisher.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the shared memory telemetry ring. The control thread publishes one fixed-layout state
+* record per iteration in a named file mapping, that any number of readers (GUI, logger, Python) can map read-only.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef TELEMETRY_PUBLISHER_H
+#define TELEMETRY_PUBLISHER_H
+
+// General includes
+#include <stdio.h>
+#include <atomic>
+#include <Windows.h>
+
+// Project includes
+#include "control_struct.h"
+
+// Telemetry constants
+#define TELEMETRY_MAPPING_NAME "Local\\ABLE_Telemetry"	// Name of the file mapping
+#define TELEMETRY_MAGIC "ABTL"							// Identifier of the telemetry mapping
+#define TELEMETRY_VERSION 2								// Version of the telemetry layout
+#define TELEMETRY_CAPACITY 4096							// Number of records of the ring (power of 2)
+#define TELEMETRY_READ_RETRIES 4						// Attempts of a reader to get the latest record
+
+// Bits of the jerk flags
+#define TELEMETRY_JERK_GO_START 0x01					// jerkMove_goStart
+#define TELEMETRY_JERK_START_REACHED 0x02				// jerkMove_startReached
+#define TELEMETRY_JERK_STARTED 0x04						// jerkMove_started
+#define TELEMETRY_JERK_ALL_ENDED 0x08					// jerkTrajs_AllEnded
+#define TELEMETRY_JERK_HOME_AFTER 0x10					// jerkHomePosAfterTrajs
+#define TELEMETRY_JERK_ROBOT_STOP 0x20					// robot_stopAfterTrajs
+
+// ------------------------------------------------ TELEMETRY MAPPING LAYOUT -------------------------------------------
+// Mapping : header (64 bytes) | slot 0 | slot 1 | ... | slot capacity-1 (record i is in slot i % capacity)
+// Fields are little-endian and naturally aligned without padding, e.g. with numpy :
+//   slot = [('sequence','<i8'),('index','<i8'),('time','<f8'),('iter_counter','<i4'),('ctrl_type','<i4'),
+//           ('order_counter','<i4'),('current_minJerkMove','<i4'),('current_posMinJerk','<i4'),('jerk_flags','<u4'),
+//           ('position','<f4',4),('speed','<f4',4),('current','<f4',4),('wrench_arm','<f4',6),('wrench_wrist','<f4',6),
+//           ('state_tick','<i8'),('ft_tick_arm','<i8'),('ft_tick_wrist','<i8'),('qtm_tick','<i8')]
+//   np.frombuffer(mmap.mmap(-1, size, tagname="Local\\ABLE_Telemetry", access=mmap.ACCESS_READ), slot, capacity, 64)
+// A slot is valid for record i if its sequence is 2 * i + 2 before and after copying it (odd while written).
+// Ticks are acquisition times in the common time base (tick_frequency ticks per second) : the streams of a record can
+// be aligned with each other and with the records of other processes stamped with the same performance counter.
+struct telemetry_header
+{
+	char magic[4];							// TELEMETRY_MAGIC
+	unsigned int version;					// TELEMETRY_VERSION
+	unsigned int header_size;				// Offset of the first slot (bytes)
+	unsigned int slot_size;					// Size of a slot (bytes)
+	unsigned int capacity;					// Number of slots of the ring
+	unsigned int writer_pid;				// Process id of the controller (changes at each run)
+	double sampling_period;					// Period of the control loop (s)
+	std::atomic<long long> nb_published;	// Number of records published since the opening
+	long long tick_frequency;				// Ticks per second of the common time base
+	char reserved[16];						// Kept to 0
+};
+
+struct telemetry_state
+{
+	long long index;						// Index of the record since the opening
+	double time;							// Time since the opening (s)
+	int iter_counter;						// Iteration of the control loop
+	int ctrl_type;							// Control type (STATIC_IDENT, ..., OSCILLATOR_CTRL)
+	int order_counter;						// Order counter
+	int current_minJerkMove;				// Counter of the minimum jerk moves
+	int current_posMinJerk;					// Position index in the current minimum jerk move (time / period)
+	unsigned int jerk_flags;				// TELEMETRY_JERK_* bits
+	float position[NB_MOTORS];				// Articular positions (rad)
+	float speed[NB_MOTORS];					// Measured speeds
+	float current[NB_MOTORS];				// Measured ADC currents
+	float wrench_arm[6];					// Fx, Fy, Fz, Tx, Ty, Tz of the arm FT sensor
+	float wrench_wrist[6];					// Fx, Fy, Fz, Tx, Ty, Tz of the wrist FT sensor
+	long long state_tick;					// Tick of the drive state frame of the iteration
+	long long ft_tick_arm;					// Acquisition tick of the arm FT sample used (0 : none)
+	long long ft_tick_wrist;				// Acquisition tick of the wrist FT sample used (0 : none)
+	long long qtm_tick;						// Reception tick of the last QTM measures used (0 : none)
+};
+
+struct telemetry_slot
+{
+	std::atomic<long long> sequence;		// 2 * index + 1 while written, 2 * index + 2 once published
+	telemetry_state state;					// Published state
+};
+
+// ---------------------------------------------------- READER STRUCT --------------------------------------------------
+struct telemetry_reader
+{
+	HANDLE mapping;							// Handle of the mapping
+	const telemetry_header* header;			// Mapped header
+	const telemetry_slot* slots;			// Mapped ring
+};
+
+// Functions declaration
+// Publisher (control process)
+int telemetry_Open(FILE* err_file, FILE* out_file, float sampling_period);
+void telemetry_Publish(AbleControlStruct* ctrl_ABLE);
+void telemetry_Close();
+// Readers
+int telemetry_OpenReader(FILE* err_file, telemetry_reader* reader);
+int telemetry_ReadRecord(const telemetry_reader* reader, long long index, telemetry_state* state);
+int telemetry_ReadLatest(const telemetry_reader* reader, telemetry_state* state);
+void telemetry_CloseReader(telemetry_reader* reader);
+#endif // !TELEMETRY_PUBLISHER_H
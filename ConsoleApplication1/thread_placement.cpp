@@ -0,0 +1,310 @@
+/***********************************************************************************************************************
+* thread_placement.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Places the real time threads : priorities, cores, resident memory and pre-faulted stacks, and reports the jitter of
+* the control loop obtained with the selected placement.
+***********************************************************************************************************************/
+
+#include "thread_placement.h"
+#include "time_base.h"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+// Placement of the process, written by the main thread before the threads are created
+static thread_Placement placement = {};
+
+// Names of the roles and levels for the reports
+static const char* placement_RoleNames[PLACEMENT_NB_ROLES] = { "Control", "FT wrist", "FT arm", "QTM" };
+static const char* placement_LevelNames[3] = { "default scheduling", "real time priorities", "full placement" };
+
+// ------------------------------------------------ CONFIGURATION FUNCTIONS --------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| placement_Init - Choose the priority and the core of each role for a placement level
+|
+| Syntax --
+|	void placement_Init(int level)
+|
+| Inputs --
+|	int level -> PLACEMENT_NONE, PLACEMENT_PRIORITY or PLACEMENT_FULL
+|
+| Remarks --
+|	Core 0 receives the interrupts and the other processes, the control thread gets the last core, the two FT streams
+|	share the previous one (they mostly wait for the serial port) and QTM the one before. With less than
+|	PLACEMENT_MIN_CORES cores, the threads are not pinned.
+----------------------------------------------------------------------------------------------------------------------*/
+void placement_Init(int level)
+{
+	// Initialise variables
+	SYSTEM_INFO system_info;
+
+	GetSystemInfo(&system_info);
+	placement.level = (level < PLACEMENT_NONE || level > PLACEMENT_FULL) ? PLACEMENT_DEFAULT_LEVEL : level;
+	placement.nb_cores = (int)system_info.dwNumberOfProcessors;
+	placement.page_size = system_info.dwPageSize;
+	placement.memory_locked = FALSE;
+	placement.working_set_min = 0;
+
+	// Priorities : the control thread above the streams it reads
+	placement.priorities[PLACEMENT_ROLE_CONTROL] = THREAD_PRIORITY_TIME_CRITICAL;
+	placement.priorities[PLACEMENT_ROLE_FT_WRIST] = THREAD_PRIORITY_HIGHEST;
+	placement.priorities[PLACEMENT_ROLE_FT_ARM] = THREAD_PRIORITY_HIGHEST;
+	placement.priorities[PLACEMENT_ROLE_QTM] = THREAD_PRIORITY_ABOVE_NORMAL;
+	for (int i(0); i < PLACEMENT_NB_ROLES; i++)
+	{
+		placement.use_mmcss[i] = (i == PLACEMENT_ROLE_CONTROL);
+		placement.cores[i] = -1;
+		placement.applied[i] = 0;
+	}
+
+	// Dedicated cores, counted from the last one
+	if (placement.level == PLACEMENT_FULL && placement.nb_cores >= PLACEMENT_MIN_CORES && placement.nb_cores <= 64)
+	{
+		placement.cores[PLACEMENT_ROLE_CONTROL] = placement.nb_cores - 1;
+		placement.cores[PLACEMENT_ROLE_FT_WRIST] = placement.nb_cores - 2;
+		placement.cores[PLACEMENT_ROLE_FT_ARM] = placement.nb_cores - 2;
+		placement.cores[PLACEMENT_ROLE_QTM] = placement.nb_cores - 3;
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| placement_SetupProcess - Set the priority class of the process and keep its memory resident
+|
+| Syntax --
+|	int placement_SetupProcess(FILE* err_file, FILE* out_file, void* locked, size_t locked_size)
+|
+| Inputs --
+|	FILE* err_file -> pointer towards "errors.txt" (stderr)
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+|	void* locked -> memory read and written by the control thread at every iteration (NULL : none)
+|	size_t locked_size -> size of the locked memory (bytes)
+|
+| Outputs --
+|	int -> 0 : every setting obtained ; 1 : at least one setting refused (the motions can run, with more jitter)
+|
+| Remarks --
+|	Windows has no equivalent of mlockall : the hard minimum of the working set is set above the memory committed at
+|	this point (buffers reserved by preallocate_memory included), so that pages are not trimmed once touched. The
+|	control struct is locked explicitly. Must be called after the preallocation and before creating the threads.
+----------------------------------------------------------------------------------------------------------------------*/
+int placement_SetupProcess(FILE* err_file, FILE* out_file, void* locked, size_t locked_size)
+{
+	// Initialise variables
+	PROCESS_MEMORY_COUNTERS_EX memory_counters;
+	int exit_flag = 0;
+
+	// High priority class : the real time priorities of the threads apply above the other processes
+	if (!SetPriorityClass(GetCurrentProcess(), placement.level == PLACEMENT_NONE ? NORMAL_PRIORITY_CLASS :
+		HIGH_PRIORITY_CLASS))
+	{
+		fprintf(err_file, "Priority class of the process refused (error %lu)\n", GetLastError());
+		exit_flag = 1;
+	}
+	if (placement.level != PLACEMENT_FULL)
+	{
+		fprintf(out_file, "Thread placement : %s\n", placement_LevelNames[placement.level]);
+		return exit_flag;
+	}
+	if (placement.cores[PLACEMENT_ROLE_CONTROL] < 0)
+	{
+		fprintf(err_file, "Thread placement : %i cores, threads not pinned (at least %i needed)\n", placement.nb_cores,
+			    PLACEMENT_MIN_CORES);
+		exit_flag = 1;
+	}
+
+	// Keep the committed memory resident
+	if (GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&memory_counters, sizeof(memory_counters)))
+	{
+		placement.working_set_min = memory_counters.PrivateUsage + PLACEMENT_WORKING_SET_MARGIN;
+		if (SetProcessWorkingSetSizeEx(GetCurrentProcess(), placement.working_set_min,
+			                           placement.working_set_min + PLACEMENT_WORKING_SET_MARGIN,
+			                           QUOTA_LIMITS_HARDWS_MIN_ENABLE | QUOTA_LIMITS_HARDWS_MAX_DISABLE))
+		{
+			placement.memory_locked = (locked == NULL || VirtualLock(locked, locked_size));
+		}
+	}
+	if (!placement.memory_locked)
+	{
+		fprintf(err_file, "Process memory could not be kept resident (error %lu)\n", GetLastError());
+		exit_flag = 1;
+	}
+	fprintf(out_file, "Thread placement : %s, %i cores, resident memory %.1f MB\n",
+		    placement_LevelNames[placement.level], placement.nb_cores, placement.working_set_min / 1048576.0);
+	return exit_flag;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| placement_ApplyThread - Apply the settings of its role to the calling thread
+|
+| Syntax --
+|	int placement_ApplyThread(FILE* err_file, int role)
+|
+| Inputs --
+|	FILE* err_file -> errors file of the thread
+|	int role -> PLACEMENT_ROLE_* of the thread
+|
+| Outputs --
+|	int -> PLACEMENT_GOT_* flags of the settings obtained
+|
+| Remarks --
+|	Called first by each thread function, before its loop. The MMCSS registration is released by Windows when the
+|	thread exits.
+----------------------------------------------------------------------------------------------------------------------*/
+int placement_ApplyThread(FILE* err_file, int role)
+{
+	// Initialise variables
+	HANDLE thread = GetCurrentThread();
+	HANDLE mmcss;
+	DWORD task_index = 0;
+	ULONG_PTR stack_low, stack_high;
+	int flags = PLACEMENT_STARTED;
+
+	if (role < 0 || role >= PLACEMENT_NB_ROLES)
+	{
+		return 0;
+	}
+	if (placement.level == PLACEMENT_NONE)
+	{
+		placement.applied[role] = flags;
+		return flags;
+	}
+
+	// Real time priority
+	if (placement.use_mmcss[role])
+	{
+		mmcss = AvSetMmThreadCharacteristicsA(PLACEMENT_MMCSS_TASK, &task_index);
+		if (mmcss != NULL && AvSetMmThreadPriority(mmcss, AVRT_PRIORITY_CRITICAL))
+		{
+			flags |= PLACEMENT_GOT_MMCSS;
+		}
+	}
+	if (SetThreadPriority(thread, placement.priorities[role]))
+	{
+		flags |= PLACEMENT_GOT_PRIORITY;
+	}
+
+	// Dedicated core, pre-faulted and locked stack
+	if (placement.level == PLACEMENT_FULL)
+	{
+		if (placement.cores[role] >= 0 && SetThreadAffinityMask(thread, (DWORD_PTR)1 << placement.cores[role]) != 0)
+		{
+			flags |= PLACEMENT_GOT_AFFINITY;
+		}
+		{
+			// Touch the pages below the current frame, then lock the top of the stack they belong to
+			volatile unsigned char stack_pages[PLACEMENT_STACK_PREFAULT];
+			for (int i(0); i < PLACEMENT_STACK_PREFAULT; i += (int)placement.page_size)
+			{
+				stack_pages[i] = 0;
+			}
+		}
+		GetCurrentThreadStackLimits(&stack_low, &stack_high);
+		if (VirtualLock((void*)(stack_high - PLACEMENT_STACK_PREFAULT), PLACEMENT_STACK_PREFAULT))
+		{
+			flags |= PLACEMENT_GOT_STACK;
+		}
+	}
+	if ((flags & PLACEMENT_GOT_PRIORITY) == 0 ||
+		(placement.level == PLACEMENT_FULL && placement.cores[role] >= 0 && (flags & PLACEMENT_GOT_AFFINITY) == 0))
+	{
+		fprintf(err_file, "%s thread : placement partially refused (flags 0x%02x, error %lu)\n",
+			    placement_RoleNames[role], flags, GetLastError());
+	}
+	placement.applied[role] = flags;
+	return flags;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| placement_LevelName - Name of a placement level
+|
+| Syntax --
+|	const char* placement_LevelName(int level)
+|
+| Inputs --
+|	int level -> PLACEMENT_NONE, PLACEMENT_PRIORITY or PLACEMENT_FULL
+|
+| Outputs --
+|	const char* -> name of the level for the reports
+----------------------------------------------------------------------------------------------------------------------*/
+const char* placement_LevelName(int level)
+{
+	return (level < PLACEMENT_NONE || level > PLACEMENT_FULL) ? "unknown" : placement_LevelNames[level];
+}
+
+// ---------------------------------------------------- REPORT FUNCTIONS -----------------------------------------------
+
+/*---------------------------------------------------------------------------------------------------------------------
+| placement_PrintReport - Print the settings obtained by each thread
+|
+| Syntax --
+|	void placement_PrintReport(FILE* out_file)
+|
+| Inputs --
+|	FILE* out_file -> pointer towards "outputs.txt" (stdout)
+----------------------------------------------------------------------------------------------------------------------*/
+void placement_PrintReport(FILE* out_file)
+{
+	fprintf(out_file, "Thread placement (%s) :\n", placement_LevelNames[placement.level]);
+	for (int i(0); i < PLACEMENT_NB_ROLES; i++)
+	{
+		if ((placement.applied[i] & PLACEMENT_STARTED) == 0)
+		{
+			continue;
+		}
+		fprintf(out_file, "   %-8s : priority %s, MMCSS %s, core %i %s, stack %s\n", placement_RoleNames[i],
+			    (placement.applied[i] & PLACEMENT_GOT_PRIORITY) ? "set" : "default",
+			    (placement.applied[i] & PLACEMENT_GOT_MMCSS) ? "critical" : "no",
+			    placement.cores[i], (placement.applied[i] & PLACEMENT_GOT_AFFINITY) ? "pinned" : "free",
+			    (placement.applied[i] & PLACEMENT_GOT_STACK) ? "locked" : "on demand");
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| placement_ReportJitter - Print the distribution of the periods of a loop, with the placement it ran with
+|
+| Syntax --
+|	void placement_ReportJitter(FILE* out_file, const char* name, const long long* ticks, size_t nb_ticks,
+|								double period)
+|
+| Inputs --
+|	FILE* out_file -> file to print the report
+|	const char* name -> name of the loop
+|	const long long* ticks -> timebase ticks of the successive iterations
+|	size_t nb_ticks -> number of ticks
+|	double period -> nominal period of the loop (s)
+----------------------------------------------------------------------------------------------------------------------*/
+void placement_ReportJitter(FILE* out_file, const char* name, const long long* ticks, size_t nb_ticks, double period)
+{
+	// Initialise variables
+	std::vector<double> periods;
+	double mean = 0.0, variance = 0.0;
+	size_t nb_late = 0, n;
+
+	if (nb_ticks < 2)
+	{
+		return;
+	}
+	n = nb_ticks - 1;
+	periods.resize(n);
+	for (size_t j(0); j < n; j++)
+	{
+		periods[j] = timebase_Seconds(ticks[j + 1] - ticks[j]) * 1e6;
+		mean += periods[j];
+		nb_late += (periods[j] > PLACEMENT_LATE_RATIO * period * 1e6);
+	}
+	mean /= n;
+	for (size_t j(0); j < n; j++)
+	{
+		variance += (periods[j] - mean) * (periods[j] - mean);
+	}
+	std::sort(periods.begin(), periods.end());
+	fprintf(out_file, "%s [%s] : period mean %.1f us, std %.1f us, median %.1f us, p99 %.1f us, p99.9 %.1f us, "
+		    "max %.1f us, %zu late periods over %zu\n", name, placement_LevelNames[placement.level], mean,
+		    sqrt(variance / n), periods[n / 2], periods[(size_t)(0.99 * (n - 1))], periods[(size_t)(0.999 * (n - 1))],
+		    periods[n - 1], nb_late, n);
+}
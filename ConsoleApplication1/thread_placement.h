@@ -0,0 +1,76 @@
+/***********************************************************************************************************************
+* thread_placement.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the placement of the real time threads. Each thread (control, FT wrist, FT arm, QTM)
+* applies the settings of its role when it starts : real time priority (MMCSS for the control thread), dedicated core,
+* pre-faulted and locked stack. The process keeps its committed memory resident. The periods measured by the control
+* loop are reported with the configuration they were obtained with, so that configurations can be compared.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+// General includes
+#include <stdio.h>
+#include <Windows.h>
+#include <avrt.h>
+#include <psapi.h>
+#pragma comment(lib, "Avrt.lib")	// Multimedia class scheduler service (MMCSS)
+
+// Placement levels
+#define PLACEMENT_NONE 0								// Default scheduling of Windows (previous behaviour)
+#define PLACEMENT_PRIORITY 1							// Real time priorities only
+#define PLACEMENT_FULL 2								// Priorities, dedicated cores, locked memory and stacks
+#define PLACEMENT_DEFAULT_LEVEL PLACEMENT_NONE			// Level used when none is given (placement is opt-in)
+
+// Roles of the threads
+#define PLACEMENT_ROLE_CONTROL 0						// Control loop (able_UpdateRealTimeProcess)
+#define PLACEMENT_ROLE_FT_WRIST 1						// Wrist FT sensor stream (run_real_time_Measures)
+#define PLACEMENT_ROLE_FT_ARM 2							// Arm FT sensor stream (run_real_time_Measures)
+#define PLACEMENT_ROLE_QTM 3							// QTM and EMG stream (get_RealTimeQTMMeas)
+#define PLACEMENT_NB_ROLES 4
+
+// Settings obtained by a thread (bits of thread_Placement::applied)
+#define PLACEMENT_GOT_PRIORITY 0x01						// SetThreadPriority succeeded
+#define PLACEMENT_GOT_MMCSS 0x02						// Thread registered in the MMCSS task, critical priority
+#define PLACEMENT_GOT_AFFINITY 0x04						// Thread pinned to its core
+#define PLACEMENT_GOT_STACK 0x08						// Stack pre-faulted and locked
+#define PLACEMENT_STARTED 0x80							// Thread went through placement_ApplyThread
+
+// Placement constants
+#define PLACEMENT_MMCSS_TASK "Pro Audio"				// MMCSS task of the control thread (1 ms class)
+#define PLACEMENT_STACK_PREFAULT 262144					// Bytes of stack touched and locked at thread start
+#define PLACEMENT_WORKING_SET_MARGIN 67108864			// Resident memory kept above the committed memory (bytes)
+#define PLACEMENT_MIN_CORES 4							// Cores needed to dedicate cores (core 0 is left to Windows)
+#define PLACEMENT_LATE_RATIO 1.5						// Period counted as late above this ratio of the nominal one
+
+// ------------------------------------------------ THREAD PLACEMENT STRUCT --------------------------------------------
+struct thread_Placement
+{
+	int level;											// PLACEMENT_NONE, PLACEMENT_PRIORITY or PLACEMENT_FULL
+	int nb_cores;										// Number of logical processors
+	DWORD page_size;									// Size of a memory page (bytes)
+	int cores[PLACEMENT_NB_ROLES];						// Core of each role, -1 : not pinned
+	int priorities[PLACEMENT_NB_ROLES];					// Windows thread priority of each role
+	BOOL use_mmcss[PLACEMENT_NB_ROLES];					// True : register the thread in PLACEMENT_MMCSS_TASK
+	BOOL memory_locked;									// True : working set minimum set and control struct locked
+	SIZE_T working_set_min;								// Hard minimum of the working set (bytes)
+	volatile int applied[PLACEMENT_NB_ROLES];			// PLACEMENT_GOT_* flags obtained by each thread
+};
+
+// Configuration functions
+void placement_Init(int level);
+int placement_SetupProcess(FILE* err_file, FILE* out_file, void* locked, size_t locked_size);
+int placement_ApplyThread(FILE* err_file, int role);
+const char* placement_LevelName(int level);
+
+// Report functions
+void placement_PrintReport(FILE* out_file);
+void placement_ReportJitter(FILE* out_file, const char* name, const long long* ticks, size_t nb_ticks, double period);
+#endif // !THREAD_PLACEMENT_H
\ No newline at end of file
@@ -0,0 +1,85 @@
+/***********************************************************************************************************************
+* time_base.cpp -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Gives the ticks of the common time base and converts them into durations.
+***********************************************************************************************************************/
+
+#include "time_base.h"
+#include <Windows.h>
+
+/*---------------------------------------------------------------------------------------------------------------------
+| timebase_Now - Get the current tick of the common time base
+|
+| Syntax --
+|	long long timebase_Now()
+|
+| Outputs --
+|	long long -> current value of the performance counter (monotonic, same origin for every thread)
+----------------------------------------------------------------------------------------------------------------------*/
+long long timebase_Now()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| timebase_Frequency - Get the number of ticks per second
+|
+| Syntax --
+|	long long timebase_Frequency()
+|
+| Outputs --
+|	long long -> frequency of the performance counter (fixed at boot)
+----------------------------------------------------------------------------------------------------------------------*/
+long long timebase_Frequency()
+{
+	static long long frequency = 0;
+	LARGE_INTEGER value;
+
+	if (frequency == 0)
+	{
+		QueryPerformanceFrequency(&value);
+		frequency = value.QuadPart;
+	}
+	return frequency;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| timebase_Seconds - Convert a number of ticks into seconds
+|
+| Syntax --
+|	double timebase_Seconds(long long ticks)
+|
+| Inputs --
+|	long long ticks -> duration in ticks
+|
+| Outputs --
+|	double -> duration in seconds
+----------------------------------------------------------------------------------------------------------------------*/
+double timebase_Seconds(long long ticks)
+{
+	return (double)ticks / (double)timebase_Frequency();
+}
+
+/*---------------------------------------------------------------------------------------------------------------------
+| timebase_Micro - Convert a number of ticks into microseconds
+|
+| Syntax --
+|	long long timebase_Micro(long long ticks)
+|
+| Inputs --
+|	long long ticks -> duration in ticks
+|
+| Outputs --
+|	long long -> duration in microseconds
+----------------------------------------------------------------------------------------------------------------------*/
+long long timebase_Micro(long long ticks)
+{
+	long long frequency = timebase_Frequency();
+	return (ticks / frequency) * 1000000 + ((ticks % frequency) * 1000000) / frequency;
+}
@@ -0,0 +1,26 @@
+/***********************************************************************************************************************
+* time_base.h -
+*
+* Author : Dorian Verdel
+* Creation  date : 03/2021
+*
+* Description :
+* Manages the definition of the common time base. Every thread stamps its samples at acquisition with a tick of the
+* same monotonic clock (performance counter), so that drive, FT and QTM streams can be aligned afterwards.
+***********************************************************************************************************************/
+
+#pragma once
+
+#ifndef TIME_BASE_H
+#define TIME_BASE_H
+
+// Bounds of the measured iteration duration, relatively to the nominal period (protects the integrators)
+#define TIMEBASE_DT_MIN_RATIO 0.5f
+#define TIMEBASE_DT_MAX_RATIO 2.0f
+
+// Functions declaration
+long long timebase_Now();
+long long timebase_Frequency();
+double timebase_Seconds(long long ticks);
+long long timebase_Micro(long long ticks);
+#endif // !TIME_BASE_H
\ No newline at end of file
@@ -27,27 +27,30 @@ void able_TorqueAsserv(ThreadInformations* ableInfos)
 	// Substructs extraction
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
-	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
+	const RobotConfig* config = &ableInfos->ctrl_ABLE->config;
+	torque_ctrlState* ctrlState = &ableInfos->ctrl_ABLE->ctrlStates.torque;
 
 	// Variables declaration
 	float gain_Kp_V, gain_Kt;
-	static int counter_FatigueTest = 0;
+	float compensation_torques[NB_MOTORS];
+	bool fatigue_running = FALSE;
+
+	// Evaluate the dynamic model once for all axes, on the state of the cycle (state_Update)
+	able_ComputeDynModelCompensation(ableInfos, compensation_torques);
 
 	for (int i(0); i < NB_MOTORS; i++)
 	{
-		// Extract current data
-		able_ExtractData(ableInfos, i);
-		
 		// Compute torque control if activated motor
-		if (mValues->inhibition_State[i] == 0)
+		if (config->active[i])
 		{
-			// Compute filtered speed
-			able_ComputeDynModelCompensation(ableInfos, i);
+			// Select compensation of current axis
+			oValues->able_DynModTorque = compensation_torques[i];
 
 			// Set corresponding speed order to ignore the controller speed loop and build a torque control
-			gain_Kp_V = (float)mValues->Kp_V[i];
-			gain_Kt = mValues->kt_gain;
-			oValues->speedOrder[i] = oValues->able_DynModTorque / (gain_Kp_V * gain_Kt) + rtValues->currentSpeed[i];
+			gain_Kp_V = config->speed_gain[i];
+			gain_Kt = config->kt_gain;
+			oValues->speedOrder[i] = oValues->able_DynModTorque / (gain_Kp_V * gain_Kt) + state->speed[i];
 
 			// If digital FT sensor measures are used for control add data
 			if (rtValues->use_FT && oValues->ctrl_type == TORQUE_CTRL)
@@ -61,11 +64,16 @@ void able_TorqueAsserv(ThreadInformations* ableInfos)
 				}
 			}
 			else if (rtValues->use_FT && oValues->ctrl_type == MINJERK_TRAJS) {
-				able_FatigueTestFT_Control(ableInfos, i, counter_FatigueTest);
-				counter_FatigueTest++;
+				able_FatigueTestFT_Control(ableInfos, i, ctrlState->time_FatigueTest);
+				fatigue_running = TRUE;
 			}
 		}
 	}
+	// Advance the fatigue test time once per iteration, from the measured period
+	if (fatigue_running)
+	{
+		ctrlState->time_FatigueTest += rtValues->cycle_dt;
+	}
 	// Store current values
 	storeValuesInVectors(ableInfos);
 	// Print current values
@@ -78,44 +86,37 @@ void able_TorqueAsserv(ThreadInformations* ableInfos)
 // ----------------------------------------------- DYNAMIC MODEL COMPENSATION ------------------------------------------
 
 /*----------------------------------------------------------------------------------------------------------------------
-| able_ComputeDynModelCompensation - Compute dynamic model compensation to apply (inertial torques are ignored for now)
+| able_ComputeDynModelCompensation - Compute dynamic model compensation of every axis (inertial torques with the RNEA
+|									 backend only)
 |
 | Syntax --
-|	void able_ComputeDynModelCompensation(ThreadInformations* ableInfos, int i)
+|	void able_ComputeDynModelCompensation(ThreadInformations* ableInfos, float* compensation_torques)
 |
 | Inputs --
 |	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
-|	int i -> Counter corresponding to the motor number
+|	float* compensation_torques -> filled with the compensation of each of the NB_MOTORS axes
+|
+| Remarks --
+|	Data of every axis must have been extracted. The model is evaluated once per iteration, analytically, in the
+|	compensation map or by inverse dynamics (rtParams.model_backend), able_ComputeDynModelStat remains the reference
+|	implementation (see MODEL_BENCH).
 ----------------------------------------------------------------------------------------------------------------------*/
-void able_ComputeDynModelCompensation(ThreadInformations* ableInfos, int i)
+void able_ComputeDynModelCompensation(ThreadInformations* ableInfos, float* compensation_torques)
 {
-	// Extract "real-time" substructs
-	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
-	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
-	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
-	// Extract dynamic parameters substructs
-	ableDynamics* aDyns = &ableInfos->ctrl_ABLE->aDynamics;
-	able_Axis3_model* ax3_mod = &aDyns->axis3_mod;
-	able_Axis4_model* ax4_mod = &aDyns->axis4_mod;
-	frictions* fmds3 = &aDyns->axis3_mod.frictions3;
-	frictions* fmds4 = &aDyns->axis4_mod.frictions4;
-
-	// Initialise variables
-	float art_speed_3, art_speed_4;
-	float compensation_torque = 0.0f;
-
-	// Compute current speeds
-	art_speed_3 = rtValues->currentSpeed[2] * 2 * (float)M_PI / mValues->able_AxisReductions[2];
-	art_speed_4 = rtValues->currentSpeed[3] * 2 * (float)M_PI / mValues->able_AxisReductions[3];
-
 	//mean_speed_3 = speed_MeanFilter(ableInfos, art_speed_3);
 	//mean_speed_4 = speed_MeanFilter(ableInfos, art_speed_4);
 
-	// Compute compensation according to speed
-	compensation_torque = able_ComputeDynModelStat(ableInfos, i);
-
-	// Compute final command torque
-	oValues->able_DynModTorque = compensation_torque;
+	// Compute compensation of all axes with the selected backend
+	if (ableInfos->ctrl_ABLE->rtParams.model_backend == MODEL_BACKEND_MAP)
+	{
+		model_ComputeCompensationMap(ableInfos->ctrl_ABLE, compensation_torques);
+	}
+	else if (ableInfos->ctrl_ABLE->rtParams.model_backend == MODEL_BACKEND_RNEA) {
+		model_ComputeCompensationRnea(ableInfos->ctrl_ABLE, compensation_torques);
+	}
+	else {
+		model_ComputeCompensation(ableInfos->ctrl_ABLE, compensation_torques);
+	}
 }
 
 /*----------------------------------------------------------------------------------------------------------------------
@@ -135,6 +136,7 @@ float able_ComputeDynModelStat(ThreadInformations* ableInfos, int i)
 {
 	// Extract "real-time" substructs
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
 	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
 	// Extract dynamic parameters substructs
 	ableDynamics* aDyns = &ableInfos->ctrl_ABLE->aDynamics;
@@ -160,15 +162,15 @@ float able_ComputeDynModelStat(ThreadInformations* ableInfos, int i)
 	compensation_torque = 0.0f;
 
 	// Compute articular position, speed and mean speed
-	art_theta_i = rtValues->currentPosition[i];
-	art_speed_i = rtValues->currentSpeed[i] * 2 * (float)M_PI / mValues->able_AxisReductions[i];
+	art_theta_i = state->position[i];
+	art_speed_i = state->speed[i] * 2 * (float)M_PI / mValues->able_AxisReductions[i];
 
 	// Compute dynamic model compensation according to current axis
 	if (i == NB_MOTORS - 2)
 	{
 		// Compute data of fourth axis
-		art_theta_ip1 = rtValues->currentPosition[i + 1];
-		art_speed_ip1 = rtValues->currentSpeed[i + 1] * 2 * (float)M_PI / mValues->able_AxisReductions[i + 1];
+		art_theta_ip1 = state->position[i + 1];
+		art_speed_ip1 = state->speed[i + 1] * 2 * (float)M_PI / mValues->able_AxisReductions[i + 1];
 		// Compute friction compensation
 		friction_torque = (fmds4->adhfric + fmds3->visc_frics[0] * art_speed_i) * rtValues->friction_comp;
 		// Compute gravity  compensation
@@ -187,8 +189,8 @@ float able_ComputeDynModelStat(ThreadInformations* ableInfos, int i)
 
 	} else if (i == NB_MOTORS - 1) {
 		// Compute data of third axis
-		art_theta_im1 = rtValues->currentPosition[i - 1];
-		art_speed_im1 = rtValues->currentSpeed[i - 1] * 2 * (float)M_PI / mValues->able_AxisReductions[i - 1];
+		art_theta_im1 = state->position[i - 1];
+		art_speed_im1 = state->speed[i - 1] * 2 * (float)M_PI / mValues->able_AxisReductions[i - 1];
 		// Compute friction compensation
 		friction_torque = (fmds4->adhfric + fmds4->visc_frics[0] * art_speed_i) * rtValues->friction_comp;
 		// Compute gravity  compensation
@@ -222,12 +224,12 @@ void able_TransparentFT_Control(ThreadInformations* ableInfos, int i)
 {
 	// Extract substructs
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
-	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
 	received_FT_meas* ftValues_Arm = &ableInfos->ctrl_ABLE->current_FT_meas_Arm;
 	received_FT_meas* ftValues_Wrist = &ableInfos->ctrl_ABLE->current_FT_meas_Wrist;
+	float* integral_sum = ableInfos->ctrl_ABLE->ctrlStates.torque.transparent_sum;
 
 	// Initialise variables
-	static float integral_sum[NB_MOTORS];
 	float error, art_theta_ip1, art_theta_i;
 	
 	error = 0.0f;
@@ -235,17 +237,17 @@ void able_TransparentFT_Control(ThreadInformations* ableInfos, int i)
 	// Compute parameters
 	if (i == NB_MOTORS - 2)
 	{
-		art_theta_i = rtValues->currentPosition[i];
-		art_theta_ip1 = rtValues->currentPosition[i + 1];
-		error = -ftValues_Arm->f_z;
-		integral_sum[i] += error * rtValues->sampling_frequency;				// Compute integral error
+		art_theta_i = state->position[i];
+		art_theta_ip1 = state->position[i + 1];
+		error = -ftValues_Arm->filtered[2];
+		integral_sum[i] -= ftValues_Arm->impulse[2];				// Integral error, integrated at the sensor rate
 		// Compute transparent order to apply
 		oValues->speedOrder[i] += error * ftValues_Arm->k_fp
 			                    + ftValues_Arm->k_fi * integral_sum[i];
 	} else if (i == NB_MOTORS - 1)
 	{
-		error = -ftValues_Wrist->f_z;									// Compute current wrist error
-		integral_sum[i] += error * rtValues->sampling_frequency;		// Compute integral error
+		error = -ftValues_Wrist->filtered[2];							// Compute current wrist error
+		integral_sum[i] -= ftValues_Wrist->impulse[2];		// Integral error, integrated at the sensor rate
 		// Compute transparent order to apply
 		oValues->speedOrder[i] += error * ftValues_Wrist->k_fp + ftValues_Wrist->k_fi * integral_sum[i];
 	}
@@ -266,18 +268,19 @@ void able_AntigravFT_Control(ThreadInformations* ableInfos, int i)
 	// Extract substructs
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
+	const RobotState* state = &ableInfos->ctrl_ABLE->state;
 	received_FT_meas* ftValues = &ableInfos->ctrl_ABLE->current_FT_meas_Wrist;
 	humanDyn* hmds = &ableInfos->ctrl_ABLE->hDynId;
+	float* integral_sum = ableInfos->ctrl_ABLE->ctrlStates.torque.antigrav_sum;
 
 	// Initialise variables
-	static float integral_sum[NB_MOTORS];
 	float error, theoretical_fz, art_theta_i;
 
 	// Compute parameters
-	art_theta_i = rtValues->currentPosition[i];					// Get current axis position
+	art_theta_i = state->position[i];					// Get current axis position
 	theoretical_fz = -hmds->mass * G_VAL * cos(art_theta_i + hmds->delta_theta) * oValues->antiG_value;
-	error = theoretical_fz - ftValues->f_z;						// Compute current error
-	integral_sum[i] += error * rtValues->sampling_frequency;	// Compute integral error
+	error = theoretical_fz - ftValues->filtered[2];				// Compute current error
+	integral_sum[i] += theoretical_fz * rtValues->cycle_dt - ftValues->impulse[2];	// Compute integral error
 
 	// Compute antigravity order to apply
 	oValues->speedOrder[i] += rtValues->correct_fz_antigrav * (0.205f * theoretical_fz + 0.398f)
@@ -291,34 +294,35 @@ void able_AntigravFT_Control(ThreadInformations* ableInfos, int i)
 | able_FatigueTestFT_Control - Achieve fatigue tests by applying a constant force on the participant
 |
 | Syntax --
-|	void able_FatigueTestFT_Control(ThreadInformations* ableInfos, int i)
+|	void able_FatigueTestFT_Control(ThreadInformations* ableInfos, int i, float time_FatigueTest)
 |
 | Inputs --
 |	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
 |	int i -> Counter corresponding to the motor number
+|	float time_FatigueTest -> time since the start of the fatigue test (s)
 ----------------------------------------------------------------------------------------------------------------------*/
-void able_FatigueTestFT_Control(ThreadInformations* ableInfos, int i, int counter_FatigueTest)
+void able_FatigueTestFT_Control(ThreadInformations* ableInfos, int i, float time_FatigueTest)
 {
 	// Extract substructs
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
 	received_FT_meas* ftValues = &ableInfos->ctrl_ABLE->current_FT_meas_Wrist;
+	float* integral_sum = ableInfos->ctrl_ABLE->ctrlStates.torque.fatigue_sum;
 
 	// Initialise variables
-	static float integral_sum[NB_MOTORS];
 	float error;
 
 	// Compute constant force orders for fatigue blocks
-	if (counter_FatigueTest < NB_MEASURES_FATIGUE_TEST) {
+	if (time_FatigueTest < FATIGUE_TEST_DURATION) {
 		// First block with positive force (fatigue of triceps)
-		error = FORCE_FATIGUE_TEST - ftValues->f_z;
-		integral_sum[i] += error * rtValues->sampling_frequency;
+		error = FORCE_FATIGUE_TEST - ftValues->filtered[2];
+		integral_sum[i] += FORCE_FATIGUE_TEST * rtValues->cycle_dt - ftValues->impulse[2];
 		oValues->speedOrder[i] += error * ftValues->k_fp + ftValues->k_fi * integral_sum[i];
 	}
-	else if (counter_FatigueTest >= NB_MEASURES_FATIGUE_TEST && counter_FatigueTest < 2 * NB_MEASURES_FATIGUE_TEST) {
+	else if (time_FatigueTest >= FATIGUE_TEST_DURATION && time_FatigueTest < 2 * FATIGUE_TEST_DURATION) {
 		// Second block with negative force (fatigue of biceps)
-		error = -FORCE_FATIGUE_TEST - ftValues->f_z;
-		integral_sum[i] += error * rtValues->sampling_frequency;
+		error = -FORCE_FATIGUE_TEST - ftValues->filtered[2];
+		integral_sum[i] += -FORCE_FATIGUE_TEST * rtValues->cycle_dt - ftValues->impulse[2];
 		oValues->speedOrder[i] += error * ftValues->k_fp + ftValues->k_fi * integral_sum[i];
 	}
 	else {
@@ -344,7 +348,7 @@ float speed_MeanFilter(ThreadInformations* ableInfos, float art_speed_i)
 {
 	// Extract substructs
 	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
-	ableMeasures* measValues = &ableInfos->ctrl_ABLE->aMeasures;
+	ableMeasures* measValues = ableInfos->ctrl_ABLE->aMeasures;
 
 	// Re-initialise variable
 	float mean_speed = 0.0f;
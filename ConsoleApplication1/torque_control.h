@@ -16,18 +16,19 @@
 #include "communication_struct_ABLE.h"
 #include "utils_for_ABLE_Com.h"
 #include "data_recording_functions.h"
+#include "able_DynamicModel.h"
 
 // Torque control main function
 void able_TorqueAsserv(ThreadInformations* ableInfos);
 
 // Dynamic model compensations computation
-void able_ComputeDynModelCompensation(ThreadInformations* ableInfos, int i);
+void able_ComputeDynModelCompensation(ThreadInformations* ableInfos, float* compensation_torques);
 float able_ComputeDynModelStat(ThreadInformations* ableInfos, int i);
 
 // FT control functions
 void able_TransparentFT_Control(ThreadInformations* ableInfos, int i);
 void able_AntigravFT_Control(ThreadInformations* ableInfos, int i);
-void able_FatigueTestFT_Control(ThreadInformations* ableInfos, int i, int counter_FatigueTest);
+void able_FatigueTestFT_Control(ThreadInformations* ableInfos, int i, float time_FatigueTest);
 
 // Computational functions
 float speed_MeanFilter(ThreadInformations* ableInfos, float art_speed_i);
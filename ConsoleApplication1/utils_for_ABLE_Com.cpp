@@ -91,35 +91,6 @@ void check_state(ThreadInformations* ableInfos)
 
 // ----------------------------------------------- DATA EXTRACTION FUNCTIONS -------------------------------------------
 
-/*----------------------------------------------------------------------------------------------------------------------
-| able_ExtractData - Extract data sent by ABLE
-|
-| Syntax --
-|	void able_ExtractData(ThreadInformations* ableInfos, int i)
-|
-| Inputs --
-|	ThreadInformations* ableInfos -> pointer towards the structure containing all the informations
-|	int i -> Counter corresponding to the motor number
-----------------------------------------------------------------------------------------------------------------------*/
-void able_ExtractData(ThreadInformations* ableInfos, int i)
-{
-	// Variables Declaration
-	static float art_theta_i, measured_current;
-	struct realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
-	struct motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
-	// Storing current data in the control struct
-	rtValues->currentCoderPosition[i] = ableInfos->eth_ABLE->moteur[i].Position_Codeur;
-	rtValues->currentSpeed[i] = ableInfos->eth_ABLE->moteur[i].Vitesse_Filtree;
-	rtValues->currentVoltage[i] = ableInfos->eth_ABLE->moteur[i].ADC_Potentiometre;
-	// Expression of the current given by the constructor of ABLE
-	measured_current = static_cast<float>(mValues->Kconv_I[i])*
-		(static_cast<float>(ableInfos->eth_ABLE->moteur[i].ADC_Courant) - static_cast<float>(mValues->offset_ADC[i]));
-	rtValues->currentADCcurrent[i] = measured_current;
-	// Compute current position of axis i
-	art_theta_i = able_ComputeCurrentPosition(rtValues->currentCoderPosition[i], mValues->able_AxisReductions[i]);
-	rtValues->currentPosition[i] = art_theta_i;
-}
-
 /*---------------------------------------------------------------------------------------------------------------------
 | able_ComputeCurrentPosition - Compute the current position of an axis thanks to current coder position and the sign
 |                               of the position (signed value)
@@ -175,16 +146,7 @@ void able_SendNullSpeedOrder(ServoComEth* eth_ABLE, AbleControlStruct* ctrl_ABLE
 	// Transmit orders to ABLE
 	ETH_carte_variateur_V3_Send_Consignes(eth_ABLE);
 	// Wait to respect sampling frequency of ABLE
-	auto timestamp_1_w = high_resolution_clock::now();
-	while (true)
-	{
-		auto timestamp_2_w = high_resolution_clock::now();
-		duration<double> elapsed_w = timestamp_2_w - timestamp_1_w;
-		if (elapsed_w.count() > 0.001f)
-		{
-			break;
-		}
-	}
+	able_WaitPeriod(timebase_Now(), ctrl_ABLE->rtParams.sampling_frequency);
 }
 
 /*---------------------------------------------------------------------------------------------------------------------
@@ -222,14 +184,14 @@ void sature_SpeedOrders(ThreadInformations* ableInfos)
 	motorsParams* mValues = &ableInfos->ctrl_ABLE->mParams;
 	ableOrders* oValues = &ableInfos->ctrl_ABLE->aOrders;
 	realTimeParams* rtValues = &ableInfos->ctrl_ABLE->rtParams;
-	float direction, timer = 0.0f;
+	float direction = 0.0f;
+	bool speed_limited = rtValues->elapsed_time <= SPEED_LIMIT_TIME;
 
 	//fprintf(ableInfos->out_file, "SAT SPEED\n");
 	if (oValues->ctrl_type == MINJERK_TRAJS)
 	{
 		direction = rtValues->current_endMinJerk - rtValues->current_startMinJerk;
-		rtValues->timer_jerk_end_move++;
-		timer = rtValues->timer_jerk_end_move / 100.0f;
+		rtValues->timer_jerk_end_move += rtValues->cycle_dt;
 	}
 
 	// Sature speeds
@@ -237,11 +199,11 @@ void sature_SpeedOrders(ThreadInformations* ableInfos)
 	{
 		// MAX_SPEED : 35 (Constructor)
 		if (oValues->speedOrder[i] > 20.0f && oValues->ctrl_type == TORQUE_CTRL && rtValues->order_counter != 0 &&
-			rtValues->iter_counter <= 6000)
+			speed_limited)
 		{
 			oValues->speedOrder[i] = 20.0f;
 		}
-		else if (oValues->speedOrder[i] > 40.0f && oValues->ctrl_type == TORQUE_CTRL && rtValues->iter_counter > 6000)
+		else if (oValues->speedOrder[i] > 40.0f && oValues->ctrl_type == TORQUE_CTRL && !speed_limited)
 		{
 			oValues->speedOrder[i] = 40.0f;
 		}
@@ -275,6 +237,11 @@ void sature_SpeedOrders(ThreadInformations* ableInfos)
 		{
 			oValues->speedOrder[i] = 20.0f;
 		}
+		else if (oValues->speedOrder[i] > 20.0f && rtValues->order_counter != 0 && (oValues->ctrl_type == CARTESIAN_CTRL ||
+			oValues->ctrl_type == HAPTIC_CTRL))
+		{
+			oValues->speedOrder[i] = 20.0f;
+		}
 		else if (oValues->speedOrder[i] > 10.0f && (rtValues->order_counter == 0 || oValues->ctrl_type == STATIC_IDENT)
 			&& oValues->ctrl_type != MINJERK_TRAJS)
 		{
@@ -282,11 +249,11 @@ void sature_SpeedOrders(ThreadInformations* ableInfos)
 		}
 		// MIN_SPEED : -35 (Constructor)
 		if (oValues->speedOrder[i] < -20.0f && oValues->ctrl_type == TORQUE_CTRL && rtValues->order_counter != 0 &&
-			rtValues->iter_counter <= 6000)
+			speed_limited)
 		{
 			oValues->speedOrder[i] = -20.0f;
 		}
-		else if (oValues->speedOrder[i] < -40.0f && oValues->ctrl_type == TORQUE_CTRL && rtValues->iter_counter > 6000)
+		else if (oValues->speedOrder[i] < -40.0f && oValues->ctrl_type == TORQUE_CTRL && !speed_limited)
 		{
 			oValues->speedOrder[i] = -40.0f;
 		}
@@ -320,6 +287,11 @@ void sature_SpeedOrders(ThreadInformations* ableInfos)
 		{
 			oValues->speedOrder[i] = -20.0f;
 		}
+		else if (oValues->speedOrder[i] < -20.0f && rtValues->order_counter != 0 && (oValues->ctrl_type == CARTESIAN_CTRL ||
+			oValues->ctrl_type == HAPTIC_CTRL))
+		{
+			oValues->speedOrder[i] = -20.0f;
+		}
 		else if (oValues->speedOrder[i] < -10.0f && (rtValues->order_counter == 0 || oValues->ctrl_type == STATIC_IDENT)
 			&& oValues->ctrl_type != MINJERK_TRAJS)
 		{
@@ -331,19 +303,24 @@ void sature_SpeedOrders(ThreadInformations* ableInfos)
 // ---------------------------------------------------- TIMING FUNCTIONS -----------------------------------------------
 
 /*----------------------------------------------------------------------------------------------------------------------
-| able_OneMsWait - Wait one millisecond
+| able_WaitPeriod - Wait until one control period has elapsed since the start of the iteration
 |
 | Syntax --
-|	void able_OneMsWait()
+|	void able_WaitPeriod(long long cycle_tick, float period)
+|
+| Inputs --
+|	long long cycle_tick -> timebase tick taken at the start of the iteration
+|	float period -> nominal period of the control loop (s, sampling_frequency)
+|
+| Remarks --
+|	The deadline is computed once in ticks, so the wait does not add the computation time of the iteration to the
+|	period. If the deadline is already passed, the function returns immediately.
 ----------------------------------------------------------------------------------------------------------------------*/
-void able_OneMsWait()
+void able_WaitPeriod(long long cycle_tick, float period)
 {
-	auto timestamp_1_w = high_resolution_clock::now();
-	while (true)
+	long long deadline = cycle_tick + (long long)(period * (double)timebase_Frequency());
+	while (timebase_Now() < deadline)
 	{
-		auto timestamp_2_w = high_resolution_clock::now();
-		duration<double> elapsed_w = timestamp_2_w - timestamp_1_w;
-		if (elapsed_w.count() > 0.001f) { break; }
 	}
 }
 
@@ -19,7 +19,6 @@
 void check_state(ThreadInformations* ableInfos);			// Function to check the healthy behaviour of ABLE
 
 // Data extraction functions definition
-void able_ExtractData(ThreadInformations* ableInfos, int i);		// Extract current data from ETH struct
 float able_ComputeCurrentPosition(int coder_pos, float reduction);	// Compute current position of an axis
 
 // Particular orders functions definition
@@ -28,7 +27,7 @@ void able_SetPowerOff(ServoComEth* eth_ABLE, AbleControlStruct* ctrl_ABLE);
 void sature_SpeedOrders(ThreadInformations* ableInfos);
 
 // Timing functions definition
-void able_OneMsWait();														// Function to wait 1ms (sampling frequency)
+void able_WaitPeriod(long long cycle_tick, float period);					// Wait until the end of the control period
 void able_WaitPower(ServoComEth* eth_ABLE, AbleControlStruct* ctrl_ABLE);	// Wait for 48V
 void end_time_wait();														// Wait at the end of execution
 